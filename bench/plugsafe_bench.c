@@ -0,0 +1,643 @@
+/*
+ * PlugSafe On-Target Benchmark
+ * Times the OLED, analysis and logging hot paths on the RP2040 at boot
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/clocks.h"
+#include "hardware/uart.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/structs/systick.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "oled_i2c.h"
+#include "oled_driver.h"
+#include "oled_display.h"
+#include "oled_graphics.h"
+#include "oled_text.h"
+#include "oled_font.h"
+#include "oled_widget.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+#include "flight_recorder.h"
+#include "event_queue.h"
+#include "deferred_log.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include "scheduler.h"
+
+/* Same wiring as main.c */
+#define I2C_SDA_PIN                   20
+#define I2C_SCL_PIN                   21
+#define I2C_PORT                      i2c0
+#define I2C_BAUDRATE                  400000
+#define OLED_ADDRESS                  0x3C
+
+/* Configuration */
+#define BENCH_MAX_SAMPLES             256   /* Per-iteration cycle samples kept */
+#define BENCH_FORMAT_VERSION          1
+#define BENCH_DEV_ADDR                1
+#define BENCH_REPORT_PERIOD_US        25000 /* 40 reports/s: below the threshold */
+#define CORE1_STACK_SIZE_WORDS        2048
+
+#ifndef PLUGSAFE_BUILD_ID
+#define PLUGSAFE_BUILD_ID             "unknown"
+#endif
+
+/* SysTick as a free-running 24-bit down-counter at the CPU clock (the
+ * Cortex-M0+ has no DWT cycle counter) */
+#define SYSTICK_CSR_ENABLE_CPU_CLK    0x5u
+#define SYSTICK_MASK                  0x00FFFFFFu
+
+/* One benchmark case. setup() runs once, prepare() before every iteration
+ * (untimed), run() is the timed part. */
+typedef struct {
+    const char *name;
+    uint32_t iterations;
+    uint8_t core;                     /* Core the case runs on */
+    bool needs_panel;                 /* Skipped when no display answered */
+    void (*setup)(void);
+    void (*prepare)(void);
+    void (*run)(uint32_t i);
+    void (*finish)(void);             /* After the last iteration, on core 0 */
+    void (*background)(void);         /* Core 1 cases: run repeatedly on core 0 meanwhile */
+} bench_case_t;
+
+typedef struct {
+    uint32_t iterations;
+    uint64_t total_us;
+    uint32_t min_cycles;
+    uint32_t median_cycles;
+    uint32_t max_cycles;
+} bench_result_t;
+
+static oled_i2c_t g_i2c;
+static oled_driver_t g_driver;
+static oled_display_t g_display;
+static const oled_font_t *g_font;
+static bool g_panel_ok;
+
+static uint32_t g_samples[BENCH_MAX_SAMPLES];
+static bench_result_t g_result;
+static uint32_t core1_stack[CORE1_STACK_SIZE_WORDS];
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static inline uint32_t _cycles_now(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t _cycles_since(uint32_t start) {
+    return (start - systick_hw->cvr) & SYSTICK_MASK;
+}
+
+static int _cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Run one case on the calling core. Iterations longer than the
+ * SysTick wrap (2^24 cycles, ~134 ms at 125 MHz) have unreliable cycle
+ * counts; their wall time is still correct.
+ */
+static void _measure(const bench_case_t *c, bench_result_t *result) {
+    if (c->setup) {
+        c->setup();
+    }
+    uint32_t kept = 0;
+    uint64_t total_us = 0;
+    for (uint32_t i = 0; i < c->iterations; i++) {
+        if (c->prepare) {
+            c->prepare();
+        }
+        uint64_t start_us = timebase_now_us();
+        uint32_t start = _cycles_now();
+        c->run(i);
+        uint32_t cycles = _cycles_since(start);
+        total_us += timebase_now_us() - start_us;
+        if (kept < BENCH_MAX_SAMPLES) {
+            g_samples[kept++] = cycles;
+        }
+    }
+    qsort(g_samples, kept, sizeof(g_samples[0]), _cmp_u32);
+    result->iterations = c->iterations;
+    result->total_us = total_us;
+    result->min_cycles = kept ? g_samples[0] : 0;
+    result->median_cycles = kept ? g_samples[kept / 2] : 0;
+    result->max_cycles = kept ? g_samples[kept - 1] : 0;
+}
+
+/* ============================================================================
+ * CASES: OLED
+ * ============================================================================ */
+
+/**
+ * @brief A device screen drawn whole, as main.c did before widgets
+ */
+static void _draw_device_screen(const char *rate) {
+    oled_display_clear(&g_display);
+    oled_draw_string(&g_display, 10, 2, "Device Detected!", g_font, true);
+    oled_draw_string(&g_display, 5, 12, "USB Keyboard", g_font, true);
+    oled_draw_string(&g_display, 5, 22, "VID:16C0 PID:27DB", g_font, true);
+    oled_draw_string(&g_display, 5, 32, "Class: HID (KBD)", g_font, true);
+    oled_draw_string(&g_display, 5, 42, "Threat: CAUTION", g_font, true);
+    oled_draw_string(&g_display, 0, 56, rate, g_font, true);
+    oled_draw_string(&g_display, 80, 56, "BOOTSEL", g_font, true);
+}
+
+static void _setup_device_screen(void) {
+    _draw_device_screen("Rate: 12/s");
+}
+
+/* Full frames: forget what the panel holds before each flush */
+static void _prepare_full_frame(void) {
+    oled_display_invalidate(&g_display);
+}
+
+/* A typical UI refresh: the screen redrawn with only the rate changed */
+static void _prepare_rate_update(void) {
+    static uint32_t rate;
+    char line[24];
+    snprintf(line, sizeof(line), "Rate: %u/s", (unsigned)(10 + rate++ % 10));
+    _draw_device_screen(line);
+}
+
+static void _run_flush(uint32_t i) {
+    (void)i;
+    oled_display_flush(&g_display);
+}
+
+/* Baseline: how oled_i2c_write_raw() used to send a payload, copied
+ * behind the control byte in a stack array of len + 1 */
+static bool _write_data_vla(const uint8_t *data, size_t len) {
+    uint8_t msg[len + 1];
+    msg[0] = OLED_I2C_CTRL_DATA;
+    for (size_t i = 0; i < len; i++) {
+        msg[i + 1] = data[i];
+    }
+    return i2c_write_blocking(g_i2c.i2c, g_i2c.address, msg, len + 1, false) == (int)(len + 1);
+}
+
+/* Baseline: the frame as page, column and data transactions per page */
+static void _run_flush_per_page(uint32_t i) {
+    (void)i;
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        oled_driver_set_page(&g_driver, page);
+        oled_driver_set_column(&g_driver, 0);
+        _write_data_vla(g_display.buffer + page * OLED_WIDTH, OLED_WIDTH);
+    }
+}
+
+/* Time for a full-frame asynchronous flush; the previous one is waited
+ * for untimed */
+static void _prepare_flush_idle(void) {
+    oled_display_flush_wait(&g_display);
+    oled_display_invalidate(&g_display);
+}
+
+static void _run_flush_async(uint32_t i) {
+    (void)i;
+    oled_display_flush_async(&g_display, NULL, NULL);
+}
+
+static void _finish_flush_async(void) {
+    oled_display_flush_wait(&g_display);
+}
+
+static void _run_page_vla(uint32_t i) {
+    _write_data_vla(g_display.buffer + (i % OLED_PAGES) * OLED_WIDTH, OLED_WIDTH);
+}
+
+static void _run_page_in_place(uint32_t i) {
+    oled_i2c_write_data_in_place(&g_i2c, g_display.buffer + (i % OLED_PAGES) * OLED_WIDTH,
+                                 OLED_WIDTH);
+}
+
+static void _run_clear(uint32_t i) {
+    (void)i;
+    oled_display_clear(&g_display);
+}
+
+static void _run_glyph_aligned(uint32_t i) {
+    oled_draw_char(&g_display, (int)(i % 20) * 6, 8, 'A', g_font, true);
+}
+
+static void _run_glyph_unaligned(uint32_t i) {
+    oled_draw_char(&g_display, (int)(i % 20) * 6, 12, 'A', g_font, true);
+}
+
+static void _run_string_aligned(uint32_t i) {
+    (void)i;
+    oled_draw_string(&g_display, 5, 16, "Threat: CAUTION", g_font, true);
+}
+
+static void _run_string_unaligned(uint32_t i) {
+    (void)i;
+    oled_draw_string(&g_display, 5, 22, "Threat: CAUTION", g_font, true);
+}
+
+/* Baseline: how oled_draw_char() used to draw, one oled_draw_pixel() per
+ * pixel of the glyph cell */
+static void _draw_string_per_pixel(int x, int y, const char *str) {
+    for (const char *p = str; *p; p++, x += g_font->char_width) {
+        int offset = (*p - g_font->start_char) * g_font->char_width;
+        for (int row = 0; row < g_font->height; row++) {
+            for (int col = 0; col < g_font->char_width; col++) {
+                bool pixel = (g_font->data[offset + col] & (1 << row)) != 0;
+                oled_draw_pixel(&g_display, x + col, y + row, pixel);
+            }
+        }
+    }
+}
+
+static void _run_string_per_pixel(uint32_t i) {
+    (void)i;
+    _draw_string_per_pixel(5, 22, "Threat: CAUTION");
+}
+
+/* The same screen as main.c keeps it: widgets, with the rate the one
+ * bound value */
+static uint32_t g_rate;
+
+static void _bind_rate(const void *model, char *out, size_t size) {
+    snprintf(out, size, "Rate: %u/s", (unsigned)*(const uint32_t *)model);
+}
+
+#define BENCH_LABEL(px, py, str) \
+    { .type = OLED_WIDGET_LABEL, .x = (px), .y = (py), \
+      .w = OLED_WIDTH - (px), .h = 7, .text = (str) }
+
+static oled_widget_t g_device_widgets[] = {
+    BENCH_LABEL(10, 2, "Device Detected!"),
+    BENCH_LABEL(5, 12, "USB Keyboard"),
+    BENCH_LABEL(5, 22, "VID:16C0 PID:27DB"),
+    BENCH_LABEL(5, 32, "Class: HID (KBD)"),
+    BENCH_LABEL(5, 42, "Threat: CAUTION"),
+    { .type = OLED_WIDGET_VALUE, .x = 0, .y = 56, .w = 80, .h = 7, .text_fn = _bind_rate },
+    BENCH_LABEL(80, 56, "BOOTSEL"),
+};
+
+static oled_screen_t g_device_screen = {
+    g_device_widgets, sizeof(g_device_widgets) / sizeof(g_device_widgets[0]), NULL
+};
+
+static void _setup_widget_screen(void) {
+    g_device_screen.font = g_font;
+    g_rate = 12;
+    oled_display_clear(&g_display);
+    oled_screen_invalidate(&g_device_screen);
+    oled_screen_update(&g_device_screen, &g_display, &g_rate);
+    oled_display_flush(&g_display);
+}
+
+/* A display task run with nothing new: no widget redrawn, nothing sent */
+static void _run_screen_idle(uint32_t i) {
+    (void)i;
+    oled_screen_update(&g_device_screen, &g_display, &g_rate);
+    oled_display_flush(&g_display);
+}
+
+/* A display task run after the rate changed: one widget redrawn and sent */
+static void _run_screen_rate_update(uint32_t i) {
+    g_rate = 10 + i % 10;
+    oled_screen_update(&g_device_screen, &g_display, &g_rate);
+    oled_display_flush(&g_display);
+}
+
+static void _run_device_screen(uint32_t i) {
+    (void)i;
+    _setup_device_screen();
+}
+
+static void _run_rect_fill_full(uint32_t i) {
+    (void)i;
+    oled_draw_rect(&g_display, 0, 0, OLED_WIDTH, OLED_HEIGHT, true, true);
+}
+
+static void _run_rect_fill_small(uint32_t i) {
+    (void)i;
+    oled_draw_rect(&g_display, 5, 3, 20, 10, true, true);
+}
+
+static void _run_rect_outline(uint32_t i) {
+    (void)i;
+    oled_draw_rect(&g_display, 0, 0, OLED_WIDTH, OLED_HEIGHT, false, true);
+}
+
+/* Baseline: how the full-screen fill used to be drawn, pixel by pixel */
+static void _run_rect_fill_per_pixel(uint32_t i) {
+    (void)i;
+    for (int y = 0; y < OLED_HEIGHT; y++) {
+        for (int x = 0; x < OLED_WIDTH; x++) {
+            oled_draw_pixel(&g_display, x, y, true);
+        }
+    }
+}
+
+static void _run_circle_fill(uint32_t i) {
+    (void)i;
+    oled_draw_circle(&g_display, 64, 32, 20, true, true);
+}
+
+/* ============================================================================
+ * CASES: ANALYSIS AND LOGGING (core 1)
+ * ============================================================================ */
+
+static uint64_t g_report_us;
+
+/**
+ * @brief A mounted boot keyboard, as the mount callbacks leave it
+ */
+static void _setup_keyboard(void) {
+    hid_monitor_init();
+    threat_analyzer_init();
+    flight_recorder_init();
+    usb_device_info_t dev = {
+        .dev_addr = BENCH_DEV_ADDR,
+        .vid = 0x16C0,
+        .pid = 0x27DB,
+        .usb_class = 0,
+        .is_hid = true,
+        .hid_protocol = 1,
+        .is_mounted = true,
+        .descriptor_ready = true
+    };
+    strcpy(dev.product, "Keyboard");
+    threat_add_device(&dev);
+    hid_monitor_add_device(BENCH_DEV_ADDR);
+    flight_recorder_add_interface(BENCH_DEV_ADDR, 0, 1, NULL, 0);
+    g_report_us = timebase_now_us();
+}
+
+/**
+ * @brief The analysis half of tuh_hid_report_received_cb(): alternating
+ * key press and release reports at 40 reports/s of arrival time
+ */
+static void _run_report_analysis(uint32_t i) {
+    static const uint8_t press[8] = { 0, 0, 0x04, 0, 0, 0, 0, 0 };
+    static const uint8_t release[8] = { 0 };
+    const uint8_t *report = (i & 1) ? release : press;
+    g_report_us += BENCH_REPORT_PERIOD_US;
+    flight_recorder_record(BENCH_DEV_ADDR, 0, report, 8, g_report_us);
+    hid_monitor_report(BENCH_DEV_ADDR, report, 8, g_report_us, (uint16_t)(i & 0x7FF));
+    threat_update_hid_activity(BENCH_DEV_ADDR, 8);
+}
+
+/* USB event service: a spare IRQ stands in for the USB IRQ, and core 1's
+ * scheduler loop picks the event up the way core1_poll() does */
+static scheduler_t g_event_sched;
+static int g_event_task = -1;
+static int g_event_irq = -1;
+static volatile bool g_event_pending;
+static volatile bool g_event_serviced;
+
+/* What tuh_event_hook_cb() does in the USB IRQ */
+static void _event_irq(void) {
+    g_event_pending = true;
+    __sev();
+}
+
+static void _event_poll(void *ctx) {
+    (void)ctx;
+    if (g_event_pending) {
+        g_event_pending = false;
+        scheduler_trigger(&g_event_sched, g_event_task);
+    }
+}
+
+static void _event_service_task(void *ctx, uint64_t now_us) {
+    (void)ctx;
+    (void)now_us;
+    g_event_serviced = true;
+}
+
+static void _setup_event_service(void) {
+    scheduler_init(&g_event_sched);
+    g_event_task = scheduler_add_task(&g_event_sched, &(scheduler_task_config_t){
+        .name = "usb", .fn = _event_service_task, .deadline_ms = 1, .priority = 0
+    });
+    scheduler_set_poll(&g_event_sched, _event_poll, NULL);
+    if (g_event_irq < 0) {
+        g_event_irq = user_irq_claim_unused(true);
+        irq_set_exclusive_handler((uint)g_event_irq, _event_irq);
+        irq_set_enabled((uint)g_event_irq, true);
+    }
+}
+
+/* Spread the events over the background's activity */
+static void _prepare_event(void) {
+    static uint32_t n;
+    busy_wait_us_32(50 + (n++ * 37) % 200);
+}
+
+/**
+ * @brief Raise the event and run scheduler_run()'s loop until the task
+ * that services it has run
+ */
+static void _run_event_service(uint32_t i) {
+    (void)i;
+    g_event_serviced = false;
+    irq_set_pending((uint)g_event_irq);
+    while (!g_event_serviced) {
+        _event_poll(NULL);
+        if (!scheduler_run_once(&g_event_sched)) {
+            __wfe();
+        }
+    }
+}
+
+/* Core 0 meanwhile: full-frame flushes back to back */
+static void _background_flush(void) {
+    oled_display_invalidate(&g_display);
+    oled_display_flush(&g_display);
+}
+
+/**
+ * @brief Start every log iteration with an idle UART
+ */
+static void _prepare_uart_idle(void) {
+    uart_tx_wait_blocking(uart_default);
+}
+
+static void _run_printf(uint32_t i) {
+    printf("[HID] Stopped monitoring HID device at address: %u (peak rate: %u keys/sec)\n",
+           (unsigned)(i & 0xFF), (unsigned)i);
+}
+
+static void _run_dlog(uint32_t i) {
+    DLOG("[HID] Stopped monitoring HID device at address: %u (peak rate: %u keys/sec)\n",
+         (unsigned)(i & 0xFF), (unsigned)i);
+}
+
+/**
+ * @brief Print what the DLOG case queued (core 0 consumes the ring)
+ */
+static void _finish_dlog(void) {
+    dlog_drain(DLOG_RING_SIZE);
+    uart_tx_wait_blocking(uart_default);
+}
+
+/* ============================================================================
+ * SUITE
+ * ============================================================================ */
+
+static const bench_case_t g_cases[] = {
+    { "oled_display_flush",       32, 0, true,  _setup_device_screen, _prepare_full_frame,
+      _run_flush, NULL },
+    { "oled_flush_rate_update",   32, 0, true,  NULL, _prepare_rate_update, _run_flush, NULL },
+    { "oled_flush_per_page",      32, 0, true,  _setup_device_screen, NULL, _run_flush_per_page, NULL },
+    { "oled_display_flush_async", 32, 0, true, _setup_device_screen, _prepare_flush_idle,
+      _run_flush_async, _finish_flush_async },
+    { "oled_i2c_page_vla",       128, 0, true,  _setup_device_screen, NULL, _run_page_vla, NULL },
+    { "oled_i2c_page_in_place",  128, 0, true,  _setup_device_screen, NULL, _run_page_in_place, NULL },
+    { "oled_display_clear",      256, 0, false, NULL, NULL, _run_clear, NULL },
+    { "oled_draw_char_aligned",  256, 0, false, NULL, NULL, _run_glyph_aligned, NULL },
+    { "oled_draw_char_unaligned", 256, 0, false, NULL, NULL, _run_glyph_unaligned, NULL },
+    { "oled_draw_string_aligned", 128, 0, false, NULL, NULL, _run_string_aligned, NULL },
+    { "oled_draw_string_unaligned", 128, 0, false, NULL, NULL, _run_string_unaligned, NULL },
+    { "oled_draw_string_per_pixel", 128, 0, false, NULL, NULL, _run_string_per_pixel, NULL },
+    { "device_screen_render",     64, 0, false, NULL, NULL, _run_device_screen, NULL },
+    { "ui_screen_idle",          128, 0, true,  _setup_widget_screen, NULL, _run_screen_idle, NULL },
+    { "ui_screen_rate_update",    32, 0, true,  _setup_widget_screen, NULL, _run_screen_rate_update,
+      NULL },
+    { "oled_draw_rect_fill_full", 32, 0, false, NULL, NULL, _run_rect_fill_full, NULL },
+    { "oled_draw_rect_fill_small", 128, 0, false, NULL, NULL, _run_rect_fill_small, NULL },
+    { "oled_draw_rect_outline",  128, 0, false, NULL, NULL, _run_rect_outline, NULL },
+    { "oled_draw_rect_fill_per_pixel", 8, 0, false, NULL, NULL, _run_rect_fill_per_pixel, NULL },
+    { "oled_draw_circle_fill",    128, 0, false, NULL, NULL, _run_circle_fill, NULL },
+    { "report_analysis",         256, 1, false, _setup_keyboard, NULL, _run_report_analysis, NULL },
+    { "log_printf",               32, 1, false, NULL, _prepare_uart_idle, _run_printf, NULL },
+    /* Fewer records than the ring holds, so none are dropped */
+    { "log_dlog",                 32, 1, false, NULL, _prepare_uart_idle, _run_dlog, _finish_dlog },
+    { "usb_event_service_idle",  256, 1, false, _setup_event_service, _prepare_event,
+      _run_event_service, NULL },
+    { "usb_event_service_flushing", 256, 1, true, _setup_event_service, _prepare_event,
+      _run_event_service, NULL, _background_flush },
+};
+
+#define CASE_COUNT                    (sizeof(g_cases) / sizeof(g_cases[0]))
+
+/**
+ * @brief Core 1 side: measure each case whose index arrives on the FIFO
+ * (each core has its own SysTick)
+ */
+static void core1_main(void) {
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = SYSTICK_CSR_ENABLE_CPU_CLK;
+    multicore_fifo_push_blocking(0);
+    while (true) {
+        uint32_t index = multicore_fifo_pop_blocking();
+        _measure(&g_cases[index], &g_result);
+        multicore_fifo_push_blocking(1);
+    }
+}
+
+/**
+ * @brief Bring up I2C and the panel. Without a panel the framebuffer
+ * cases still run; the flush cases are skipped.
+ */
+static void _init_display(void) {
+    g_i2c = (oled_i2c_t){
+        .i2c = I2C_PORT,
+        .sda_pin = I2C_SDA_PIN,
+        .scl_pin = I2C_SCL_PIN,
+        .baudrate = I2C_BAUDRATE,
+        .address = OLED_ADDRESS
+    };
+    g_panel_ok = oled_i2c_init(&g_i2c) &&
+                 oled_driver_init(&g_driver, OLED_DISPLAY_SSD1306, &g_i2c);
+    if (!g_panel_ok) {
+        /* Framebuffer geometry only */
+        g_driver.i2c = &g_i2c;
+        g_driver.type = OLED_DISPLAY_SSD1306;
+        g_driver.width = OLED_WIDTH;
+        g_driver.height = OLED_HEIGHT;
+    }
+    if (!oled_display_init(&g_display, &g_driver)) {
+        printf("[BENCH] ERROR: framebuffer allocation failed\n");
+        while (true) {
+            tight_loop_contents();
+        }
+    }
+    g_font = oled_get_font_5x7();
+}
+
+/**
+ * @brief Print one result row: BENCH,name,iterations,mean_us,min,median,max
+ */
+static void _print_result(const char *name, const bench_result_t *r) {
+    uint32_t mean_x10 = r->iterations ? (uint32_t)(r->total_us * 10 / r->iterations) : 0;
+    printf("BENCH,%s,%lu,%lu.%lu,%lu,%lu,%lu\n", name, (unsigned long)r->iterations,
+           (unsigned long)(mean_x10 / 10), (unsigned long)(mean_x10 % 10),
+           (unsigned long)r->min_cycles, (unsigned long)r->median_cycles,
+           (unsigned long)r->max_cycles);
+}
+
+int main(void) {
+    stdio_init_all();
+    timebase_sleep_ms(1000);          /* Let a terminal attach */
+
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = SYSTICK_CSR_ENABLE_CPU_CLK;
+
+    _init_display();
+    event_queue_init();
+    dlog_init();
+    telemetry_init();
+    multicore_launch_core1_with_stack(core1_main, core1_stack, sizeof(core1_stack));
+    multicore_fifo_pop_blocking();
+
+    printf("\nBENCH_META,format,%d\n", BENCH_FORMAT_VERSION);
+    printf("BENCH_META,build,%s\n", PLUGSAFE_BUILD_ID);
+    printf("BENCH_META,clk_sys_hz,%lu\n", (unsigned long)clock_get_hz(clk_sys));
+    printf("BENCH_META,i2c_hz,%d\n", I2C_BAUDRATE);
+    printf("BENCH_META,panel,%s\n", g_panel_ok ? "ssd1306" : "none");
+    printf("BENCH_META,deferred_log,%d\n", PLUGSAFE_DEFERRED_LOG);
+    printf("BENCH,name,iterations,mean_us,min_cycles,median_cycles,max_cycles\n");
+    uart_tx_wait_blocking(uart_default);
+
+    for (uint32_t i = 0; i < CASE_COUNT; i++) {
+        const bench_case_t *c = &g_cases[i];
+        if (c->needs_panel && !g_panel_ok) {
+            printf("BENCH_SKIP,%s,no panel\n", c->name);
+            continue;
+        }
+        bench_result_t result;
+        if (c->core == 1) {
+            multicore_fifo_push_blocking(i);
+            while (c->background && !multicore_fifo_rvalid()) {
+                c->background();
+            }
+            multicore_fifo_pop_blocking();
+            result = g_result;
+        } else {
+            _measure(c, &result);
+        }
+        if (c->finish) {
+            c->finish();
+        }
+        _print_result(c->name, &result);
+        uart_tx_wait_blocking(uart_default);
+    }
+    printf("BENCH_END,%u\n", (unsigned)CASE_COUNT);
+
+    while (true) {
+        timebase_sleep_ms(1000);
+    }
+}
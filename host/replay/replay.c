@@ -0,0 +1,144 @@
+/*
+ * PlugSafe HID Trace Replay Implementation
+ * Feeds a recorded trace through the TinyUSB host callback sequence in virtual time
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "replay.h"
+#include <string.h>
+
+#define REPLAY_MAX_DEV_ADDR           128
+
+typedef struct {
+    const replay_target_t *target;
+    const replay_options_t *opt;
+    replay_stats_t stats;
+    uint64_t now_us;
+    uint64_t next_idle_us;
+    bool have_itf[HT_MAX_INTERFACES];
+    hid_trace_interface_t itfs[HT_MAX_INTERFACES];
+    bool mounted[REPLAY_MAX_DEV_ADDR];
+} replay_state_t;
+
+/**
+ * @brief Move the virtual clock to target_us, running idle() on the way
+ */
+static void _advance(replay_state_t *s, uint64_t target_us) {
+    const replay_target_t *t = s->target;
+    if (target_us < s->now_us) {
+        target_us = s->now_us;        /* Interfaces interleave; time never runs backwards */
+    }
+    if (s->opt->idle_period_us) {
+        while (s->next_idle_us <= target_us) {
+            s->now_us = s->next_idle_us;
+            s->next_idle_us += s->opt->idle_period_us;
+            if (t->set_time) {
+                t->set_time(t->ctx, s->now_us);
+            }
+            if (t->idle) {
+                t->idle(t->ctx, s->now_us);
+            }
+            s->stats.idle_calls++;
+        }
+    }
+    s->now_us = target_us;
+    if (t->set_time) {
+        t->set_time(t->ctx, s->now_us);
+    }
+}
+
+void replay_default_options(replay_options_t *opt) {
+    opt->start_us = 1000000;
+    opt->idle_period_us = 10000;
+    opt->tail_us = 2000000;
+    opt->unmount_at_end = true;
+}
+
+bool replay_run(const uint8_t *trace, size_t len, const replay_target_t *target,
+                const replay_options_t *opt, replay_stats_t *stats) {
+    replay_state_t s;
+    memset(&s, 0, sizeof(s));
+    s.target = target;
+    s.opt = opt;
+    s.now_us = opt->start_us;
+    s.next_idle_us = opt->start_us + opt->idle_period_us;
+
+    hid_trace_reader_t r;
+    hid_trace_record_t rec;
+    bool ok = hid_trace_reader_init(&r, trace, len);
+    if (target->set_time) {
+        target->set_time(target->ctx, s.now_us);
+    }
+
+    while (ok) {
+        if (!hid_trace_next(&r, &rec)) {
+            ok = false;
+            break;
+        }
+        if (rec.type == HT_REC_END) {
+            break;
+        }
+
+        switch (rec.type) {
+            case HT_REC_DEVICE:
+                if (rec.device.dev_addr >= REPLAY_MAX_DEV_ADDR) {
+                    ok = false;
+                    break;
+                }
+                s.mounted[rec.device.dev_addr] = true;
+                s.stats.devices++;
+                if (target->mount) {
+                    target->mount(target->ctx, &rec.device);
+                }
+                break;
+
+            case HT_REC_INTERFACE:
+                s.have_itf[rec.itf.itf_id] = true;
+                s.itfs[rec.itf.itf_id] = rec.itf;
+                s.stats.interfaces++;
+                if (target->hid_mount) {
+                    target->hid_mount(target->ctx, &rec.itf);
+                }
+                break;
+
+            case HT_REC_REPORT: {
+                if (!s.have_itf[rec.report.itf_id]) {
+                    ok = false;
+                    break;
+                }
+                _advance(&s, opt->start_us + rec.report.time_us);
+                s.stats.reports++;
+                s.stats.last_report_us = rec.report.time_us;
+                if (target->report) {
+                    target->report(target->ctx, &s.itfs[rec.report.itf_id],
+                                   rec.report.data, rec.report.len);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    /* Let windows close and deferred work run, then remove the devices */
+    _advance(&s, s.now_us + opt->tail_us);
+    if (opt->unmount_at_end) {
+        for (int addr = 0; addr < REPLAY_MAX_DEV_ADDR; addr++) {
+            if (s.mounted[addr] && target->unmount) {
+                target->unmount(target->ctx, (uint8_t)addr);
+            }
+        }
+    }
+
+    s.stats.end_us = s.now_us;
+    if (stats) {
+        *stats = s.stats;
+    }
+    return ok;
+}
@@ -0,0 +1,69 @@
+/*
+ * PlugSafe HID Trace Replay
+ * Feeds a recorded trace through the TinyUSB host callback sequence in virtual time
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hid_trace.h"
+
+/*
+ * Replay is driven entirely by the trace's timestamps: the engine sets the
+ * target's clock to each event's time and calls it, without sleeping, so a
+ * trace runs as fast as the target can process it. Between events the
+ * clock advances in idle_period_us steps with an idle() call each, standing
+ * in for the firmware's periodic tasks.
+ *
+ * Callback order follows the firmware's view of a device: mount() when the
+ * device record is read (tuh_mount_cb), hid_mount() per interface record
+ * (tuh_hid_mount_cb), report() per report (tuh_hid_report_received_cb) and,
+ * optionally, unmount() after the tail (tuh_umount_cb). Every callback is
+ * optional.
+ */
+
+typedef struct {
+    void *ctx;
+    void (*set_time)(void *ctx, uint64_t now_us);
+    void (*mount)(void *ctx, const hid_trace_device_t *dev);
+    void (*hid_mount)(void *ctx, const hid_trace_interface_t *itf);
+    void (*report)(void *ctx, const hid_trace_interface_t *itf,
+                   const uint8_t *data, uint16_t len);
+    void (*unmount)(void *ctx, uint8_t dev_addr);
+    void (*idle)(void *ctx, uint64_t now_us);
+} replay_target_t;
+
+typedef struct {
+    uint64_t start_us;                /* Virtual time of trace time 0 */
+    uint32_t idle_period_us;          /* idle() spacing between events, 0 = never */
+    uint64_t tail_us;                 /* Virtual time to keep idling after the last report */
+    bool unmount_at_end;              /* Unmount every device after the tail */
+} replay_options_t;
+
+typedef struct {
+    uint32_t devices;
+    uint32_t interfaces;
+    uint32_t reports;
+    uint32_t idle_calls;
+    uint64_t last_report_us;          /* Trace time of the last report */
+    uint64_t end_us;                  /* Virtual time when replay finished */
+} replay_stats_t;
+
+/* Default options: start at 1 s, idle every 10 ms, 2 s tail, unmount */
+void replay_default_options(replay_options_t *opt);
+
+/* Replay a whole trace. Returns false if the trace is malformed (events up
+ * to the bad record have been delivered). stats may be NULL. */
+bool replay_run(const uint8_t *trace, size_t len, const replay_target_t *target,
+                const replay_options_t *opt, replay_stats_t *stats);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,25 @@
+/*
+ * PlugSafe Host Simulator - hardware/flash.h
+ * Stand-in for the Pico SDK flash programming API (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _HARDWARE_FLASH_H
+#define _HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE               (1u << 8)
+#define FLASH_SECTOR_SIZE             (1u << 12)
+
+/* Operate on sim_flash with NOR semantics: erase sets bytes to 0xFF,
+ * programming can only clear bits */
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif /* _HARDWARE_FLASH_H */
@@ -0,0 +1,36 @@
+/*
+ * PlugSafe Host Simulator - hardware/i2c.h
+ * Stand-in for the Pico SDK I2C API, backed by the simulated bus (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _HARDWARE_I2C_H
+#define _HARDWARE_I2C_H
+
+#include "pico.h"
+
+/* One controller; the bus behind it is sim_i2c (sim_i2c.h) */
+typedef struct i2c_inst {
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0                          (&i2c0_inst)
+#define i2c1                          (&i2c1_inst)
+
+/* Returns the baud rate set */
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+
+/* Returns len, or PICO_ERROR_GENERIC when nothing acknowledges addr.
+ * Advances the virtual clock by the time the transfer takes on the wire. */
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                       bool nostop);
+
+#endif /* _HARDWARE_I2C_H */
@@ -0,0 +1,32 @@
+/*
+ * PlugSafe Host Simulator - hardware/irq.h
+ * Stand-in for the Pico SDK interrupt API (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _HARDWARE_IRQ_H
+#define _HARDWARE_IRQ_H
+
+#include "pico.h"
+
+#define USBCTRL_IRQ                   5
+#define SIM_IRQ_COUNT                 32
+
+#define PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY  0xff
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY  0x80
+#define PICO_SHARED_IRQ_HANDLER_LOWEST_ORDER_PRIORITY   0x00
+
+typedef void (*irq_handler_t)(void);
+
+/* Handlers run in order priority order (highest first, newest first among
+ * equals) when the simulator raises the IRQ */
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif /* _HARDWARE_IRQ_H */
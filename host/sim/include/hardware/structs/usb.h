@@ -0,0 +1,39 @@
+/*
+ * PlugSafe Host Simulator - hardware/structs/usb.h
+ * Stand-in for the RP2040 USB controller registers (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _HARDWARE_STRUCTS_USB_H
+#define _HARDWARE_STRUCTS_USB_H
+
+#include "pico.h"
+
+#define USB_HOST_INTERRUPT_ENDPOINTS  15
+
+#define USB_SOF_RD_BITS               0x000007ffu
+#define USB_ADDR_ENDP1_ADDRESS_BITS   0x0000007fu
+#define USB_ADDR_ENDP1_ENDPOINT_BITS  0x000f0000u
+#define USB_ADDR_ENDP1_ENDPOINT_LSB   16
+#define USB_ADDR_ENDP1_INTEP_DIR_BITS 0x02000000u
+
+/* Only the registers the firmware reads. sim_usb keeps them consistent
+ * with the virtual devices: int_ep_addr_ctrl[] names the device behind each
+ * host interrupt endpoint, and buf_status/sof_rd are set while the USB IRQ
+ * handlers run for a completed transfer. */
+typedef struct {
+    volatile uint32_t dev_addr_ctrl;
+    volatile uint32_t int_ep_addr_ctrl[USB_HOST_INTERRUPT_ENDPOINTS];
+    volatile uint32_t sof_rd;
+    volatile uint32_t buf_status;
+} usb_hw_t;
+
+extern usb_hw_t sim_usb_hw;
+#define usb_hw                        (&sim_usb_hw)
+
+#endif /* _HARDWARE_STRUCTS_USB_H */
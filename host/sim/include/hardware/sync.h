@@ -0,0 +1,22 @@
+/*
+ * PlugSafe Host Simulator - hardware/sync.h
+ * Stand-in for the Pico SDK synchronisation primitives (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _HARDWARE_SYNC_H
+#define _HARDWARE_SYNC_H
+
+#include "pico.h"
+
+/* Simulated IRQs only fire from sim_usb calls, never asynchronously, so
+ * masking is bookkeeping only */
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif /* _HARDWARE_SYNC_H */
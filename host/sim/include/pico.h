@@ -0,0 +1,31 @@
+/*
+ * PlugSafe Host Simulator - pico.h
+ * Stand-in for the Pico SDK base header (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _PICO_H
+#define _PICO_H
+
+#include "pico/types.h"
+#include "pico/platform.h"
+
+/* Flash size of the default board (Raspberry Pi Pico) */
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES         (2u * 1024u * 1024u)
+#endif
+
+/* The simulated flash is a RAM array; XIP addresses point into it */
+extern uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE                      ((uintptr_t)sim_flash)
+
+#define PICO_OK                       0
+#define PICO_ERROR_TIMEOUT            (-1)
+#define PICO_ERROR_GENERIC            (-2)
+
+#endif /* _PICO_H */
@@ -0,0 +1,21 @@
+/*
+ * PlugSafe Host Simulator - pico/flash.h
+ * Stand-in for the Pico SDK safe flash execution API (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _PICO_FLASH_H
+#define _PICO_FLASH_H
+
+#include "pico.h"
+
+/* There is no other core to lock out: func runs immediately */
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+
+#endif /* _PICO_FLASH_H */
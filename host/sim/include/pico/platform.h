@@ -0,0 +1,40 @@
+/*
+ * PlugSafe Host Simulator - pico/platform.h
+ * Stand-in for the Pico SDK platform macros (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _PICO_PLATFORM_H
+#define _PICO_PLATFORM_H
+
+#include "pico/types.h"
+
+/* Placement attributes have no meaning on the host */
+#define __not_in_flash_func(f)        f
+#define __time_critical_func(f)       f
+#define __scratch_x(name)
+#define __scratch_y(name)
+#define __uninitialized_ram(name)     name
+
+/* Runs the test hook set with sim_set_barrier_hook(), if any */
+void sim_barrier(void);
+
+/* The simulator runs both cores' code on one thread: barriers only have to
+ * stop the compiler from reordering, and there is nobody to wake. A test
+ * can hook them to run the other core's code in between. */
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); sim_barrier(); }
+static inline void __compiler_memory_barrier(void) { __asm__ volatile ("" ::: "memory"); }
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+static inline void __wfi(void) {}
+static inline void tight_loop_contents(void) {}
+
+/* Core the calling code is treated as running on (see sim_platform.h) */
+uint get_core_num(void);
+
+#endif /* _PICO_PLATFORM_H */
@@ -0,0 +1,24 @@
+/*
+ * PlugSafe Host Simulator - pico/stdlib.h
+ * Stand-in for the Pico SDK standard library header (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+/* stdio goes to the host's stdout; there is no console input */
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+
+#endif /* _PICO_STDLIB_H */
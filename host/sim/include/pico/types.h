@@ -0,0 +1,24 @@
+/*
+ * PlugSafe Host Simulator - pico/types.h
+ * Stand-in for the Pico SDK basic types (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _PICO_TYPES_H
+#define _PICO_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+/* Microseconds since boot on the simulated clock */
+typedef uint64_t absolute_time_t;
+
+#endif /* _PICO_TYPES_H */
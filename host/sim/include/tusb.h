@@ -0,0 +1,118 @@
+/*
+ * PlugSafe Host Simulator - tusb.h
+ * Stand-in for the TinyUSB host API, served by the virtual devices of sim_usb (host build only)
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef _TUSB_H_
+#define _TUSB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico.h"
+
+#define OPT_OS_NONE                   1
+#define OPT_MODE_DEFAULT_SPEED        0
+
+#include "tusb_config.h"
+
+/* Endpoint buffers need no DMA placement on the host */
+#define TUH_EPBUF_DEF(_name, _size)       CFG_TUH_MEM_ALIGN uint8_t _name[_size]
+#define TUH_EPBUF_TYPE_DEF(_type, _name)  CFG_TUH_MEM_ALIGN _type _name
+
+/* ---- Types (layouts as in TinyUSB) ---------------------------------------- */
+
+typedef enum {
+    TUSB_ROLE_INVALID = 0,
+    TUSB_ROLE_DEVICE = 1,
+    TUSB_ROLE_HOST = 2
+} tusb_role_t;
+
+typedef enum {
+    TUSB_SPEED_FULL = 0,
+    TUSB_SPEED_LOW = 1,
+    TUSB_SPEED_HIGH = 2,
+    TUSB_SPEED_INVALID = 0xff,
+    TUSB_SPEED_AUTO = TUSB_SPEED_INVALID
+} tusb_speed_t;
+
+typedef struct {
+    tusb_role_t role;
+    tusb_speed_t speed;
+} tusb_rhport_init_t;
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+    XFER_RESULT_STALLED,
+    XFER_RESULT_TIMEOUT,
+    XFER_RESULT_INVALID
+} xfer_result_t;
+
+typedef enum {
+    HID_ITF_PROTOCOL_NONE = 0,
+    HID_ITF_PROTOCOL_KEYBOARD = 1,
+    HID_ITF_PROTOCOL_MOUSE = 2
+} hid_interface_protocol_enum_t;
+
+#define TUSB_DESC_DEVICE              0x01
+#define TUSB_DESC_STRING              0x03
+
+typedef struct __attribute__((packed)) {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+_Static_assert(sizeof(tusb_desc_device_t) == 18, "tusb_desc_device_t layout");
+
+/* ---- Stack API -------------------------------------------------------------- */
+
+bool tusb_init(uint8_t rhport, const tusb_rhport_init_t *rh_init);
+
+/* Dispatch queued events (mount, HID mount, report, unmount) to the
+ * callbacks below, in the order they were queued */
+void tuh_task(void);
+
+uint8_t tuh_descriptor_get_device_sync(uint8_t daddr, void *buffer, uint16_t len);
+uint8_t tuh_descriptor_get_manufacturer_string_sync(uint8_t daddr, uint16_t language_id,
+                                                    void *buffer, uint16_t len);
+uint8_t tuh_descriptor_get_product_string_sync(uint8_t daddr, uint16_t language_id,
+                                               void *buffer, uint16_t len);
+uint8_t tuh_descriptor_get_serial_string_sync(uint8_t daddr, uint16_t language_id,
+                                              void *buffer, uint16_t len);
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx);
+
+/* Arm the interrupt IN endpoint for one report. False if the interface is
+ * not mounted or a request is already pending. */
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx);
+
+/* ---- Callbacks (implemented by the application) ------------------------ */
+
+void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr);
+void tuh_mount_cb(uint8_t daddr);
+void tuh_umount_cb(uint8_t daddr);
+void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t idx, uint8_t const *desc_report,
+                      uint16_t desc_len);
+void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t idx);
+void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t idx, uint8_t const *report,
+                                uint16_t len);
+
+#endif /* _TUSB_H_ */
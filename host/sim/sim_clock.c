@@ -0,0 +1,83 @@
+/*
+ * PlugSafe Host Simulator - Virtual Clock Implementation
+ * Monotonic microsecond clock behind the simulated Pico SDK timer API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_clock.h"
+#include "pico/time.h"
+#include "timebase.h"
+
+static uint64_t g_now_us = 0;
+
+/* ============================================================================
+ * CLOCK CONTROL
+ * ============================================================================ */
+
+void sim_clock_reset(void) {
+    g_now_us = 0;
+}
+
+uint64_t sim_clock_now_us(void) {
+    return g_now_us;
+}
+
+void sim_clock_set_us(uint64_t now_us) {
+    if (now_us > g_now_us) {
+        g_now_us = now_us;
+    }
+}
+
+void sim_clock_advance_us(uint64_t delta_us) {
+    g_now_us += delta_us;
+}
+
+/* ============================================================================
+ * PICO SDK TIMER API
+ * ============================================================================ */
+
+uint64_t time_us_64(void) {
+    return g_now_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)g_now_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return from_us_since_boot(g_now_us);
+}
+
+void sleep_us(uint64_t us) {
+    g_now_us += us;
+}
+
+void sleep_ms(uint32_t ms) {
+    g_now_us += (uint64_t)ms * 1000;
+}
+
+void busy_wait_us(uint64_t us) {
+    g_now_us += us;
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+    sim_clock_set_us(to_us_since_boot(timeout));
+    return true;
+}
+
+/* ============================================================================
+ * TIMEBASE (PLUGSAFE_VIRTUAL_CLOCK=1)
+ * ============================================================================ */
+
+uint64_t timebase_virtual_now_us(void) {
+    return g_now_us;
+}
+
+void timebase_virtual_wait_until_us(uint64_t deadline_us) {
+    sim_clock_set_us(deadline_us);
+}
@@ -0,0 +1,36 @@
+/*
+ * PlugSafe Host Simulator - Virtual Clock
+ * Monotonic microsecond clock behind the simulated Pico SDK timer API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+/*
+ * The firmware's timebase (timebase.h, built with PLUGSAFE_VIRTUAL_CLOCK=1)
+ * and the stand-in time_us_64(), get_absolute_time() and friends all return
+ * this clock. It only moves when the simulation moves it: code under test
+ * runs in zero virtual time, so CPU-time budgets and latency probes read 0
+ * unless a test advances the clock from inside a callback. Sleeps and
+ * timebase waits advance it to their deadline.
+ */
+
+/* Back to 0 (boot) */
+void sim_clock_reset(void);
+
+uint64_t sim_clock_now_us(void);
+
+/* Move to now_us. The clock is monotonic: an earlier time is ignored. */
+void sim_clock_set_us(uint64_t now_us);
+
+void sim_clock_advance_us(uint64_t delta_us);
+
+#endif /* SIM_CLOCK_H */
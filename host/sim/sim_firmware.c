@@ -0,0 +1,139 @@
+/*
+ * PlugSafe Host Simulator - Firmware Harness Implementation
+ * Boots the unmodified USB host and analysis modules on the simulated platform
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_firmware.h"
+#include <string.h>
+#include "sim_clock.h"
+#include "sim_platform.h"
+#include "sim_usb.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+#include "event_queue.h"
+#include "deferred_log.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "profiler.h"
+#include "flight_recorder.h"
+
+static bool g_verbose = false;
+
+/* Trace interface -> instance on the virtual bus (traces number interfaces
+ * on their own) */
+static int8_t g_replay_instance[HT_MAX_INTERFACES];
+
+/* ============================================================================
+ * BOOT AND SCHEDULING
+ * ============================================================================ */
+
+void sim_firmware_boot(bool verbose) {
+    g_verbose = verbose;
+    sim_platform_reset();
+    sim_clock_reset();
+    sim_usb_reset();
+    memset(g_replay_instance, -1, sizeof(g_replay_instance));
+
+    /* main(): core 0 brings up the shared modules before launching core 1 */
+    sim_set_core_num(0);
+    profiler_init();
+    event_queue_init();
+    dlog_init();
+    dlog_set_enabled(verbose);
+    telemetry_init();
+    trace_init();
+    flight_recorder_init();
+
+    /* core1_main() */
+    sim_set_core_num(1);
+    usb_host_init();
+    hid_monitor_init();
+    threat_analyzer_init();
+}
+
+void sim_firmware_run(void) {
+    if (usb_host_event_pending()) {
+        usb_host_task();
+    }
+    usb_host_analysis_task();
+
+    if (g_verbose) {
+        sim_set_core_num(0);
+        while (dlog_drain(DLOG_DRAIN_BATCH)) {
+        }
+        sim_set_core_num(1);
+    }
+}
+
+/* ============================================================================
+ * REPLAY TARGET
+ * ============================================================================ */
+
+static void _set_time(void *ctx, uint64_t now_us) {
+    (void)ctx;
+    sim_clock_set_us(now_us);
+}
+
+static void _mount(void *ctx, const hid_trace_device_t *dev) {
+    (void)ctx;
+    sim_usb_device_t sim_dev;
+    memset(&sim_dev, 0, sizeof(sim_dev));
+    memcpy(sim_dev.desc_device, dev->desc_device, sizeof(sim_dev.desc_device));
+    strncpy(sim_dev.manufacturer, dev->manufacturer, SIM_USB_STRING_MAX - 1);
+    strncpy(sim_dev.product, dev->product, SIM_USB_STRING_MAX - 1);
+    strncpy(sim_dev.serial, dev->serial, SIM_USB_STRING_MAX - 1);
+    sim_usb_attach(dev->dev_addr, &sim_dev);
+    sim_firmware_run();
+}
+
+static void _hid_mount(void *ctx, const hid_trace_interface_t *itf) {
+    (void)ctx;
+    sim_usb_interface_t sim_itf = {
+        .protocol = itf->protocol,
+        .desc_report = itf->desc,
+        .desc_len = itf->desc_len
+    };
+    g_replay_instance[itf->itf_id] = (int8_t)sim_usb_attach_interface(itf->dev_addr, &sim_itf);
+    sim_firmware_run();
+}
+
+static void _report(void *ctx, const hid_trace_interface_t *itf,
+                    const uint8_t *data, uint16_t len) {
+    (void)ctx;
+    int8_t instance = g_replay_instance[itf->itf_id];
+    if (instance >= 0) {
+        sim_usb_send_report(itf->dev_addr, (uint8_t)instance, data, len);
+        sim_firmware_run();
+    }
+}
+
+static void _unmount(void *ctx, uint8_t dev_addr) {
+    (void)ctx;
+    sim_usb_detach(dev_addr);
+    sim_firmware_run();
+}
+
+static void _idle(void *ctx, uint64_t now_us) {
+    (void)ctx;
+    (void)now_us;
+    sim_firmware_run();
+}
+
+void sim_firmware_replay_target(replay_target_t *target) {
+    *target = (replay_target_t){
+        .ctx = NULL,
+        .set_time = _set_time,
+        .mount = _mount,
+        .hid_mount = _hid_mount,
+        .report = _report,
+        .unmount = _unmount,
+        .idle = _idle
+    };
+}
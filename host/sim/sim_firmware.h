@@ -0,0 +1,36 @@
+/*
+ * PlugSafe Host Simulator - Firmware Harness
+ * Boots the unmodified USB host and analysis modules on the simulated platform
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_FIRMWARE_H
+#define SIM_FIRMWARE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "replay.h"
+
+/* Reset the platform, clock and bus, then run the module initialisation of
+ * main.c and core1_main() in the same order (the flash journal is left
+ * uninitialised). With verbose set, the firmware's log output goes to
+ * stdout; otherwise it is discarded. */
+void sim_firmware_boot(bool verbose);
+
+/* One pass of the core 1 scheduler: the USB task if TinyUSB has events
+ * queued, then the analysis task. Logs queued on core 1 are printed after
+ * it (verbose only). Core events are left in the event queue for the
+ * caller to pop. */
+void sim_firmware_run(void);
+
+/* Replay target that plays a trace's devices through the virtual bus into
+ * the firmware: each callback sets up the bus, then calls
+ * sim_firmware_run(). idle() stands in for the scheduler's idle passes. */
+void sim_firmware_replay_target(replay_target_t *target);
+
+#endif /* SIM_FIRMWARE_H */
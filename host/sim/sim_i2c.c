@@ -0,0 +1,240 @@
+/*
+ * PlugSafe Host Simulator - Virtual I2C Bus Implementation
+ * Transfer accounting and a virtual SSD1306/SH1106 panel behind the simulated I2C API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_i2c.h"
+#include "sim_clock.h"
+#include "hardware/i2c.h"
+#include <string.h>
+
+#define ADDRESSING_HORIZONTAL         0
+#define ADDRESSING_PAGE               2
+
+typedef struct {
+    bool attached;
+    uint8_t address;
+    oled_display_type_e type;
+    bool on;
+    uint8_t ram[OLED_PAGES][SIM_I2C_RAM_COLUMNS];
+    uint8_t addressing;
+    uint8_t page;
+    uint8_t col;
+    uint8_t col_start, col_end;       /* SSD1306 windows (21, 22) */
+    uint8_t page_start, page_end;
+    uint8_t cmd;                      /* Command collecting arguments */
+    uint8_t args[2];
+    uint8_t args_have, args_want;
+} sim_panel_t;
+
+i2c_inst_t i2c0_inst;
+i2c_inst_t i2c1_inst;
+
+static sim_panel_t g_panel;
+static sim_i2c_stats_t g_stats;
+static uint64_t g_bus_rem;            /* Sub-microsecond remainder, bit-time * baud units */
+
+/* ============================================================================
+ * PANEL MODEL
+ * ============================================================================ */
+
+static uint8_t _ram_columns(void) {
+    return g_panel.type == OLED_DISPLAY_SH1106 ? SIM_I2C_RAM_COLUMNS : OLED_WIDTH;
+}
+
+static uint8_t _arg_count(uint8_t cmd) {
+    switch (cmd) {
+        case 0x21:
+        case 0x22:
+            return g_panel.type == OLED_DISPLAY_SSD1306 ? 2 : 0;
+        case 0x20:
+        case 0x81:
+        case 0x8D:
+        case 0xA8:
+        case 0xAD:
+        case 0xD3:
+        case 0xD5:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Apply a command once all its arguments are in
+ */
+static void _panel_execute(uint8_t cmd, const uint8_t *args) {
+    /* Page-mode pointers: the SSD1306 ignores them in horizontal mode */
+    bool page_mode = g_panel.type == OLED_DISPLAY_SH1106 ||
+                     g_panel.addressing == ADDRESSING_PAGE;
+
+    if (cmd >= 0xB0 && cmd <= 0xB7) {
+        if (page_mode) {
+            g_panel.page = cmd & 0x07;
+        }
+    } else if (cmd <= 0x0F) {
+        if (page_mode) {
+            g_panel.col = (uint8_t)((g_panel.col & 0xF0) | cmd);
+        }
+    } else if (cmd <= 0x1F) {
+        if (page_mode) {
+            g_panel.col = (uint8_t)((g_panel.col & 0x0F) | ((cmd & 0x0F) << 4));
+        }
+    } else if (cmd == 0x20) {
+        g_panel.addressing = args[0] & 0x03;
+    } else if (cmd == 0x21 && g_panel.type == OLED_DISPLAY_SSD1306) {
+        g_panel.col_start = args[0] & 0x7F;
+        g_panel.col_end = args[1] & 0x7F;
+        g_panel.col = g_panel.col_start;
+    } else if (cmd == 0x22 && g_panel.type == OLED_DISPLAY_SSD1306) {
+        g_panel.page_start = args[0] & 0x07;
+        g_panel.page_end = args[1] & 0x07;
+        g_panel.page = g_panel.page_start;
+    } else if (cmd == 0xAE || cmd == 0xAF) {
+        g_panel.on = cmd == 0xAF;
+    }
+}
+
+static void _panel_command(uint8_t byte) {
+    g_stats.command_bytes++;
+    if (g_panel.args_want) {
+        g_panel.args[g_panel.args_have++] = byte;
+        if (g_panel.args_have == g_panel.args_want) {
+            g_panel.args_want = 0;
+            _panel_execute(g_panel.cmd, g_panel.args);
+        }
+        return;
+    }
+    uint8_t want = _arg_count(byte);
+    if (want) {
+        g_panel.cmd = byte;
+        g_panel.args_have = 0;
+        g_panel.args_want = want;
+    } else {
+        _panel_execute(byte, NULL);
+    }
+}
+
+static void _panel_data(uint8_t byte) {
+    g_stats.data_bytes++;
+    if (g_panel.col < _ram_columns()) {
+        g_panel.ram[g_panel.page][g_panel.col] = byte;
+    }
+
+    if (g_panel.type == OLED_DISPLAY_SSD1306 && g_panel.addressing != ADDRESSING_PAGE) {
+        /* Horizontal: wrap within the window, column first */
+        if (g_panel.col >= g_panel.col_end) {
+            g_panel.col = g_panel.col_start;
+            g_panel.page = g_panel.page >= g_panel.page_end ? g_panel.page_start
+                                                            : g_panel.page + 1;
+        } else {
+            g_panel.col++;
+        }
+    } else if (g_panel.type == OLED_DISPLAY_SSD1306) {
+        g_panel.col = (uint8_t)((g_panel.col + 1) % OLED_WIDTH);
+    } else if (g_panel.col < SIM_I2C_RAM_COLUMNS) {
+        g_panel.col++;                /* SH1106: stops past the last column */
+    }
+}
+
+/**
+ * @brief Decode one transaction: control byte, then either one byte (Co=1)
+ * and another control byte, or a stream to the end (Co=0)
+ */
+static void _panel_receive(const uint8_t *src, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        uint8_t ctrl = src[i++];
+        g_stats.control_bytes++;
+        bool data = (ctrl & 0x40) != 0;
+        size_t end = (ctrl & 0x80) ? (i + 1 < len ? i + 1 : len) : len;
+        for (; i < end; i++) {
+            if (data) {
+                _panel_data(src[i]);
+            } else {
+                _panel_command(src[i]);
+            }
+        }
+    }
+}
+
+/* ============================================================================
+ * BUS CONTROL
+ * ============================================================================ */
+
+void sim_i2c_reset(void) {
+    memset(&g_panel, 0, sizeof(g_panel));
+    memset(&g_stats, 0, sizeof(g_stats));
+    i2c0_inst.baudrate = 0;
+    i2c1_inst.baudrate = 0;
+    g_bus_rem = 0;
+}
+
+void sim_i2c_attach_panel(uint8_t address, oled_display_type_e type) {
+    memset(&g_panel, 0, sizeof(g_panel));
+    g_panel.attached = true;
+    g_panel.address = address;
+    g_panel.type = type;
+    g_panel.addressing = ADDRESSING_PAGE;
+    g_panel.col_end = OLED_WIDTH - 1;
+    g_panel.page_end = OLED_PAGES - 1;
+}
+
+const uint8_t *sim_i2c_panel_ram(void) {
+    return &g_panel.ram[0][0];
+}
+
+bool sim_i2c_panel_is_on(void) {
+    return g_panel.on;
+}
+
+const sim_i2c_stats_t *sim_i2c_get_stats(void) {
+    return &g_stats;
+}
+
+void sim_i2c_clear_stats(void) {
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_bus_rem = 0;
+}
+
+/* ============================================================================
+ * PICO SDK I2C API
+ * ============================================================================ */
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len,
+                       bool nostop) {
+    (void)nostop;
+    uint32_t bytes = (uint32_t)len + 1;
+    g_stats.transactions++;
+    g_stats.bytes += bytes;
+
+    /* START + 9 bits per byte + STOP */
+    if (i2c->baudrate) {
+        g_bus_rem += ((uint64_t)bytes * 9 + 2) * 1000000ull;
+        uint64_t us = g_bus_rem / i2c->baudrate;
+        g_bus_rem -= us * i2c->baudrate;
+        g_stats.bus_us += us;
+        sim_clock_advance_us(us);
+    }
+
+    if (!g_panel.attached || addr != g_panel.address) {
+        g_stats.nacks++;
+        return PICO_ERROR_GENERIC;
+    }
+    _panel_receive(src, len);
+    return (int)len;
+}
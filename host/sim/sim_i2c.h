@@ -0,0 +1,65 @@
+/*
+ * PlugSafe Host Simulator - Virtual I2C Bus
+ * Transfer accounting and a virtual SSD1306/SH1106 panel behind the simulated I2C API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "oled_driver.h"
+
+/*
+ * i2c_write_blocking() delivers each transaction to the panel attached at
+ * its address, which decodes control bytes (Co, D/C) and the addressing
+ * commands the driver uses: page (B0-B7) and column (00-1F) pointers,
+ * memory addressing mode (20) and the SSD1306 column and page windows
+ * (21, 22). Other commands are accepted and their arguments skipped. Data
+ * lands in display RAM the way the controller would place it: the SSD1306
+ * in horizontal mode wraps within its window and ignores the page-mode
+ * pointer commands; the SH1106 has a 132-column RAM and page addressing
+ * only.
+ *
+ * Every transaction, acknowledged or not, advances the virtual clock by
+ * its time on the wire: 9 bit times per byte (8 data + ACK), the address
+ * byte included, plus a START and a STOP.
+ */
+
+#define SIM_I2C_RAM_COLUMNS           132
+
+/* Bus statistics */
+typedef struct {
+    uint32_t transactions;            /* i2c_write_blocking() calls */
+    uint32_t nacks;                   /* No device at the address */
+    uint32_t bytes;                   /* On the wire, address bytes included */
+    uint32_t control_bytes;           /* Panel control bytes (Co, D/C) */
+    uint32_t command_bytes;           /* Commands and their arguments */
+    uint32_t data_bytes;              /* Display RAM writes */
+    uint64_t bus_us;                  /* Time on the wire */
+} sim_i2c_stats_t;
+
+/* Detach the panel and clear statistics and the controller baud rates */
+void sim_i2c_reset(void);
+
+/* Attach a panel at a 7-bit address, RAM cleared, in its power-on state */
+void sim_i2c_attach_panel(uint8_t address, oled_display_type_e type);
+
+/* Display RAM, OLED_PAGES rows of SIM_I2C_RAM_COLUMNS bytes. The SSD1306
+ * uses the first OLED_WIDTH columns. */
+const uint8_t *sim_i2c_panel_ram(void);
+
+/* Whether the panel saw Display ON (AF) last, rather than OFF (AE) */
+bool sim_i2c_panel_is_on(void);
+
+const sim_i2c_stats_t *sim_i2c_get_stats(void);
+
+void sim_i2c_clear_stats(void);
+
+#endif /* SIM_I2C_H */
@@ -0,0 +1,284 @@
+/*
+ * PlugSafe Host Simulator - Platform Implementation
+ * Simulated RP2040 core identity, IRQs, flash, GPIO and stdio
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_platform.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/gpio.h"
+
+/* Shared handlers per IRQ line (the SDK allows a handful as well) */
+#define SIM_IRQ_MAX_HANDLERS          4
+
+typedef struct {
+    irq_handler_t handler;
+    uint8_t order_priority;
+} irq_slot_t;
+
+/* GPIO pin state */
+typedef struct {
+    bool out;                         /* Direction */
+    bool level;                       /* Output level */
+    bool input_set;                   /* sim_gpio_set_input() was called */
+    bool input_level;
+    bool pull_up;
+} gpio_pin_t;
+
+/* Flash contents; XIP_BASE points here */
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+
+/* The firmware image occupies no simulated flash: its end is offset 0 */
+extern char __flash_binary_end __attribute__((alias("sim_flash")));
+
+static uint g_core_num = 1;
+static irq_slot_t g_irq_handlers[SIM_IRQ_COUNT][SIM_IRQ_MAX_HANDLERS];
+static uint32_t g_irq_disabled = 0;
+static sim_flash_stats_t g_flash_stats;
+static size_t g_program_cut = SIZE_MAX;
+static gpio_pin_t g_pins[NUM_BANK0_GPIOS];
+static void (*g_barrier_hook)(void) = NULL;
+static bool g_in_barrier_hook = false;
+
+/* ============================================================================
+ * SIMULATOR CONTROL
+ * ============================================================================ */
+
+void sim_platform_reset(void) {
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(g_irq_handlers, 0, sizeof(g_irq_handlers));
+    memset(&g_flash_stats, 0, sizeof(g_flash_stats));
+    memset(g_pins, 0, sizeof(g_pins));
+    g_irq_disabled = 0;
+    g_core_num = 1;
+    g_barrier_hook = NULL;
+    g_program_cut = SIZE_MAX;
+}
+
+void sim_set_core_num(uint core) {
+    g_core_num = core;
+}
+
+void sim_set_barrier_hook(void (*hook)(void)) {
+    g_barrier_hook = hook;
+}
+
+void sim_irq_raise(uint num) {
+    if (num >= SIM_IRQ_COUNT) {
+        return;
+    }
+    for (int i = 0; i < SIM_IRQ_MAX_HANDLERS; i++) {
+        if (g_irq_handlers[num][i].handler) {
+            g_irq_handlers[num][i].handler();
+        }
+    }
+}
+
+void sim_flash_cut_next_program(size_t bytes) {
+    g_program_cut = bytes;
+}
+
+const sim_flash_stats_t *sim_flash_get_stats(void) {
+    return &g_flash_stats;
+}
+
+void sim_gpio_set_input(uint gpio, bool level) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_pins[gpio].input_set = true;
+        g_pins[gpio].input_level = level;
+    }
+}
+
+/* ============================================================================
+ * PICO SDK: CORE, IRQ, SYNC
+ * ============================================================================ */
+
+uint get_core_num(void) {
+    return g_core_num;
+}
+
+void sim_barrier(void) {
+    if (!g_barrier_hook || g_in_barrier_hook) {
+        return;
+    }
+    g_in_barrier_hook = true;
+    g_barrier_hook();
+    g_in_barrier_hook = false;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    if (num >= SIM_IRQ_COUNT) {
+        return;
+    }
+    irq_slot_t *slots = g_irq_handlers[num];
+
+    /* Sorted by descending priority; a new handler goes ahead of equals */
+    int pos = 0;
+    while (pos < SIM_IRQ_MAX_HANDLERS && slots[pos].handler &&
+           slots[pos].order_priority > order_priority) {
+        pos++;
+    }
+    if (pos == SIM_IRQ_MAX_HANDLERS || slots[SIM_IRQ_MAX_HANDLERS - 1].handler) {
+        printf("[SIM] ERROR: Too many shared handlers on IRQ %u\n", num);
+        return;
+    }
+    memmove(&slots[pos + 1], &slots[pos], (SIM_IRQ_MAX_HANDLERS - 1 - pos) * sizeof(slots[0]));
+    slots[pos].handler = handler;
+    slots[pos].order_priority = order_priority;
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    if (num >= SIM_IRQ_COUNT) {
+        return;
+    }
+    irq_slot_t *slots = g_irq_handlers[num];
+    for (int i = 0; i < SIM_IRQ_MAX_HANDLERS; i++) {
+        if (slots[i].handler == handler) {
+            memmove(&slots[i], &slots[i + 1], (SIM_IRQ_MAX_HANDLERS - 1 - i) * sizeof(slots[0]));
+            memset(&slots[SIM_IRQ_MAX_HANDLERS - 1], 0, sizeof(slots[0]));
+            return;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = g_irq_disabled;
+    g_irq_disabled = 1;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    g_irq_disabled = status;
+}
+
+/* ============================================================================
+ * PICO SDK: FLASH
+ * ============================================================================ */
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE ||
+        count > sizeof(sim_flash) - flash_offs) {
+        printf("[SIM] ERROR: Bad flash erase 0x%06lx+%lu\n",
+               (unsigned long)flash_offs, (unsigned long)count);
+        return;
+    }
+    memset(sim_flash + flash_offs, 0xFF, count);
+    g_flash_stats.erases++;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE ||
+        count > sizeof(sim_flash) - flash_offs) {
+        printf("[SIM] ERROR: Bad flash program 0x%06lx+%lu\n",
+               (unsigned long)flash_offs, (unsigned long)count);
+        return;
+    }
+    /* Power lost partway: the rest of the range keeps its old contents */
+    if (g_program_cut < count) {
+        count = g_program_cut;
+    }
+    g_program_cut = SIZE_MAX;
+
+    for (size_t i = 0; i < count; i++) {
+        sim_flash[flash_offs + i] &= data[i];
+    }
+    g_flash_stats.programs++;
+    g_flash_stats.bytes_programmed += (uint32_t)count;
+}
+
+/* ============================================================================
+ * PICO SDK: GPIO
+ * ============================================================================ */
+
+void gpio_init(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        memset(&g_pins[gpio], 0, sizeof(g_pins[gpio]));
+    }
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_pins[gpio].out = out;
+    }
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_pins[gpio].level = value;
+    }
+}
+
+bool gpio_get(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) {
+        return false;
+    }
+    const gpio_pin_t *pin = &g_pins[gpio];
+    if (pin->out) {
+        return pin->level;
+    }
+    return pin->input_set ? pin->input_level : pin->pull_up;
+}
+
+void gpio_pull_up(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_pins[gpio].pull_up = true;
+    }
+}
+
+void gpio_pull_down(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_pins[gpio].pull_up = false;
+    }
+}
+
+void gpio_disable_pulls(uint gpio) {
+    gpio_pull_down(gpio);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+/* ============================================================================
+ * PICO SDK: STDIO
+ * ============================================================================ */
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    sleep_us(timeout_us);
+    return PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c) {
+    return putchar(c);
+}
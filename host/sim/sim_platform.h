@@ -0,0 +1,55 @@
+/*
+ * PlugSafe Host Simulator - Platform
+ * Control of the simulated RP2040: core identity, IRQs, flash and GPIO
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_PLATFORM_H
+#define SIM_PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico.h"
+
+/* Simulated flash operations */
+typedef struct {
+    uint32_t erases;                  /* flash_range_erase() calls */
+    uint32_t programs;                /* flash_range_program() calls */
+    uint32_t bytes_programmed;
+} sim_flash_stats_t;
+
+/* Erase all of flash, clear IRQ handlers, pins and statistics, and run as
+ * core 1. The clock and the USB bus are reset separately. */
+void sim_platform_reset(void);
+
+/* Core that get_core_num() reports. The USB and analysis code expects 1;
+ * switch to 0 around calls that the firmware makes on core 0 (draining
+ * queues, flash writes). */
+void sim_set_core_num(uint core);
+
+/* Function called at every __dmb(), standing in for the other core doing
+ * something at that point (a write between a reader's sequence checks, say).
+ * It is not re-entered from its own barriers. NULL removes it; reset does
+ * too. */
+void sim_set_barrier_hook(void (*hook)(void));
+
+/* Run the handlers registered for an IRQ, as the hardware would on entry */
+void sim_irq_raise(uint num);
+
+/* Fault: power fails partway through the next flash_range_program(), after
+ * its first `bytes` bytes. The rest of the range keeps its old contents.
+ * Applies once; reset clears it. */
+void sim_flash_cut_next_program(size_t bytes);
+
+const sim_flash_stats_t *sim_flash_get_stats(void);
+
+/* Level an input pin reads (overrides its pull) */
+void sim_gpio_set_input(uint gpio, bool level);
+
+#endif /* SIM_PLATFORM_H */
@@ -0,0 +1,479 @@
+/*
+ * PlugSafe Host Simulator - Virtual USB Bus Implementation
+ * Programmable virtual devices behind the simulated TinyUSB host API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_usb.h"
+#include <string.h>
+#include "sim_platform.h"
+#include "sim_clock.h"
+#include "pico/time.h"
+#include "hardware/irq.h"
+#include "hardware/structs/usb.h"
+
+#define SIM_USB_MAX_ADDR              127
+#define SIM_USB_NO_ENDPOINT           0xFF
+
+typedef enum {
+    SIM_EVT_MOUNT,
+    SIM_EVT_HID_MOUNT,
+    SIM_EVT_REPORT,
+    SIM_EVT_UNMOUNT
+} sim_event_type_e;
+
+typedef struct {
+    uint8_t type;                     /* sim_event_type_e */
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t len;
+    uint8_t data[CFG_TUH_HID_EPIN_BUFSIZE];
+} sim_event_t;
+
+/* Host-side state of one HID interface */
+typedef struct {
+    sim_usb_interface_t desc;
+    bool mounted;                     /* tuh_hid_mount_cb() delivered */
+    bool armed;                       /* IN request pending */
+    uint8_t endpoint;                 /* Host interrupt endpoint index, or SIM_USB_NO_ENDPOINT */
+    bool held;                        /* Device has a report waiting for a poll */
+    uint8_t held_len;
+    uint8_t held_data[CFG_TUH_HID_EPIN_BUFSIZE];
+} sim_itf_t;
+
+typedef struct {
+    bool attached;                    /* Plugged in (cleared at detach) */
+    bool mounted;                     /* tuh_mount_cb() delivered */
+    uint8_t dev_addr;
+    sim_usb_device_t dev;
+    sim_itf_t itfs[SIM_USB_MAX_INTERFACES];
+} sim_dev_t;
+
+/* Controller registers the firmware reads (hardware/structs/usb.h) */
+usb_hw_t sim_usb_hw;
+
+static sim_dev_t g_devices[SIM_USB_MAX_DEVICES];
+static sim_event_t g_events[SIM_USB_EVENT_QUEUE_SIZE];
+static uint32_t g_event_head = 0;
+static uint32_t g_event_tail = 0;
+static bool g_endpoint_used[USB_HOST_INTERRUPT_ENDPOINTS];
+static sim_usb_stats_t g_stats;
+static uint32_t g_report_cost_us = 0;
+
+/* ============================================================================
+ * INTERNAL HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Find the slot of a device that is attached or still being dispatched
+ */
+static sim_dev_t *_find_device(uint8_t dev_addr) {
+    for (int i = 0; i < SIM_USB_MAX_DEVICES; i++) {
+        if (g_devices[i].dev_addr == dev_addr &&
+            (g_devices[i].attached || g_devices[i].mounted)) {
+            return &g_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find a HID interface of an attached device
+ */
+static sim_itf_t *_find_interface(uint8_t dev_addr, uint8_t instance) {
+    sim_dev_t *d = _find_device(dev_addr);
+    if (!d || instance >= d->dev.itf_count) {
+        return NULL;
+    }
+    return &d->itfs[instance];
+}
+
+/**
+ * @brief Queue an event for tuh_task() and signal it, as the USB IRQ does
+ */
+static void _queue_event(const sim_event_t *event) {
+    if (g_event_head - g_event_tail >= SIM_USB_EVENT_QUEUE_SIZE) {
+        g_stats.events_lost++;
+        return;
+    }
+    g_events[g_event_head & (SIM_USB_EVENT_QUEUE_SIZE - 1)] = *event;
+    g_event_head++;
+    g_stats.events++;
+    tuh_event_hook_cb(BOARD_TUH_RHPORT, event->type, true);
+}
+
+/**
+ * @brief Give an interface a host interrupt endpoint and point its
+ * address register at the device
+ */
+static void _assign_endpoint(uint8_t dev_addr, sim_itf_t *itf) {
+    itf->endpoint = SIM_USB_NO_ENDPOINT;
+    for (uint8_t i = 0; i < USB_HOST_INTERRUPT_ENDPOINTS; i++) {
+        if (!g_endpoint_used[i]) {
+            g_endpoint_used[i] = true;
+            itf->endpoint = i;
+            sim_usb_hw.int_ep_addr_ctrl[i] = dev_addr |
+                ((uint32_t)(i + 1) << USB_ADDR_ENDP1_ENDPOINT_LSB);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Return an interface's interrupt endpoint to the pool
+ */
+static void _release_endpoint(sim_itf_t *itf) {
+    if (itf->endpoint != SIM_USB_NO_ENDPOINT) {
+        g_endpoint_used[itf->endpoint] = false;
+        sim_usb_hw.int_ep_addr_ctrl[itf->endpoint] = 0;
+        itf->endpoint = SIM_USB_NO_ENDPOINT;
+    }
+}
+
+/**
+ * @brief Complete the armed IN transfer of an interface: run the USB IRQ
+ * with the endpoint's BUFF_STATUS bit set, then queue the report
+ */
+static void _complete_transfer(uint8_t dev_addr, uint8_t instance, sim_itf_t *itf,
+                               const uint8_t *data, uint8_t len) {
+    itf->armed = false;
+
+    sim_usb_hw.sof_rd = (uint32_t)(time_us_64() / 1000) & USB_SOF_RD_BITS;
+    if (itf->endpoint != SIM_USB_NO_ENDPOINT) {
+        /* Host interrupt endpoint n (IEPn) IN is BUFF_STATUS bit 2n */
+        sim_usb_hw.buf_status = 1u << ((itf->endpoint + 1) * 2);
+        sim_irq_raise(USBCTRL_IRQ);
+        sim_usb_hw.buf_status = 0;
+    }
+
+    sim_event_t event = {
+        .type = SIM_EVT_REPORT,
+        .dev_addr = dev_addr,
+        .instance = instance,
+        .len = len
+    };
+    memcpy(event.data, data, len);
+    _queue_event(&event);
+}
+
+/**
+ * @brief Encode a UTF-8 string as a USB string descriptor (UTF-16LE)
+ * @return XFER_RESULT_SUCCESS, or XFER_RESULT_STALLED if there is no string
+ */
+static uint8_t _string_descriptor(uint8_t daddr, uint8_t index_offset,
+                                  void *buffer, uint16_t len) {
+    sim_dev_t *d = _find_device(daddr);
+    if (!d || !d->attached || d->dev.stall_descriptors) {
+        return XFER_RESULT_STALLED;
+    }
+    const char *strings[] = { d->dev.manufacturer, d->dev.product, d->dev.serial };
+    const char *str = strings[index_offset];
+    if (d->dev.desc_device[14 + index_offset] == 0 || str[0] == '\0') {
+        return XFER_RESULT_STALLED;
+    }
+
+    uint8_t desc[2 + 2 * (SIM_USB_STRING_MAX - 1)];
+    size_t pos = 2;
+    const uint8_t *s = (const uint8_t *)str;
+    while (*s && pos + 2 <= sizeof(desc)) {
+        uint16_t chr;
+        if (s[0] < 0x80) {
+            chr = s[0];
+            s += 1;
+        } else if ((s[0] & 0xE0) == 0xC0 && s[1]) {
+            chr = (uint16_t)(((s[0] & 0x1F) << 6) | (s[1] & 0x3F));
+            s += 2;
+        } else if ((s[0] & 0xF0) == 0xE0 && s[1] && s[2]) {
+            chr = (uint16_t)(((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F));
+            s += 3;
+        } else {
+            chr = '?';
+            s += 1;
+        }
+        desc[pos++] = (uint8_t)chr;
+        desc[pos++] = (uint8_t)(chr >> 8);
+    }
+    desc[0] = (uint8_t)pos;
+    desc[1] = TUSB_DESC_STRING;
+
+    memset(buffer, 0, len);
+    memcpy(buffer, desc, pos < len ? pos : len);
+    return XFER_RESULT_SUCCESS;
+}
+
+/* ============================================================================
+ * SIMULATOR CONTROL
+ * ============================================================================ */
+
+void sim_usb_reset(void) {
+    memset(g_devices, 0, sizeof(g_devices));
+    memset(g_endpoint_used, 0, sizeof(g_endpoint_used));
+    memset(&sim_usb_hw, 0, sizeof(sim_usb_hw));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_event_head = 0;
+    g_event_tail = 0;
+    g_report_cost_us = 0;
+}
+
+void sim_usb_set_report_cost_us(uint32_t cost_us) {
+    g_report_cost_us = cost_us;
+}
+
+void sim_usb_device_init(sim_usb_device_t *dev, uint16_t vid, uint16_t pid,
+                         const char *manufacturer, const char *product, const char *serial) {
+    memset(dev, 0, sizeof(*dev));
+    tusb_desc_device_t desc = {
+        .bLength = sizeof(tusb_desc_device_t),
+        .bDescriptorType = TUSB_DESC_DEVICE,
+        .bcdUSB = 0x0200,
+        .bMaxPacketSize0 = 8,
+        .idVendor = vid,
+        .idProduct = pid,
+        .bcdDevice = 0x0100,
+        .iManufacturer = manufacturer ? 1 : 0,
+        .iProduct = product ? 2 : 0,
+        .iSerialNumber = serial ? 3 : 0,
+        .bNumConfigurations = 1
+    };
+    memcpy(dev->desc_device, &desc, sizeof(desc));
+    if (manufacturer) {
+        strncpy(dev->manufacturer, manufacturer, SIM_USB_STRING_MAX - 1);
+    }
+    if (product) {
+        strncpy(dev->product, product, SIM_USB_STRING_MAX - 1);
+    }
+    if (serial) {
+        strncpy(dev->serial, serial, SIM_USB_STRING_MAX - 1);
+    }
+}
+
+bool sim_usb_device_add_interface(sim_usb_device_t *dev, uint8_t protocol,
+                                  const uint8_t *desc_report, uint16_t desc_len) {
+    if (dev->itf_count >= SIM_USB_MAX_INTERFACES) {
+        return false;
+    }
+    dev->itfs[dev->itf_count++] = (sim_usb_interface_t){
+        .protocol = protocol,
+        .desc_report = desc_report,
+        .desc_len = desc_len
+    };
+    return true;
+}
+
+bool sim_usb_attach(uint8_t dev_addr, const sim_usb_device_t *dev) {
+    if (dev_addr == 0 || dev_addr > SIM_USB_MAX_ADDR || _find_device(dev_addr) ||
+        dev->itf_count > SIM_USB_MAX_INTERFACES) {
+        return false;
+    }
+    sim_dev_t *d = NULL;
+    for (int i = 0; i < SIM_USB_MAX_DEVICES && !d; i++) {
+        if (!g_devices[i].attached && !g_devices[i].mounted) {
+            d = &g_devices[i];
+        }
+    }
+    if (!d) {
+        return false;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->attached = true;
+    d->dev_addr = dev_addr;
+    d->dev = *dev;
+    d->dev.itf_count = 0;
+
+    _queue_event(&(sim_event_t){ .type = SIM_EVT_MOUNT, .dev_addr = dev_addr });
+    for (uint8_t i = 0; i < dev->itf_count; i++) {
+        sim_usb_attach_interface(dev_addr, &dev->itfs[i]);
+    }
+    return true;
+}
+
+int sim_usb_attach_interface(uint8_t dev_addr, const sim_usb_interface_t *itf) {
+    sim_dev_t *d = _find_device(dev_addr);
+    if (!d || !d->attached || d->dev.itf_count >= SIM_USB_MAX_INTERFACES) {
+        return -1;
+    }
+    uint8_t instance = d->dev.itf_count++;
+    d->dev.itfs[instance] = *itf;
+    sim_itf_t *host_itf = &d->itfs[instance];
+    memset(host_itf, 0, sizeof(*host_itf));
+    host_itf->desc = *itf;
+    _assign_endpoint(dev_addr, host_itf);
+
+    _queue_event(&(sim_event_t){
+        .type = SIM_EVT_HID_MOUNT, .dev_addr = dev_addr, .instance = instance
+    });
+    return instance;
+}
+
+bool sim_usb_detach(uint8_t dev_addr) {
+    sim_dev_t *d = _find_device(dev_addr);
+    if (!d || !d->attached) {
+        return false;
+    }
+    d->attached = false;
+    for (uint8_t i = 0; i < d->dev.itf_count; i++) {
+        d->itfs[i].armed = false;
+        d->itfs[i].held = false;
+    }
+    if (!d->mounted) {
+        /* Unplugged before tuh_task() saw it: its queued events are dropped */
+        for (uint8_t i = 0; i < d->dev.itf_count; i++) {
+            _release_endpoint(&d->itfs[i]);
+        }
+        memset(d, 0, sizeof(*d));
+        return true;
+    }
+    _queue_event(&(sim_event_t){ .type = SIM_EVT_UNMOUNT, .dev_addr = dev_addr });
+    return true;
+}
+
+bool sim_usb_send_report(uint8_t dev_addr, uint8_t instance, const uint8_t *report,
+                         uint16_t len) {
+    sim_itf_t *itf = _find_interface(dev_addr, instance);
+    if (!itf || !_find_device(dev_addr)->attached || len > CFG_TUH_HID_EPIN_BUFSIZE) {
+        return false;
+    }
+    g_stats.reports_sent++;
+
+    if (itf->armed) {
+        _complete_transfer(dev_addr, instance, itf, report, (uint8_t)len);
+    } else {
+        if (itf->held) {
+            g_stats.reports_replaced++;
+        }
+        itf->held = true;
+        itf->held_len = (uint8_t)len;
+        memcpy(itf->held_data, report, len);
+    }
+    return true;
+}
+
+bool sim_usb_event_pending(void) {
+    return g_event_head != g_event_tail;
+}
+
+bool sim_usb_report_armed(uint8_t dev_addr, uint8_t instance) {
+    sim_itf_t *itf = _find_interface(dev_addr, instance);
+    return itf && itf->armed;
+}
+
+const sim_usb_stats_t *sim_usb_get_stats(void) {
+    return &g_stats;
+}
+
+/* ============================================================================
+ * TinyUSB HOST API
+ * ============================================================================ */
+
+bool tusb_init(uint8_t rhport, const tusb_rhport_init_t *rh_init) {
+    return rhport == BOARD_TUH_RHPORT && rh_init && rh_init->role == TUSB_ROLE_HOST;
+}
+
+void tuh_task(void) {
+    while (g_event_tail != g_event_head) {
+        sim_event_t event = g_events[g_event_tail & (SIM_USB_EVENT_QUEUE_SIZE - 1)];
+        g_event_tail++;
+
+        sim_dev_t *d = _find_device(event.dev_addr);
+        if (!d) {
+            continue;
+        }
+        sim_itf_t *itf = event.instance < d->dev.itf_count ? &d->itfs[event.instance] : NULL;
+
+        switch (event.type) {
+            case SIM_EVT_MOUNT:
+                d->mounted = true;
+                tuh_mount_cb(event.dev_addr);
+                break;
+
+            case SIM_EVT_HID_MOUNT:
+                if (d->mounted && itf) {
+                    itf->mounted = true;
+                    tuh_hid_mount_cb(event.dev_addr, event.instance,
+                                     itf->desc.desc_report, itf->desc.desc_len);
+                }
+                break;
+
+            case SIM_EVT_REPORT:
+                if (itf && itf->mounted) {
+                    g_stats.reports_delivered++;
+                    sim_clock_advance_us(g_report_cost_us);
+                    tuh_hid_report_received_cb(event.dev_addr, event.instance,
+                                               event.data, event.len);
+                } else {
+                    g_stats.reports_discarded++;
+                }
+                break;
+
+            case SIM_EVT_UNMOUNT:
+                /* Like TinyUSB: the device callback first, then each class
+                 * driver closes its interfaces */
+                if (d->mounted) {
+                    tuh_umount_cb(event.dev_addr);
+                }
+                for (uint8_t i = 0; i < d->dev.itf_count; i++) {
+                    if (d->itfs[i].mounted) {
+                        d->itfs[i].mounted = false;
+                        tuh_hid_umount_cb(event.dev_addr, i);
+                    }
+                    _release_endpoint(&d->itfs[i]);
+                }
+                memset(d, 0, sizeof(*d));
+                break;
+        }
+    }
+}
+
+uint8_t tuh_descriptor_get_device_sync(uint8_t daddr, void *buffer, uint16_t len) {
+    sim_dev_t *d = _find_device(daddr);
+    if (!d || !d->attached || d->dev.stall_descriptors) {
+        return XFER_RESULT_STALLED;
+    }
+    memcpy(buffer, d->dev.desc_device,
+           len < sizeof(d->dev.desc_device) ? len : sizeof(d->dev.desc_device));
+    return XFER_RESULT_SUCCESS;
+}
+
+uint8_t tuh_descriptor_get_manufacturer_string_sync(uint8_t daddr, uint16_t language_id,
+                                                    void *buffer, uint16_t len) {
+    (void)language_id;
+    return _string_descriptor(daddr, 0, buffer, len);
+}
+
+uint8_t tuh_descriptor_get_product_string_sync(uint8_t daddr, uint16_t language_id,
+                                               void *buffer, uint16_t len) {
+    (void)language_id;
+    return _string_descriptor(daddr, 1, buffer, len);
+}
+
+uint8_t tuh_descriptor_get_serial_string_sync(uint8_t daddr, uint16_t language_id,
+                                              void *buffer, uint16_t len) {
+    (void)language_id;
+    return _string_descriptor(daddr, 2, buffer, len);
+}
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx) {
+    sim_itf_t *itf = _find_interface(dev_addr, idx);
+    return itf ? itf->desc.protocol : HID_ITF_PROTOCOL_NONE;
+}
+
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx) {
+    sim_itf_t *itf = _find_interface(dev_addr, idx);
+    if (!itf || !itf->mounted || itf->armed || !_find_device(dev_addr)->attached) {
+        return false;
+    }
+    itf->armed = true;
+
+    /* A report the device was holding answers the first poll */
+    if (itf->held) {
+        itf->held = false;
+        _complete_transfer(dev_addr, idx, itf, itf->held_data, itf->held_len);
+    }
+    return true;
+}
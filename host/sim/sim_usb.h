@@ -0,0 +1,118 @@
+/*
+ * PlugSafe Host Simulator - Virtual USB Bus
+ * Programmable virtual devices behind the simulated TinyUSB host API
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_USB_H
+#define SIM_USB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "tusb.h"
+
+/*
+ * The bus stands in for TinyUSB and the RP2040 host controller. Attaching,
+ * detaching and device-side reports queue events the way the USB IRQ
+ * would (tuh_event_hook_cb() is called for each), and tuh_task() delivers
+ * them to the application callbacks:
+ *
+ *   attach      tuh_mount_cb(), then tuh_hid_mount_cb() per interface
+ *   report      tuh_hid_report_received_cb()
+ *   detach      tuh_umount_cb(), then tuh_hid_umount_cb() per interface
+ *
+ * A report completes only while the host has an IN request armed on the
+ * interface (tuh_hid_receive_report()). Otherwise the device holds it in
+ * its endpoint buffer, as real devices NAK polls they cannot answer, and a
+ * newer report replaces a held one. On completion the USB IRQ handlers run
+ * with BUFF_STATUS and SOF_RD set for the interface's interrupt endpoint,
+ * so the firmware's completion stamping sees what it sees on hardware.
+ */
+
+/* Configuration */
+#define SIM_USB_MAX_DEVICES           CFG_TUH_DEVICE_MAX
+#define SIM_USB_MAX_INTERFACES        4     /* HID interfaces per device */
+#define SIM_USB_EVENT_QUEUE_SIZE      64    /* Like TinyUSB, overflowing events are lost */
+#define SIM_USB_STRING_MAX            64    /* Incl. NUL */
+
+/* One HID interface of a virtual device */
+typedef struct {
+    uint8_t protocol;                 /* HID_ITF_PROTOCOL_* */
+    const uint8_t *desc_report;       /* Report descriptor (must outlive the attachment) */
+    uint16_t desc_len;
+} sim_usb_interface_t;
+
+/* A virtual device. Strings are UTF-8; an empty string is not offered
+ * (its index in the descriptor is 0). */
+typedef struct {
+    uint8_t desc_device[18];          /* Raw device descriptor */
+    char manufacturer[SIM_USB_STRING_MAX];
+    char product[SIM_USB_STRING_MAX];
+    char serial[SIM_USB_STRING_MAX];
+    uint8_t itf_count;
+    sim_usb_interface_t itfs[SIM_USB_MAX_INTERFACES];
+    bool stall_descriptors;           /* Fault: every descriptor request stalls */
+} sim_usb_device_t;
+
+/* Bus statistics */
+typedef struct {
+    uint32_t events;                  /* Events queued for tuh_task() */
+    uint32_t events_lost;             /* Queue full */
+    uint32_t reports_sent;            /* Accepted from devices */
+    uint32_t reports_delivered;       /* Passed to tuh_hid_report_received_cb() */
+    uint32_t reports_replaced;        /* Held report overwritten before the host asked */
+    uint32_t reports_discarded;       /* Completed for an interface gone by dispatch */
+} sim_usb_stats_t;
+
+/* Detach everything without callbacks, drop queued events, clear the
+ * controller registers and statistics */
+void sim_usb_reset(void);
+
+/* Virtual time tuh_task() spends on each report it delivers, standing in
+ * for the stack and the callback on hardware (0 after a reset) */
+void sim_usb_set_report_cost_us(uint32_t cost_us);
+
+/* Fill in a full-speed device with class 0 (defined per interface). NULL
+ * strings are not offered. No interfaces are added. */
+void sim_usb_device_init(sim_usb_device_t *dev, uint16_t vid, uint16_t pid,
+                         const char *manufacturer, const char *product, const char *serial);
+
+/* Append a HID interface to a device before it is attached. Returns false
+ * when the device already has SIM_USB_MAX_INTERFACES. */
+bool sim_usb_device_add_interface(sim_usb_device_t *dev, uint8_t protocol,
+                                  const uint8_t *desc_report, uint16_t desc_len);
+
+/* Plug a device in at dev_addr (1..127). The device is copied. False if the
+ * address is in use or no slot is free. */
+bool sim_usb_attach(uint8_t dev_addr, const sim_usb_device_t *dev);
+
+/* Enumerate one more HID interface of an attached device (its instance is
+ * the next free one). Returns the instance, or -1. */
+int sim_usb_attach_interface(uint8_t dev_addr, const sim_usb_interface_t *itf);
+
+/* Unplug a device. Once tuh_task() has mounted it, events already queued
+ * for it are still dispatched before the unmount; a device unplugged
+ * before that simply disappears. */
+bool sim_usb_detach(uint8_t dev_addr);
+
+/* The device sends a report on one of its interfaces (len up to
+ * CFG_TUH_HID_EPIN_BUFSIZE). False if there is no such interface or the
+ * report is too long. */
+bool sim_usb_send_report(uint8_t dev_addr, uint8_t instance, const uint8_t *report,
+                         uint16_t len);
+
+/* True when events are waiting for tuh_task() */
+bool sim_usb_event_pending(void);
+
+/* True while the host has a report request armed on the interface */
+bool sim_usb_report_armed(uint8_t dev_addr, uint8_t instance);
+
+const sim_usb_stats_t *sim_usb_get_stats(void);
+
+#endif /* SIM_USB_H */
@@ -0,0 +1,384 @@
+/*
+ * PlugSafe DuckyScript Compiler Implementation
+ * Keystroke-injection payload scripts compiled to timed boot-keyboard reports
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "ducky.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DUCKY_CHORD_MAX               128   /* Longest key chord line */
+
+typedef struct {
+    const ducky_options_t *opt;
+    synth_keyboard_t *kbd;
+    ducky_error_t *err;
+    synth_rng_t rng;
+    uint64_t now_us;                  /* When the next command starts */
+    uint32_t line;
+    uint32_t default_delay_ms;
+    uint32_t string_delay_ms;
+    int64_t next_string_delay_ms;     /* STRING_DELAY for the next STRING, -1 = none */
+    uint32_t skipped;
+} ducky_state_t;
+
+/* Result of one line */
+typedef enum {
+    LINE_ERROR = -1,
+    LINE_SETTING = 0,                 /* Blank, REM or a setting: not repeatable */
+    LINE_ACTION = 1                   /* Typed or waited: REPEAT runs it again */
+} line_result_e;
+
+/* ============================================================================
+ * KEY NAMES
+ * ============================================================================ */
+
+static const struct {
+    const char *name;
+    uint8_t modifier;
+} g_modifiers[] = {
+    { "CTRL", SYNTH_MOD_LCTRL }, { "CONTROL", SYNTH_MOD_LCTRL },
+    { "SHIFT", SYNTH_MOD_LSHIFT },
+    { "ALT", SYNTH_MOD_LALT }, { "OPTION", SYNTH_MOD_LALT },
+    { "GUI", SYNTH_MOD_LGUI }, { "WINDOWS", SYNTH_MOD_LGUI },
+    { "COMMAND", SYNTH_MOD_LGUI }, { "META", SYNTH_MOD_LGUI }
+};
+
+static const struct {
+    const char *name;
+    uint8_t key;
+} g_keys[] = {
+    { "ENTER", 0x28 }, { "ESC", 0x29 }, { "ESCAPE", 0x29 }, { "BACKSPACE", 0x2A },
+    { "TAB", 0x2B }, { "SPACE", 0x2C }, { "CAPSLOCK", 0x39 },
+    { "F1", 0x3A }, { "F2", 0x3B }, { "F3", 0x3C }, { "F4", 0x3D }, { "F5", 0x3E },
+    { "F6", 0x3F }, { "F7", 0x40 }, { "F8", 0x41 }, { "F9", 0x42 }, { "F10", 0x43 },
+    { "F11", 0x44 }, { "F12", 0x45 },
+    { "PRINTSCREEN", 0x46 }, { "SCROLLLOCK", 0x47 }, { "PAUSE", 0x48 }, { "BREAK", 0x48 },
+    { "INSERT", 0x49 }, { "HOME", 0x4A }, { "PAGEUP", 0x4B }, { "DELETE", 0x4C },
+    { "DEL", 0x4C }, { "END", 0x4D }, { "PAGEDOWN", 0x4E },
+    { "RIGHT", 0x4F }, { "RIGHTARROW", 0x4F }, { "LEFT", 0x50 }, { "LEFTARROW", 0x50 },
+    { "DOWN", 0x51 }, { "DOWNARROW", 0x51 }, { "UP", 0x52 }, { "UPARROW", 0x52 },
+    { "NUMLOCK", 0x53 }, { "MENU", 0x65 }, { "APP", 0x65 }
+};
+
+#define ARRAY_LEN(a)                  (sizeof(a) / sizeof((a)[0]))
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+static line_result_e _fail(ducky_state_t *s, const char *fmt, ...) {
+    if (s->err) {
+        va_list args;
+        va_start(args, fmt);
+        s->err->line = s->line;
+        vsnprintf(s->err->message, sizeof(s->err->message), fmt, args);
+        va_end(args);
+    }
+    return LINE_ERROR;
+}
+
+/**
+ * @brief Parse a whole argument as an unsigned number
+ */
+static bool _parse_uint(const char *arg, size_t len, uint32_t *value_out) {
+    char buf[16];
+    if (len == 0 || len >= sizeof(buf)) {
+        return false;
+    }
+    memcpy(buf, arg, len);
+    buf[len] = '\0';
+    char *end;
+    unsigned long value = strtoul(buf, &end, 10);
+    if (*end != '\0' || buf[0] == '-' || value > UINT32_MAX) {
+        return false;
+    }
+    *value_out = (uint32_t)value;
+    return true;
+}
+
+/**
+ * @brief Advance time by a jittered gap
+ */
+static void _gap(ducky_state_t *s, uint64_t gap_us) {
+    s->now_us += synth_jitter_apply(&s->opt->jitter, &s->rng, gap_us);
+}
+
+/**
+ * @brief Resolve one chord token to a modifier bit or key code
+ */
+static bool _chord_token(const char *token, uint8_t *modifiers, uint8_t *keys,
+                         uint8_t *key_count) {
+    for (size_t i = 0; i < ARRAY_LEN(g_modifiers); i++) {
+        if (strcmp(token, g_modifiers[i].name) == 0) {
+            *modifiers |= g_modifiers[i].modifier;
+            return true;
+        }
+    }
+
+    uint8_t key = 0;
+    uint8_t shift = 0;
+    for (size_t i = 0; i < ARRAY_LEN(g_keys); i++) {
+        if (strcmp(token, g_keys[i].name) == 0) {
+            key = g_keys[i].key;
+            break;
+        }
+    }
+    if (!key && token[1] == '\0') {
+        char c = token[0];
+        if (c >= 'A' && c <= 'Z') {
+            c = (char)(c - 'A' + 'a');        /* "GUI R" means the R key, not Shift+R */
+        }
+        if (!synth_ascii_to_key(c, &key, &shift)) {
+            return false;
+        }
+    }
+    if (!key || *key_count >= 6) {
+        return false;
+    }
+    *modifiers |= shift;
+    keys[(*key_count)++] = key;
+    return true;
+}
+
+/**
+ * @brief Parse a chord line ("CTRL ALT DELETE", "CTRL-SHIFT ESC", "GUI r")
+ */
+static line_result_e _parse_chord(ducky_state_t *s, const char *text, size_t len,
+                                  uint8_t *modifiers, uint8_t *keys, uint8_t *key_count) {
+    char buf[DUCKY_CHORD_MAX];
+    if (len >= sizeof(buf)) {
+        return _fail(s, "key chord too long");
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+
+    *modifiers = 0;
+    *key_count = 0;
+    char *save;
+    for (char *word = strtok_r(buf, " \t", &save); word; word = strtok_r(NULL, " \t", &save)) {
+        /* Hyphens join chord keys, but a lone "-" is the minus key */
+        char *part = word;
+        while (1) {
+            char *hyphen = (part[0] && part[1]) ? strchr(part + 1, '-') : NULL;
+            if (hyphen) {
+                *hyphen = '\0';
+            }
+            if (!_chord_token(part, modifiers, keys, key_count)) {
+                return _fail(s, "unknown key '%s'", part);
+            }
+            if (!hyphen) {
+                break;
+            }
+            part = hyphen + 1;
+        }
+    }
+    if (*modifiers == 0 && *key_count == 0) {
+        return _fail(s, "empty key chord");
+    }
+    return LINE_ACTION;
+}
+
+/**
+ * @brief Type text, one tap per character, with the STRING gap after each
+ */
+static void _type(ducky_state_t *s, const char *text, size_t len, bool newline) {
+    uint64_t gap_us = (uint64_t)(s->next_string_delay_ms >= 0 ?
+                                 (uint32_t)s->next_string_delay_ms : s->string_delay_ms) * 1000;
+    s->next_string_delay_ms = -1;
+
+    for (size_t i = 0; i < len + (newline ? 1 : 0); i++) {
+        char c = i < len ? text[i] : '\n';
+        uint8_t key;
+        uint8_t modifiers;
+        if (!synth_ascii_to_key(c, &key, &modifiers)) {
+            s->skipped++;
+            continue;
+        }
+        s->now_us = synth_keyboard_tap(s->kbd, s->now_us, modifiers, &key, 1, s->opt->hold_us);
+        _gap(s, gap_us);
+    }
+}
+
+/* ============================================================================
+ * COMMANDS
+ * ============================================================================ */
+
+/**
+ * @brief Run one script line (without its line ending)
+ */
+static line_result_e _run_line(ducky_state_t *s, const char *line, size_t len) {
+    while (len && (*line == ' ' || *line == '\t')) {
+        line++;
+        len--;
+    }
+    if (len == 0) {
+        return LINE_SETTING;
+    }
+
+    size_t cmd_len = 0;
+    while (cmd_len < len && line[cmd_len] != ' ' && line[cmd_len] != '\t') {
+        cmd_len++;
+    }
+    const char *arg = line + cmd_len;
+    size_t arg_len = len - cmd_len;
+    if (arg_len) {
+        arg++;                        /* One separator; STRING keeps the rest verbatim */
+        arg_len--;
+    }
+#define IS(name) (cmd_len == sizeof(name) - 1 && memcmp(line, name, cmd_len) == 0)
+
+    if (IS("REM")) {
+        return LINE_SETTING;
+    }
+    if (IS("STRING") || IS("STRINGLN")) {
+        _type(s, arg, arg_len, IS("STRINGLN"));
+        return LINE_ACTION;
+    }
+
+    uint32_t ms;
+    if (IS("DELAY")) {
+        if (!_parse_uint(arg, arg_len, &ms)) {
+            return _fail(s, "DELAY needs milliseconds");
+        }
+        _gap(s, (uint64_t)ms * 1000);
+        return LINE_ACTION;
+    }
+    if (IS("DEFAULT_DELAY") || IS("DEFAULTDELAY")) {
+        if (!_parse_uint(arg, arg_len, &ms)) {
+            return _fail(s, "DEFAULT_DELAY needs milliseconds");
+        }
+        s->default_delay_ms = ms;
+        return LINE_SETTING;
+    }
+    if (IS("STRING_DELAY") || IS("STRINGDELAY")) {
+        if (!_parse_uint(arg, arg_len, &ms)) {
+            return _fail(s, "STRING_DELAY needs milliseconds");
+        }
+        s->next_string_delay_ms = ms;
+        return LINE_SETTING;
+    }
+    if (IS("DEFAULT_STRING_DELAY") || IS("DEFAULTCHARDELAY")) {
+        if (!_parse_uint(arg, arg_len, &ms)) {
+            return _fail(s, "DEFAULT_STRING_DELAY needs milliseconds");
+        }
+        s->string_delay_ms = ms;
+        return LINE_SETTING;
+    }
+
+    uint8_t modifiers;
+    uint8_t keys[6];
+    uint8_t key_count;
+    if (IS("HOLD") || IS("RELEASE")) {
+        bool hold = IS("HOLD");
+        if (_parse_chord(s, arg, arg_len, &modifiers, keys, &key_count) == LINE_ERROR) {
+            return LINE_ERROR;
+        }
+        for (uint8_t i = 0; i < (key_count ? key_count : 1); i++) {
+            uint8_t key = key_count ? keys[i] : 0;
+            if (hold) {
+                if (!synth_keyboard_hold(s->kbd, s->now_us, modifiers, key)) {
+                    return _fail(s, "more than 6 keys held");
+                }
+            } else {
+                synth_keyboard_release(s->kbd, s->now_us, modifiers, key);
+            }
+            s->now_us = s->kbd->last_us;
+        }
+        return LINE_ACTION;
+    }
+#undef IS
+
+    /* Anything else must be a key chord */
+    if (_parse_chord(s, line, len, &modifiers, keys, &key_count) == LINE_ERROR) {
+        return LINE_ERROR;
+    }
+    s->now_us = synth_keyboard_tap(s->kbd, s->now_us, modifiers, keys, key_count,
+                                   s->opt->hold_us);
+    return LINE_ACTION;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void ducky_default_options(ducky_options_t *opt) {
+    *opt = (ducky_options_t){
+        .default_delay_ms = 0,
+        .string_delay_ms = DUCKY_DEFAULT_STRING_DELAY_MS,
+        .hold_us = DUCKY_DEFAULT_HOLD_US,
+        .jitter = { SYNTH_JITTER_NONE, 0 },
+        .seed = 1,
+        .start_us = 0
+    };
+}
+
+bool ducky_compile(const char *script, const ducky_options_t *opt, synth_keyboard_t *kbd,
+                   uint32_t *skipped, ducky_error_t *err) {
+    ducky_state_t s = {
+        .opt = opt,
+        .kbd = kbd,
+        .err = err,
+        .now_us = opt->start_us,
+        .default_delay_ms = opt->default_delay_ms,
+        .string_delay_ms = opt->string_delay_ms,
+        .next_string_delay_ms = -1
+    };
+    synth_rng_seed(&s.rng, opt->seed);
+
+    const char *prev = NULL;          /* Last repeatable line */
+    size_t prev_len = 0;
+    bool ok = true;
+    for (const char *p = script; *p && ok; ) {
+        const char *eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+        size_t text_len = (len && p[len - 1] == '\r') ? len - 1 : len;
+        s.line++;
+
+        const char *cmd = p;
+        while (cmd < p + text_len && (*cmd == ' ' || *cmd == '\t')) {
+            cmd++;
+        }
+        bool repeat = (strncmp(cmd, "REPEAT ", 7) == 0 || strncmp(cmd, "REPLAY ", 7) == 0);
+        if (repeat) {
+            uint32_t count;
+            if (!_parse_uint(cmd + 7, text_len - (size_t)(cmd + 7 - p), &count)) {
+                ok = _fail(&s, "REPEAT needs a count") != LINE_ERROR;
+            } else if (!prev) {
+                ok = _fail(&s, "REPEAT without a previous command") != LINE_ERROR;
+            }
+            for (uint32_t i = 0; ok && i < count; i++) {
+                ok = _run_line(&s, prev, prev_len) != LINE_ERROR;
+                _gap(&s, (uint64_t)s.default_delay_ms * 1000);
+            }
+        } else {
+            line_result_e result = _run_line(&s, p, text_len);
+            ok = result != LINE_ERROR;
+            if (result == LINE_ACTION) {
+                prev = p;
+                prev_len = text_len;
+                _gap(&s, (uint64_t)s.default_delay_ms * 1000);
+            }
+        }
+        p = eol ? eol + 1 : p + len;
+    }
+
+    /* Nothing stays held after the payload ends */
+    if (ok && (kbd->held_modifiers || kbd->held_count)) {
+        kbd->held_modifiers = 0;
+        kbd->held_count = 0;
+        synth_keyboard_report(kbd, s.now_us, 0, NULL, 0);
+    }
+    if (skipped) {
+        *skipped = s.skipped;
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+/*
+ * PlugSafe DuckyScript Compiler
+ * Keystroke-injection payload scripts compiled to timed boot-keyboard reports
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef DUCKY_H
+#define DUCKY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/*
+ * Supported commands (USB Rubber Ducky 1.0 plus the common Flipper BadUSB
+ * spellings), one per line, case-sensitive as in DuckyScript:
+ *
+ *   REM ...                          comment
+ *   DELAY ms                         pause
+ *   DEFAULT_DELAY / DEFAULTDELAY ms  pause after every later command
+ *   STRING text / STRINGLN text      type text (STRINGLN adds ENTER)
+ *   STRING_DELAY / STRINGDELAY ms    per-character gap for the next STRING only
+ *   DEFAULT_STRING_DELAY /
+ *   DEFAULTCHARDELAY ms              per-character gap for every later STRING
+ *   REPEAT / REPLAY n                run the previous command n more times
+ *   HOLD keys / RELEASE keys         keep keys down across commands
+ *   key chord                        e.g. "GUI r", "CTRL ALT DELETE",
+ *                                    "CTRL-SHIFT ESC", "ENTER"
+ *
+ * Chord keys are modifiers (CTRL, SHIFT, ALT, GUI and aliases), named keys
+ * (ENTER, TAB, F1-F12, arrows, ...) or single characters on a US layout.
+ * Every gap (between characters, after commands, DELAY) gets the jitter
+ * model; key hold times do not.
+ */
+
+/* Configuration */
+#define DUCKY_DEFAULT_HOLD_US         5000
+#define DUCKY_DEFAULT_STRING_DELAY_MS 5
+
+/* Timing model */
+typedef struct {
+    uint32_t default_delay_ms;        /* Pause after each command until DEFAULT_DELAY */
+    uint32_t string_delay_ms;         /* Gap after each typed character until DEFAULT_STRING_DELAY */
+    uint32_t hold_us;                 /* How long each key is down */
+    synth_jitter_t jitter;            /* Noise on every gap */
+    uint32_t seed;                    /* Jitter seed */
+    uint64_t start_us;                /* Trace time of the first command */
+} ducky_options_t;
+
+typedef struct {
+    uint32_t line;                    /* 1-based, 0 = not tied to a line */
+    char message[96];
+} ducky_error_t;
+
+/* Defaults: no default delay, 5 ms between characters, 5 ms holds, no
+ * jitter, start at 0 */
+void ducky_default_options(ducky_options_t *opt);
+
+/* Compile a NUL-terminated script into reports on kbd (its statistics
+ * count what was written). Characters a US keyboard cannot type are
+ * skipped and counted in *skipped (may be NULL). Returns false with err
+ * set on an unknown command or bad argument. */
+bool ducky_compile(const char *script, const ducky_options_t *opt, synth_keyboard_t *kbd,
+                   uint32_t *skipped, ducky_error_t *err);
+
+#endif /* DUCKY_H */
@@ -0,0 +1,269 @@
+/*
+ * PlugSafe Synthetic HID Traces Implementation
+ * Boot-keyboard report streams written as HID traces, with timing models
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "synth.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYNTH_TWO_PI                  6.283185307179586
+
+/* ============================================================================
+ * RANDOM NUMBERS AND JITTER
+ * ============================================================================ */
+
+void synth_rng_seed(synth_rng_t *rng, uint32_t seed) {
+    /* xorshift has a fixed point at 0; spread small seeds over the state */
+    rng->state = (seed ^ 0x9E3779B9u) * 2654435761u;
+    if (rng->state == 0) {
+        rng->state = 0x6D2B79F5u;
+    }
+}
+
+uint32_t synth_rng_next(synth_rng_t *rng) {
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x;
+}
+
+double synth_rng_uniform(synth_rng_t *rng) {
+    return (synth_rng_next(rng) >> 8) / 16777216.0;
+}
+
+double synth_rng_normal(synth_rng_t *rng) {
+    double u1 = 1.0 - synth_rng_uniform(rng);   /* (0, 1] */
+    double u2 = synth_rng_uniform(rng);
+    return sqrt(-2.0 * log(u1)) * cos(SYNTH_TWO_PI * u2);
+}
+
+double synth_rng_exp(synth_rng_t *rng, double mean) {
+    return -mean * log(1.0 - synth_rng_uniform(rng));
+}
+
+uint64_t synth_jitter_apply(const synth_jitter_t *jitter, synth_rng_t *rng, uint64_t gap_us) {
+    double gap = (double)gap_us;
+    double amount = (double)jitter->amount_us;
+    switch (jitter->kind) {
+        case SYNTH_JITTER_UNIFORM:
+            gap += (synth_rng_uniform(rng) * 2.0 - 1.0) * amount;
+            break;
+        case SYNTH_JITTER_NORMAL:
+            gap += synth_rng_normal(rng) * amount;
+            break;
+        case SYNTH_JITTER_EXP:
+            gap += synth_rng_exp(rng, amount);
+            break;
+        case SYNTH_JITTER_NONE:
+        default:
+            break;
+    }
+    return gap > 0.0 ? (uint64_t)(gap + 0.5) : 0;
+}
+
+bool synth_jitter_parse(const char *spec, synth_jitter_t *jitter) {
+    static const struct {
+        const char *name;
+        synth_jitter_e kind;
+    } kinds[] = {
+        { "uniform", SYNTH_JITTER_UNIFORM },
+        { "normal", SYNTH_JITTER_NORMAL },
+        { "exp", SYNTH_JITTER_EXP }
+    };
+
+    if (strcmp(spec, "none") == 0) {
+        *jitter = (synth_jitter_t){ SYNTH_JITTER_NONE, 0 };
+        return true;
+    }
+    const char *colon = strchr(spec, ':');
+    if (!colon) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+        if (strlen(kinds[i].name) == (size_t)(colon - spec) &&
+            strncmp(spec, kinds[i].name, (size_t)(colon - spec)) == 0) {
+            char *end;
+            double ms = strtod(colon + 1, &end);
+            if (end == colon + 1 || *end != '\0' || ms < 0.0) {
+                return false;
+            }
+            *jitter = (synth_jitter_t){ kinds[i].kind, (uint32_t)(ms * 1000.0 + 0.5) };
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * US KEYBOARD LAYOUT
+ * ============================================================================ */
+
+/* Shifted and unshifted punctuation: character, key code */
+static const struct {
+    char plain;
+    char shifted;
+    uint8_t key;
+} g_punctuation[] = {
+    { '1', '!', 0x1E }, { '2', '@', 0x1F }, { '3', '#', 0x20 }, { '4', '$', 0x21 },
+    { '5', '%', 0x22 }, { '6', '^', 0x23 }, { '7', '&', 0x24 }, { '8', '*', 0x25 },
+    { '9', '(', 0x26 }, { '0', ')', 0x27 },
+    { '-', '_', 0x2D }, { '=', '+', 0x2E }, { '[', '{', 0x2F }, { ']', '}', 0x30 },
+    { '\\', '|', 0x31 }, { ';', ':', 0x33 }, { '\'', '"', 0x34 }, { '`', '~', 0x35 },
+    { ',', '<', 0x36 }, { '.', '>', 0x37 }, { '/', '?', 0x38 }
+};
+
+bool synth_ascii_to_key(char c, uint8_t *key, uint8_t *modifiers) {
+    *modifiers = 0;
+    if (c >= 'a' && c <= 'z') {
+        *key = (uint8_t)(0x04 + (c - 'a'));
+        return true;
+    }
+    if (c >= 'A' && c <= 'Z') {
+        *key = (uint8_t)(0x04 + (c - 'A'));
+        *modifiers = SYNTH_MOD_LSHIFT;
+        return true;
+    }
+    switch (c) {
+        case ' ':  *key = SYNTH_KEY_SPACE; return true;
+        case '\n': *key = SYNTH_KEY_ENTER; return true;
+        case '\t': *key = 0x2B; return true;
+        default: break;
+    }
+    for (size_t i = 0; i < sizeof(g_punctuation) / sizeof(g_punctuation[0]); i++) {
+        if (c == g_punctuation[i].plain || c == g_punctuation[i].shifted) {
+            *key = g_punctuation[i].key;
+            if (c == g_punctuation[i].shifted) {
+                *modifiers = SYNTH_MOD_LSHIFT;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * TRACE OUTPUT
+ * ============================================================================ */
+
+/**
+ * @brief Copy an optional string into a fixed trace field
+ */
+static void _copy_string(char *dst, const char *src) {
+    dst[0] = '\0';
+    if (src) {
+        strncpy(dst, src, HT_STRING_MAX - 1);
+        dst[HT_STRING_MAX - 1] = '\0';
+    }
+}
+
+bool synth_write_keyboard(hid_trace_writer_t *w, const synth_device_t *dev, uint8_t itf_id) {
+    hid_trace_device_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.dev_addr = dev->dev_addr;
+    _copy_string(rec.manufacturer, dev->manufacturer);
+    _copy_string(rec.product, dev->product);
+    _copy_string(rec.serial, dev->serial);
+
+    /* Full-speed device, class defined per interface, USB 2.0 */
+    const uint8_t desc[HT_DEVICE_DESC_SIZE] = {
+        HT_DEVICE_DESC_SIZE, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 8,
+        (uint8_t)dev->vid, (uint8_t)(dev->vid >> 8),
+        (uint8_t)dev->pid, (uint8_t)(dev->pid >> 8),
+        0x00, 0x01,
+        rec.manufacturer[0] ? 1 : 0, rec.product[0] ? 2 : 0, rec.serial[0] ? 3 : 0,
+        1
+    };
+    memcpy(rec.desc_device, desc, sizeof(desc));
+
+    hid_trace_interface_t itf = {
+        .itf_id = itf_id,
+        .dev_addr = dev->dev_addr,
+        .instance = 0,
+        .protocol = 1                 /* Boot keyboard */
+    };
+    return hid_trace_write_device(w, &rec) && hid_trace_write_interface(w, &itf);
+}
+
+void synth_keyboard_init(synth_keyboard_t *kbd, hid_trace_writer_t *w, uint8_t itf_id,
+                         uint32_t poll_interval_us) {
+    memset(kbd, 0, sizeof(*kbd));
+    kbd->w = w;
+    kbd->itf_id = itf_id;
+    kbd->poll_interval_us = poll_interval_us ? poll_interval_us : SYNTH_DEFAULT_POLL_US;
+}
+
+uint64_t synth_keyboard_report(synth_keyboard_t *kbd, uint64_t time_us,
+                               uint8_t modifiers, const uint8_t *keys, uint8_t key_count) {
+    uint64_t poll = kbd->poll_interval_us;
+    time_us = (time_us + poll - 1) / poll * poll;
+    if (kbd->any && time_us < kbd->last_us + poll) {
+        time_us = kbd->last_us + poll;
+    }
+
+    /* Held keys first, then the new ones; a boot report has 6 key slots */
+    uint8_t report[SYNTH_REPORT_SIZE] = { (uint8_t)(kbd->held_modifiers | modifiers) };
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < kbd->held_count; i++) {
+        report[2 + n++] = kbd->held_keys[i];
+    }
+    for (uint8_t i = 0; i < key_count && n < 6; i++) {
+        report[2 + n++] = keys[i];
+    }
+    hid_trace_write_report(kbd->w, kbd->itf_id, time_us, report, sizeof(report));
+    kbd->last_us = time_us;
+    kbd->any = true;
+    kbd->reports++;
+    return time_us;
+}
+
+/**
+ * @brief Count a key press for the statistics
+ */
+static void _count_keystroke(synth_keyboard_t *kbd, uint64_t pressed_us) {
+    if (kbd->keystrokes++ == 0) {
+        kbd->first_key_us = pressed_us;
+    }
+}
+
+uint64_t synth_keyboard_tap(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                            const uint8_t *keys, uint8_t key_count, uint64_t hold_us) {
+    uint64_t pressed_us = synth_keyboard_report(kbd, time_us, modifiers, keys, key_count);
+    _count_keystroke(kbd, pressed_us);
+    return synth_keyboard_report(kbd, pressed_us + hold_us, 0, NULL, 0);
+}
+
+bool synth_keyboard_hold(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                         uint8_t key) {
+    if (key && kbd->held_count >= 6) {
+        return false;
+    }
+    kbd->held_modifiers |= modifiers;
+    if (key) {
+        kbd->held_keys[kbd->held_count++] = key;
+    }
+    _count_keystroke(kbd, synth_keyboard_report(kbd, time_us, 0, NULL, 0));
+    return true;
+}
+
+void synth_keyboard_release(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                            uint8_t key) {
+    kbd->held_modifiers &= (uint8_t)~modifiers;
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < kbd->held_count; i++) {
+        if (kbd->held_keys[i] != key) {
+            kbd->held_keys[n++] = kbd->held_keys[i];
+        }
+    }
+    kbd->held_count = n;
+    synth_keyboard_report(kbd, time_us, 0, NULL, 0);
+}
@@ -0,0 +1,139 @@
+/*
+ * PlugSafe Synthetic HID Traces
+ * Boot-keyboard report streams written as HID traces, with timing models
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hid_trace.h"
+
+/*
+ * The generators (ducky.h, typing_model.h) describe keystrokes; a
+ * synth_keyboard_t turns them into 8-byte boot-keyboard reports
+ * (modifiers, reserved, 6 key codes) on one trace interface. Report times
+ * are moved onto the device's polling grid: a full-speed interrupt
+ * endpoint answers at most one IN poll per bInterval, so no two reports
+ * are closer than poll_interval_us and each lands on a poll.
+ *
+ * Everything random draws from a synth_rng_t, so a seed reproduces a trace
+ * exactly.
+ */
+
+/* Boot keyboard modifier bits (report byte 0) */
+#define SYNTH_MOD_LCTRL               0x01
+#define SYNTH_MOD_LSHIFT              0x02
+#define SYNTH_MOD_LALT                0x04
+#define SYNTH_MOD_LGUI                0x08
+
+/* Key codes used by the generators (HID usage page 0x07) */
+#define SYNTH_KEY_ENTER               0x28
+#define SYNTH_KEY_BACKSPACE           0x2A
+#define SYNTH_KEY_SPACE               0x2C
+
+#define SYNTH_REPORT_SIZE             8
+#define SYNTH_DEFAULT_POLL_US         1000  /* bInterval 1 ms */
+
+/* Deterministic PRNG (xorshift32) */
+typedef struct {
+    uint32_t state;
+} synth_rng_t;
+
+/* Per-gap timing noise */
+typedef enum {
+    SYNTH_JITTER_NONE = 0,
+    SYNTH_JITTER_UNIFORM,             /* Uniform in +/- amount */
+    SYNTH_JITTER_NORMAL,              /* Normal, sigma = amount */
+    SYNTH_JITTER_EXP                  /* Extra delay, exponential with mean = amount */
+} synth_jitter_e;
+
+typedef struct {
+    synth_jitter_e kind;
+    uint32_t amount_us;
+} synth_jitter_t;
+
+/* Identity of the generated keyboard */
+typedef struct {
+    uint8_t dev_addr;
+    uint16_t vid;
+    uint16_t pid;
+    const char *manufacturer;         /* NULL or "" = not offered */
+    const char *product;
+    const char *serial;
+} synth_device_t;
+
+/* Report emitter for one keyboard interface */
+typedef struct {
+    hid_trace_writer_t *w;
+    uint8_t itf_id;
+    uint32_t poll_interval_us;
+    uint64_t last_us;                 /* Time of the last report written */
+    bool any;                         /* A report has been written */
+    uint32_t reports;
+    uint32_t keystrokes;              /* Key presses (chords count once) */
+    uint64_t first_key_us;            /* Time of the first key press */
+    uint8_t held_modifiers;           /* Held down across taps (synth_keyboard_hold()) */
+    uint8_t held_keys[6];
+    uint8_t held_count;
+} synth_keyboard_t;
+
+void synth_rng_seed(synth_rng_t *rng, uint32_t seed);
+uint32_t synth_rng_next(synth_rng_t *rng);
+
+/* Uniform in [0, 1) */
+double synth_rng_uniform(synth_rng_t *rng);
+
+/* Standard normal (Box-Muller) */
+double synth_rng_normal(synth_rng_t *rng);
+
+/* Exponential with the given mean */
+double synth_rng_exp(synth_rng_t *rng, double mean);
+
+/* Apply jitter to a gap; the result is never negative */
+uint64_t synth_jitter_apply(const synth_jitter_t *jitter, synth_rng_t *rng, uint64_t gap_us);
+
+/* Parse "none", "uniform:MS", "normal:MS" or "exp:MS" (MS may be
+ * fractional). False on a malformed spec. */
+bool synth_jitter_parse(const char *spec, synth_jitter_t *jitter);
+
+/* Map a printable ASCII character to a key code and modifiers on a US
+ * layout. False for characters a US keyboard cannot type. */
+bool synth_ascii_to_key(char c, uint8_t *key, uint8_t *modifiers);
+
+/* Write the device record and a boot-keyboard interface record (itf_id,
+ * instance 0) */
+bool synth_write_keyboard(hid_trace_writer_t *w, const synth_device_t *dev, uint8_t itf_id);
+
+/* Start emitting reports on itf_id. poll_interval_us 0 means
+ * SYNTH_DEFAULT_POLL_US. */
+void synth_keyboard_init(synth_keyboard_t *kbd, hid_trace_writer_t *w, uint8_t itf_id,
+                         uint32_t poll_interval_us);
+
+/* Write one report (held keys included) at time_us or the next free poll
+ * after it. Returns the time it was written at. */
+uint64_t synth_keyboard_report(synth_keyboard_t *kbd, uint64_t time_us,
+                               uint8_t modifiers, const uint8_t *keys, uint8_t key_count);
+
+/* Press modifiers + keys (none for a modifier-only chord) at time_us and
+ * let go of them hold_us later. Returns the release time. */
+uint64_t synth_keyboard_tap(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                            const uint8_t *keys, uint8_t key_count, uint64_t hold_us);
+
+/* Press modifiers + key (0 = none) and keep them down until released.
+ * False when 6 keys are already held. */
+bool synth_keyboard_hold(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                         uint8_t key);
+
+/* Let go of held modifiers + key (0 = none) */
+void synth_keyboard_release(synth_keyboard_t *kbd, uint64_t time_us, uint8_t modifiers,
+                            uint8_t key);
+
+#endif /* SYNTH_H */
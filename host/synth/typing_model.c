@@ -0,0 +1,167 @@
+/*
+ * PlugSafe Human Typing Model Implementation
+ * Statistical keystroke timing for benign keyboard traces
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "typing_model.h"
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    const typing_options_t *opt;
+    synth_keyboard_t *kbd;
+    synth_rng_t rng;
+    uint64_t now_us;                  /* Earliest time of the next press */
+    double median_interval_us;        /* Log-normal median for the wpm mean */
+} typist_t;
+
+/* Words for generated prose */
+static const char *const g_words[] = {
+    "the", "of", "and", "to", "in", "is", "you", "that", "it", "he", "was", "for",
+    "on", "are", "as", "with", "his", "they", "at", "be", "this", "have", "from",
+    "or", "one", "had", "by", "word", "but", "not", "what", "all", "were", "we",
+    "when", "your", "can", "said", "there", "use", "each", "which", "she", "do",
+    "how", "their", "if", "will", "up", "other", "about", "out", "many", "then",
+    "them", "these", "so", "some", "her", "would", "make", "like", "him", "into",
+    "time", "has", "look", "two", "more", "write", "go", "see", "number", "no",
+    "way", "could", "people", "my", "than", "first", "water", "been", "call",
+    "who", "oil", "its", "now", "find", "long", "down", "day", "did", "get",
+    "come", "made", "may", "part", "report", "meeting", "project", "update"
+};
+
+#define WORD_COUNT                    (sizeof(g_words) / sizeof(g_words[0]))
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static void _typist_init(typist_t *t, const typing_options_t *opt, synth_keyboard_t *kbd) {
+    t->opt = opt;
+    t->kbd = kbd;
+    synth_rng_seed(&t->rng, opt->seed);
+    t->now_us = opt->start_us;
+
+    /* mean = median * exp(sigma^2 / 2) */
+    double mean_us = 60e6 / ((opt->wpm ? opt->wpm : 1) * 5.0);
+    t->median_interval_us = mean_us / exp(opt->interval_sigma * opt->interval_sigma / 2.0);
+}
+
+/**
+ * @brief Press and release one key; the next press follows one interval
+ * after this one, but never before this release
+ */
+static void _tap(typist_t *t, uint8_t modifiers, uint8_t key) {
+    const typing_options_t *opt = t->opt;
+    double hold_ms = opt->hold_mean_ms + synth_rng_normal(&t->rng) * opt->hold_sd_ms;
+    if (hold_ms < TYPING_MIN_HOLD_MS) {
+        hold_ms = TYPING_MIN_HOLD_MS;
+    }
+    uint64_t pressed_us = t->now_us;
+    uint64_t released_us = synth_keyboard_tap(t->kbd, pressed_us, modifiers, &key, 1,
+                                              (uint64_t)(hold_ms * 1000.0));
+
+    double interval_us = t->median_interval_us *
+                         exp(opt->interval_sigma * synth_rng_normal(&t->rng));
+    t->now_us = pressed_us + (uint64_t)interval_us;
+    if (t->now_us <= released_us) {
+        t->now_us = released_us + 1;
+    }
+}
+
+/**
+ * @brief Type one character, possibly hitting a wrong letter first
+ */
+static bool _type_char(typist_t *t, char c) {
+    uint8_t key;
+    uint8_t modifiers;
+    if (!synth_ascii_to_key(c, &key, &modifiers)) {
+        return false;
+    }
+
+    bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    if (letter && synth_rng_uniform(&t->rng) < t->opt->typo_rate) {
+        uint8_t wrong = (uint8_t)(0x04 + synth_rng_next(&t->rng) % 26);
+        if (wrong == key) {
+            wrong = (uint8_t)(wrong == 0x1D ? 0x04 : wrong + 1);
+        }
+        _tap(t, modifiers, wrong);
+        t->now_us += (uint64_t)synth_rng_exp(&t->rng, TYPING_TYPO_REACTION_MS * 1000.0);
+        _tap(t, 0, SYNTH_KEY_BACKSPACE);
+    }
+    _tap(t, modifiers, key);
+
+    if (c == ' ') {
+        t->now_us += (uint64_t)synth_rng_exp(&t->rng, t->opt->word_pause_ms * 1000.0);
+    } else if (c == '.' || c == '!' || c == '?' || c == '\n') {
+        t->now_us += (uint64_t)synth_rng_exp(&t->rng, t->opt->sentence_pause_ms * 1000.0);
+    }
+    return true;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void typing_default_options(typing_options_t *opt) {
+    *opt = (typing_options_t){
+        .wpm = 45,
+        .interval_sigma = 0.35,
+        .hold_mean_ms = 95,
+        .hold_sd_ms = 25,
+        .word_pause_ms = 150,
+        .sentence_pause_ms = 1500,
+        .typo_rate = 0.02,
+        .seed = 1,
+        .start_us = 0
+    };
+}
+
+uint64_t typing_type_text(const char *text, const typing_options_t *opt, synth_keyboard_t *kbd,
+                          uint32_t *skipped) {
+    typist_t t;
+    _typist_init(&t, opt, kbd);
+    uint32_t not_typed = 0;
+    for (; *text; text++) {
+        if (*text == '\r') {
+            continue;
+        }
+        if (!_type_char(&t, *text)) {
+            not_typed++;
+        }
+    }
+    if (skipped) {
+        *skipped = not_typed;
+    }
+    return t.now_us;
+}
+
+uint64_t typing_generate(uint64_t duration_us, const typing_options_t *opt,
+                         synth_keyboard_t *kbd) {
+    typist_t t;
+    _typist_init(&t, opt, kbd);
+    uint64_t end_us = opt->start_us + duration_us;
+
+    while (t.now_us < end_us) {
+        uint32_t words = 5 + synth_rng_next(&t.rng) % 11;
+        for (uint32_t i = 0; i < words && t.now_us < end_us; i++) {
+            const char *word = g_words[synth_rng_next(&t.rng) % WORD_COUNT];
+            for (const char *c = word; *c && t.now_us < end_us; c++) {
+                char ch = (i == 0 && c == word) ? (char)(*c - 'a' + 'A') : *c;
+                _type_char(&t, ch);
+            }
+            if (t.now_us < end_us) {
+                _type_char(&t, i + 1 < words ? ' ' : '.');
+            }
+        }
+        if (t.now_us < end_us) {
+            _type_char(&t, ' ');
+        }
+    }
+    return t.now_us;
+}
@@ -0,0 +1,60 @@
+/*
+ * PlugSafe Human Typing Model
+ * Statistical keystroke timing for benign keyboard traces
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TYPING_MODEL_H
+#define TYPING_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/*
+ * The time from one key press to the next is log-normal around the mean
+ * that wpm implies (5 characters per word), the usual shape of measured
+ * inter-key intervals: mostly near the mean, with a long slow tail. On top
+ * of that come exponential pauses after words and sentences, normal key
+ * hold times, and occasional typos that are noticed, erased with BACKSPACE
+ * and retyped. Keys do not overlap (no rollover): the next press waits for
+ * the previous release.
+ */
+
+/* Configuration */
+#define TYPING_TYPO_REACTION_MS       250   /* Mean time to notice a typo (exponential) */
+#define TYPING_MIN_HOLD_MS            20
+
+typedef struct {
+    uint32_t wpm;                     /* Mean speed, words per minute */
+    double interval_sigma;            /* Log-normal shape of the press-to-press interval */
+    uint32_t hold_mean_ms;            /* Key hold time, normal */
+    uint32_t hold_sd_ms;
+    uint32_t word_pause_ms;           /* Mean extra pause after a space */
+    uint32_t sentence_pause_ms;       /* Mean extra pause after '.', '!', '?' or a newline */
+    double typo_rate;                 /* Chance per letter of a wrong key first */
+    uint32_t seed;
+    uint64_t start_us;                /* Trace time of the first key */
+} typing_options_t;
+
+/* Defaults: 45 wpm, sigma 0.35, 95 +/- 25 ms holds, 150 ms word pauses,
+ * 1.5 s sentence pauses, 2% typos */
+void typing_default_options(typing_options_t *opt);
+
+/* Type a NUL-terminated text. Characters a US keyboard cannot type are
+ * skipped and counted in *skipped (may be NULL). Returns the time after
+ * the last key. */
+uint64_t typing_type_text(const char *text, const typing_options_t *opt, synth_keyboard_t *kbd,
+                          uint32_t *skipped);
+
+/* Type generated prose (common English words in sentences) until
+ * duration_us after start_us. Returns the time after the last key. */
+uint64_t typing_generate(uint64_t duration_us, const typing_options_t *opt,
+                         synth_keyboard_t *kbd);
+
+#endif /* TYPING_MODEL_H */
@@ -0,0 +1,39 @@
+/*
+ * PlugSafe Host Simulator - Test Helpers
+ * Minimal checks shared by the simulator tests
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SIM_TEST_H
+#define SIM_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+static int g_test_failures = 0;
+
+/* Report a failed condition and carry on */
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_STR(a, b)               CHECK(strcmp((a), (b)) == 0)
+
+/* Run one test function and print its name */
+#define RUN_TEST(fn) do { \
+        int _before = g_test_failures; \
+        fn(); \
+        printf("%s %s\n", g_test_failures == _before ? "PASS" : "FAIL", #fn); \
+    } while (0)
+
+#define TEST_EXIT_CODE()              (g_test_failures ? 1 : 0)
+
+#endif /* SIM_TEST_H */
@@ -0,0 +1,166 @@
+/*
+ * PlugSafe Host Simulator - Virtual Clock Tests
+ * Long traces and scheduler runs in virtual time, faster than real time
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <time.h>
+#include "sim_test.h"
+#include "sim_clock.h"
+#include "sim_firmware.h"
+#include "sim_usb.h"
+#include "replay.h"
+#include "hid_trace.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+
+#define TRACE_DEV_ADDR                3
+#define HOUR_US                       (3600ull * 1000000ull)
+#define MAX_WALL_US                   1000000ull  /* Budget for replaying the hour */
+
+static uint8_t g_trace[1024 * 1024];
+static uint32_t g_rng;
+
+static uint32_t _rand_range(uint32_t lo, uint32_t hi) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return lo + (g_rng >> 8) % (hi - lo + 1);
+}
+
+static uint64_t _wall_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * @brief Record an hour of someone typing: 120-280 ms between keys, keys
+ * held 50-110 ms, and a 2-10 s pause after every sentence
+ */
+static size_t _make_hour_trace(uint32_t *reports) {
+    hid_trace_writer_t w;
+    hid_trace_writer_init(&w, g_trace, sizeof(g_trace), 0);
+
+    hid_trace_device_t dev = { .dev_addr = TRACE_DEV_ADDR };
+    sim_usb_device_t desc;
+    sim_usb_device_init(&desc, 0x046D, 0xC31C, "Logitech", "USB Keyboard", NULL);
+    memcpy(dev.desc_device, desc.desc_device, sizeof(dev.desc_device));
+    strcpy(dev.manufacturer, "Logitech");
+    strcpy(dev.product, "USB Keyboard");
+    hid_trace_write_device(&w, &dev);
+
+    hid_trace_interface_t itf = {
+        .itf_id = 0,
+        .dev_addr = TRACE_DEV_ADDR,
+        .instance = 0,
+        .protocol = HID_ITF_PROTOCOL_KEYBOARD
+    };
+    hid_trace_write_interface(&w, &itf);
+
+    g_rng = 12345;
+    *reports = 0;
+    uint8_t press[8] = { 0 };
+    const uint8_t release[8] = { 0 };
+    uint64_t t = 0;
+    uint32_t keys = 0;
+    while (t < HOUR_US) {
+        press[2] = (uint8_t)_rand_range(0x04, 0x1D);
+        hid_trace_write_report(&w, 0, t, press, sizeof(press));
+        hid_trace_write_report(&w, 0, t + _rand_range(50, 110) * 1000u, release, sizeof(release));
+        *reports += 2;
+        t += _rand_range(120, 280) * 1000u;
+        if (++keys % 60 == 0) {
+            t += _rand_range(2000, 10000) * 1000u;
+        }
+    }
+    return hid_trace_finish(&w);
+}
+
+/**
+ * @brief Replay the trace into a freshly booted firmware, device left mounted
+ */
+static bool _replay(size_t len, replay_stats_t *stats) {
+    sim_firmware_boot(false);
+    replay_target_t target;
+    sim_firmware_replay_target(&target);
+    replay_options_t opt;
+    replay_default_options(&opt);
+    opt.unmount_at_end = false;
+    return replay_run(g_trace, len, &target, &opt, stats);
+}
+
+static void test_hour_of_typing_replays_in_under_a_second(void) {
+    uint32_t reports;
+    size_t len = _make_hour_trace(&reports);
+    CHECK(len > 0);
+
+    replay_stats_t first, second;
+    uint64_t start_us = _wall_us();
+    CHECK(_replay(len, &first));
+    uint64_t wall_us = _wall_us() - start_us;
+    printf("  %lu reports, %.1f s virtual in %.3f s wall\n", (unsigned long)reports,
+           sim_clock_now_us() / 1e6, wall_us / 1e6);
+
+    CHECK(first.reports == reports);
+    CHECK(sim_usb_get_stats()->reports_delivered == reports);
+    CHECK(timebase_now_us() >= HOUR_US);
+    CHECK(wall_us < MAX_WALL_US);
+    CHECK(threat_get_current_level(TRACE_DEV_ADDR) == THREAT_POTENTIALLY_UNSAFE);
+
+    /* Same trace, same clock, same result */
+    hid_monitor_t mon_first = *hid_get_monitor_stats(TRACE_DEV_ADDR);
+    uint64_t end_first_us = sim_clock_now_us();
+    CHECK(_replay(len, &second));
+    hid_monitor_t *mon_second = hid_get_monitor_stats(TRACE_DEV_ADDR);
+    CHECK(memcmp(&first, &second, sizeof(first)) == 0);
+    CHECK(mon_second && memcmp(&mon_first, mon_second, sizeof(mon_first)) == 0);
+    CHECK(sim_clock_now_us() == end_first_us);
+}
+
+static uint32_t g_ticks;
+
+static void _tick_task(void *ctx, uint64_t now_us) {
+    (void)ctx;
+    (void)now_us;
+    g_ticks++;
+}
+
+static void test_scheduler_sleeps_in_virtual_time(void) {
+    sim_clock_reset();
+    scheduler_t sched;
+    scheduler_init(&sched);
+    int id = scheduler_add_task(&sched, &(scheduler_task_config_t){
+        .name = "tick", .fn = _tick_task, .period_ms = 20, .priority = 0
+    });
+    CHECK(id == 0);
+
+    /* scheduler_run() with an exit: its idle wait is what moves the clock */
+    g_ticks = 0;
+    uint64_t start_us = _wall_us();
+    while (timebase_now_us() <= HOUR_US) {
+        if (!scheduler_run_once(&sched)) {
+            timebase_wait_until_us(scheduler_next_deadline_us(&sched));
+        }
+    }
+    uint64_t wall_us = _wall_us() - start_us;
+
+    const scheduler_task_stats_t *stats = scheduler_get_task_stats(&sched, id);
+    CHECK(g_ticks == HOUR_US / 20000);
+    CHECK(stats->runs == g_ticks);
+    CHECK(stats->max_lateness_us == 0 && stats->deadline_misses == 0);
+    CHECK(timebase_now_us() == HOUR_US + 20000);
+    CHECK(wall_us < MAX_WALL_US);
+}
+
+int main(void) {
+    RUN_TEST(test_hour_of_typing_replays_in_under_a_second);
+    RUN_TEST(test_scheduler_sleeps_in_virtual_time);
+    return TEST_EXIT_CODE();
+}
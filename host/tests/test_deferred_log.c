@@ -0,0 +1,142 @@
+/*
+ * PlugSafe Host Simulator - Deferred Log Tests
+ * Records queued on core 1 and printed on core 0 come out exactly as
+ * printf() would print them, with integer and string arguments mixed
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_platform.h"
+#include "deferred_log.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#define CAPTURE_MAX                   2048
+
+static char g_captured[CAPTURE_MAX];
+static FILE *g_capture_file;
+static int g_saved_stdout = -1;
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Send stdout to a temporary file until _capture_end()
+ */
+static void _capture_begin(void) {
+    fflush(stdout);
+    g_capture_file = tmpfile();
+    g_saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(g_capture_file), STDOUT_FILENO);
+}
+
+/**
+ * @brief Restore stdout and return what was printed meanwhile
+ */
+static const char *_capture_end(void) {
+    fflush(stdout);
+    dup2(g_saved_stdout, STDOUT_FILENO);
+    close(g_saved_stdout);
+
+    rewind(g_capture_file);
+    size_t len = fread(g_captured, 1, CAPTURE_MAX - 1, g_capture_file);
+    g_captured[len] = '\0';
+    fclose(g_capture_file);
+    return g_captured;
+}
+
+/**
+ * @brief Print everything queued, as the log task on core 0 does
+ */
+static const char *_drain(void) {
+    sim_set_core_num(0);
+    _capture_begin();
+    while (dlog_drain(DLOG_DRAIN_BATCH)) {
+    }
+    const char *out = _capture_end();
+    sim_set_core_num(1);
+    return out;
+}
+
+static void _reset(void) {
+    sim_platform_reset();
+    dlog_init();
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_integers_and_strings_mixed(void) {
+    _reset();
+    const char *kind = "Keyboard";
+
+    DLOG("[HID] Interface Protocol = %s\n", kind);
+    DLOG("[USB] VID: 0x%04X  PID: 0x%04X  Class: 0x%02X\n", 0x046D, 0xC31C, 0);
+    DLOG("[T] %d %s %u %c\n", -42, "str", 4000000000u, 'x');
+    DLOG("[T] 100%% of %d, no arguments after\n", 7);
+    CHECK(dlog_get_high_water() == 4);
+
+    CHECK_STR(_drain(),
+              "[HID] Interface Protocol = Keyboard\n"
+              "[USB] VID: 0x046D  PID: 0xC31C  Class: 0x00\n"
+              "[T] -42 str 4000000000 x\n"
+              "[T] 100% of 7, no arguments after\n");
+}
+
+static void test_copied_string_comes_first(void) {
+    _reset();
+    char name[DLOG_STR_LEN];
+
+    strcpy(name, "Evil Keyboard");
+    DLOG_S("[USB] Product: %s (device %d, %lu ms)\n", name, 3, 1500ul);
+    strcpy(name, "overwritten");
+
+    CHECK_STR(_drain(), "[USB] Product: Evil Keyboard (device 3, 1500 ms)\n");
+}
+
+static void test_core0_prints_immediately(void) {
+    _reset();
+    sim_set_core_num(0);
+
+    _capture_begin();
+    DLOG("[UI] %s at %d\n", "now", 5);
+    CHECK_STR(_capture_end(), "[UI] now at 5\n");
+
+    sim_set_core_num(1);
+    CHECK(dlog_get_high_water() == 0);
+}
+
+static void test_missing_arguments_print_literally(void) {
+    _reset();
+
+    dlog_write("a=%d b=%5u\n", NULL, 1, (const dlog_arg_t[]){ { .u = 9 } });
+    CHECK_STR(_drain(), "a=9 b=%5u\n");
+}
+
+static void test_full_ring_counts_drops(void) {
+    _reset();
+
+    for (int i = 0; i < DLOG_RING_SIZE + 3; i++) {
+        DLOG("%d\n", i);
+    }
+    CHECK(dlog_get_dropped() == 3);
+
+    const char *out = _drain();
+    CHECK(strncmp(out, "[LOG] 3 log records dropped (ring full)\n0\n1\n", 44) == 0);
+}
+
+int main(void) {
+    RUN_TEST(test_integers_and_strings_mixed);
+    RUN_TEST(test_copied_string_comes_first);
+    RUN_TEST(test_core0_prints_immediately);
+    RUN_TEST(test_missing_arguments_print_literally);
+    RUN_TEST(test_full_ring_counts_drops);
+    return TEST_EXIT_CODE();
+}
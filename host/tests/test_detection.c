@@ -0,0 +1,320 @@
+/*
+ * PlugSafe Host Simulator - Detection Tests
+ * Keystroke-rate verdicts and report budgeting on virtual devices
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_clock.h"
+#include "sim_firmware.h"
+#include "sim_usb.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+#include "event_queue.h"
+#include "flight_recorder.h"
+#include "flash_store.h"
+#include "hid_trace.h"
+#include "sim_platform.h"
+
+#define KBD_ADDR                      1
+
+/* Mouse flood: all CFG_TUH_HID interfaces reporting every millisecond */
+#define FLOOD_DEVICES                 CFG_TUH_DEVICE_MAX
+#define FLOOD_DEVICE_ITFS             (CFG_TUH_HID / CFG_TUH_DEVICE_MAX)
+#define FLOOD_ITFS                    (FLOOD_DEVICES * FLOOD_DEVICE_ITFS)
+#define REPORT_COST_US                20    /* USB task time per delivered report */
+#define STORAGE_PERIOD_MS             50    /* storage task period on core 0 */
+
+/* One USB task pass delivers at most two reports per interface: the one
+ * that completed, and the one the device held until the callback re-armed */
+#define FLOOD_TASK_BOUND_US           (2 * FLOOD_ITFS * REPORT_COST_US)
+
+/* The budget lets each interface through HID_BUDGET_MAX_REPORTS reports a
+ * window: half the flood's 1 kHz, so half its USB task time */
+#define FLOOD_WINDOW_BOUND_US         (FLOOD_ITFS * HID_BUDGET_MAX_REPORTS * REPORT_COST_US)
+
+static const uint8_t KEY_A[8] = { 0, 0, 0x04, 0, 0, 0, 0, 0 };
+static const uint8_t KEY_UP[8] = { 0 };
+
+/**
+ * @brief Boot and enumerate one device with a single HID interface
+ */
+static void _boot_with(uint8_t protocol) {
+    sim_firmware_boot(false);
+    sim_clock_set_us(1000000);
+    sim_usb_device_t dev;
+    sim_usb_device_init(&dev, 0x16C0, 0x27DB, "Test", "Test HID", NULL);
+    sim_usb_device_add_interface(&dev, protocol, NULL, 0);
+    sim_usb_attach(KBD_ADDR, &dev);
+    sim_firmware_run();
+}
+
+/**
+ * @brief Type n keys (press + release) with the given period, starting now
+ */
+static void _type_keys(uint32_t n, uint32_t period_us) {
+    for (uint32_t i = 0; i < n; i++) {
+        sim_clock_advance_us(period_us / 2);
+        sim_usb_send_report(KBD_ADDR, 0, KEY_A, sizeof(KEY_A));
+        sim_firmware_run();
+        sim_clock_advance_us(period_us - period_us / 2);
+        sim_usb_send_report(KBD_ADDR, 0, KEY_UP, sizeof(KEY_UP));
+        sim_firmware_run();
+    }
+}
+
+/**
+ * @brief One run of the storage task's forensic step on core 0
+ */
+static void _storage_step(void) {
+    sim_set_core_num(0);
+    flight_recorder_persist_step((uint32_t)(sim_clock_now_us() / 1000));
+    sim_set_core_num(1);
+}
+
+/**
+ * @brief Let ms pass with no reports, the storage task running as usual
+ */
+static void _idle_ms(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += STORAGE_PERIOD_MS) {
+        sim_clock_advance_us(STORAGE_PERIOD_MS * 1000);
+        _storage_step();
+    }
+}
+
+/**
+ * @brief Plug the keyboard in and inject keys until it is flagged, the
+ * storage task running between keys as it does on core 0, then unplug it
+ */
+static void _attack_and_unplug(void) {
+    sim_usb_device_t dev;
+    sim_usb_device_init(&dev, 0x16C0, 0x27DB, "Test", "Test HID", NULL);
+    sim_usb_device_add_interface(&dev, HID_ITF_PROTOCOL_KEYBOARD, NULL, 0);
+    sim_usb_attach(KBD_ADDR, &dev);
+    sim_firmware_run();
+    for (int i = 0; i < 100; i++) {
+        _type_keys(6, 8000);          /* 125 keys/s */
+        _storage_step();
+    }
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_MALICIOUS);
+    sim_usb_detach(KBD_ADDR);
+    sim_firmware_run();
+}
+
+/**
+ * @brief Reports in a saved capture, checking the device record on the way
+ */
+static uint32_t _count_reports(const uint8_t *capture, size_t len) {
+    hid_trace_reader_t r;
+    hid_trace_record_t rec;
+    uint32_t reports = 0;
+    CHECK(hid_trace_reader_init(&r, capture, len));
+    while (hid_trace_next(&r, &rec) && rec.type != HT_REC_END) {
+        if (rec.type == HT_REC_DEVICE) {
+            CHECK_STR(rec.device.product, "Test HID");
+        } else if (rec.type == HT_REC_REPORT) {
+            reports++;
+        }
+    }
+    return reports;
+}
+
+/**
+ * @brief True if a THREAT_CHANGED event to level was queued
+ */
+static bool _saw_threat_event(threat_level_e level) {
+    core_event_t event;
+    while (event_queue_pop(&event)) {
+        if (event.type == CORE_EVENT_THREAT_CHANGED && event.arg == level) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_human_typing_is_not_flagged(void) {
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    _type_keys(60, 125000);           /* 8 keys/s for 7.5 s: 16 reports/s */
+
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_POTENTIALLY_UNSAFE);
+    CHECK(!_saw_threat_event(THREAT_MALICIOUS));
+    hid_monitor_t *mon = hid_get_monitor_stats(KBD_ADDR);
+    CHECK(mon && mon->peak_rate_hz >= 14 && mon->peak_rate_hz <= 18);
+    CHECK(mon && mon->total_reports == 120);
+    CHECK(flight_recorder_get_stats()->captures == 0);
+}
+
+static void test_injection_is_flagged(void) {
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    _type_keys(300, 8000);            /* 125 keys/s: 250 reports/s */
+
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_MALICIOUS);
+    CHECK(_saw_threat_event(THREAT_MALICIOUS));
+    CHECK(flight_recorder_get_stats()->captures == 1);
+
+    /* Arrival times came from the simulated USB IRQ, not the fallback */
+    usb_stamp_stats_t *stamps = usb_host_get_stamp_stats();
+    CHECK(stamps->irq_stamped == 600 && stamps->fallback_stamped == 0);
+}
+
+static void test_trigger_only_freezes_the_rings(void) {
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    _type_keys(300, 8000);
+    CHECK(flight_recorder_get_stats()->captures == 1);
+
+    /* Core 1 froze the device's history and went on; the rings stay
+     * frozen, and nothing is recorded into them, until core 0 has built
+     * the capture */
+    uint32_t recorded = flight_recorder_get_stats()->reports_recorded;
+    _type_keys(5, 8000);
+    CHECK(flight_recorder_get_stats()->reports_recorded == recorded);
+
+    _storage_step();
+    _type_keys(5, 8000);
+    CHECK(flight_recorder_get_stats()->reports_recorded == recorded + 10);
+}
+
+static void test_capture_is_saved_without_erasing(void) {
+    sim_firmware_boot(false);
+    sim_clock_set_us(1000000);
+    sim_set_core_num(0);
+    CHECK(flash_store_init());
+    sim_set_core_num(1);
+
+    /* Both slots start blank: nothing to erase */
+    _attack_and_unplug();
+    _idle_ms(2000);
+    _attack_and_unplug();
+    CHECK(flight_recorder_get_stats()->captures_saved == 2);
+    CHECK(sim_flash_get_stats()->erases == 0);
+
+    /* Slot 0 holds the oldest capture: it is erased once USB is quiet,
+     * before the next verdict needs it */
+    _idle_ms(2000);
+    CHECK(sim_flash_get_stats()->erases == FR_SLOT_SECTORS);
+
+    /* So the next capture is saved with page programs only, while the
+     * device is still typing */
+    _attack_and_unplug();
+    CHECK(flight_recorder_get_stats()->captures_saved == 3);
+    CHECK(sim_flash_get_stats()->erases == FR_SLOT_SECTORS);
+
+    const fr_slot_header_t *hdr =
+        (const fr_slot_header_t *)flash_store_read_ptr(FLASH_STORE_FORENSIC_OFFSET);
+    const uint8_t *capture =
+        flash_store_read_ptr(FLASH_STORE_FORENSIC_OFFSET + FR_SLOT_DATA_OFFSET);
+    CHECK(hdr->magic == FR_SLOT_MAGIC && hdr->seq == 3 && hdr->dev_addr == KBD_ADDR);
+    CHECK(hdr->capture_len <= FR_CAPTURE_MAX &&
+          hid_trace_crc32(capture, hdr->capture_len) == hdr->capture_crc);
+    CHECK(_count_reports(capture, hdr->capture_len) == FR_REPORTS_PER_ITF);
+
+    /* Flagged again with no quiet spell in between: slot 1 is not erased
+     * yet, and the capture waits in RAM until USB goes quiet */
+    _attack_and_unplug();
+    CHECK(flight_recorder_get_stats()->captures == 4);
+    CHECK(flight_recorder_get_stats()->captures_saved == 3);
+    CHECK(sim_flash_get_stats()->erases == FR_SLOT_SECTORS);
+    _idle_ms(2000);
+    CHECK(flight_recorder_get_stats()->captures_saved == 4);
+
+    /* Slot 1 erased for it, then slot 0 ahead of the next one */
+    CHECK(sim_flash_get_stats()->erases == 3 * FR_SLOT_SECTORS);
+    CHECK(flight_recorder_get_stats()->flash_errors == 0);
+}
+
+static void test_tuning_changes_the_verdict(void) {
+    /* A 0.6 s burst ends before the 1 s window that opened at mount closes */
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    _type_keys(30, 20000);            /* 50 keys/s: 100 reports/s */
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_POTENTIALLY_UNSAFE);
+
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    const hid_monitor_tuning_t short_window = { .threshold_hz = 50, .window_ms = 250 };
+    hid_monitor_set_tuning(&short_window);
+    _type_keys(30, 20000);
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_MALICIOUS);
+
+    /* A lower threshold catches the 16 reports/s typist */
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    const hid_monitor_tuning_t low = { .threshold_hz = 10, .window_ms = 1000 };
+    hid_monitor_set_tuning(&low);
+    _type_keys(20, 125000);
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_MALICIOUS);
+
+    /* Booting restores the defaults */
+    _boot_with(HID_ITF_PROTOCOL_KEYBOARD);
+    CHECK(hid_monitor_get_tuning()->threshold_hz == HID_KEYSTROKE_THRESHOLD_HZ);
+    CHECK(hid_monitor_get_tuning()->window_ms == KEYSTROKE_RATE_WINDOW_MS);
+}
+
+static void test_mouse_flood_is_budgeted(void) {
+    /* Every HID interface the host supports flooding at 1 kHz, each report
+     * costing REPORT_COST_US of USB task time */
+    sim_firmware_boot(false);
+    sim_clock_set_us(1000000);
+    sim_usb_set_report_cost_us(REPORT_COST_US);
+    for (uint8_t addr = 1; addr <= FLOOD_DEVICES; addr++) {
+        sim_usb_device_t dev;
+        sim_usb_device_init(&dev, 0x16C0, 0x27DB, "Test", "Test Mouse", NULL);
+        for (int i = 0; i < FLOOD_DEVICE_ITFS; i++) {
+            sim_usb_device_add_interface(&dev, HID_ITF_PROTOCOL_MOUSE, NULL, 0);
+        }
+        sim_usb_attach(addr, &dev);
+    }
+    sim_firmware_run();
+
+    const uint8_t move[4] = { 0, 1, 1, 0 };
+    uint32_t window_us = 0;
+    uint32_t max_window_us = 0;
+    uint64_t window = sim_clock_now_us() / (HID_BUDGET_WINDOW_MS * 1000);
+    for (int i = 0; i < 1000; i++) {  /* 1 kHz for one second */
+        sim_clock_advance_us(1000);
+        for (uint8_t addr = 1; addr <= FLOOD_DEVICES; addr++) {
+            for (uint8_t itf = 0; itf < FLOOD_DEVICE_ITFS; itf++) {
+                sim_usb_send_report(addr, itf, move, sizeof(move));
+            }
+        }
+
+        /* USB task time spent in each budget window */
+        uint64_t start_us = sim_clock_now_us();
+        if (start_us / (HID_BUDGET_WINDOW_MS * 1000) != window) {
+            window = start_us / (HID_BUDGET_WINDOW_MS * 1000);
+            window_us = 0;
+        }
+        sim_firmware_run();
+        window_us += (uint32_t)(sim_clock_now_us() - start_us);
+        if (window_us > max_window_us) {
+            max_window_us = window_us;
+        }
+    }
+
+    /* A pass never drains a backlog, so other core 1 work waits at most
+     * FLOOD_TASK_BOUND_US, and the budget caps the flood's share of a window */
+    CHECK(usb_host_get_max_task_us() > 0);
+    CHECK(usb_host_get_max_task_us() <= FLOOD_TASK_BOUND_US);
+    CHECK(max_window_us <= FLOOD_WINDOW_BOUND_US);
+
+    hid_itf_budget_t *budget = usb_get_hid_budget(KBD_ADDR, 0);
+    CHECK(budget && budget->flood_suspect && budget->deferred_count > 0);
+    CHECK(budget && budget->total_reports < 1000);
+    CHECK(sim_usb_get_stats()->reports_replaced > 0);
+    CHECK(threat_get_current_level(KBD_ADDR) == THREAT_SAFE);
+    device_threat_t *threat = threat_get_device_status(KBD_ADDR);
+    CHECK(threat && threat->flood_suspect);
+}
+
+int main(void) {
+    RUN_TEST(test_human_typing_is_not_flagged);
+    RUN_TEST(test_injection_is_flagged);
+    RUN_TEST(test_trigger_only_freezes_the_rings);
+    RUN_TEST(test_capture_is_saved_without_erasing);
+    RUN_TEST(test_tuning_changes_the_verdict);
+    RUN_TEST(test_mouse_flood_is_budgeted);
+    return TEST_EXIT_CODE();
+}
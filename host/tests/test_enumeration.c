@@ -0,0 +1,172 @@
+/*
+ * PlugSafe Host Simulator - Enumeration Tests
+ * Device and HID mounting through the unmodified usb_host module
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_firmware.h"
+#include "sim_usb.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "event_queue.h"
+#include "state_snapshot.h"
+
+/**
+ * @brief Pop core events until one of the given type; false if none
+ */
+static bool _pop_event(core_event_type_e type, core_event_t *out) {
+    core_event_t event;
+    while (event_queue_pop(&event)) {
+        if (event.type == type) {
+            *out = event;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_keyboard_mount(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t kbd;
+    sim_usb_device_init(&kbd, 0x046D, 0xC31C, "Logitech", "USB Keyboard", "SN-0042");
+    sim_usb_device_add_interface(&kbd, HID_ITF_PROTOCOL_KEYBOARD, NULL, 0);
+    CHECK(sim_usb_attach(1, &kbd));
+    CHECK(usb_host_event_pending());
+    sim_firmware_run();
+
+    CHECK(usb_get_device_count() == 1);
+    usb_device_info_t *dev = usb_get_device_info(1);
+    CHECK(dev != NULL);
+    if (!dev) {
+        return;
+    }
+    CHECK(dev->vid == 0x046D && dev->pid == 0xC31C);
+    CHECK(dev->descriptor_ready && dev->strings_ready);
+    CHECK_STR(dev->manufacturer, "Logitech");
+    CHECK_STR(dev->product, "USB Keyboard");
+    CHECK_STR(dev->serial, "SN-0042");
+    CHECK(dev->is_hid && dev->hid_protocol == HID_ITF_PROTOCOL_KEYBOARD);
+    CHECK(dev->usb_class == 0x03);
+    CHECK(threat_get_current_level(1) == THREAT_POTENTIALLY_UNSAFE);
+    CHECK(usb_get_hid_budget(1, 0) != NULL);
+    CHECK(sim_usb_report_armed(1, 0));
+
+    core_event_t event;
+    CHECK(_pop_event(CORE_EVENT_DEVICE_MOUNTED, &event) && event.dev_addr == 1);
+    CHECK(_pop_event(CORE_EVENT_HID_MOUNTED, &event) &&
+          event.arg == HID_ITF_PROTOCOL_KEYBOARD);
+}
+
+static void test_missing_strings(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t dev;
+    sim_usb_device_init(&dev, 0x1234, 0x5678, NULL, "Caf\xc3\xa9 Pad", NULL);
+    CHECK(sim_usb_attach(2, &dev));
+    sim_firmware_run();
+
+    usb_device_info_t *info = usb_get_device_info(2);
+    CHECK(info != NULL);
+    if (info) {
+        CHECK_STR(info->manufacturer, "Unknown");
+        CHECK_STR(info->product, "Caf\xc3\xa9 Pad");
+        CHECK_STR(info->serial, "N/A");
+        CHECK(!info->is_hid);
+    }
+    CHECK(threat_get_current_level(2) == THREAT_SAFE);
+}
+
+static void test_descriptor_stall(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t dev;
+    sim_usb_device_init(&dev, 0x1234, 0x5678, "Vendor", "Product", "1");
+    dev.stall_descriptors = true;
+    CHECK(sim_usb_attach(3, &dev));
+    sim_firmware_run();
+
+    usb_device_info_t *info = usb_get_device_info(3);
+    CHECK(info != NULL);
+    if (info) {
+        CHECK(!info->descriptor_ready && !info->strings_ready);
+        CHECK(info->vid == 0);
+        CHECK_STR(info->product, "USB Device");
+    }
+}
+
+static void test_hub_and_unmount(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t hub;
+    sim_usb_device_init(&hub, 0x05E3, 0x0608, NULL, "USB2.0 Hub", NULL);
+    hub.desc_device[4] = 0x09;        /* bDeviceClass: hub */
+    CHECK(sim_usb_attach(1, &hub));
+    sim_firmware_run();
+    CHECK(usb_is_hub_connected());
+
+    CHECK(sim_usb_detach(1));
+    sim_firmware_run();
+    CHECK(!usb_is_hub_connected());
+    CHECK(usb_get_device_count() == 0);
+    CHECK(threat_get_device_status(1) == NULL);
+
+    core_event_t event;
+    CHECK(_pop_event(CORE_EVENT_DEVICE_UNMOUNTED, &event) && event.dev_addr == 1);
+
+    /* The address can be reused once the unmount has been dispatched */
+    CHECK(sim_usb_attach(1, &hub));
+    sim_firmware_run();
+    CHECK(usb_get_device_count() == 1);
+}
+
+static void test_mouse_is_safe(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t combo;
+    sim_usb_device_init(&combo, 0x1A2C, 0x0E24, "Generic", "Wireless Receiver", NULL);
+    sim_usb_device_add_interface(&combo, HID_ITF_PROTOCOL_MOUSE, NULL, 0);
+    CHECK(sim_usb_attach(4, &combo));
+    sim_firmware_run();
+
+    usb_device_info_t *info = usb_get_device_info(4);
+    CHECK(info && info->is_hid && info->hid_protocol == HID_ITF_PROTOCOL_MOUSE);
+    CHECK(threat_get_current_level(4) == THREAT_SAFE);
+    CHECK(sim_usb_report_armed(4, 0));
+}
+
+static void test_events_follow_snapshot(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t kbd;
+    sim_usb_device_init(&kbd, 0x046D, 0xC31C, "Logitech", "USB Keyboard", NULL);
+    sim_usb_device_add_interface(&kbd, HID_ITF_PROTOCOL_KEYBOARD, NULL, 0);
+    CHECK(sim_usb_attach(1, &kbd));
+
+    /* The callbacks have run, but the snapshot is not published yet: core 0
+     * must not see the events */
+    uint32_t version = state_snapshot_get_version();
+    usb_host_task();
+    CHECK(usb_get_device_count() == 1);
+    CHECK(state_snapshot_get_version() == version);
+    core_event_t event;
+    CHECK(!event_queue_pop(&event));
+
+    /* After the analysis task they arrive with the snapshot showing them */
+    usb_host_analysis_task();
+    CHECK(event_queue_pop(&event) && event.type == CORE_EVENT_DEVICE_MOUNTED);
+    system_snapshot_t snap;
+    CHECK(state_snapshot_read(&snap));
+    CHECK(snap.version != version && snap.device_count == 1);
+    CHECK(snap.devices[0].device.vid == 0x046D);
+}
+
+int main(void) {
+    RUN_TEST(test_keyboard_mount);
+    RUN_TEST(test_missing_strings);
+    RUN_TEST(test_descriptor_stall);
+    RUN_TEST(test_hub_and_unmount);
+    RUN_TEST(test_mouse_is_safe);
+    RUN_TEST(test_events_follow_snapshot);
+    return TEST_EXIT_CODE();
+}
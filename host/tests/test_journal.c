@@ -0,0 +1,335 @@
+/*
+ * PlugSafe Host Simulator - Journal Tests
+ * The flash event journal across reboots: tail-scan recovery, torn records,
+ * sector rotation and erases held off while USB is busy
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_clock.h"
+#include "sim_firmware.h"
+#include "sim_platform.h"
+#include "sim_usb.h"
+#include "flash_store.h"
+#include "journal.h"
+
+#define JOURNAL_SECTORS               (FLASH_STORE_JOURNAL_SIZE / JOURNAL_SECTOR_SIZE)
+#define MAX_RECOVERED                 4096
+#define STEP_MS                       10
+
+static const uint8_t KEY_A[8] = { 0, 0, 0x04, 0, 0, 0, 0, 0 };
+
+/* What a read of the whole journal found, oldest first */
+typedef struct {
+    uint32_t count;
+    uint32_t torn;
+    uint32_t sectors;
+    uint8_t type[MAX_RECOVERED];
+    uint32_t value[MAX_RECOVERED];    /* Record number, or boot number for BOOT */
+} recovered_t;
+
+static recovered_t g_found;
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Power up with erased flash: firmware boot, then the journal
+ */
+static void _boot_fresh(void) {
+    sim_firmware_boot(false);
+    sim_clock_set_us(1000000);
+    sim_set_core_num(0);
+    CHECK(flash_store_init());
+    journal_init();
+    sim_set_core_num(1);
+}
+
+/**
+ * @brief Power cycle: RAM is lost (including records not yet programmed),
+ * flash is kept and the journal recovers from it
+ */
+static void _reboot(void) {
+    sim_set_core_num(0);
+    journal_init();
+    sim_set_core_num(1);
+}
+
+/**
+ * @brief Queue record number n from core 1, the way usb_host.c does
+ */
+static void _append(uint32_t n) {
+    journal_fingerprint_t fp = { .dev_addr = 1, .strings_crc = n };
+    snprintf(fp.product, sizeof(fp.product), "record %lu", (unsigned long)n);
+    journal_append(JOURNAL_REC_FINGERPRINT, &fp, sizeof(fp));
+}
+
+/**
+ * @brief One storage task run on core 0, STEP_MS after the last
+ */
+static bool _step(void) {
+    sim_clock_advance_us(STEP_MS * 1000);
+    sim_set_core_num(0);
+    bool wrote = journal_step((uint32_t)(sim_clock_now_us() / 1000));
+    sim_set_core_num(1);
+    return wrote;
+}
+
+/**
+ * @brief Run the storage task until everything queued is programmed
+ */
+static void _flush(void) {
+    for (int i = 0; i < 2 * JOURNAL_FLUSH_INTERVAL_MS / STEP_MS; i++) {
+        _step();
+    }
+}
+
+/**
+ * @brief Read every valid sector in sequence order into g_found, as the
+ * dump extractor does
+ */
+static void _read_journal(void) {
+    memset(&g_found, 0, sizeof(g_found));
+    uint32_t last_seq = 0;
+
+    for (;;) {
+        /* Next sector by sequence number */
+        const uint8_t *next = NULL;
+        journal_sector_header_t next_hdr;
+        for (uint32_t s = 0; s < JOURNAL_SECTORS; s++) {
+            const uint8_t *sector = flash_store_read_ptr(FLASH_STORE_JOURNAL_OFFSET +
+                                                         s * JOURNAL_SECTOR_SIZE);
+            journal_sector_header_t hdr;
+            if (journal_sector_valid(sector, &hdr) && hdr.seq > last_seq &&
+                (!next || hdr.seq < next_hdr.seq)) {
+                next = sector;
+                next_hdr = hdr;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        last_seq = next_hdr.seq;
+        g_found.sectors++;
+
+        journal_reader_t r;
+        journal_record_t rec;
+        journal_reader_init(&r, next);
+        while (journal_reader_next(&r, &rec) && g_found.count < MAX_RECOVERED) {
+            uint32_t value = 0;
+            if (rec.type == JOURNAL_REC_BOOT) {
+                memcpy(&value, rec.payload, sizeof(value));
+            } else if (rec.type == JOURNAL_REC_FINGERPRINT) {
+                journal_fingerprint_t fp;
+                memcpy(&fp, rec.payload, sizeof(fp));
+                value = fp.strings_crc;
+            }
+            g_found.type[g_found.count] = rec.type;
+            g_found.value[g_found.count] = value;
+            g_found.count++;
+        }
+        g_found.torn += r.torn;
+    }
+}
+
+/**
+ * @brief Where the next record goes in the newest sector (offset in it)
+ */
+static uint32_t _append_position(void) {
+    const uint8_t *newest = NULL;
+    journal_sector_header_t newest_hdr;
+    for (uint32_t s = 0; s < JOURNAL_SECTORS; s++) {
+        const uint8_t *sector = flash_store_read_ptr(FLASH_STORE_JOURNAL_OFFSET +
+                                                     s * JOURNAL_SECTOR_SIZE);
+        journal_sector_header_t hdr;
+        if (journal_sector_valid(sector, &hdr) && (!newest || hdr.seq > newest_hdr.seq)) {
+            newest = sector;
+            newest_hdr = hdr;
+        }
+    }
+    if (!newest) {
+        return 0;
+    }
+
+    journal_reader_t r;
+    journal_record_t rec;
+    journal_reader_init(&r, newest);
+    while (journal_reader_next(&r, &rec)) {
+    }
+    return r.pos;
+}
+
+/**
+ * @brief Records numbered first..last follow each other in g_found from
+ * index at
+ */
+static bool _run_of_records(uint32_t at, uint32_t first, uint32_t last) {
+    for (uint32_t n = first; n <= last; n++, at++) {
+        if (at >= g_found.count || g_found.type[at] != JOURNAL_REC_FINGERPRINT ||
+            g_found.value[at] != n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static void test_records_survive_reboot(void) {
+    _boot_fresh();
+    for (uint32_t n = 1; n <= 20; n++) {
+        _append(n);
+        _step();
+    }
+    _flush();
+
+    /* Records still queued when power goes are lost, nothing else */
+    _append(21);
+    _reboot();
+    CHECK(journal_get_stats()->boot == 2);
+    CHECK(journal_get_stats()->torn == 0);
+    for (uint32_t n = 22; n <= 25; n++) {
+        _append(n);
+        _step();
+    }
+    _flush();
+
+    /* Boot 1, its records, then boot 2 appended after them */
+    _read_journal();
+    CHECK(g_found.torn == 0);
+    CHECK(g_found.count == 1 + 20 + 1 + 4);
+    CHECK(g_found.type[0] == JOURNAL_REC_BOOT && g_found.value[0] == 1);
+    CHECK(_run_of_records(1, 1, 20));
+    CHECK(g_found.type[21] == JOURNAL_REC_BOOT && g_found.value[21] == 2);
+    CHECK(_run_of_records(22, 22, 25));
+    CHECK(journal_get_stats()->dropped == 0);
+}
+
+static void test_torn_record_is_skipped(void) {
+    _boot_fresh();
+    for (uint32_t n = 1; n <= 3; n++) {
+        _append(n);
+    }
+    _flush();
+
+    /* Power fails 5 bytes into the next record's page program */
+    uint32_t pos = _append_position();
+    _append(4);
+    _append(5);
+    sim_flash_cut_next_program(pos % JOURNAL_PAGE_SIZE + 5);
+    _flush();
+
+    _reboot();
+    CHECK(journal_get_stats()->torn == 1);
+    CHECK(journal_get_stats()->boot == 2);
+
+    /* Appending resumes on the next erased page, not over the torn bytes */
+    _append(6);
+    _flush();
+    uint32_t after = _append_position();
+    CHECK(after > (pos & ~(JOURNAL_PAGE_SIZE - 1)) + JOURNAL_PAGE_SIZE);
+
+    _read_journal();
+    CHECK(g_found.torn == 1);
+    CHECK(g_found.count == 1 + 3 + 1 + 1);
+    CHECK(_run_of_records(1, 1, 3));
+    CHECK(g_found.type[4] == JOURNAL_REC_BOOT && g_found.value[4] == 2);
+    CHECK(_run_of_records(5, 6, 6));
+}
+
+static void test_sectors_rotate(void) {
+    _boot_fresh();
+
+    /* Several times round the ring, with USB quiet so erases may run */
+    uint32_t total = 0;
+    while (journal_get_stats()->sectors_erased < 2 * JOURNAL_SECTORS) {
+        _append(++total);
+        _step();
+        _step();
+    }
+    _flush();
+    CHECK(journal_get_stats()->dropped == 0);
+    CHECK(sim_flash_get_stats()->erases == journal_get_stats()->sectors_erased);
+
+    /* Reboot with records still queued */
+    _append(total + 1);
+    _append(total + 2);
+    _reboot();
+    CHECK(journal_get_stats()->torn == 0);
+    _append(total + 3);
+    _flush();
+
+    /* The oldest sectors were reused: what is left is an unbroken run of
+     * the newest records, then boot 2 */
+    _read_journal();
+    CHECK(g_found.torn == 0);
+    CHECK(g_found.sectors >= JOURNAL_SECTORS - 1);
+    CHECK(g_found.count > 3);
+    if (g_found.count > 3) {
+        uint32_t last = g_found.count - 1;
+        uint32_t first = g_found.value[0];
+        CHECK(g_found.type[last] == JOURNAL_REC_FINGERPRINT &&
+              g_found.value[last] == total + 3);
+        CHECK(g_found.type[last - 1] == JOURNAL_REC_BOOT && g_found.value[last - 1] == 2);
+        CHECK(first > 1);
+        CHECK(_run_of_records(0, first, total));
+        CHECK(last - 1 == total - first + 1);
+    }
+}
+
+static void test_busy_usb_holds_off_erases(void) {
+    _boot_fresh();
+    sim_usb_device_t kbd;
+    sim_usb_device_init(&kbd, 0x046D, 0xC31C, "Logitech", "USB Keyboard", NULL);
+    sim_usb_device_add_interface(&kbd, HID_ITF_PROTOCOL_KEYBOARD, NULL, 0);
+    sim_usb_attach(1, &kbd);
+    sim_firmware_run();
+
+    /* Fill every sector while USB is quiet: the next one needs an erase */
+    uint32_t n = 0;
+    while (journal_get_stats()->sectors_erased == 0) {
+        _append(++n);
+        _step();
+        _step();
+    }
+    uint32_t erases = sim_flash_get_stats()->erases;
+
+    /* Fill the current sector while typing: no erase, records dropped */
+    for (int i = 0; i < 20000 && journal_get_stats()->dropped == 0; i++) {
+        sim_usb_send_report(1, 0, (i & 1) ? KEY_A : (const uint8_t[8]){ 0 }, 8);
+        sim_firmware_run();
+        _append(++n);
+        _step();
+    }
+    CHECK(journal_get_stats()->dropped > 0);
+    CHECK(sim_flash_get_stats()->erases == erases);
+    for (int i = 0; i < 100; i++) {
+        sim_usb_send_report(1, 0, (i & 1) ? KEY_A : (const uint8_t[8]){ 0 }, 8);
+        sim_firmware_run();
+        _step();
+    }
+    CHECK(sim_flash_get_stats()->erases == erases);
+
+    /* Once USB has been quiet long enough the erase goes ahead and the
+     * records that waited in the ring are written */
+    uint32_t records = journal_get_stats()->records;
+    _flush();
+    CHECK(sim_flash_get_stats()->erases > erases);
+    CHECK(journal_get_stats()->records >= records + JOURNAL_RING_SIZE);
+}
+
+int main(void) {
+    RUN_TEST(test_records_survive_reboot);
+    RUN_TEST(test_torn_record_is_skipped);
+    RUN_TEST(test_sectors_rotate);
+    RUN_TEST(test_busy_usb_holds_off_erases);
+    return TEST_EXIT_CODE();
+}
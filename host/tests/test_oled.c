@@ -0,0 +1,599 @@
+/*
+ * PlugSafe Host Simulator - OLED Tests
+ * Framebuffer flushes through the driver to a virtual panel on the simulated I2C bus
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_clock.h"
+#include "sim_platform.h"
+#include "sim_i2c.h"
+#include "oled_display.h"
+#include "oled_graphics.h"
+#include "oled_text.h"
+#include "oled_font.h"
+#include "oled_widget.h"
+
+static oled_i2c_t g_i2c;
+static oled_driver_t g_driver;
+static oled_display_t g_display;
+
+/**
+ * @brief Bring up the OLED stack on a freshly attached panel, statistics
+ * cleared after init
+ */
+static void _boot(oled_display_type_e type) {
+    sim_platform_reset();
+    sim_clock_reset();
+    sim_i2c_reset();
+    sim_i2c_attach_panel(OLED_I2C_ADDRESS_DEFAULT, type);
+
+    g_i2c = (oled_i2c_t){
+        .i2c = i2c0,
+        .sda_pin = 4,
+        .scl_pin = 5,
+        .baudrate = OLED_I2C_BAUDRATE_DEFAULT,
+        .address = OLED_I2C_ADDRESS_DEFAULT
+    };
+    CHECK(oled_i2c_init(&g_i2c));
+    CHECK(oled_driver_init(&g_driver, type, &g_i2c));
+    CHECK(oled_display_init(&g_display, &g_driver));
+    CHECK(sim_i2c_panel_is_on());
+    sim_i2c_clear_stats();
+}
+
+/**
+ * @brief Something on every page, straddling page boundaries
+ */
+static void _draw_scene(void) {
+    oled_display_clear(&g_display);
+    oled_draw_rect(&g_display, 0, 0, OLED_WIDTH, OLED_HEIGHT, false, true);
+    oled_draw_rect(&g_display, 10, 5, 30, 20, true, true);
+    oled_draw_circle(&g_display, 90, 40, 15, false, true);
+    oled_draw_string(&g_display, 4, 50, "PLUGSAFE", oled_get_font_5x7(), true);
+}
+
+/**
+ * @brief Panel RAM shows the framebuffer, starting at column col0
+ */
+static bool _panel_matches(uint8_t col0) {
+    const uint8_t *ram = sim_i2c_panel_ram();
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        if (memcmp(ram + page * SIM_I2C_RAM_COLUMNS + col0,
+                   g_display.buffer + page * OLED_WIDTH, OLED_WIDTH) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief The flush before frames went out whole: page, column and data as
+ * separate transactions for each page
+ */
+static void _flush_per_page(void) {
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        oled_driver_set_page(&g_driver, page);
+        oled_driver_set_column(&g_driver, 0);
+        oled_i2c_write_data_in_place(&g_i2c, g_display.buffer + page * OLED_WIDTH,
+                                     OLED_WIDTH);
+    }
+}
+
+static void test_ssd1306_frame_is_one_transaction(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    _draw_scene();
+    CHECK(oled_display_flush(&g_display));
+
+    const sim_i2c_stats_t *s = sim_i2c_get_stats();
+    CHECK(s->transactions == 1 && s->nacks == 0);
+    CHECK(s->data_bytes == OLED_BUFFER_SIZE);
+    CHECK(s->command_bytes == 6);                       /* 21 0 127, 22 0 7 */
+    CHECK(s->bytes == 1 + 13 + OLED_BUFFER_SIZE);
+    CHECK(_panel_matches(0));
+
+    /* A second frame lands in the same place */
+    oled_draw_rect(&g_display, 60, 0, 20, 64, true, true);
+    CHECK(oled_display_flush(&g_display));
+    CHECK(_panel_matches(0));
+    oled_display_deinit(&g_display);
+}
+
+static void test_sh1106_frame_is_one_transaction_per_page(void) {
+    _boot(OLED_DISPLAY_SH1106);
+    _draw_scene();
+    CHECK(oled_display_flush(&g_display));
+
+    /* Page and column commands ride in front of each page's data */
+    const sim_i2c_stats_t *s = sim_i2c_get_stats();
+    CHECK(s->transactions == OLED_PAGES && s->nacks == 0);
+    CHECK(s->data_bytes == OLED_BUFFER_SIZE);
+    CHECK(_panel_matches(2));
+    oled_display_deinit(&g_display);
+}
+
+static void test_frame_beats_per_page_flush(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    _draw_scene();
+    _flush_per_page();
+    CHECK(_panel_matches(0));
+    sim_i2c_stats_t before = *sim_i2c_get_stats();
+    CHECK(before.transactions == 3 * OLED_PAGES);
+
+    sim_i2c_clear_stats();
+    uint64_t start_us = sim_clock_now_us();
+    CHECK(oled_display_flush(&g_display));
+    sim_i2c_stats_t after = *sim_i2c_get_stats();
+    CHECK(after.bus_us == sim_clock_now_us() - start_us);
+    CHECK(after.bytes < before.bytes && after.bus_us < before.bus_us);
+    printf("  per-page: %u transactions, %u bytes, %llu us; "
+           "one frame: %u transaction, %u bytes, %llu us\n",
+           before.transactions, before.bytes, (unsigned long long)before.bus_us,
+           after.transactions, after.bytes, (unsigned long long)after.bus_us);
+    oled_display_deinit(&g_display);
+}
+
+static void test_writes_are_bounded_and_copy_free(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    static uint8_t pattern[1 + 100];
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    /* A const payload is staged OLED_I2C_STAGING_SIZE bytes at a time */
+    CHECK(oled_i2c_write_data(&g_i2c, pattern + 1, 100));
+    const sim_i2c_stats_t *s = sim_i2c_get_stats();
+    CHECK(s->transactions == (100 + OLED_I2C_STAGING_SIZE - 1) / OLED_I2C_STAGING_SIZE);
+    CHECK(s->data_bytes == 100);
+    CHECK(memcmp(sim_i2c_panel_ram(), pattern + 1, 100) == 0);
+
+    /* In place: one transaction, and the borrowed byte comes back */
+    sim_i2c_clear_stats();
+    uint8_t slot = pattern[0];
+    CHECK(oled_i2c_write_data_in_place(&g_i2c, pattern + 1, 100));
+    CHECK(s->transactions == 1 && s->bytes == 1 + 1 + 100);
+    CHECK(pattern[0] == slot);
+    CHECK(memcmp(sim_i2c_panel_ram() + 100, pattern + 1, 28) == 0);
+
+    /* Command lists must fit in one transaction */
+    uint8_t cmds[OLED_I2C_STAGING_SIZE + 1];
+    memset(cmds, 0xE3, sizeof(cmds));                   /* NOP */
+    CHECK(oled_i2c_write_cmd(&g_i2c, cmds, OLED_I2C_STAGING_SIZE));
+    CHECK(!oled_i2c_write_cmd(&g_i2c, cmds, sizeof(cmds)));
+    oled_display_deinit(&g_display);
+}
+
+/**
+ * @brief The device screen as main.c draws it: cleared and redrawn in full
+ */
+static void _draw_device_screen(const char *rate) {
+    const oled_font_t *font = oled_get_font_5x7();
+    oled_display_clear(&g_display);
+    oled_draw_string(&g_display, 10, 2, "Device Detected!", font, true);
+    oled_draw_string(&g_display, 5, 12, "USB Keyboard", font, true);
+    oled_draw_string(&g_display, 5, 22, "VID:16C0 PID:27DB", font, true);
+    oled_draw_string(&g_display, 5, 32, "Class: HID (KBD)", font, true);
+    oled_draw_string(&g_display, 5, 42, "Threat: CAUTION", font, true);
+    oled_draw_string(&g_display, 0, 56, rate, font, true);
+    oled_draw_string(&g_display, 80, 56, "BOOTSEL", font, true);
+}
+
+static void test_flush_sends_only_changes(void) {
+    static const oled_display_type_e types[] = { OLED_DISPLAY_SSD1306, OLED_DISPLAY_SH1106 };
+    for (size_t t = 0; t < 2; t++) {
+        _boot(types[t]);
+        uint8_t col0 = types[t] == OLED_DISPLAY_SSD1306 ? 0 : 2;
+        oled_window_t windows[OLED_PAGES];
+
+        /* First frame: the panel's contents are unknown */
+        _draw_device_screen("Rate: 12/s");
+        CHECK(oled_display_dirty_windows(&g_display, windows) == 1);
+        CHECK(windows[0].page_end == OLED_PAGES - 1 && windows[0].col_end == OLED_WIDTH - 1);
+        CHECK(oled_display_flush(&g_display));
+        uint32_t full_bytes = sim_i2c_get_stats()->bytes;
+        CHECK(g_display.flush_bytes + sim_i2c_get_stats()->transactions == full_bytes);
+
+        /* Same picture again: nothing to send */
+        sim_i2c_clear_stats();
+        _draw_device_screen("Rate: 12/s");
+        CHECK(oled_display_dirty_windows(&g_display, windows) == 0);
+        CHECK(oled_display_flush(&g_display));
+        CHECK(sim_i2c_get_stats()->transactions == 0 && g_display.flush_bytes == 0);
+
+        /* Only the rate changed: one narrow window on the last page */
+        sim_i2c_clear_stats();
+        _draw_device_screen("Rate: 13/s");
+        CHECK(oled_display_dirty_windows(&g_display, windows) == 1);
+        CHECK(windows[0].page_start == 7 && windows[0].page_end == 7);
+        CHECK(windows[0].col_start >= 30 && windows[0].col_end < 42);
+        CHECK(oled_display_flush(&g_display));
+        uint32_t rate_bytes = sim_i2c_get_stats()->bytes;
+        CHECK(sim_i2c_get_stats()->transactions == 1 && rate_bytes < 32);
+        CHECK(_panel_matches(col0));
+
+        /* Async flushes diff the same way */
+        sim_i2c_clear_stats();
+        _draw_device_screen("Rate: 14/s");
+        CHECK(oled_display_flush_async(&g_display, NULL, NULL));
+        CHECK(oled_display_flush_wait(&g_display));
+        CHECK(sim_i2c_get_stats()->bytes == rate_bytes && _panel_matches(col0));
+
+        /* Forgetting the panel's contents sends it all again */
+        sim_i2c_clear_stats();
+        oled_display_invalidate(&g_display);
+        CHECK(oled_display_flush(&g_display));
+        CHECK(sim_i2c_get_stats()->bytes == full_bytes);
+        printf("  %s: full frame %u bytes, rate update %u bytes\n",
+               types[t] == OLED_DISPLAY_SSD1306 ? "SSD1306" : "SH1106", full_bytes, rate_bytes);
+        oled_display_deinit(&g_display);
+    }
+}
+
+static void test_windows_merge_whole_pages(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    CHECK(oled_display_flush(&g_display));
+
+    oled_window_t windows[OLED_PAGES];
+    oled_draw_rect(&g_display, 0, 8, OLED_WIDTH, 24, true, true);   /* Pages 1-3 */
+    oled_draw_pixel(&g_display, 5, 40, true);                        /* Page 5 */
+    oled_draw_pixel(&g_display, 90, 41, true);
+    CHECK(oled_display_dirty_windows(&g_display, windows) == 2);
+    CHECK(windows[0].page_start == 1 && windows[0].page_end == 3);
+    CHECK(windows[0].col_start == 0 && windows[0].col_end == OLED_WIDTH - 1);
+    CHECK(windows[1].page_start == 5 && windows[1].col_start == 5 && windows[1].col_end == 90);
+
+    sim_i2c_clear_stats();
+    CHECK(oled_display_flush(&g_display));
+    CHECK(sim_i2c_get_stats()->transactions == 2 && _panel_matches(0));
+    CHECK(sim_i2c_get_stats()->data_bytes == 3 * OLED_WIDTH + 86);
+
+    /* A failed flush forgets the panel's contents */
+    sim_i2c_attach_panel(OLED_I2C_ADDRESS_ALT, OLED_DISPLAY_SSD1306);
+    oled_draw_pixel(&g_display, 0, 0, true);
+    CHECK(!oled_display_flush(&g_display));
+    CHECK(!g_display.shadow_valid);
+    oled_display_deinit(&g_display);
+}
+
+static int g_done_calls;
+static bool g_done_ok;
+
+static void _flush_done(oled_display_t *display, bool ok, void *ctx) {
+    CHECK(display == &g_display && ctx == &g_done_calls);
+    g_done_calls++;
+    g_done_ok = ok;
+}
+
+static void test_async_flush_sends_a_copy(void) {
+    static const oled_display_type_e types[] = { OLED_DISPLAY_SSD1306, OLED_DISPLAY_SH1106 };
+    for (size_t t = 0; t < 2; t++) {
+        _boot(types[t]);
+        _draw_scene();
+        static uint8_t sent[OLED_BUFFER_SIZE];
+        memcpy(sent, g_display.buffer, OLED_BUFFER_SIZE);
+
+        g_done_calls = 0;
+        CHECK(oled_display_flush_async(&g_display, _flush_done, &g_done_calls));
+        /* The next frame is drawn while this one goes out */
+        oled_draw_rect(&g_display, 0, 0, OLED_WIDTH, OLED_HEIGHT, true, true);
+        CHECK(oled_display_flush_wait(&g_display));
+        CHECK(!oled_display_flush_busy(&g_display));
+        CHECK(g_done_calls == 1 && g_done_ok);
+
+        /* SSD1306: one transaction; SH1106: page commands and data together */
+        const sim_i2c_stats_t *s = sim_i2c_get_stats();
+        CHECK(s->transactions == (types[t] == OLED_DISPLAY_SSD1306 ? 1 : OLED_PAGES));
+        CHECK(s->data_bytes == OLED_BUFFER_SIZE);
+        uint8_t col0 = types[t] == OLED_DISPLAY_SSD1306 ? 0 : 2;
+        for (uint8_t page = 0; page < OLED_PAGES; page++) {
+            CHECK(memcmp(sim_i2c_panel_ram() + page * SIM_I2C_RAM_COLUMNS + col0,
+                         sent + page * OLED_WIDTH, OLED_WIDTH) == 0);
+        }
+        oled_display_deinit(&g_display);
+    }
+
+    /* A NACK reaches the callback */
+    _boot(OLED_DISPLAY_SSD1306);
+    sim_i2c_attach_panel(OLED_I2C_ADDRESS_ALT, OLED_DISPLAY_SSD1306);
+    g_done_calls = 0;
+    CHECK(oled_display_flush_async(&g_display, _flush_done, &g_done_calls));
+    CHECK(!oled_display_flush_wait(&g_display));
+    CHECK(g_done_calls == 1 && !g_done_ok);
+    oled_display_deinit(&g_display);
+}
+
+/**
+ * @brief How oled_draw_char() drew before the byte blitter: the glyph cell
+ * pixel by pixel
+ */
+static void _draw_char_per_pixel(oled_display_t *display, int x, int y, char c,
+                                 const oled_font_t *font, bool on) {
+    int offset = (c - font->start_char) * font->char_width;
+    for (int row = 0; row < font->height; row++) {
+        for (int col = 0; col < font->char_width && offset + col < font->width; col++) {
+            bool pixel = (font->data[offset + col] & (1 << row)) != 0;
+            oled_draw_pixel(display, x + col, y + row, pixel ? on : !on);
+        }
+    }
+}
+
+static void test_glyphs_match_per_pixel_drawing(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    const oled_font_t *font = oled_get_font_5x7();
+    static uint8_t ref_buffer[OLED_BUFFER_SIZE];
+    oled_display_t ref = g_display;
+    ref.buffer = ref_buffer;
+
+    /* Every glyph, on and off, at every row offset and clipped on all edges,
+     * over a background that shows any stray write */
+    bool same = true;
+    for (int i = 0; i < OLED_BUFFER_SIZE; i++) {
+        g_display.buffer[i] = ref_buffer[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (char c = font->start_char; c <= font->end_char && same; c++) {
+        for (int y = -8; y <= OLED_HEIGHT && same; y++) {
+            for (int x = -6; x <= OLED_WIDTH && same; x += 3) {
+                bool on = ((x + y + c) & 1) != 0;
+                same = oled_draw_char(&g_display, x, y, c, font, on) == font->char_width;
+                _draw_char_per_pixel(&ref, x, y, c, font, on);
+                same = same && memcmp(g_display.buffer, ref_buffer, OLED_BUFFER_SIZE) == 0;
+            }
+        }
+    }
+    CHECK(same);
+
+    /* Off screen draws nothing and leaves the frame clean */
+    g_display.dirty = false;
+    oled_draw_char(&g_display, OLED_WIDTH, 0, 'A', font, true);
+    oled_draw_char(&g_display, 0, -7, 'A', font, true);
+    CHECK(!g_display.dirty);
+    CHECK(oled_draw_char(&g_display, 0, 0, '\x7f', font, true) == 0);
+    oled_display_deinit(&g_display);
+}
+
+/* The fills before span filling, pixel by pixel, for the comparison */
+static void _hline_per_pixel(oled_display_t *display, int x, int y, int len, bool on) {
+    for (int i = 0; i < len; i++) {
+        oled_draw_pixel(display, x + i, y, on);
+    }
+}
+
+static void _vline_per_pixel(oled_display_t *display, int x, int y, int len, bool on) {
+    for (int i = 0; i < len; i++) {
+        oled_draw_pixel(display, x, y + i, on);
+    }
+}
+
+static void _rect_per_pixel(oled_display_t *display, int x, int y, int w, int h, bool fill,
+                            bool on) {
+    if (fill) {
+        for (int yy = 0; yy < h; yy++) {
+            _hline_per_pixel(display, x, y + yy, w, on);
+        }
+    } else {
+        _hline_per_pixel(display, x, y, w, on);
+        _hline_per_pixel(display, x, y + h - 1, w, on);
+        _vline_per_pixel(display, x, y, h, on);
+        _vline_per_pixel(display, x + w - 1, y, h, on);
+    }
+}
+
+static void _filled_circle_per_pixel(oled_display_t *display, int cx, int cy, int r, bool on) {
+    int x = r;
+    int y = 0;
+    int d = 3 - 2 * r;
+    while (x >= y) {
+        _hline_per_pixel(display, cx - x, cy + y, 2 * x + 1, on);
+        _hline_per_pixel(display, cx - x, cy - y, 2 * x + 1, on);
+        _hline_per_pixel(display, cx - y, cy + x, 2 * y + 1, on);
+        _hline_per_pixel(display, cx - y, cy - x, 2 * y + 1, on);
+        if (d < 0) {
+            d = d + 4 * y + 6;
+        } else {
+            d = d + 4 * (y - x) + 10;
+            x--;
+        }
+        y++;
+    }
+}
+
+static void test_fills_match_per_pixel_drawing(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    static uint8_t ref_buffer[OLED_BUFFER_SIZE];
+    oled_display_t ref = g_display;
+    ref.buffer = ref_buffer;
+    for (int i = 0; i < OLED_BUFFER_SIZE; i++) {
+        g_display.buffer[i] = ref_buffer[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    /* Random shapes, on and off, from empty and negative sizes to larger
+     * than the screen and hanging off every edge */
+    uint32_t seed = 12345;
+    bool same = true;
+    for (int i = 0; i < 20000 && same; i++) {
+        int v[4];
+        for (int k = 0; k < 4; k++) {
+            seed = seed * 1103515245u + 12345u;
+            v[k] = (int)((seed >> 16) % 180) - 30;
+        }
+        bool on = (seed & 0x100) != 0;
+        int x = v[0];
+        int y = v[1] - 30;
+        switch (i % 5) {
+        case 0:
+            oled_draw_hline(&g_display, x, y, v[2], on);
+            _hline_per_pixel(&ref, x, y, v[2], on);
+            break;
+        case 1:
+            oled_draw_vline(&g_display, x, y, v[2] / 2, on);
+            _vline_per_pixel(&ref, x, y, v[2] / 2, on);
+            break;
+        case 2:
+            oled_draw_rect(&g_display, x, y, v[2], v[3] / 2, true, on);
+            _rect_per_pixel(&ref, x, y, v[2], v[3] / 2, true, on);
+            break;
+        case 3:
+            oled_draw_rect(&g_display, x, y, v[2], v[3] / 2, false, on);
+            _rect_per_pixel(&ref, x, y, v[2], v[3] / 2, false, on);
+            break;
+        default:
+            oled_draw_circle(&g_display, x, y, v[2] / 4, true, on);
+            _filled_circle_per_pixel(&ref, x, y, v[2] / 4, on);
+            break;
+        }
+        same = memcmp(g_display.buffer, ref_buffer, OLED_BUFFER_SIZE) == 0;
+    }
+    CHECK(same);
+
+    /* Golden: the full screen filled, then a page-straddling hole */
+    oled_draw_rect(&g_display, 0, 0, OLED_WIDTH, OLED_HEIGHT, true, true);
+    oled_draw_rect(&g_display, 3, 5, 2, 6, true, false);
+    CHECK(g_display.buffer[2] == 0xFF && g_display.buffer[5] == 0xFF);
+    CHECK(g_display.buffer[3] == 0x1F && g_display.buffer[4] == 0x1F);
+    CHECK(g_display.buffer[OLED_WIDTH + 3] == 0xF8 && g_display.buffer[OLED_WIDTH + 4] == 0xF8);
+    CHECK(g_display.buffer[2 * OLED_WIDTH + 3] == 0xFF);
+
+    /* Nothing on screen leaves the frame clean */
+    g_display.dirty = false;
+    oled_draw_hline(&g_display, -10, 5, 10, true);
+    oled_draw_vline(&g_display, 5, OLED_HEIGHT, 4, true);
+    oled_draw_rect(&g_display, 5, 5, 0, 10, true, true);
+    CHECK(!g_display.dirty);
+    oled_display_deinit(&g_display);
+}
+
+/* What the widget tests bind to */
+typedef struct {
+    char text[16];
+    uint32_t level;
+    uint32_t icon;
+} ui_model_t;
+
+static void _bind_text(const void *model, char *out, size_t size) {
+    snprintf(out, size, "%s", ((const ui_model_t *)model)->text);
+}
+
+static uint32_t _bind_level(const void *model) {
+    return ((const ui_model_t *)model)->level;
+}
+
+static uint32_t _bind_icon(const void *model) {
+    return ((const ui_model_t *)model)->icon;
+}
+
+static const uint8_t g_icon_a[8] = { 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xFF };
+static const uint8_t g_icon_b[8] = { 0x18, 0x3C, 0x7E, 0xFF, 0xFF, 0x7E, 0x3C, 0x18 };
+static const uint8_t *const g_icons[] = { g_icon_a, g_icon_b };
+
+static oled_widget_t g_widgets[] = {
+    { .type = OLED_WIDGET_LABEL, .x = 5, .y = 2, .w = 100, .h = 7, .text = "Title" },
+    { .type = OLED_WIDGET_VALUE, .x = 5, .y = 22, .w = 60, .h = 7, .text_fn = _bind_text },
+    { .type = OLED_WIDGET_BAR, .x = 4, .y = 40, .w = 102, .h = 6, .level_fn = _bind_level,
+      .max = 100 },
+    { .type = OLED_WIDGET_ICON, .x = 110, .y = 48, .w = 8, .h = 8, .level_fn = _bind_icon,
+      .max = 2, .icons = g_icons },
+};
+
+/**
+ * @brief A blank frame with the widgets drawn over it
+ */
+static oled_screen_t _show_screen(const ui_model_t *model) {
+    oled_screen_t screen = { g_widgets, sizeof(g_widgets) / sizeof(g_widgets[0]),
+                             oled_get_font_5x7() };
+    oled_display_clear(&g_display);
+    oled_screen_invalidate(&screen);
+    CHECK(oled_screen_update(&screen, &g_display, model) == screen.count);
+    return screen;
+}
+
+static void test_widgets_redraw_only_changes(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    ui_model_t model = { "Rate:12 k/s", 50, 0 };
+    oled_screen_t screen = _show_screen(&model);
+    CHECK(oled_display_flush(&g_display));
+
+    /* Nothing changed: nothing drawn, compared or sent */
+    sim_i2c_clear_stats();
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 0);
+    CHECK(!g_display.dirty && g_display.dirty_pages == 0);
+    CHECK(oled_display_flush(&g_display));
+    CHECK(g_display.flush_bytes == 0 && sim_i2c_get_stats()->transactions == 0);
+
+    /* One value: its pages only, and only the columns that changed */
+    snprintf(model.text, sizeof(model.text), "Rate:13 k/s");
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 1);
+    CHECK(g_display.dirty_pages == ((1u << 2) | (1u << 3)));
+    oled_window_t windows[OLED_PAGES];
+    CHECK(oled_display_dirty_windows(&g_display, windows) == 2);
+    CHECK(windows[0].col_start == 5 + 6 * 5 && windows[0].col_end == 5 + 7 * 5 - 1);
+    CHECK(oled_display_flush(&g_display) && _panel_matches(0));
+
+    /* Bar and icon follow their levels */
+    model.level = 100;
+    model.icon = 1;
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 2);
+    CHECK(oled_get_pixel(&g_display, 104, 42) && oled_get_pixel(&g_display, 113, 51));
+    model.level = 0;
+    model.icon = 5;                   /* No such icon: left blank */
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 2);
+    CHECK(!oled_get_pixel(&g_display, 5, 42) && oled_get_pixel(&g_display, 4, 42));
+    CHECK(!oled_get_pixel(&g_display, 110, 48));
+    CHECK(oled_display_flush(&g_display) && _panel_matches(0));
+    oled_display_deinit(&g_display);
+}
+
+static void test_widgets_match_immediate_drawing(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    static uint8_t expect[OLED_BUFFER_SIZE];
+    const oled_font_t *font = oled_get_font_5x7();
+    ui_model_t model = { "CAUTION", 0, 0 };
+    oled_screen_t screen = _show_screen(&model);
+
+    /* A shorter value leaves nothing of the longer one behind */
+    snprintf(model.text, sizeof(model.text), "SAFE");
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 1);
+    memcpy(expect, g_display.buffer, OLED_BUFFER_SIZE);
+
+    oled_display_clear(&g_display);
+    oled_draw_string(&g_display, 5, 2, "Title", font, true);
+    oled_draw_string(&g_display, 5, 22, "SAFE", font, true);
+    oled_draw_rect(&g_display, 4, 40, 102, 6, false, true);
+    oled_draw_bitmap(&g_display, 110, 48, g_icon_a, 8, 8);
+    CHECK(memcmp(expect, g_display.buffer, OLED_BUFFER_SIZE) == 0);
+
+    /* Text stops at the widget's edge, on a whole glyph */
+    snprintf(model.text, sizeof(model.text), "0123456789ABCDE");
+    CHECK(oled_screen_update(&screen, &g_display, &model) == 1);
+    CHECK(oled_get_pixel(&g_display, 5 + 11 * 5, 23));
+    CHECK(!oled_get_pixel(&g_display, 5 + 12 * 5, 23));
+    oled_display_deinit(&g_display);
+}
+
+static void test_missing_panel_fails_flush(void) {
+    _boot(OLED_DISPLAY_SSD1306);
+    sim_i2c_attach_panel(OLED_I2C_ADDRESS_ALT, OLED_DISPLAY_SSD1306);
+    CHECK(!oled_display_flush(&g_display));
+    CHECK(sim_i2c_get_stats()->nacks == 1);
+    oled_display_deinit(&g_display);
+}
+
+int main(void) {
+    RUN_TEST(test_ssd1306_frame_is_one_transaction);
+    RUN_TEST(test_sh1106_frame_is_one_transaction_per_page);
+    RUN_TEST(test_frame_beats_per_page_flush);
+    RUN_TEST(test_writes_are_bounded_and_copy_free);
+    RUN_TEST(test_async_flush_sends_a_copy);
+    RUN_TEST(test_flush_sends_only_changes);
+    RUN_TEST(test_windows_merge_whole_pages);
+    RUN_TEST(test_glyphs_match_per_pixel_drawing);
+    RUN_TEST(test_fills_match_per_pixel_drawing);
+    RUN_TEST(test_widgets_redraw_only_changes);
+    RUN_TEST(test_widgets_match_immediate_drawing);
+    RUN_TEST(test_missing_panel_fails_flush);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,105 @@
+/*
+ * PlugSafe Host Simulator - Replay Tests
+ * HID traces replayed in virtual time through the firmware's analyzers
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_firmware.h"
+#include "sim_usb.h"
+#include "replay.h"
+#include "hid_trace.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+
+#define TRACE_DEV_ADDR                5
+
+static uint8_t g_trace[64 * 1024];
+
+/**
+ * @brief Record a keyboard typing n keys with the given period
+ */
+static size_t _make_trace(uint32_t n, uint32_t period_us) {
+    hid_trace_writer_t w;
+    hid_trace_writer_init(&w, g_trace, sizeof(g_trace), 0);
+
+    hid_trace_device_t dev = { .dev_addr = TRACE_DEV_ADDR };
+    sim_usb_device_t desc;
+    sim_usb_device_init(&desc, 0x03EB, 0x2042, "Atmel", "Keyboard", NULL);
+    memcpy(dev.desc_device, desc.desc_device, sizeof(dev.desc_device));
+    strcpy(dev.manufacturer, "Atmel");
+    strcpy(dev.product, "Keyboard");
+    hid_trace_write_device(&w, &dev);
+
+    hid_trace_interface_t itf = {
+        .itf_id = 0,
+        .dev_addr = TRACE_DEV_ADDR,
+        .instance = 0,
+        .protocol = HID_ITF_PROTOCOL_KEYBOARD
+    };
+    hid_trace_write_interface(&w, &itf);
+
+    const uint8_t press[8] = { 0, 0, 0x05 };
+    const uint8_t release[8] = { 0 };
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t t = (uint64_t)i * period_us;
+        hid_trace_write_report(&w, 0, t, press, sizeof(press));
+        hid_trace_write_report(&w, 0, t + period_us / 2, release, sizeof(release));
+    }
+    return hid_trace_finish(&w);
+}
+
+/**
+ * @brief Replay the trace into a freshly booted firmware, leaving the
+ * device mounted so its state can be inspected
+ */
+static bool _replay(size_t len, replay_stats_t *stats) {
+    sim_firmware_boot(false);
+    replay_target_t target;
+    sim_firmware_replay_target(&target);
+    replay_options_t opt;
+    replay_default_options(&opt);
+    opt.unmount_at_end = false;
+    return replay_run(g_trace, len, &target, &opt, stats);
+}
+
+static void test_replayed_attack_is_flagged(void) {
+    size_t len = _make_trace(400, 10000);   /* 100 keys/s */
+    CHECK(len > 0);
+
+    replay_stats_t stats;
+    CHECK(_replay(len, &stats));
+    CHECK(stats.devices == 1 && stats.interfaces == 1 && stats.reports == 800);
+    CHECK(threat_get_current_level(TRACE_DEV_ADDR) == THREAT_MALICIOUS);
+    usb_device_info_t *dev = usb_get_device_info(TRACE_DEV_ADDR);
+    CHECK(dev && strcmp(dev->product, "Keyboard") == 0);
+    CHECK(sim_usb_get_stats()->reports_delivered == 800);
+}
+
+static void test_replay_is_deterministic(void) {
+    size_t len = _make_trace(200, 90000);   /* ~11 keys/s */
+    replay_stats_t first, second;
+
+    CHECK(_replay(len, &first));
+    hid_monitor_t mon_first = *hid_get_monitor_stats(TRACE_DEV_ADDR);
+    threat_level_e level = threat_get_current_level(TRACE_DEV_ADDR);
+
+    CHECK(_replay(len, &second));
+    hid_monitor_t *mon_second = hid_get_monitor_stats(TRACE_DEV_ADDR);
+    CHECK(memcmp(&first, &second, sizeof(first)) == 0);
+    CHECK(mon_second && memcmp(&mon_first, mon_second, sizeof(mon_first)) == 0);
+    CHECK(level == THREAT_POTENTIALLY_UNSAFE);
+    CHECK(threat_get_current_level(TRACE_DEV_ADDR) == level);
+}
+
+int main(void) {
+    RUN_TEST(test_replayed_attack_is_flagged);
+    RUN_TEST(test_replay_is_deterministic);
+    return TEST_EXIT_CODE();
+}
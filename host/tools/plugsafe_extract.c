@@ -0,0 +1,371 @@
+/*
+ * PlugSafe Flash Dump Extractor
+ * Writes flight-recorder slots as HID traces and prints the event journal
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "flight_recorder.h"
+#include "hid_trace.h"
+#include "journal_format.h"
+
+/* Slots and journal sectors are sector aligned; scanning every sector also
+ * finds them in a dump that starts anywhere (full image or just the
+ * reserved region) */
+#define SCAN_STEP                     4096u
+
+/* Journal sector found in the dump */
+typedef struct {
+    size_t offset;
+    journal_sector_header_t hdr;
+} journal_sector_t;
+
+static const char *_level_name(uint8_t level) {
+    static const char *const names[] = {"safe", "potentially_unsafe", "malicious"};
+    return level < 3 ? names[level] : "unknown";
+}
+
+static const char *_reason_name(uint8_t reason) {
+    static const char *const names[] = {"classified", "reclassified", "rate", "flood"};
+    return reason < 4 ? names[reason] : "unknown";
+}
+
+/**
+ * @brief Read a whole file into memory
+ */
+static uint8_t *_read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "plugsafe_extract: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    size_t cap = 1 << 20;
+    size_t n = 0;
+    uint8_t *buf = malloc(cap);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += got;
+        if (n == cap) {
+            uint8_t *bigger = realloc(buf, cap * 2);
+            if (!bigger) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = bigger;
+            cap *= 2;
+        }
+    }
+    fclose(f);
+    if (!buf) {
+        fprintf(stderr, "plugsafe_extract: out of memory\n");
+        return NULL;
+    }
+    *len = n;
+    return buf;
+}
+
+/**
+ * @brief Validate a slot header at a dump offset
+ */
+static const fr_slot_header_t *_slot_at(const uint8_t *dump, size_t dump_len, size_t offset) {
+    if (dump_len - offset < sizeof(fr_slot_header_t)) {
+        return NULL;
+    }
+    fr_slot_header_t hdr;
+    memcpy(&hdr, dump + offset, sizeof(hdr));
+    if (hdr.magic != FR_SLOT_MAGIC || hdr.version != FR_SLOT_VERSION ||
+        hdr.header_size != sizeof(fr_slot_header_t) || hdr.capture_len > FR_CAPTURE_MAX ||
+        hdr.header_crc != hid_trace_crc32(&hdr, offsetof(fr_slot_header_t, header_crc))) {
+        return NULL;
+    }
+    return (const fr_slot_header_t *)(dump + offset);
+}
+
+/**
+ * @brief Print what a capture contains: devices, interfaces, report span
+ */
+static bool _summarize(const uint8_t *trace, size_t len) {
+    hid_trace_reader_t r;
+    if (!hid_trace_reader_init(&r, trace, len)) {
+        return false;
+    }
+
+    uint32_t reports = 0;
+    uint64_t last_us = 0;
+    hid_trace_record_t rec;
+    while (hid_trace_next(&r, &rec)) {
+        switch (rec.type) {
+            case HT_REC_DEVICE:
+                printf("    device %u: VID 0x%02x%02x PID 0x%02x%02x \"%s\" / \"%s\"\n",
+                       rec.device.dev_addr,
+                       rec.device.desc_device[9], rec.device.desc_device[8],
+                       rec.device.desc_device[11], rec.device.desc_device[10],
+                       rec.device.manufacturer, rec.device.product);
+                break;
+            case HT_REC_INTERFACE:
+                printf("    interface %u: instance %u, protocol %u, %u-byte report descriptor\n",
+                       rec.itf.itf_id, rec.itf.instance, rec.itf.protocol, rec.itf.desc_len);
+                break;
+            case HT_REC_REPORT:
+                reports++;
+                last_us = rec.report.time_us;
+                break;
+            case HT_REC_END:
+                printf("    %u reports over %.3f s before the verdict\n",
+                       reports, (double)last_us / 1e6);
+                return true;
+        }
+    }
+    return false;
+}
+
+static int _compare_seq(const void *a, const void *b) {
+    uint32_t sa = ((const journal_sector_t *)a)->hdr.seq;
+    uint32_t sb = ((const journal_sector_t *)b)->hdr.seq;
+    return sa < sb ? -1 : sa > sb;
+}
+
+/**
+ * @brief Collect the journal sectors in a dump, oldest first.
+ *
+ * Returns the count; *out is malloc'ed (NULL if none).
+ */
+static size_t _find_journal(const uint8_t *dump, size_t dump_len, journal_sector_t **out) {
+    size_t count = 0;
+    *out = NULL;
+    for (size_t offset = 0; offset + JOURNAL_SECTOR_SIZE <= dump_len; offset += SCAN_STEP) {
+        journal_sector_header_t hdr;
+        if (!journal_sector_valid(dump + offset, &hdr)) {
+            continue;
+        }
+        journal_sector_t *bigger = realloc(*out, (count + 1) * sizeof(**out));
+        if (!bigger) {
+            break;
+        }
+        *out = bigger;
+        (*out)[count++] = (journal_sector_t){ .offset = offset, .hdr = hdr };
+    }
+    if (count) {
+        qsort(*out, count, sizeof(**out), _compare_seq);
+    }
+    return count;
+}
+
+/**
+ * @brief Print one journal record as a text line
+ */
+static void _print_record(uint32_t boot, const journal_record_t *rec) {
+    printf("boot %-4u %10.3f s  ", boot, rec->time_ms / 1000.0);
+    switch (rec->type) {
+        case JOURNAL_REC_BOOT:
+            printf("boot\n");
+            return;
+        case JOURNAL_REC_MOUNT:
+            if (rec->len == sizeof(tlm_mount_t)) {
+                tlm_mount_t m;
+                memcpy(&m, rec->payload, sizeof(m));
+                printf("mount        dev %u VID 0x%04x PID 0x%04x class 0x%02x/0x%02x/0x%02x\n",
+                       m.dev_addr, m.vid, m.pid, m.usb_class, m.subclass, m.protocol);
+                return;
+            }
+            break;
+        case JOURNAL_REC_UNMOUNT:
+            if (rec->len == sizeof(tlm_unmount_t)) {
+                printf("unmount      dev %u\n", rec->payload[0]);
+                return;
+            }
+            break;
+        case JOURNAL_REC_FINGERPRINT:
+            if (rec->len == sizeof(journal_fingerprint_t)) {
+                journal_fingerprint_t fp;
+                memcpy(&fp, rec->payload, sizeof(fp));
+                printf("fingerprint  dev %u strings 0x%08x \"%.*s\"\n", fp.dev_addr,
+                       fp.strings_crc, (int)strnlen(fp.product, sizeof(fp.product)),
+                       fp.product);
+                return;
+            }
+            break;
+        case JOURNAL_REC_VERDICT:
+            if (rec->len == sizeof(tlm_verdict_t)) {
+                tlm_verdict_t v;
+                memcpy(&v, rec->payload, sizeof(v));
+                printf("verdict      dev %u %s (%s), %u keys/s%s\n", v.dev_addr,
+                       _level_name(v.level), _reason_name(v.reason), v.rate_hz,
+                       v.flood_suspect ? ", flood suspect" : "");
+                return;
+            }
+            break;
+        case JOURNAL_REC_COUNTERS:
+            if (rec->len == sizeof(tlm_counters_t)) {
+                tlm_counters_t c;
+                memcpy(&c, rec->payload, sizeof(c));
+                printf("counters     tlm_dropped %u log_dropped %u events_dropped %u "
+                       "max_dispatch %u us max_usb_task %u us\n",
+                       c.tlm_dropped, c.log_dropped, c.events_dropped,
+                       c.max_dispatch_us, c.max_usb_task_us);
+                return;
+            }
+            break;
+    }
+    printf("type 0x%02x    %u bytes\n", rec->type, rec->len);
+}
+
+/**
+ * @brief Print every journal record in the dump, oldest first
+ */
+static void _print_journal(const uint8_t *dump, const journal_sector_t *sectors, size_t count) {
+    uint32_t torn = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && sectors[i].hdr.seq != sectors[i - 1].hdr.seq + 1) {
+            printf("-- sectors %u..%u missing (overwritten or corrupt) --\n",
+                   sectors[i - 1].hdr.seq + 1, sectors[i].hdr.seq - 1);
+        }
+
+        /* Records before the sector's first BOOT belong to the boot that
+         * opened it */
+        uint32_t boot = sectors[i].hdr.boot;
+        journal_reader_t r;
+        journal_record_t rec;
+        journal_reader_init(&r, dump + sectors[i].offset);
+        while (journal_reader_next(&r, &rec)) {
+            if (rec.type == JOURNAL_REC_BOOT && rec.len == sizeof(journal_boot_t)) {
+                journal_boot_t b;
+                memcpy(&b, rec.payload, sizeof(b));
+                boot = b.boot;
+            }
+            _print_record(boot, &rec);
+        }
+        torn += r.torn;
+    }
+    if (torn) {
+        printf("-- %u torn records skipped --\n", torn);
+    }
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: plugsafe_extract [-o prefix] [--list] [--journal] <flash-dump.bin>\n"
+            "  Writes each valid forensic slot as <prefix>-<seq>.pstrace (HID trace format).\n"
+            "  -o prefix   output file prefix (default \"capture\")\n"
+            "  --list      only list the slots found\n"
+            "  --journal   print the event journal instead, oldest record first\n"
+            "  Dump the reserved region with e.g.:\n"
+            "    picotool save -r 0x101ec000 0x10200000 plugsafe.bin\n");
+}
+
+int main(int argc, char **argv) {
+    const char *prefix = "capture";
+    const char *path = NULL;
+    bool list_only = false;
+    bool journal = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list_only = true;
+        } else if (strcmp(argv[i], "--journal") == 0) {
+            journal = true;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            _usage();
+            return 0;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            _usage();
+            return 2;
+        }
+    }
+    if (!path) {
+        _usage();
+        return 2;
+    }
+
+    size_t dump_len;
+    uint8_t *dump = _read_file(path, &dump_len);
+    if (!dump) {
+        return 1;
+    }
+
+    journal_sector_t *sectors;
+    size_t sector_count = _find_journal(dump, dump_len, &sectors);
+    if (journal) {
+        if (sector_count) {
+            _print_journal(dump, sectors, sector_count);
+        } else {
+            printf("no journal sectors found\n");
+        }
+        free(sectors);
+        free(dump);
+        return 0;
+    }
+    if (sector_count) {
+        printf("journal: %zu sectors, seq %u..%u (print with --journal)\n", sector_count,
+               sectors[0].hdr.seq, sectors[sector_count - 1].hdr.seq);
+    }
+    free(sectors);
+
+    int found = 0;
+    int bad = 0;
+    for (size_t offset = 0; offset + FR_SLOT_DATA_OFFSET <= dump_len; offset += SCAN_STEP) {
+        const fr_slot_header_t *hdr = _slot_at(dump, dump_len, offset);
+        if (!hdr) {
+            continue;
+        }
+
+        const uint8_t *trace = dump + offset + FR_SLOT_DATA_OFFSET;
+        size_t trace_len = hdr->capture_len;
+        if (dump_len - offset - FR_SLOT_DATA_OFFSET < trace_len ||
+            hid_trace_crc32(trace, trace_len) != hdr->capture_crc) {
+            printf("slot at 0x%06zx: capture #%u is truncated or corrupt (CRC mismatch)\n",
+                   offset, hdr->seq);
+            bad++;
+            continue;
+        }
+
+        found++;
+        printf("slot at 0x%06zx: capture #%u, dev_addr %u, level %u, reason %s, "
+               "at %u ms, %u bytes\n",
+               offset, hdr->seq, hdr->dev_addr, hdr->level, _reason_name(hdr->reason),
+               hdr->trigger_time_ms, hdr->capture_len);
+        if (!_summarize(trace, trace_len)) {
+            printf("    (not a valid HID trace)\n");
+            bad++;
+            continue;
+        }
+
+        if (!list_only) {
+            char out_path[512];
+            snprintf(out_path, sizeof(out_path), "%s-%u.pstrace", prefix, hdr->seq);
+            FILE *out = fopen(out_path, "wb");
+            if (!out || fwrite(trace, 1, trace_len, out) != trace_len) {
+                fprintf(stderr, "plugsafe_extract: %s: %s\n", out_path, strerror(errno));
+                if (out) {
+                    fclose(out);
+                }
+                free(dump);
+                return 1;
+            }
+            fclose(out);
+            printf("    -> %s\n", out_path);
+        }
+    }
+
+    if (found == 0 && bad == 0) {
+        printf("no forensic captures found\n");
+    }
+    free(dump);
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,345 @@
+/*
+ * PlugSafe Trace Replay Tool
+ * Replays a HID trace in virtual time, printing the callback sequence or
+ * running it through the firmware's analyzers
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include "hid_trace.h"
+#include "replay.h"
+#include "sim_firmware.h"
+#include "usb_host.h"
+#include "threat_analyzer.h"
+#include "hid_monitor.h"
+#include "event_queue.h"
+
+/* Per-interface counts for the summary */
+typedef struct {
+    bool seen;
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t protocol;
+    uint32_t reports;
+    uint64_t first_us;
+    uint64_t last_us;
+    uint64_t min_interval_us;
+} itf_summary_t;
+
+typedef struct {
+    bool json;                        /* Print every callback as a JSON line */
+    uint64_t now_us;
+    itf_summary_t itfs[HT_MAX_INTERFACES];
+} print_target_t;
+
+static print_target_t g_printer;
+
+/* ============================================================================
+ * PRINTING TARGET
+ * ============================================================================ */
+
+/**
+ * @brief Print a JSON string literal (quotes included)
+ */
+static void _json_string(const char *text) {
+    putchar('"');
+    for (; *text; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            printf("\\%c", c);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+static void _set_time(void *ctx, uint64_t now_us) {
+    ((print_target_t *)ctx)->now_us = now_us;
+}
+
+static void _mount(void *ctx, const hid_trace_device_t *dev) {
+    print_target_t *p = ctx;
+    if (p->json) {
+        printf("{\"t_us\":%llu,\"event\":\"mount\",\"dev_addr\":%u,"
+               "\"vid\":%u,\"pid\":%u,\"manufacturer\":",
+               (unsigned long long)p->now_us, dev->dev_addr,
+               dev->desc_device[8] | (dev->desc_device[9] << 8),
+               dev->desc_device[10] | (dev->desc_device[11] << 8));
+        _json_string(dev->manufacturer);
+        printf(",\"product\":");
+        _json_string(dev->product);
+        printf("}\n");
+    }
+}
+
+static void _hid_mount(void *ctx, const hid_trace_interface_t *itf) {
+    print_target_t *p = ctx;
+    itf_summary_t *sum = &p->itfs[itf->itf_id];
+    sum->seen = true;
+    sum->dev_addr = itf->dev_addr;
+    sum->instance = itf->instance;
+    sum->protocol = itf->protocol;
+    if (p->json) {
+        printf("{\"t_us\":%llu,\"event\":\"hid_mount\",\"dev_addr\":%u,\"instance\":%u,"
+               "\"protocol\":%u,\"desc_len\":%u}\n",
+               (unsigned long long)p->now_us, itf->dev_addr, itf->instance,
+               itf->protocol, itf->desc_len);
+    }
+}
+
+static void _report(void *ctx, const hid_trace_interface_t *itf,
+                    const uint8_t *data, uint16_t len) {
+    print_target_t *p = ctx;
+    itf_summary_t *sum = &p->itfs[itf->itf_id];
+    if (sum->reports == 0) {
+        sum->first_us = p->now_us;
+    } else if (sum->min_interval_us == 0 || p->now_us - sum->last_us < sum->min_interval_us) {
+        sum->min_interval_us = p->now_us - sum->last_us;
+    }
+    sum->last_us = p->now_us;
+    sum->reports++;
+
+    if (p->json) {
+        printf("{\"t_us\":%llu,\"event\":\"report\",\"dev_addr\":%u,\"instance\":%u,\"data\":\"",
+               (unsigned long long)p->now_us, itf->dev_addr, itf->instance);
+        for (uint16_t i = 0; i < len; i++) {
+            printf("%02x", data[i]);
+        }
+        printf("\"}\n");
+    }
+}
+
+static void _unmount(void *ctx, uint8_t dev_addr) {
+    print_target_t *p = ctx;
+    if (p->json) {
+        printf("{\"t_us\":%llu,\"event\":\"unmount\",\"dev_addr\":%u}\n",
+               (unsigned long long)p->now_us, dev_addr);
+    }
+}
+
+/* ============================================================================
+ * ANALYZER TARGET
+ * ============================================================================ */
+
+static const char *const LEVEL_NAMES[] = { "SAFE", "POTENTIALLY_UNSAFE", "MALICIOUS" };
+
+/* The firmware target, with core events printed as they are raised */
+static replay_target_t g_firmware;
+
+/**
+ * @brief Print the verdict-changing core events the firmware queued (core 0
+ * pops them the same way)
+ */
+static void _print_events(void) {
+    core_event_t event;
+    while (event_queue_pop(&event)) {
+        if (event.type == CORE_EVENT_THREAT_CHANGED) {
+            printf("[%10.3f s] dev %u: threat level -> %s\n", event.time_ms / 1e3,
+                   event.dev_addr, event.arg < 3 ? LEVEL_NAMES[event.arg] : "?");
+        } else if (event.type == CORE_EVENT_FLOOD_SUSPECT) {
+            printf("[%10.3f s] dev %u: report flood suspect\n", event.time_ms / 1e3,
+                   event.dev_addr);
+        }
+    }
+}
+
+static void _fw_set_time(void *ctx, uint64_t now_us) {
+    _set_time(&g_printer, now_us);
+    g_firmware.set_time(ctx, now_us);
+}
+
+static void _fw_mount(void *ctx, const hid_trace_device_t *dev) {
+    g_firmware.mount(ctx, dev);
+    _print_events();
+}
+
+static void _fw_hid_mount(void *ctx, const hid_trace_interface_t *itf) {
+    _hid_mount(&g_printer, itf);
+    g_firmware.hid_mount(ctx, itf);
+    _print_events();
+}
+
+static void _fw_report(void *ctx, const hid_trace_interface_t *itf,
+                       const uint8_t *data, uint16_t len) {
+    _report(&g_printer, itf, data, len);
+    g_firmware.report(ctx, itf, data, len);
+    _print_events();
+}
+
+static void _fw_idle(void *ctx, uint64_t now_us) {
+    g_firmware.idle(ctx, now_us);
+    _print_events();
+}
+
+/**
+ * @brief Print each mounted device's final verdict
+ */
+static void _print_verdicts(void) {
+    for (uint8_t i = 0; i < usb_get_device_count(); i++) {
+        usb_device_info_t *dev = usb_get_device_at_index(i);
+        device_threat_t *threat = threat_get_device_status(dev->dev_addr);
+        hid_monitor_t *mon = hid_get_monitor_stats(dev->dev_addr);
+        printf("dev %u (%04x:%04x \"%s\"): %s, peak %u reports/s%s\n",
+               dev->dev_addr, dev->vid, dev->pid, dev->product,
+               threat ? LEVEL_NAMES[threat->threat_level] : "untracked",
+               mon ? (unsigned)mon->peak_rate_hz : 0u,
+               dev->flood_suspect ? ", flood suspect" : "");
+    }
+}
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+static uint8_t *_read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "plugsafe_replay: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = size > 0 ? malloc((size_t)size) : NULL;
+    if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "plugsafe_replay: %s: cannot read\n", path);
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *len = (size_t)size;
+    return buf;
+}
+
+static double _wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: plugsafe_replay [--json | --analyze [--log]] [--idle-ms n] [--tail-ms n]\n"
+            "                       <trace.pstrace>\n"
+            "  Replays a HID trace in virtual time (no sleeping) and summarizes it.\n"
+            "  --json       print every callback (mount, hid_mount, report, unmount)\n"
+            "               as a JSON line with its virtual time\n"
+            "  --analyze    run the trace through the firmware's USB host and threat\n"
+            "               analysis, print verdict changes and final verdicts\n"
+            "  --log        with --analyze, print the firmware's log output\n"
+            "  --idle-ms n  idle tick spacing between reports (default 10)\n"
+            "  --tail-ms n  virtual time to run on after the last report (default 2000)\n");
+}
+
+int main(int argc, char **argv) {
+    print_target_t *printer = &g_printer;
+    replay_options_t opt;
+    replay_default_options(&opt);
+    const char *path = NULL;
+    bool analyze = false;
+    bool log = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            printer->json = true;
+        } else if (strcmp(argv[i], "--analyze") == 0) {
+            analyze = true;
+        } else if (strcmp(argv[i], "--log") == 0) {
+            log = true;
+        } else if (strcmp(argv[i], "--idle-ms") == 0 && i + 1 < argc) {
+            opt.idle_period_us = (uint32_t)strtoul(argv[++i], NULL, 10) * 1000u;
+        } else if (strcmp(argv[i], "--tail-ms") == 0 && i + 1 < argc) {
+            opt.tail_us = strtoull(argv[++i], NULL, 10) * 1000u;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            _usage();
+            return 0;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            _usage();
+            return 2;
+        }
+    }
+    if (!path || (analyze && printer->json)) {
+        _usage();
+        return 2;
+    }
+
+    size_t len;
+    uint8_t *trace = _read_file(path, &len);
+    if (!trace) {
+        return 1;
+    }
+
+    replay_target_t target = {
+        .ctx = printer,
+        .set_time = _set_time,
+        .mount = _mount,
+        .hid_mount = _hid_mount,
+        .report = _report,
+        .unmount = _unmount
+    };
+    if (analyze) {
+        /* Verdicts are read from the devices as they stand at the end */
+        opt.unmount_at_end = false;
+        sim_firmware_boot(log);
+        sim_firmware_replay_target(&g_firmware);
+        target = g_firmware;
+        target.set_time = _fw_set_time;
+        target.mount = _fw_mount;
+        target.hid_mount = _fw_hid_mount;
+        target.report = _fw_report;
+        target.idle = _fw_idle;
+    }
+    replay_stats_t stats;
+    double start_ms = _wall_ms();
+    bool ok = replay_run(trace, len, &target, &opt, &stats);
+    double wall_ms = _wall_ms() - start_ms;
+    free(trace);
+    if (analyze) {
+        _print_verdicts();
+    }
+
+    FILE *out = printer->json ? stderr : stdout;
+    for (int i = 0; i < HT_MAX_INTERFACES; i++) {
+        const itf_summary_t *sum = &printer->itfs[i];
+        if (!sum->seen) {
+            continue;
+        }
+        double span_s = (sum->last_us - sum->first_us) / 1e6;
+        fprintf(out, "interface %d (dev %u, instance %u, protocol %u): %u reports",
+                i, sum->dev_addr, sum->instance, sum->protocol, sum->reports);
+        if (sum->reports > 1) {
+            fprintf(out, " over %.3f s, mean %.1f Hz, min interval %llu us",
+                    span_s, (sum->reports - 1) / span_s,
+                    (unsigned long long)sum->min_interval_us);
+        }
+        fprintf(out, "\n");
+    }
+    double virtual_ms = (stats.end_us - opt.start_us) / 1e3;
+    fprintf(out, "%u devices, %u interfaces, %u reports: %.1f ms of virtual time "
+            "replayed in %.3f ms (%.0fx real time)\n",
+            stats.devices, stats.interfaces, stats.reports, virtual_ms, wall_ms,
+            wall_ms > 0 ? virtual_ms / wall_ms : 0.0);
+    if (!ok) {
+        fprintf(stderr, "plugsafe_replay: %s: malformed trace, replay stopped early\n", path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+/*
+ * PlugSafe Synthetic Trace Generator
+ * Compiles DuckyScript payloads and human typing models into HID traces
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "hid_trace.h"
+#include "synth.h"
+#include "ducky.h"
+#include "typing_model.h"
+
+#define SYNTH_TRACE_CAP               (16u << 20)   /* ~1.3M reports */
+#define SYNTH_DEV_ADDR                1
+
+typedef enum {
+    MODE_DUCKY,
+    MODE_HUMAN
+} synth_mode_e;
+
+typedef struct {
+    synth_mode_e mode;
+    const char *prefix;
+    uint32_t count;
+    uint32_t poll_us;
+    synth_device_t dev;
+    ducky_options_t ducky;
+    typing_options_t typing;
+    const char *script;               /* DuckyScript or text to type (NULL = prose) */
+    uint64_t seconds_us;              /* Length of generated prose */
+} synth_job_t;
+
+/**
+ * @brief Read a whole text file, NUL-terminated
+ */
+static char *_read_text(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "plugsafe_synth: %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    size_t cap = 4096;
+    size_t n = 0;
+    char *buf = malloc(cap);
+    size_t got;
+    while (buf && (got = fread(buf + n, 1, cap - n - 1, f)) > 0) {
+        n += got;
+        if (n + 1 == cap) {
+            char *bigger = realloc(buf, cap * 2);
+            if (!bigger) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = bigger;
+            cap *= 2;
+        }
+    }
+    fclose(f);
+    if (!buf) {
+        fprintf(stderr, "plugsafe_synth: out of memory\n");
+        return NULL;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+/**
+ * @brief Generate one trace with the given seed and write it out
+ */
+static bool _generate(const synth_job_t *job, uint32_t seed, const char *out_path,
+                      uint8_t *buf) {
+    hid_trace_writer_t w;
+    hid_trace_writer_init(&w, buf, SYNTH_TRACE_CAP, 0);
+    synth_write_keyboard(&w, &job->dev, 0);
+    synth_keyboard_t kbd;
+    synth_keyboard_init(&kbd, &w, 0, job->poll_us);
+
+    uint32_t skipped = 0;
+    if (job->mode == MODE_DUCKY) {
+        ducky_options_t opt = job->ducky;
+        opt.seed = seed;
+        ducky_error_t err;
+        if (!ducky_compile(job->script, &opt, &kbd, &skipped, &err)) {
+            fprintf(stderr, "plugsafe_synth: line %u: %s\n", err.line, err.message);
+            return false;
+        }
+    } else {
+        typing_options_t opt = job->typing;
+        opt.seed = seed;
+        if (job->script) {
+            typing_type_text(job->script, &opt, &kbd, &skipped);
+        } else {
+            typing_generate(job->seconds_us, &opt, &kbd);
+        }
+    }
+
+    size_t len = hid_trace_finish(&w);
+    if (len == 0) {
+        fprintf(stderr, "plugsafe_synth: %s: trace larger than %u bytes\n",
+                out_path, SYNTH_TRACE_CAP);
+        return false;
+    }
+    FILE *out = fopen(out_path, "wb");
+    if (!out || fwrite(buf, 1, len, out) != len) {
+        fprintf(stderr, "plugsafe_synth: %s: %s\n", out_path, strerror(errno));
+        if (out) {
+            fclose(out);
+        }
+        return false;
+    }
+    fclose(out);
+
+    double span_s = (kbd.last_us - kbd.first_key_us) / 1e6;
+    printf("%s: %u keystrokes, %u reports, first key at %.3f s, %.3f s long",
+           out_path, kbd.keystrokes, kbd.reports, kbd.first_key_us / 1e6, span_s);
+    if (span_s > 0) {
+        printf(", %.1f keys/s", kbd.keystrokes / span_s);
+    }
+    if (skipped) {
+        printf(", %u characters not typeable", skipped);
+    }
+    printf("\n");
+    return true;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: plugsafe_synth ducky [options] <payload.txt>\n"
+            "       plugsafe_synth human [options] (<text.txt> | --seconds n)\n"
+            "  Compiles a DuckyScript payload, or simulates a person typing, into a\n"
+            "  boot-keyboard HID trace (<prefix>.pstrace).\n"
+            "  -o prefix             output file prefix (default \"synth\")\n"
+            "  --count n             write n variants <prefix>-<i>.pstrace, seeds seed..seed+n-1\n"
+            "  --seed n              random seed (default 1)\n"
+            "  --poll-ms n           device polling interval, bInterval (default 1)\n"
+            "  --vid x --pid x       device IDs, hex (default 16c0:27db)\n"
+            "  --manufacturer s --product s\n"
+            "  ducky:\n"
+            "  --default-delay ms    pause after every command (default 0)\n"
+            "  --string-delay ms     gap after every STRING character (default 5)\n"
+            "  --hold-ms ms          key hold time (default 5)\n"
+            "  --jitter spec         none, uniform:MS, normal:MS or exp:MS on every gap\n"
+            "  human:\n"
+            "  --seconds n           type generated prose for n seconds instead of a file\n"
+            "  --wpm n               mean speed (default 45)\n"
+            "  --sigma x             log-normal shape of key intervals (default 0.35)\n"
+            "  --typo-rate x         chance per letter of a corrected typo (default 0.02)\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        _usage();
+        return argc < 2 ? 2 : 0;
+    }
+
+    synth_job_t job = {
+        .prefix = "synth",
+        .count = 1,
+        .poll_us = SYNTH_DEFAULT_POLL_US,
+        .dev = {
+            .dev_addr = SYNTH_DEV_ADDR,
+            .vid = 0x16C0,
+            .pid = 0x27DB,
+            .manufacturer = "PlugSafe",
+            .product = "Keyboard"
+        }
+    };
+    if (strcmp(argv[1], "ducky") == 0) {
+        job.mode = MODE_DUCKY;
+    } else if (strcmp(argv[1], "human") == 0) {
+        job.mode = MODE_HUMAN;
+    } else {
+        _usage();
+        return 2;
+    }
+    ducky_default_options(&job.ducky);
+    typing_default_options(&job.typing);
+
+    uint32_t seed = 1;
+    const char *path = NULL;
+    bool ducky = job.mode == MODE_DUCKY;
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "-o") == 0 && has_value) {
+            job.prefix = argv[++i];
+        } else if (strcmp(arg, "--count") == 0 && has_value) {
+            job.count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--poll-ms") == 0 && has_value) {
+            job.poll_us = (uint32_t)(strtod(argv[++i], NULL) * 1000.0);
+        } else if (strcmp(arg, "--vid") == 0 && has_value) {
+            job.dev.vid = (uint16_t)strtoul(argv[++i], NULL, 16);
+        } else if (strcmp(arg, "--pid") == 0 && has_value) {
+            job.dev.pid = (uint16_t)strtoul(argv[++i], NULL, 16);
+        } else if (strcmp(arg, "--manufacturer") == 0 && has_value) {
+            job.dev.manufacturer = argv[++i];
+        } else if (strcmp(arg, "--product") == 0 && has_value) {
+            job.dev.product = argv[++i];
+        } else if (ducky && strcmp(arg, "--default-delay") == 0 && has_value) {
+            job.ducky.default_delay_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (ducky && strcmp(arg, "--string-delay") == 0 && has_value) {
+            job.ducky.string_delay_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (ducky && strcmp(arg, "--hold-ms") == 0 && has_value) {
+            job.ducky.hold_us = (uint32_t)(strtod(argv[++i], NULL) * 1000.0);
+        } else if (ducky && strcmp(arg, "--jitter") == 0 && has_value) {
+            if (!synth_jitter_parse(argv[++i], &job.ducky.jitter)) {
+                fprintf(stderr, "plugsafe_synth: bad jitter spec '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (!ducky && strcmp(arg, "--seconds") == 0 && has_value) {
+            job.seconds_us = (uint64_t)(strtod(argv[++i], NULL) * 1e6);
+        } else if (!ducky && strcmp(arg, "--wpm") == 0 && has_value) {
+            job.typing.wpm = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (!ducky && strcmp(arg, "--sigma") == 0 && has_value) {
+            job.typing.interval_sigma = strtod(argv[++i], NULL);
+        } else if (!ducky && strcmp(arg, "--typo-rate") == 0 && has_value) {
+            job.typing.typo_rate = strtod(argv[++i], NULL);
+        } else if (arg[0] != '-' && !path) {
+            path = arg;
+        } else {
+            _usage();
+            return 2;
+        }
+    }
+    /* ducky needs a script; human needs exactly one of a text and --seconds */
+    if (job.count == 0 || job.poll_us == 0 ||
+        (ducky ? !path : (!path == !job.seconds_us))) {
+        _usage();
+        return 2;
+    }
+
+    char *text = NULL;
+    if (path) {
+        text = _read_text(path);
+        if (!text) {
+            return 1;
+        }
+        job.script = text;
+    }
+    uint8_t *buf = malloc(SYNTH_TRACE_CAP);
+    if (!buf) {
+        fprintf(stderr, "plugsafe_synth: out of memory\n");
+        free(text);
+        return 1;
+    }
+
+    bool ok = true;
+    for (uint32_t i = 0; i < job.count && ok; i++) {
+        char out_path[512];
+        if (job.count == 1) {
+            snprintf(out_path, sizeof(out_path), "%s.pstrace", job.prefix);
+        } else {
+            snprintf(out_path, sizeof(out_path), "%s-%u.pstrace", job.prefix, i);
+        }
+        ok = _generate(&job, seed + i, out_path, buf);
+    }
+    free(buf);
+    free(text);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * PlugSafe Deferred Logging
+ * Callers on the USB core queue compact records; core 0 formats them later
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Build switch: 0 makes DLOG() a plain printf() (set by CMake) */
+#ifndef PLUGSAFE_DEFERRED_LOG
+#define PLUGSAFE_DEFERRED_LOG         0
+#endif
+
+/* Configuration */
+#define DLOG_RING_SIZE                64    /* Records (must be a power of two) */
+#define DLOG_MAX_ARGS                 4     /* 32-bit arguments per record */
+#define DLOG_STR_LEN                  64    /* Copied string argument, incl. NUL */
+#define DLOG_PRODUCER_CORE            1     /* Core whose DLOG() calls are deferred */
+#define DLOG_DRAIN_BATCH              8     /* Records formatted per log task run */
+
+/* One argument: the format decides which member is read back */
+typedef union {
+    uint32_t u;                       /* Integer (%d, %u, %X, %c, ...) */
+    const char *s;                    /* Pointer to a string literal (%s) */
+} dlog_arg_t;
+
+/* Queued record. The format string stays in flash and doubles as its ID. */
+typedef struct {
+    const char *fmt;                  /* printf format */
+    uint8_t nargs;                    /* Valid entries in args[] */
+    bool has_str;                     /* str[] is the first format argument */
+    dlog_arg_t args[DLOG_MAX_ARGS];
+    char str[DLOG_STR_LEN];           /* Copy of a mutable string argument */
+} dlog_record_t;
+
+/* Reset the ring (call before launching core 1) */
+void dlog_init(void);
+
+/* Queue a record; str (may be NULL) is copied. Called on any other core, the
+ * message is printed immediately instead. */
+void dlog_write(const char *fmt, const char *str, uint8_t nargs, const dlog_arg_t *args);
+
+/* Enable or disable DLOG() output at runtime (enabled after init). Disabled
+ * calls are discarded, e.g. while the UART carries only binary telemetry. */
+void dlog_set_enabled(bool enabled);
+
+/* Format and print up to max_records queued records (consumer core only).
+ * Returns the number printed. */
+uint32_t dlog_drain(uint32_t max_records);
+
+/* Records dropped because the ring was full */
+uint32_t dlog_get_dropped(void);
+
+/* Deepest ring occupancy seen */
+uint32_t dlog_get_high_water(void);
+
+/* ---- Call-site macros -------------------------------------------------------
+ * DLOG(fmt, ...)          integer arguments and pointers to string literals
+ * DLOG_S(fmt, str, ...)   str is copied; it must be the first %s in fmt
+ * Arguments must be 32 bits or narrower (no %llu, no floating point). */
+
+static inline dlog_arg_t _dlog_int(uint32_t u) { return (dlog_arg_t){ .u = u }; }
+static inline dlog_arg_t _dlog_str(const char *s) { return (dlog_arg_t){ .s = s }; }
+
+/* Strings go in .s, everything else is converted to 32 bits in .u */
+#define _DLOG_A(x)                    _Generic((x), char *: _dlog_str, const char *: _dlog_str, \
+                                               default: _dlog_int)(x)
+#define _DLOG_COUNT(...)              _DLOG_COUNT_(_, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define _DLOG_COUNT_(_, a, b, c, d, n, ...) n
+#define _DLOG_CAT(a, b)               _DLOG_CAT_(a, b)
+#define _DLOG_CAT_(a, b)              a##b
+#define _DLOG_ARGS(...)               _DLOG_CAT(_DLOG_ARGS_, _DLOG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+#define _DLOG_ARGS_0()                0, NULL
+#define _DLOG_ARGS_1(a)               1, (const dlog_arg_t[]){ _DLOG_A(a) }
+#define _DLOG_ARGS_2(a, b)            2, (const dlog_arg_t[]){ _DLOG_A(a), _DLOG_A(b) }
+#define _DLOG_ARGS_3(a, b, c)         3, (const dlog_arg_t[]){ _DLOG_A(a), _DLOG_A(b), _DLOG_A(c) }
+#define _DLOG_ARGS_4(a, b, c, d)      4, (const dlog_arg_t[]){ _DLOG_A(a), _DLOG_A(b), _DLOG_A(c), _DLOG_A(d) }
+
+#if PLUGSAFE_DEFERRED_LOG
+
+/* The dead printf() keeps -Wformat checking of every call site */
+#define DLOG(fmt, ...) do { \
+        if (0) printf(fmt, ##__VA_ARGS__); \
+        dlog_write((fmt), NULL, _DLOG_ARGS(__VA_ARGS__)); \
+    } while (0)
+
+#define DLOG_S(fmt, str, ...) do { \
+        if (0) printf(fmt, (str), ##__VA_ARGS__); \
+        dlog_write((fmt), (str), _DLOG_ARGS(__VA_ARGS__)); \
+    } while (0)
+
+#else
+
+#define DLOG(fmt, ...)                printf(fmt, ##__VA_ARGS__)
+#define DLOG_S(fmt, str, ...)         printf(fmt, (str), ##__VA_ARGS__)
+
+#endif /* PLUGSAFE_DEFERRED_LOG */
+
+#endif /* DEFERRED_LOG_H */
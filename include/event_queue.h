@@ -0,0 +1,56 @@
+/*
+ * PlugSafe Inter-Core Event Queue
+ * Lock-free single-producer/single-consumer ring (core 1 -> core 0)
+ * Copyright (c) 2026
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Configuration */
+#define EVENT_QUEUE_SIZE              32    /* Entries (must be a power of two) */
+
+/* Event types raised by the USB/analysis core */
+typedef enum {
+    CORE_EVENT_DEVICE_MOUNTED = 0,    /* Device enumerated (descriptors ready) */
+    CORE_EVENT_DEVICE_UNMOUNTED = 1,  /* Device disconnected */
+    CORE_EVENT_HID_MOUNTED = 2,       /* HID interface mounted (arg = protocol) */
+    CORE_EVENT_THREAT_CHANGED = 3,    /* Threat level changed (arg = new level) */
+    CORE_EVENT_FLOOD_SUSPECT = 4      /* Report flood detected */
+} core_event_type_e;
+
+/* Queued event */
+typedef struct {
+    uint8_t type;                     /* core_event_type_e */
+    uint8_t dev_addr;                 /* TinyUSB device address */
+    uint16_t arg;                     /* Event-specific argument */
+    uint32_t time_ms;                 /* Time the event was raised */
+} core_event_t;
+
+/* Reset the queue (call before launching core 1) */
+void event_queue_init(void);
+
+/* Producer side (core 1 only): stage an event for the next commit. Returns
+ * false and counts a drop when full. */
+bool event_queue_push(core_event_type_e type, uint8_t dev_addr, uint16_t arg);
+
+/* Producer side (core 1 only): make the staged events visible to core 0
+ * and wake it. Called after state_snapshot_publish(), so core 0 never sees
+ * an event before the snapshot that shows it. */
+void event_queue_commit(void);
+
+/* Consumer side (core 0 only): returns false when empty */
+bool event_queue_pop(core_event_t *event);
+
+/* Events dropped because the queue was full */
+uint32_t event_queue_get_dropped(void);
+
+#endif /* EVENT_QUEUE_H */
@@ -0,0 +1,53 @@
+/*
+ * PlugSafe Flash Store
+ * Reserved flash regions and multicore-safe erase/program
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico.h"
+
+/* Flash geometry (matches hardware/flash.h) */
+#define FLASH_STORE_SECTOR_SIZE       4096u /* Erase unit */
+#define FLASH_STORE_PAGE_SIZE         256u  /* Program unit */
+
+/* Reserved regions at the top of flash. Offsets are from the
+ * start of flash, not XIP addresses. The firmware image must end below
+ * the lowest region (checked by flash_store_init()). */
+#define FLASH_STORE_FORENSIC_SIZE     (16u * 1024u)
+#define FLASH_STORE_FORENSIC_OFFSET   (PICO_FLASH_SIZE_BYTES - FLASH_STORE_FORENSIC_SIZE)
+#define FLASH_STORE_JOURNAL_SIZE      (64u * 1024u)
+#define FLASH_STORE_JOURNAL_OFFSET    (FLASH_STORE_FORENSIC_OFFSET - FLASH_STORE_JOURNAL_SIZE)
+#define FLASH_STORE_REGION_START      FLASH_STORE_JOURNAL_OFFSET
+
+/* How long to wait for the other core to park before giving up */
+#define FLASH_STORE_LOCKOUT_TIMEOUT_MS 100
+
+/* Check the region layout against the firmware image. Erase and program
+ * are refused until this has succeeded. */
+bool flash_store_init(void);
+
+/* Call once on core 1 so the other core can park it during flash writes */
+void flash_store_core1_init(void);
+
+/* Erase whole sectors. Both cores stop executing from flash meanwhile
+ * (about 45 ms per sector), so call this in small steps. */
+bool flash_store_erase(uint32_t offset, size_t len);
+
+/* Program whole pages from RAM (data must not point into flash) */
+bool flash_store_program(uint32_t offset, const void *data, size_t len);
+
+/* Memory-mapped (XIP) view of flash at offset */
+const uint8_t *flash_store_read_ptr(uint32_t offset);
+
+#endif /* FLASH_STORE_H */
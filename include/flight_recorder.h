@@ -0,0 +1,100 @@
+/*
+ * PlugSafe Flight Recorder
+ * Pre-trigger capture of raw HID reports and descriptors for flagged devices
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Configuration */
+#define FR_MAX_DEVICES                4     /* Devices with a saved device descriptor */
+#define FR_MAX_INTERFACES             6     /* Recorded HID interfaces */
+#define FR_REPORTS_PER_ITF            64    /* Pre-trigger history per interface */
+#define FR_REPORT_BYTES               16    /* Bytes kept per report (longer ones truncated) */
+#define FR_REPORT_DESC_MAX            256   /* Report descriptor bytes kept */
+#define FR_PERSIST_PAGES_PER_STEP     8     /* Flash pages programmed per persist step */
+#define FR_ERASE_QUIET_MS             1000  /* Erase a slot only after this long without HID reports */
+
+/* Forensic slots in flash (FLASH_STORE_FORENSIC_*). Each slot holds a
+ * header page followed by one hid_trace capture. */
+#define FR_FLASH_SLOTS                2
+#define FR_SLOT_SIZE                  (8u * 1024u)
+#define FR_SLOT_SECTORS               (FR_SLOT_SIZE / 4096u)
+#define FR_SLOT_DATA_OFFSET           256u  /* Capture starts after the header page */
+#define FR_CAPTURE_MAX                (FR_SLOT_SIZE - FR_SLOT_DATA_OFFSET)
+
+#define FR_SLOT_MAGIC                 0x52465350u  /* "PSFR" */
+#define FR_SLOT_VERSION               1
+
+/* Slot header, programmed last so a slot only becomes valid once the
+ * capture behind it is complete. Shared with host tools. */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                   /* FR_SLOT_MAGIC */
+    uint16_t version;                 /* FR_SLOT_VERSION */
+    uint16_t header_size;             /* sizeof(fr_slot_header_t) */
+    uint32_t seq;                     /* Capture number, highest is newest */
+    uint32_t capture_len;             /* hid_trace bytes at FR_SLOT_DATA_OFFSET */
+    uint32_t capture_crc;             /* CRC-32 of the capture */
+    uint32_t trigger_time_ms;         /* Device uptime at the verdict */
+    uint8_t dev_addr;                 /* Flagged device */
+    uint8_t level;                    /* threat_level_e at the trigger */
+    uint8_t reason;                   /* tlm_verdict_reason_e */
+    uint8_t reserved;
+    uint32_t header_crc;              /* CRC-32 of the fields above */
+} fr_slot_header_t;
+
+/* Recorder statistics */
+typedef struct {
+    uint32_t reports_recorded;
+    uint32_t reports_truncated;       /* Longer than FR_REPORT_BYTES */
+    uint32_t captures;                /* Triggers that produced a capture */
+    uint32_t captures_missed;         /* Triggers while a capture was still being saved */
+    uint32_t captures_saved;          /* Captures written to flash */
+    uint32_t flash_errors;
+} fr_stats_t;
+
+/* Reset the rings and find the newest saved capture (core 0, before
+ * launching core 1) */
+void flight_recorder_init(void);
+
+/* Register a device / HID interface (core 1, from the mount callbacks) */
+void flight_recorder_add_device(uint8_t dev_addr, const uint8_t *desc_device);
+void flight_recorder_add_interface(uint8_t dev_addr, uint8_t instance, uint8_t protocol,
+                                   const uint8_t *desc_report, uint16_t desc_len);
+
+/* Forget a device and its interfaces (core 1) */
+void flight_recorder_remove_device(uint8_t dev_addr);
+
+/* Hot path: copy a report into its interface ring (core 1) */
+void flight_recorder_record(uint8_t dev_addr, uint8_t instance,
+                            const uint8_t *report, uint16_t len, uint64_t time_us);
+
+/* Freeze the device's rings for a capture (core 1). Only flags the rings
+ * and copies the device record; core 0 merges and serializes them in its
+ * next persist step, and recording for the device resumes after that.
+ * Returns false if a previous capture is still being saved or the device
+ * is unknown. */
+bool flight_recorder_trigger(uint8_t dev_addr, uint8_t level, uint8_t reason);
+
+/* One bounded flash step (core 0): save a pending capture, or erase the
+ * next slot ahead of time while USB is quiet. Sector erases wait for USB
+ * to be quiet in either case. Returns true if the step used this run
+ * (flash written or a capture prepared), false when idle or waiting. */
+bool flight_recorder_persist_step(uint32_t now_ms);
+
+/* Print the saved slots (core 0) */
+void flight_recorder_print_slots(void);
+
+const fr_stats_t *flight_recorder_get_stats(void);
+
+#endif /* FLIGHT_RECORDER_H */
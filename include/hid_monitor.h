@@ -25,20 +25,35 @@ typedef struct {
     uint8_t dev_addr;
     uint32_t total_reports;           /* Total HID reports received */
     uint32_t reports_this_second;     /* Reports in current 1-second window */
+    uint32_t key_reports_this_window; /* Reports in the window with any key/usage byte set */
     uint64_t last_window_start_ms;    /* Start time of current window */
     uint32_t peak_rate_hz;            /* Peak keystroke rate seen */
     uint32_t current_rate_hz;         /* Current keystroke rate */
+    uint64_t last_report_us;          /* Arrival time of the previous report */
+    uint16_t last_frame;              /* USB frame number of the previous report */
+    uint32_t last_interval_us;        /* Inter-arrival time of the last two reports */
+    uint32_t min_interval_us;         /* Shortest inter-arrival time seen */
+    uint32_t jitter_us;               /* Smoothed inter-arrival jitter (RFC 3550 style) */
     bool is_monitoring;               /* Currently monitoring this device */
 } hid_monitor_t;
 
+/* Detection tuning. hid_monitor_init() loads the defaults above; the host
+ * detection benchmark overrides them to sweep thresholds and windows. */
+typedef struct {
+    uint32_t threshold_hz;            /* Window rate above which a device is spammy */
+    uint32_t window_ms;               /* Rate measurement window */
+} hid_monitor_tuning_t;
+
 /* Initialize HID monitor */
 void hid_monitor_init(void);
 
 /* Register a HID device for monitoring */
 void hid_monitor_add_device(uint8_t dev_addr);
 
-/* Process HID report and update keystroke rate */
-void hid_monitor_report(uint8_t dev_addr, const uint8_t *report, uint16_t len);
+/* Process HID report and update keystroke rate.
+ * arrival_us/frame are the transfer-completion stamp taken in the USB IRQ. */
+void hid_monitor_report(uint8_t dev_addr, const uint8_t *report, uint16_t len,
+                        uint64_t arrival_us, uint16_t frame);
 
 /* Get keystroke rate for a device (keys/sec) */
 uint32_t hid_get_keystroke_rate(uint8_t dev_addr);
@@ -46,6 +61,12 @@ uint32_t hid_get_keystroke_rate(uint8_t dev_addr);
 /* Check if keystroke rate is spammy/malicious */
 bool hid_is_spammy(uint8_t dev_addr);
 
+/* Replace the detection tuning (takes effect at the next window boundary) */
+void hid_monitor_set_tuning(const hid_monitor_tuning_t *tuning);
+
+/* Current detection tuning */
+const hid_monitor_tuning_t *hid_monitor_get_tuning(void);
+
 /* Remove device from monitoring */
 void hid_monitor_remove_device(uint8_t dev_addr);
 
@@ -0,0 +1,132 @@
+/*
+ * PlugSafe HID Trace Format
+ * Compact capture of USB descriptors and timestamped HID reports
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef HID_TRACE_H
+#define HID_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * File layout (all multi-byte fields little-endian):
+ *
+ *   header   "PSHT", version, flags, reserved[2], start_time_ms (u32)
+ *   records  type (u8) followed by a type-specific body:
+ *
+ *   HT_REC_DEVICE     dev_addr, device descriptor[18],
+ *                     3 x (len u8, UTF-8 bytes): manufacturer, product, serial
+ *   HT_REC_INTERFACE  itf_id, dev_addr, instance, protocol,
+ *                     desc_len (u16), report descriptor[desc_len]
+ *   HT_REC_REPORT     itf_id, delta_us (LEB128 varint), len (u8), report[len]
+ *   HT_REC_END        (no body)
+ *
+ * Devices and interfaces come before the reports that use them. Reports are
+ * in arrival order across interfaces; delta_us is relative to the previous
+ * report of the same interface (the first one to the trace start). The
+ * format is shared by the firmware and host tools: no SDK dependencies.
+ */
+
+#define HT_MAGIC                      "PSHT"
+#define HT_VERSION                    1
+#define HT_HEADER_SIZE                12
+
+#define HT_MAX_INTERFACES             16    /* itf_id range */
+#define HT_MAX_REPORT                 64    /* Longest report (CFG_TUH_HID_EPIN_BUFSIZE) */
+#define HT_MAX_REPORT_DESC            1024
+#define HT_STRING_MAX                 64    /* Incl. NUL when decoded */
+#define HT_DEVICE_DESC_SIZE           18
+
+/* Worst-case encoded size of a report record (delta below 2^35 us) */
+#define HT_REPORT_RECORD_MAX(len)     (1 + 1 + 5 + 1 + (len))
+
+typedef enum {
+    HT_REC_END = 0,
+    HT_REC_DEVICE = 1,
+    HT_REC_INTERFACE = 2,
+    HT_REC_REPORT = 3
+} hid_trace_rec_type_e;
+
+typedef struct {
+    uint8_t dev_addr;
+    uint8_t desc_device[HT_DEVICE_DESC_SIZE]; /* Raw device descriptor */
+    char manufacturer[HT_STRING_MAX];
+    char product[HT_STRING_MAX];
+    char serial[HT_STRING_MAX];
+} hid_trace_device_t;
+
+typedef struct {
+    uint8_t itf_id;                   /* Trace-local interface number */
+    uint8_t dev_addr;
+    uint8_t instance;                 /* TinyUSB HID instance */
+    uint8_t protocol;                 /* 0 none, 1 keyboard, 2 mouse */
+    uint16_t desc_len;
+    const uint8_t *desc;              /* Report descriptor */
+} hid_trace_interface_t;
+
+typedef struct {
+    uint8_t itf_id;
+    uint8_t len;
+    uint64_t time_us;                 /* Since trace start */
+    const uint8_t *data;
+} hid_trace_report_t;
+
+/* One decoded record; pointers refer into the reader's buffer */
+typedef struct {
+    hid_trace_rec_type_e type;
+    union {
+        hid_trace_device_t device;
+        hid_trace_interface_t itf;
+        hid_trace_report_t report;
+    };
+} hid_trace_record_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;                    /* A write did not fit; trace is invalid */
+    uint64_t last_us[HT_MAX_INTERFACES];
+} hid_trace_writer_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    uint8_t version;
+    uint32_t start_time_ms;           /* Source uptime at trace time 0 */
+    uint64_t last_us[HT_MAX_INTERFACES];
+} hid_trace_reader_t;
+
+/* Start a trace in buf (writes the header) */
+void hid_trace_writer_init(hid_trace_writer_t *w, uint8_t *buf, size_t cap,
+                           uint32_t start_time_ms);
+
+/* Append records. Return false (and set overflow) when out of space. */
+bool hid_trace_write_device(hid_trace_writer_t *w, const hid_trace_device_t *dev);
+bool hid_trace_write_interface(hid_trace_writer_t *w, const hid_trace_interface_t *itf);
+bool hid_trace_write_report(hid_trace_writer_t *w, uint8_t itf_id, uint64_t time_us,
+                            const uint8_t *data, uint8_t len);
+
+/* Append HT_REC_END. Returns the trace length, or 0 if anything overflowed. */
+size_t hid_trace_finish(hid_trace_writer_t *w);
+
+/* Check the header and prepare to read records */
+bool hid_trace_reader_init(hid_trace_reader_t *r, const uint8_t *data, size_t len);
+
+/* Decode the next record. Returns false on a malformed or truncated trace;
+ * HT_REC_END is returned (true) once, then false. */
+bool hid_trace_next(hid_trace_reader_t *r, hid_trace_record_t *rec);
+
+/* CRC-32 (IEEE 802.3, reflected, as used by zlib) */
+uint32_t hid_trace_crc32(const void *data, size_t len);
+
+#endif /* HID_TRACE_H */
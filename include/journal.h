@@ -0,0 +1,61 @@
+/*
+ * PlugSafe Event Journal
+ * Log-structured, wear-leveled record of device events that survives reboots
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "journal_format.h"
+
+/* Configuration */
+#define JOURNAL_RING_SIZE             16    /* Queued records (must be a power of two) */
+#define JOURNAL_PRODUCER_CORE         1     /* Core whose records are queued */
+#define JOURNAL_FLUSH_INTERVAL_MS     2000  /* Longest a record waits in RAM */
+#define JOURNAL_COUNTERS_INTERVAL_MS  (15u * 60u * 1000u)  /* Counter snapshot period */
+#define JOURNAL_ERASE_QUIET_MS        1000  /* Pre-erase only after this long without HID reports */
+
+/* Journal statistics */
+typedef struct {
+    uint32_t boot;                    /* This boot's number */
+    uint32_t records;                 /* Records staged for flash this boot */
+    uint32_t dropped;                 /* Lost: ring full or flash busy */
+    uint32_t torn;                    /* Torn records skipped at recovery */
+    uint32_t pages_programmed;
+    uint32_t sectors_erased;
+    uint32_t flash_errors;
+} journal_stats_t;
+
+/* Find the newest sector and its tail, and queue this boot's BOOT record
+ * (core 0, after flash_store_init() succeeded, before launching core 1).
+ * Until this is called the journal discards everything. */
+void journal_init(void);
+
+/* Record an event. On the producer core it is queued; on core 0 it goes
+ * straight into the page buffer. */
+void journal_append(journal_rec_type_e type, const void *payload, size_t len);
+
+/* Move queued records into the page buffer and do at most one flash
+ * operation: program the buffered page when it is full or its oldest
+ * record is due, or erase the next sector while USB is quiet (core 0).
+ * Sectors are never erased while HID reports are arriving; if the journal
+ * runs out of erased space first, records wait and then drop. Returns true
+ * if flash was written. */
+bool journal_step(uint32_t now_ms);
+
+/* Print the journal position and statistics (core 0) */
+void journal_print_status(void);
+
+/* Statistics, with the drops of both cores added up (core 0) */
+const journal_stats_t *journal_get_stats(void);
+
+#endif /* JOURNAL_H */
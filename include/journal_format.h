@@ -0,0 +1,108 @@
+/*
+ * PlugSafe Event Journal Format
+ * On-flash sector and record layout shared by the firmware and host tools
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef JOURNAL_FORMAT_H
+#define JOURNAL_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "telemetry_proto.h"
+
+/*
+ * The journal is a ring of flash sectors written strictly in order. Each
+ * sector starts with a header carrying a sequence number (the newest sector
+ * has the highest), followed by records:
+ *
+ *   len | type | time_ms (u32) | payload[len] | crc16
+ *
+ * CRC-16/CCITT-FALSE over everything before it. Records never cross a page
+ * boundary; an erased len byte (0xFF) means the rest of the page is unused.
+ * A record with a bad CRC was torn by a power loss: readers skip to the next
+ * page. The first erased page start ends the sector's data.
+ */
+
+#define JOURNAL_SECTOR_MAGIC          0x4C4A5350u  /* "PSJL" */
+#define JOURNAL_FORMAT_VERSION        1
+
+#define JOURNAL_SECTOR_SIZE           4096u
+#define JOURNAL_PAGE_SIZE             256u
+#define JOURNAL_SECTOR_DATA_OFFSET    16u   /* First record after the sector header */
+#define JOURNAL_ERASED                0xFF
+
+#define JOURNAL_MAX_PAYLOAD           32
+#define JOURNAL_RECORD_OVERHEAD       8     /* len, type, time_ms, crc16 */
+#define JOURNAL_RECORD_MAX            (JOURNAL_RECORD_OVERHEAD + JOURNAL_MAX_PAYLOAD)
+
+/* Record types. Where a telemetry message carries the same information its
+ * type number and payload layout are reused. */
+typedef enum {
+    JOURNAL_REC_MOUNT = TLM_MSG_MOUNT,            /* tlm_mount_t */
+    JOURNAL_REC_UNMOUNT = TLM_MSG_UNMOUNT,        /* tlm_unmount_t */
+    JOURNAL_REC_VERDICT = TLM_MSG_VERDICT,        /* tlm_verdict_t */
+    JOURNAL_REC_COUNTERS = TLM_MSG_COUNTERS,      /* tlm_counters_t */
+    JOURNAL_REC_BOOT = 0x20,                      /* journal_boot_t */
+    JOURNAL_REC_FINGERPRINT = 0x21                /* journal_fingerprint_t */
+} journal_rec_type_e;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;                   /* JOURNAL_SECTOR_MAGIC */
+    uint32_t seq;                     /* Sector sequence, +1 per sector opened */
+    uint32_t boot;                    /* Boot number when the sector was opened */
+    uint16_t version;                 /* JOURNAL_FORMAT_VERSION */
+    uint16_t crc;                     /* CRC-16 of the fields above */
+} journal_sector_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t boot;                    /* Boot number, +1 per power-up */
+} journal_boot_t;
+
+/* Identity of an enumerated device beyond VID/PID */
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint32_t strings_crc;             /* CRC-32 of manufacturer, product, serial (NUL-separated) */
+    char product[24];                 /* Truncated, NUL-padded */
+} journal_fingerprint_t;
+
+/* Decoded record; payload points into the sector image */
+typedef struct {
+    uint8_t type;                     /* journal_rec_type_e */
+    uint8_t len;
+    uint32_t time_ms;                 /* Uptime in the boot that wrote it */
+    const uint8_t *payload;
+} journal_record_t;
+
+/* Walks the records of one sector image */
+typedef struct {
+    const uint8_t *sector;
+    uint32_t pos;                     /* After the walk: where the next record goes */
+    uint32_t torn;                    /* Records skipped for a bad CRC */
+} journal_reader_t;
+
+/* Check a sector header; on success it is copied to *hdr (may be NULL) */
+bool journal_sector_valid(const uint8_t *sector, journal_sector_header_t *hdr);
+
+/* Fill in a sector header including its CRC */
+void journal_sector_header_init(journal_sector_header_t *hdr, uint32_t seq, uint32_t boot);
+
+/* Encode one record into out (JOURNAL_RECORD_OVERHEAD + len bytes).
+ * Returns the encoded length, 0 if len exceeds JOURNAL_MAX_PAYLOAD. */
+size_t journal_encode_record(uint8_t *out, uint8_t type, uint32_t time_ms,
+                             const void *payload, size_t len);
+
+/* Start walking a sector whose header has been validated */
+void journal_reader_init(journal_reader_t *r, const uint8_t *sector);
+
+/* Decode the next record. Returns false at the end of the sector's data,
+ * leaving r->pos at the first free byte (JOURNAL_SECTOR_SIZE when full). */
+bool journal_reader_next(journal_reader_t *r, journal_record_t *rec);
+
+#endif /* JOURNAL_FORMAT_H */
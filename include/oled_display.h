@@ -18,14 +18,32 @@
 #include "oled_config.h"
 #include "oled_driver.h"
 
+typedef struct oled_display oled_display_t;
+
+/* Completion of oled_display_flush_async() */
+typedef void (*oled_display_flush_cb_t)(oled_display_t *display, bool ok, void *ctx);
+
 /* Display with framebuffer */
-typedef struct {
+struct oled_display {
     oled_driver_t *driver;
     uint8_t *buffer;
     uint8_t width;
     uint8_t height;
     bool dirty;
-} oled_display_t;
+    uint8_t dirty_pages;        /* Bit per page drawn to since the last flush */
+
+    /* Second buffer: the frame oled_display_flush_async() is sending, as
+     * I2C words (allocated on first use) */
+    uint16_t *tx_words;
+    oled_display_flush_cb_t flush_done;
+    void *flush_ctx;
+
+    /* What the panel holds; flushes send only the windows that differ from
+     * it. NULL (allocation failed) or invalid: the next flush sends it all. */
+    uint8_t *shadow;
+    volatile bool shadow_valid;
+    uint32_t flush_bytes;       /* Sent by the last flush, address bytes excluded */
+};
 
 /* Initialize display */
 bool oled_display_init(oled_display_t *display, oled_driver_t *driver);
@@ -39,9 +57,37 @@ void oled_display_clear(oled_display_t *display);
 /* Invert all pixels in framebuffer */
 void oled_display_invert(oled_display_t *display, bool invert);
 
-/* Send framebuffer to display hardware */
+/* Note that rows [y, y + h) were drawn to, for code that writes the
+ * buffer directly; the drawing functions do this themselves */
+void oled_display_mark_dirty(oled_display_t *display, int y, int h);
+
+/* Send the changed windows of the framebuffer to the display */
 bool oled_display_flush(oled_display_t *display);
 
+/* Windows of the framebuffer that differ from what the panel holds: per
+ * page, the first to the last changed column; runs of whole changed pages
+ * are merged. Only pages drawn to since the last flush are compared.
+ * windows needs OLED_PAGES entries. Returns the count. */
+size_t oled_display_dirty_windows(oled_display_t *display, oled_window_t *windows);
+
+/* Forget what the panel holds (e.g. after it was reset), so the next
+ * flush sends the whole frame */
+void oled_display_invalidate(oled_display_t *display);
+
+/* Send the changed windows of the framebuffer from a second buffer, so
+ * drawing never waits on the words of a frame in flight. Waits for the
+ * previous asynchronous flush first. done (may be NULL) is called when the
+ * frame is out. The words are currently sent before returning. Falls back
+ * to oled_display_flush() when the second buffer cannot be allocated. */
+bool oled_display_flush_async(oled_display_t *display,
+                              oled_display_flush_cb_t done, void *ctx);
+
+/* Whether an asynchronous flush is still being sent */
+bool oled_display_flush_busy(oled_display_t *display);
+
+/* Wait for the asynchronous flush in progress; returns its result */
+bool oled_display_flush_wait(oled_display_t *display);
+
 /* Get framebuffer pointer */
 uint8_t *oled_display_get_buffer(oled_display_t *display);
 
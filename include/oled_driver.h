@@ -17,6 +17,27 @@
 #include "oled_config.h"
 #include "oled_i2c.h"
 
+/* Writable bytes oled_driver_write_window() needs in front of the frame
+ * for the addressing commands and control bytes */
+#define OLED_DRIVER_FRAME_HEADROOM    16
+
+/* Longest header (commands and control bytes) in front of window data */
+#define OLED_DRIVER_WINDOW_HEADER     13
+
+/* Room oled_driver_window_words() needs for a frame's worth of windows:
+ * every page as its own window, each with a header */
+#define OLED_DRIVER_WORDS_MAX         (OLED_PAGES * (OLED_DRIVER_WINDOW_HEADER + OLED_WIDTH))
+
+/* Rectangle of display RAM: pages page_start..page_end and columns
+ * col_start..col_end, inclusive. Its bytes are contiguous in a frame when
+ * it spans one page, or whole pages. */
+typedef struct {
+    uint8_t page_start;
+    uint8_t page_end;
+    uint8_t col_start;
+    uint8_t col_end;
+} oled_window_t;
+
 /* OLED Driver state */
 typedef struct {
     oled_i2c_t *i2c;
@@ -56,6 +77,40 @@ bool oled_driver_set_column(oled_driver_t *driver, uint8_t col);
 bool oled_driver_write_pixel_data(oled_driver_t *driver, 
                                   const uint8_t *data, size_t len);
 
+/* Set the SSD1306 column/page window (0x21/0x22); horizontal addressing
+ * then wraps writes inside it. Not available on the SH1106. */
+bool oled_driver_set_window(oled_driver_t *driver, uint8_t col_start, uint8_t col_end,
+                            uint8_t page_start, uint8_t page_end);
+
+/* Send a window's bytes of frame (a contiguous window). Sent in place:
+ * the header goes in the bytes just before the window's data, which are
+ * restored afterwards, so frame must be preceded by
+ * OLED_DRIVER_FRAME_HEADROOM writable bytes.
+ * SSD1306: one transaction (window commands, then the data).
+ * SH1106: one transaction per page (page and column commands, then data). */
+bool oled_driver_write_window(oled_driver_t *driver, const oled_window_t *window,
+                              uint8_t *frame);
+
+/* Bytes oled_driver_write_window() puts on the bus, address bytes excluded */
+size_t oled_driver_window_bytes(oled_driver_t *driver, const oled_window_t *window);
+
+/* oled_driver_write_window() for the whole frame */
+bool oled_driver_write_frame(oled_driver_t *driver, uint8_t *frame);
+
+/* Build the I2C words (see oled_i2c_write_async) that send a window of
+ * frame, in the same transactions as oled_driver_write_window(). Any
+ * window works: its rows are gathered. Returns the number of words. */
+size_t oled_driver_window_words(oled_driver_t *driver, const oled_window_t *window,
+                                const uint8_t *frame, uint16_t *words);
+
+/* oled_driver_window_words() for the whole frame (OLED_DRIVER_WORDS_MAX
+ * entries is always enough) */
+size_t oled_driver_frame_words(oled_driver_t *driver, const uint8_t *frame, uint16_t *words);
+
+/* Start sending words built by oled_driver_window_words() */
+bool oled_driver_write_words_async(oled_driver_t *driver, const uint16_t *words, size_t count,
+                                   oled_i2c_done_cb_t done, void *ctx);
+
 /* Power control */
 bool oled_driver_power_on(oled_driver_t *driver);
 bool oled_driver_power_off(oled_driver_t *driver);
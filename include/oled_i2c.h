@@ -21,6 +21,19 @@
 #define OLED_I2C_CTRL_CMD   0x00    /* Control byte for command data */
 #define OLED_I2C_CTRL_DATA  0x40    /* Control byte for pixel data */
 
+/* Largest payload oled_i2c_write_raw() sends per transaction; it stages
+ * the control byte and payload in a stack buffer of this size + 1 */
+#define OLED_I2C_STAGING_SIZE   32
+
+/* Asynchronous writes are sequences of IC_DATA_CMD words: a byte in the
+ * low 8 bits, OLED_I2C_WORD_STOP on the last byte of each transaction. The
+ * next word starts a new transaction to the same address. */
+#define OLED_I2C_WORD_STOP  0x0200
+
+/* Completion of an asynchronous write; ok is false when the device did
+ * not acknowledge */
+typedef void (*oled_i2c_done_cb_t)(bool ok, void *ctx);
+
 /* I2C configuration and state */
 typedef struct {
     i2c_inst_t *i2c;        /* Pico I2C instance (i2c0 or i2c1) */
@@ -28,6 +41,12 @@ typedef struct {
     uint scl_pin;           /* GPIO pin for SCL */
     uint baudrate;          /* Baud rate in Hz */
     uint8_t address;        /* 7-bit I2C address */
+
+    /* Asynchronous write state (set up by oled_i2c_init) */
+    volatile bool busy;
+    volatile bool ok;       /* Result of the last asynchronous write */
+    oled_i2c_done_cb_t done;
+    void *done_ctx;
 } oled_i2c_t;
 
 /* Initialize I2C hardware */
@@ -39,8 +58,30 @@ bool oled_i2c_write_cmd(oled_i2c_t *i2c, const uint8_t *cmds, size_t len);
 /* Send pixel data */
 bool oled_i2c_write_data(oled_i2c_t *i2c, const uint8_t *data, size_t len);
 
-/* Low-level raw write with control byte */
+/* Low-level raw write with control byte. Payloads longer than
+ * OLED_I2C_STAGING_SIZE go out as consecutive transactions, which suits
+ * pixel data (the RAM pointer carries on); command lists must fit in one. */
 bool oled_i2c_write_raw(oled_i2c_t *i2c, uint8_t ctrl_byte, 
                         const uint8_t *data, size_t len);
 
+/* Send pixel data in one transaction without copying it. data[-1] must be
+ * writable: it is borrowed for the control byte and restored. */
+bool oled_i2c_write_data_in_place(oled_i2c_t *i2c, uint8_t *data, size_t len);
+
+/* Send a complete message (control bytes already in place) as one
+ * transaction, without copying. Waits for an asynchronous write first. */
+bool oled_i2c_write_message(oled_i2c_t *i2c, const uint8_t *msg, size_t len);
+
+/* Send count words (see OLED_I2C_WORD_STOP). The words are sent with
+ * i2c_write_blocking() before returning, and done is called from here.
+ * Returns false if a write is still in progress. */
+bool oled_i2c_write_async(oled_i2c_t *i2c, const uint16_t *words, size_t count,
+                          oled_i2c_done_cb_t done, void *ctx);
+
+/* Whether an asynchronous write is in progress */
+bool oled_i2c_busy(const oled_i2c_t *i2c);
+
+/* Wait for the asynchronous write in progress, if any; returns its result */
+bool oled_i2c_wait(oled_i2c_t *i2c);
+
 #endif /* OLED_I2C_H */
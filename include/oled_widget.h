@@ -0,0 +1,74 @@
+/*
+ * OLED Widgets
+ * Retained-mode labels, values, bars and icons bound to application state
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef OLED_WIDGET_H
+#define OLED_WIDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "oled_display.h"
+#include "oled_text.h"
+
+/* Longest text a value widget shows, NUL included */
+#define OLED_WIDGET_TEXT_MAX          24
+
+/* Widget kinds */
+typedef enum {
+    OLED_WIDGET_LABEL,          /* Fixed text */
+    OLED_WIDGET_VALUE,          /* Text formatted from the model */
+    OLED_WIDGET_BAR,            /* Horizontal bar filled to a level from the model */
+    OLED_WIDGET_ICON            /* One of a set of bitmaps, picked by the model */
+} oled_widget_type_e;
+
+/* Bindings: read a widget's value out of the model passed to
+ * oled_screen_update() (a state snapshot, say) */
+typedef void (*oled_widget_text_fn)(const void *model, char *out, size_t size);
+typedef uint32_t (*oled_widget_level_fn)(const void *model);
+
+/* A widget owns the rectangle (x, y, w, h): it is cleared and redrawn as a
+ * whole when the bound value changes, and nothing else draws into it */
+typedef struct {
+    oled_widget_type_e type;
+    int16_t x;
+    int16_t y;
+    uint8_t w;
+    uint8_t h;
+
+    const char *text;                   /* LABEL */
+    oled_widget_text_fn text_fn;        /* VALUE */
+    oled_widget_level_fn level_fn;      /* BAR: 0..max; ICON: index into icons */
+    uint32_t max;                       /* BAR: full scale; ICON: number of icons */
+    const uint8_t *const *icons;        /* ICON: w x h bitmaps, page format */
+
+    /* What is on the framebuffer now */
+    bool drawn;
+    uint32_t level;
+    char shown[OLED_WIDGET_TEXT_MAX];
+} oled_widget_t;
+
+/* A screen: the widgets drawn together, in one font */
+typedef struct {
+    oled_widget_t *widgets;
+    size_t count;
+    const oled_font_t *font;
+} oled_screen_t;
+
+/* Forget what the widgets show, so the next update draws them all (after
+ * the framebuffer was cleared or drawn over) */
+void oled_screen_invalidate(oled_screen_t *screen);
+
+/* Redraw the widgets whose bound value differs from what they show.
+ * Untouched widgets cost a binding call and a compare; nothing is drawn
+ * and no page is marked dirty for them. Returns the number redrawn. */
+size_t oled_screen_update(oled_screen_t *screen, oled_display_t *display, const void *model);
+
+#endif /* OLED_WIDGET_H */
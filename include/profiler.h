@@ -0,0 +1,112 @@
+/*
+ * PlugSafe Latency Profiler
+ * Named probes feeding log2 latency histograms, plus stack high-water marks
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "timebase.h"
+#include "trace.h"
+
+/* Build switch: 0 compiles every PROFILE_SCOPE() out (set by CMake) */
+#ifndef PLUGSAFE_PROFILING
+#define PLUGSAFE_PROFILING            0
+#endif
+
+/* Configuration */
+#define PROFILER_BUCKETS              24    /* log2 buckets: 0us, 1us, 2-3us, ... 4.2s+ */
+#define PROFILER_STACK_PAINT          0x5AFE57ACu
+#define PROFILER_STACK_GUARD_WORDS    32    /* Left unpainted below the live SP */
+
+/* Probe points. Each probe must only be hit from one core. The IDs are also
+ * the first trace points (trace_points.h). */
+typedef enum {
+    PROBE_USB_TASK = 0,               /* usb_host_task() (core 1) */
+    PROBE_ANALYSIS_TASK,              /* usb_host_analysis_task() (core 1) */
+    PROBE_TUH_MOUNT_CB,               /* tuh_mount_cb(), incl. sync descriptor reads */
+    PROBE_TUH_UMOUNT_CB,              /* tuh_umount_cb() */
+    PROBE_HID_MOUNT_CB,               /* tuh_hid_mount_cb() */
+    PROBE_HID_REPORT_CB,              /* tuh_hid_report_received_cb() */
+    PROBE_STATS_PRINT,                /* usb_host_print_stats() printf burst */
+    PROBE_DISPLAY_DRAW,               /* Page rendering into the framebuffer (core 0) */
+    PROBE_DISPLAY_FLUSH,              /* oled_display_flush_async() start (core 0) */
+    PROBE_COUNT
+} profiler_probe_e;
+
+/* Latency histogram for one probe */
+typedef struct {
+    uint32_t count;                   /* Samples recorded */
+    uint32_t min_us;                  /* Shortest sample */
+    uint32_t max_us;                  /* Longest sample */
+    uint64_t total_us;                /* Sum of samples */
+    uint32_t buckets[PROFILER_BUCKETS]; /* bucket b > 0 holds [2^(b-1), 2^b) us */
+} profiler_histogram_t;
+
+/* Stack usage for one core */
+typedef struct {
+    uint32_t size_bytes;              /* Registered stack size */
+    uint32_t high_water_bytes;        /* Deepest use seen (from paint) */
+    bool registered;
+} profiler_stack_info_t;
+
+/* Reset all histograms */
+void profiler_init(void);
+
+/* Record one sample (normally via PROFILE_SCOPE) */
+void profiler_record(profiler_probe_e probe, uint32_t elapsed_us);
+
+/* Histogram for one probe, or NULL for an invalid probe */
+const profiler_histogram_t* profiler_get_histogram(profiler_probe_e probe);
+
+/* Estimated percentile (0-100) in microseconds, interpolated within a bucket */
+uint32_t profiler_percentile_us(const profiler_histogram_t *hist, uint8_t percentile);
+
+/* Register and paint a core's stack. Only the part below the caller's frame
+ * is painted when called on the stack being registered. */
+void profiler_register_stack(uint8_t core, uint32_t *bottom, size_t size_bytes);
+
+/* Stack usage for core 0 or 1 (high-water mark is recomputed on each call) */
+const profiler_stack_info_t* profiler_get_stack_info(uint8_t core);
+
+/* Print every histogram and stack high-water mark to stdio (UART) */
+void profiler_dump(void);
+
+/* Clear all histograms (stack paint is kept) */
+void profiler_reset(void);
+
+#if PLUGSAFE_PROFILING
+
+typedef struct {
+    uint8_t probe;
+    uint32_t start_us;
+} profiler_scope_t;
+
+static inline void profiler_scope_end(profiler_scope_t *scope) {
+    uint32_t elapsed_us = timebase_now_us32() - scope->start_us;
+    profiler_record((profiler_probe_e)scope->probe, elapsed_us);
+    trace_span(scope->probe, 0, scope->start_us, elapsed_us);
+}
+
+/* Time from here to the end of the enclosing block, early returns included.
+ * The sample also becomes a trace span while tracing is enabled. */
+#define PROFILE_SCOPE(probe) \
+    profiler_scope_t _profile_scope __attribute__((cleanup(profiler_scope_end))) = \
+        { (uint8_t)(probe), timebase_now_us32() }
+
+#else
+
+#define PROFILE_SCOPE(probe)          do { } while (0)
+
+#endif /* PLUGSAFE_PROFILING */
+
+#endif /* PROFILER_H */
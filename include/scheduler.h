@@ -0,0 +1,95 @@
+/*
+ * PlugSafe Cooperative Task Scheduler
+ * Deadline-ordered run-to-completion tasks, one scheduler per core
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Configuration */
+#define SCHEDULER_MAX_TASKS           8     /* Tasks per scheduler instance */
+#define SCHEDULER_NEVER               UINT64_MAX
+
+/* Task body. now_us is the dispatch time. */
+typedef void (*scheduler_task_fn)(void *ctx, uint64_t now_us);
+
+/* Called before every dispatch decision; may trigger tasks (e.g. on events) */
+typedef void (*scheduler_poll_fn)(void *ctx);
+
+/* Task registration parameters */
+typedef struct {
+    const char *name;                 /* Short name for stats output */
+    scheduler_task_fn fn;             /* Task body */
+    void *ctx;                        /* Passed to fn */
+    uint32_t period_ms;               /* Run interval, 0 = only when triggered */
+    uint32_t deadline_ms;             /* Allowed start lateness, 0 = period */
+    uint8_t priority;                 /* 0 = most urgent; breaks ties between due tasks */
+} scheduler_task_config_t;
+
+/* Per-task run statistics */
+typedef struct {
+    uint32_t runs;                    /* Completed runs */
+    uint32_t deadline_misses;         /* Runs started later than deadline_ms */
+    uint32_t last_run_us;             /* Duration of the latest run */
+    uint32_t max_run_us;              /* Longest run */
+    uint64_t total_run_us;            /* Sum of run durations */
+    uint32_t max_lateness_us;         /* Worst start delay after becoming due */
+} scheduler_task_stats_t;
+
+/* Registered task */
+typedef struct {
+    scheduler_task_config_t config;
+    uint64_t next_run_us;             /* Heap key: release time */
+    uint64_t release_us;              /* When the pending run became due */
+    uint8_t heap_index;               /* Position in scheduler_t.heap */
+    scheduler_task_stats_t stats;
+} scheduler_task_t;
+
+/* Scheduler instance. Not thread-safe: register, trigger and run on one core;
+ * other cores and IRQs signal work through the poll hook. */
+typedef struct {
+    scheduler_task_t tasks[SCHEDULER_MAX_TASKS];
+    uint8_t heap[SCHEDULER_MAX_TASKS];  /* Task ids, min-heap on (next_run_us, priority) */
+    uint8_t task_count;
+    scheduler_poll_fn poll;
+    void *poll_ctx;
+} scheduler_t;
+
+/* Reset an instance */
+void scheduler_init(scheduler_t *sched);
+
+/* Register a task; returns its id or -1 when full. Periodic tasks first run
+ * one period after registration. */
+int scheduler_add_task(scheduler_t *sched, const scheduler_task_config_t *config);
+
+/* Install the poll hook run before each dispatch and before sleeping */
+void scheduler_set_poll(scheduler_t *sched, scheduler_poll_fn poll, void *ctx);
+
+/* Make a task due now (ahead of timer-released tasks) */
+void scheduler_trigger(scheduler_t *sched, int task_id);
+
+/* Run at most one due task; returns false when nothing was due */
+bool scheduler_run_once(scheduler_t *sched);
+
+/* Earliest release time of any task (SCHEDULER_NEVER when none) */
+uint64_t scheduler_next_deadline_us(const scheduler_t *sched);
+
+/* Dispatch forever, sleeping in WFE until the next release or a wake event */
+void scheduler_run(scheduler_t *sched) __attribute__((noreturn));
+
+/* Statistics for one task, or NULL for an invalid id */
+const scheduler_task_stats_t* scheduler_get_task_stats(const scheduler_t *sched, int task_id);
+
+/* Print per-task run time and deadline misses */
+void scheduler_print_stats(const scheduler_t *sched, const char *label);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,54 @@
+/*
+ * PlugSafe State Snapshots
+ * Seqlock-protected, versioned copies of device/threat state for readers
+ * Copyright (c) 2026
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_host.h"
+#include "threat_analyzer.h"
+
+/* Configuration */
+#define SNAPSHOT_MAX_DEVICES          4     /* Matches MAX_DEVICES in usb_host.c */
+#define SNAPSHOT_READ_RETRIES         64    /* Reader retries before giving up */
+
+/* Consistent view of one connected device */
+typedef struct {
+    usb_device_info_t device;         /* Copy of the live device record */
+    threat_level_e threat_level;      /* Current threat classification */
+    uint32_t hid_reports_per_sec;     /* Current keystroke rate (keys/sec) */
+    bool flood_suspect;               /* HID report flood / DoS suspect */
+} device_snapshot_t;
+
+/* Consistent view of the whole USB/threat state */
+typedef struct {
+    uint32_t version;                 /* Even sequence number this copy was taken at */
+    uint8_t device_count;             /* Valid entries in devices[] */
+    bool hub_connected;               /* USB hub warning state */
+    device_snapshot_t devices[SNAPSHOT_MAX_DEVICES];
+} system_snapshot_t;
+
+/* Reset snapshot state (call before the writer core starts) */
+void state_snapshot_init(void);
+
+/* Writer side (USB core only): rebuild the snapshot from live state */
+void state_snapshot_publish(void);
+
+/* Reader side (any core, lock-free): copy a consistent snapshot.
+ * Must not be called from an IRQ on the writer core. Returns false if the
+ * copy was torn SNAPSHOT_READ_RETRIES times in a row. */
+bool state_snapshot_read(system_snapshot_t *out);
+
+/* Current published version (changes on every publish) */
+uint32_t state_snapshot_get_version(void);
+
+#endif /* STATE_SNAPSHOT_H */
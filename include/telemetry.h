@@ -0,0 +1,54 @@
+/*
+ * PlugSafe Binary Telemetry
+ * Structured events from the USB core, framed and sent from core 0
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "telemetry_proto.h"
+
+/* Configuration */
+#define TLM_RING_SIZE                 32    /* Queued messages (must be a power of two) */
+#define TLM_PRODUCER_CORE             1     /* Core whose messages are queued */
+#define TLM_DRAIN_BATCH               8     /* Frames sent per telemetry task run */
+#define TLM_COUNTERS_INTERVAL_MS      5000  /* TLM_MSG_COUNTERS period */
+#define TLM_TRACE_FRAMES_PER_DRAIN    1     /* TLM_MSG_TRACE frames per drain (UART budget) */
+
+/* Reset the ring (call before launching core 1). Starts disabled. */
+void telemetry_init(void);
+
+/* Enable or disable the stream; enabling sends TLM_MSG_HELLO */
+void telemetry_set_enabled(bool enabled);
+bool telemetry_is_enabled(void);
+
+/* Emit one message. On the producer core it is queued; on core 0 it is
+ * framed and written immediately. No-op while disabled. */
+void telemetry_emit(tlm_msg_type_e type, const void *payload, size_t len);
+
+/* Frame and send up to max_msgs queued messages, plus TLM_MSG_COUNTERS when
+ * due and up to TLM_TRACE_FRAMES_PER_DRAIN trace batches (consumer core
+ * only). Returns the number of frames sent. */
+uint32_t telemetry_drain(uint32_t max_msgs);
+
+/* Messages dropped because the ring was full */
+uint32_t telemetry_get_dropped(void);
+
+/* Current drop and latency counters (the TLM_MSG_COUNTERS payload) */
+void telemetry_get_counters(tlm_counters_t *out);
+
+/* Convenience emitters used by the USB core */
+void telemetry_emit_verdict(uint8_t dev_addr, uint8_t level, tlm_verdict_reason_e reason,
+                            bool flood_suspect, uint32_t rate_hz);
+void telemetry_emit_string(uint8_t dev_addr, tlm_string_kind_e kind, const char *text);
+
+#endif /* TELEMETRY_H */
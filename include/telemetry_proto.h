@@ -0,0 +1,184 @@
+/*
+ * PlugSafe Telemetry Wire Protocol
+ * Framing, CRC and message layouts shared by the firmware and host tools
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TELEMETRY_PROTO_H
+#define TELEMETRY_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Frame on the wire:
+ *
+ *   0x00 | COBS( header | payload | crc16 ) | 0x00
+ *
+ * The leading delimiter ends any text that was printed before the frame, so
+ * frames and plain log lines can share one UART. The CRC is CRC-16/CCITT-FALSE
+ * over header and payload, little-endian. All multi-byte fields are
+ * little-endian; the structs below are the exact byte layouts.
+ */
+
+/* Protocol version carried in every frame; bump on any layout change */
+#define TLM_PROTO_VERSION             1
+
+#define TLM_FRAME_DELIMITER           0x00
+#define TLM_MAX_PAYLOAD               72
+#define TLM_HEADER_SIZE               8
+#define TLM_CRC_SIZE                  2
+#define TLM_MAX_RAW_FRAME             (TLM_HEADER_SIZE + TLM_MAX_PAYLOAD + TLM_CRC_SIZE)
+#define TLM_MAX_ENCODED_FRAME         (TLM_MAX_RAW_FRAME + TLM_MAX_RAW_FRAME / 254 + 1)
+
+/* Message types */
+typedef enum {
+    TLM_MSG_HELLO = 1,                /* Stream start / telemetry enabled */
+    TLM_MSG_MOUNT = 2,                /* Device enumerated */
+    TLM_MSG_UNMOUNT = 3,              /* Device removed */
+    TLM_MSG_DESCRIPTOR = 4,           /* One string descriptor */
+    TLM_MSG_HID_MOUNT = 5,            /* HID interface mounted */
+    TLM_MSG_KEY_SUMMARY = 6,          /* Per-window report/key counts */
+    TLM_MSG_RATE_SAMPLE = 7,          /* Per-window rate and timing */
+    TLM_MSG_VERDICT = 8,              /* Threat level assigned or changed */
+    TLM_MSG_COUNTERS = 9,             /* Periodic health counters */
+    TLM_MSG_TRACE = 10,               /* Batch of trace events from one core */
+    TLM_MSG_TYPE_COUNT
+} tlm_msg_type_e;
+
+/* String descriptor kinds (tlm_descriptor_t.kind) */
+typedef enum {
+    TLM_STR_MANUFACTURER = 0,
+    TLM_STR_PRODUCT = 1,
+    TLM_STR_SERIAL = 2
+} tlm_string_kind_e;
+
+/* Verdict reasons (tlm_verdict_t.reason) */
+typedef enum {
+    TLM_REASON_CLASSIFIED = 0,        /* Descriptor-based classification */
+    TLM_REASON_RECLASSIFIED = 1,      /* Re-classified after HID mount */
+    TLM_REASON_RATE = 2,              /* Keystroke rate over threshold */
+    TLM_REASON_FLOOD = 3              /* HID report budget flood */
+} tlm_verdict_reason_e;
+
+/* Frame header */
+typedef struct __attribute__((packed)) {
+    uint8_t version;                  /* TLM_PROTO_VERSION */
+    uint8_t type;                     /* tlm_msg_type_e */
+    uint16_t seq;                     /* Frame counter, gaps mean lost frames */
+    uint32_t time_ms;                 /* Device uptime when the event happened */
+} tlm_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t proto_version;
+    uint8_t max_devices;
+    uint16_t keystroke_threshold_hz;
+} tlm_hello_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint16_t vid;
+    uint16_t pid;
+    uint8_t usb_class;
+    uint8_t subclass;
+    uint8_t protocol;
+    uint8_t descriptor_ready;
+} tlm_mount_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+} tlm_unmount_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint8_t kind;                     /* tlm_string_kind_e */
+    uint8_t len;                      /* Bytes used in text[] (no NUL) */
+    char text[64];                    /* UTF-8, only len bytes are sent */
+} tlm_descriptor_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t protocol;                 /* 0 none, 1 keyboard, 2 mouse */
+} tlm_hid_mount_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint16_t window_ms;               /* Length of the closed window */
+    uint32_t reports;                 /* Reports in the window */
+    uint32_t key_reports;             /* Reports with any key/usage byte set */
+} tlm_key_summary_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint32_t rate_hz;                 /* Rate over the closed window */
+    uint32_t peak_rate_hz;
+    uint32_t min_interval_us;
+    uint32_t jitter_us;
+} tlm_rate_sample_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t dev_addr;
+    uint8_t level;                    /* threat_level_e */
+    uint8_t reason;                   /* tlm_verdict_reason_e */
+    uint8_t flood_suspect;
+    uint32_t rate_hz;
+} tlm_verdict_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t tlm_dropped;             /* Telemetry messages lost (ring full) */
+    uint32_t log_dropped;             /* Deferred log records lost */
+    uint32_t events_dropped;          /* Inter-core events lost */
+    uint32_t irq_stamped;             /* Reports stamped in the USB IRQ */
+    uint32_t fallback_stamped;        /* Reports stamped at callback time */
+    uint32_t max_dispatch_us;         /* Worst completion-to-callback delay */
+    uint32_t max_usb_task_us;         /* Worst usb_host_task() duration */
+} tlm_counters_t;
+
+/* Trace event (layout of trace_event_t, see trace_points.h for IDs) */
+typedef struct __attribute__((packed)) {
+    uint32_t ts_us;                   /* Start, device microsecond timer (wraps ~71 min) */
+    uint32_t dur_us;                  /* Span length, 0 for instants */
+    uint8_t point;                    /* trace_point_e */
+    uint8_t flags;                    /* TLM_TRACE_FLAG_* */
+    uint16_t arg;
+} tlm_trace_event_t;
+
+#define TLM_TRACE_BATCH_MAX           5
+#define TLM_TRACE_FLAG_INSTANT        0x01
+
+typedef struct __attribute__((packed)) {
+    uint8_t core;                     /* Core that recorded the events */
+    uint8_t count;                    /* Valid entries in events[] */
+    uint16_t dropped;                 /* Events lost on this core since the last batch */
+    tlm_trace_event_t events[TLM_TRACE_BATCH_MAX];  /* Only count entries are sent */
+} tlm_trace_batch_t;
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) */
+uint16_t tlm_crc16(const uint8_t *data, size_t len);
+
+/* COBS-encode len bytes; out must hold len + len/254 + 1. Returns bytes written
+ * (no delimiter). */
+size_t tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+
+/* COBS-decode a frame without delimiters. Returns decoded length, or 0 on a
+ * malformed frame or when out_max would be exceeded. */
+size_t tlm_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_max);
+
+/* Build a complete frame (both delimiters included) into out, which must hold
+ * TLM_MAX_ENCODED_FRAME + 2 bytes. Returns the frame length, 0 on error. */
+size_t tlm_build_frame(uint8_t type, uint16_t seq, uint32_t time_ms,
+                       const void *payload, size_t payload_len, uint8_t *out);
+
+/* Validate a COBS-decoded frame: length, version and CRC. On success the
+ * header is copied out and *payload / *payload_len point into raw. */
+bool tlm_parse_frame(const uint8_t *raw, size_t raw_len, tlm_header_t *header,
+                     const uint8_t **payload, size_t *payload_len);
+
+#endif /* TELEMETRY_PROTO_H */
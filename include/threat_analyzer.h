@@ -30,6 +30,7 @@ typedef struct {
     threat_level_e threat_level;
     uint32_t hid_report_count;         /* Total HID reports received */
     uint32_t hid_reports_per_sec;      /* Current keystroke rate (keys/sec) */
+    bool flood_suspect;                /* HID report flood / DoS suspect */
     bool is_active;
 } device_threat_t;
 
@@ -65,6 +66,9 @@ void threat_remove_device(uint8_t dev_addr);
 /* Add device to threat tracking (called by USB host) */
 void threat_add_device(const usb_device_info_t *dev_info);
 
+/* Flag a device whose HID interface exceeded its report budget */
+void threat_report_flood(uint8_t dev_addr);
+
 /* Update device info and re-classify threat (called when HID mounts after initial enumeration) */
 void threat_update_device_info(const usb_device_info_t *dev_info);
 
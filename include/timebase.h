@@ -0,0 +1,88 @@
+/*
+ * PlugSafe Timebase
+ * The one clock every module reads: the hardware timer on the device, a
+ * virtual clock in the host simulator
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+/* Build switch: 1 reads a virtual clock that only moves when the simulator
+ * advances it (set by the host build). 0 reads the RP2040 timer. */
+#ifndef PLUGSAFE_VIRTUAL_CLOCK
+#define PLUGSAFE_VIRTUAL_CLOCK        0
+#endif
+
+/*
+ * All times are since boot. Modules call these instead of time_us_64(),
+ * get_absolute_time() or sleep_*(), so a simulation can run faster than
+ * real time and give the same result on every run.
+ */
+
+#if PLUGSAFE_VIRTUAL_CLOCK
+
+/* Provided by the simulator (host/sim/sim_clock.c) */
+uint64_t timebase_virtual_now_us(void);
+void timebase_virtual_wait_until_us(uint64_t deadline_us);
+
+static inline uint64_t timebase_now_us(void) {
+    return timebase_virtual_now_us();
+}
+
+/* Low 32 bits of the microsecond clock (wraps after ~71 minutes; use for
+ * short intervals only) */
+static inline uint32_t timebase_now_us32(void) {
+    return (uint32_t)timebase_virtual_now_us();
+}
+
+/* Nothing else can happen while waiting, so virtual time just moves on */
+static inline void timebase_wait_until_us(uint64_t deadline_us) {
+    timebase_virtual_wait_until_us(deadline_us);
+}
+
+static inline void timebase_sleep_us(uint64_t us) {
+    timebase_virtual_wait_until_us(timebase_virtual_now_us() + us);
+}
+
+#else
+
+#include "pico/time.h"
+
+static inline uint64_t timebase_now_us(void) {
+    return time_us_64();
+}
+
+static inline uint32_t timebase_now_us32(void) {
+    return time_us_32();          /* TIMERAWL only, no latched 64-bit read */
+}
+
+/* Sleep in WFE until deadline_us or an earlier event (e.g. an IRQ's SEV) */
+static inline void timebase_wait_until_us(uint64_t deadline_us) {
+    best_effort_wfe_or_timeout(from_us_since_boot(deadline_us));
+}
+
+static inline void timebase_sleep_us(uint64_t us) {
+    sleep_us(us);
+}
+
+#endif /* PLUGSAFE_VIRTUAL_CLOCK */
+
+/* Milliseconds since boot (wraps after ~49 days) */
+static inline uint32_t timebase_now_ms(void) {
+    return (uint32_t)(timebase_now_us() / 1000);
+}
+
+/* Blocking delay; only for initialisation sequences */
+static inline void timebase_sleep_ms(uint32_t ms) {
+    timebase_sleep_us((uint64_t)ms * 1000);
+}
+
+#endif /* TIMEBASE_H */
@@ -0,0 +1,73 @@
+/*
+ * PlugSafe Event Trace
+ * Per-core lock-free rings of timestamped spans and instants
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timebase.h"
+#include "trace_points.h"
+
+/* Trace recording is compiled in with the profiler (PLUGSAFE_PROFILING) */
+#ifndef PLUGSAFE_PROFILING
+#define PLUGSAFE_PROFILING            0
+#endif
+
+/* Configuration */
+#define TRACE_RING_SIZE               128   /* Events per core (must be a power of two) */
+
+#define TRACE_FLAG_INSTANT            0x01  /* Point event, dur_us is 0 */
+
+/* One recorded event */
+typedef struct {
+    uint32_t ts_us;                   /* timebase_now_us32() at the start of the event */
+    uint32_t dur_us;                  /* Span length */
+    uint8_t point;                    /* trace_point_e */
+    uint8_t flags;                    /* TRACE_FLAG_* */
+    uint16_t arg;                     /* Point-specific argument */
+} trace_event_t;
+
+/* Reset both rings (call before launching core 1). Starts disabled. */
+void trace_init(void);
+
+/* Start or stop recording. Events already queued stay readable. */
+void trace_set_enabled(bool enabled);
+bool trace_is_enabled(void);
+
+/* Record on the calling core's ring. No-op while disabled; dropped (and
+ * counted) when the ring is full. Never blocks. */
+void trace_span(uint8_t point, uint16_t arg, uint32_t start_us, uint32_t dur_us);
+void trace_instant(uint8_t point, uint16_t arg);
+
+/* Copy up to max oldest events of a core's ring into out (core 0 only).
+ * Returns the number copied. */
+uint32_t trace_read(uint8_t core, trace_event_t *out, uint32_t max);
+
+/* Events a core dropped since the last call (core 0 only) */
+uint32_t trace_take_dropped(uint8_t core);
+
+#if PLUGSAFE_PROFILING
+
+/* Span from start_us (a timebase_now_us32() value) to now */
+#define TRACE_SPAN(point, arg, start_us) \
+    do { uint32_t _t0 = (start_us); trace_span((point), (arg), _t0, timebase_now_us32() - _t0); } while (0)
+
+#define TRACE_INSTANT(point, arg)     trace_instant((point), (arg))
+
+#else
+
+#define TRACE_SPAN(point, arg, start_us) do { (void)(start_us); } while (0)
+#define TRACE_INSTANT(point, arg)     do { } while (0)
+
+#endif /* PLUGSAFE_PROFILING */
+
+#endif /* TRACE_H */
@@ -0,0 +1,56 @@
+/*
+ * PlugSafe Trace Points
+ * Identifiers and names of on-device trace events, shared with host tools
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef TRACE_POINTS_H
+#define TRACE_POINTS_H
+
+#include <stdint.h>
+
+/* Trace point IDs. The first PROBE_COUNT IDs are the profiler probes (every
+ * PROFILE_SCOPE() is also a trace span); keep both lists in the same order. */
+typedef enum {
+    TRACE_PT_USB_TASK = 0,            /* usb_host_task() */
+    TRACE_PT_ANALYSIS_TASK,           /* usb_host_analysis_task() */
+    TRACE_PT_TUH_MOUNT_CB,            /* tuh_mount_cb() */
+    TRACE_PT_TUH_UMOUNT_CB,           /* tuh_umount_cb() */
+    TRACE_PT_HID_MOUNT_CB,            /* tuh_hid_mount_cb() */
+    TRACE_PT_HID_REPORT_CB,           /* tuh_hid_report_received_cb() */
+    TRACE_PT_STATS_PRINT,             /* usb_host_print_stats() */
+    TRACE_PT_DISPLAY_DRAW,            /* Page rendering (core 0) */
+    TRACE_PT_DISPLAY_FLUSH,           /* oled_display_flush() (core 0) */
+    TRACE_PT_ENUM_DEVICE_DESC,        /* Enumeration: device descriptor read (arg: address) */
+    TRACE_PT_ENUM_STRINGS,            /* Enumeration: string descriptor reads (arg: address) */
+    TRACE_PT_ENUM_CLASSIFY,           /* Enumeration: threat_add_device() (arg: address) */
+    TRACE_PT_VERDICT,                 /* Instant: threat level set (arg: level << 8 | address) */
+    TRACE_PT_COUNT
+} trace_point_e;
+
+/* Name shown in trace viewers */
+static inline const char *trace_point_name(uint8_t point) {
+    static const char *const names[TRACE_PT_COUNT] = {
+        "usb_task",
+        "analysis",
+        "mount_cb",
+        "umount_cb",
+        "hid_mount",
+        "hid_report",
+        "stats_print",
+        "draw",
+        "flush",
+        "enum_device_desc",
+        "enum_strings",
+        "enum_classify",
+        "verdict",
+    };
+    return point < TRACE_PT_COUNT ? names[point] : "unknown";
+}
+
+#endif /* TRACE_POINTS_H */
@@ -34,14 +34,62 @@ typedef struct {
     bool descriptor_ready;      /* VID/PID/Class valid (immediate) */
     bool strings_ready;         /* Manufacturer/Product/Serial valid (async) */
     uint64_t connected_time_ms; /* Time device was connected */
+    bool flood_suspect;         /* A HID interface exceeded its report budget */
 } usb_device_info_t;
 
+/* Per-interface HID report budget (flood / DoS protection).
+ * Each HID interface may consume at most HID_BUDGET_MAX_REPORTS reports or
+ * HID_BUDGET_MAX_CPU_US of processing time per HID_BUDGET_WINDOW_MS window.
+ * Once exhausted, the next tuh_hid_receive_report() is deferred until the
+ * window ends, so a flooding interface cannot starve the main loop. */
+#define HID_BUDGET_WINDOW_MS          100   /* Budget accounting window */
+#define HID_BUDGET_MAX_REPORTS        50    /* Reports per window (500 Hz) */
+#define HID_BUDGET_MAX_CPU_US         1000  /* Processing time per window (1% CPU) */
+#define HID_BUDGET_FLOOD_WINDOWS      5     /* Consecutive exhausted windows => flood suspect */
+
+/* HID Interface Budget State */
+typedef struct {
+    uint8_t dev_addr;
+    uint8_t instance;
+    bool in_use;
+    bool rearm_pending;               /* Report request deferred to window end */
+    bool window_exhausted;            /* Budget ran out in the current window */
+    bool flood_suspect;               /* Sticky: flooding / DoS suspect */
+    uint8_t exhausted_windows;        /* Consecutive exhausted windows */
+    uint64_t window_start_ms;         /* Start time of current budget window */
+    uint32_t window_reports;          /* Reports processed in current window */
+    uint32_t window_cpu_us;           /* Processing time spent in current window */
+    uint32_t total_reports;           /* Total reports received */
+    uint32_t deferred_count;          /* Times re-arming was deferred */
+    uint32_t max_report_us;           /* Worst single-report processing time */
+} hid_itf_budget_t;
+
+/* HID report timestamping statistics.
+ * Reports are stamped in the USB IRQ when the interrupt transfer completes;
+ * the dispatch delay is the time until tuh_task() runs the report callback. */
+#define USB_STAMP_MAX_AGE_US          100000 /* Older IRQ stamps are treated as stale */
+
+typedef struct {
+    uint32_t irq_stamped;             /* Reports stamped at transfer completion */
+    uint32_t fallback_stamped;        /* Reports stamped at callback time (no IRQ stamp) */
+    uint32_t max_dispatch_us;         /* Worst completion-to-callback delay */
+    uint64_t total_dispatch_us;       /* Sum of completion-to-callback delays */
+} usb_stamp_stats_t;
+
 /* USB Host Initialization */
 bool usb_host_init(void);
 
-/* Must be called regularly in main loop */
+/* Run TinyUSB host processing; call whenever usb_host_event_pending() */
 void usb_host_task(void);
 
+/* Re-arm budget-deferred HID interfaces, publish pending state snapshots,
+ * then hand the core events raised since the last run to core 0. Call
+ * after usb_host_task() and periodically while idle. */
+void usb_host_analysis_task(void);
+
+/* True when the USB IRQ has queued events that usb_host_task() must process */
+bool usb_host_event_pending(void);
+
 /* Query device information */
 usb_device_info_t* usb_get_device_info(uint8_t dev_addr);
 
@@ -57,4 +105,21 @@ bool usb_is_device_mounted(uint8_t dev_addr);
 /* Check if a USB hub is currently connected (warning state) */
 bool usb_is_hub_connected(void);
 
+/* Get report budget state for a HID interface (NULL if not mounted) */
+hid_itf_budget_t* usb_get_hid_budget(uint8_t dev_addr, uint8_t instance);
+
+/* Worst-case duration of a single usb_host_task() call (microseconds) */
+uint32_t usb_host_get_max_task_us(void);
+
+/* Get HID report timestamping statistics */
+usb_stamp_stats_t* usb_host_get_stamp_stats(void);
+
+/* True once no HID report has arrived for quiet_ms. Called from core 0
+ * before a flash erase, which parks core 1 for ~45 ms; it samples the
+ * report counters, so call it on every storage run. */
+bool usb_host_reports_quiet(uint32_t now_ms, uint32_t quiet_ms);
+
+/* Print event latency / timestamping statistics to the console */
+void usb_host_print_stats(void);
+
 #endif /* USB_HOST_H */
@@ -9,8 +9,8 @@
  * (at your option) any later version.
  */
 
-#include "pico/time.h"
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include <stdio.h>
 #include <string.h>
 #include "oled_i2c.h"
@@ -19,9 +19,21 @@
 #include "oled_graphics.h"
 #include "oled_text.h"
 #include "oled_font.h"
+#include "oled_widget.h"
 #include "usb_host.h"
 #include "threat_analyzer.h"
 #include "hid_monitor.h"
+#include "event_queue.h"
+#include "state_snapshot.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "deferred_log.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "flash_store.h"
+#include "flight_recorder.h"
+#include "journal.h"
+#include "timebase.h"
 
 /* GPIO pins for LED */
 #define LED_PIN 25
@@ -40,7 +52,33 @@
 
 /* Display update timing (in milliseconds) */
 #define DISPLAY_UPDATE_INTERVAL_MS 200
-#define USB_HOST_POLL_INTERVAL_MS  10
+
+/* USB is serviced as soon as the IRQ queues an event. The analysis task
+ * also runs on this period to re-arm budget-deferred HID interfaces when
+ * no event arrives. */
+#define USB_HOST_IDLE_SERVICE_MS   20
+
+/* LED blink pattern update interval */
+#define LED_UPDATE_INTERVAL_MS     100
+
+/* Deferred log drain interval (core 1 log records are printed from core 0) */
+#define LOG_DRAIN_INTERVAL_MS      10
+
+/* Binary telemetry drain interval */
+#define TELEMETRY_DRAIN_INTERVAL_MS 10
+
+/* Flash writes (forensic captures, event journal): at most one bounded
+ * erase or program step per run */
+#define STORAGE_STEP_INTERVAL_MS   50
+
+/* UART console poll interval ('p' profile, 's' scheduler stats, 'r' reset,
+ * 'm' output mode, 't' trace, 'f' forensic slots, 'j' journal) */
+#define CONSOLE_POLL_INTERVAL_MS   100
+
+/* Core 1 (USB host + analysis) stack and startup handshake */
+#define CORE1_STACK_SIZE_WORDS     2048    /* 8 KB: printf-heavy TinyUSB callbacks */
+#define CORE1_READY_OK             0x55534231u
+#define CORE1_READY_FAIL           0x55534230u
 
 /* Display page enumeration for state management */
 typedef enum {
@@ -55,204 +93,514 @@ typedef enum {
     DISPLAY_MODE_MANUFACTURER = 1    /* Show Manufacturer/Product strings */
 } display_mode_t;
 
+/* What the USB core writes to the UART: text logs, telemetry frames or both.
+ * Frames start and end with 0x00, so text lines between them are harmless. */
+typedef enum {
+    UART_OUTPUT_TEXT = 0,            /* Human-readable DLOG() output only */
+    UART_OUTPUT_TELEMETRY = 1,       /* COBS-framed binary telemetry only */
+    UART_OUTPUT_BOTH = 2,
+    UART_OUTPUT_MODE_COUNT = 3
+} uart_output_mode_t;
+
+#define UART_OUTPUT_DEFAULT        UART_OUTPUT_TEXT
+
+static uart_output_mode_t uart_output_mode = UART_OUTPUT_DEFAULT;
+
 /* Current display page and mode */
 static display_page_t current_page = DISPLAY_PAGE_WELCOME;
 static display_mode_t current_mode = DISPLAY_MODE_VID_PID;
 
-/* Time tracking for display updates */
-static uint64_t last_display_update_ms = 0;
-static uint64_t last_usb_poll_ms = 0;
-static uint64_t last_bootsel_check_ms = 0;
+/* Per-core cooperative schedulers and the ids of tasks that get triggered */
+static scheduler_t core0_sched;
+static scheduler_t core1_sched;
+static int display_task_id = -1;
+static int usb_task_id = -1;
+static int analysis_task_id = -1;
+
+/* Display handed to the display task, and the screen on its framebuffer */
+typedef struct {
+    oled_display_t *display;
+    oled_screen_t *screen;
+} ui_context_t;
 
-/* Track last device count for edge detection */
-static uint8_t last_device_count = 0;
+/* Latest consistent copy of device/threat state owned by core 1 */
+static system_snapshot_t ui_snapshot;
 
-/* LED control with adaptive blinking based on device state */
-static uint64_t last_led_update_ms = 0;
+/* Core 1 stack (the SDK default of 2 KB is too small for the USB callbacks) */
+static uint32_t core1_stack[CORE1_STACK_SIZE_WORDS];
+
+/* Core 0 stack bounds from the SDK linker script */
+extern uint32_t __StackBottom;
+extern uint32_t __StackTop;
 
 /* BOOTSEL button debouncing */
 #define BOOTSEL_DEBOUNCE_MS 200
 static bool bootsel_pressed_prev = false;
 
 /* ============================================================================
- * DISPLAY HELPER FUNCTIONS
+ * DISPLAY SCREENS
+ * ============================================================================ */
+
+/* Each screen is a table of widgets bound to the UI's snapshot. The display
+ * task redraws only the widgets whose text changed, so an unchanged screen
+ * costs no drawing and no I2C traffic. */
+
+#define UI_TEXT_HEIGHT 7   /* 5x7 font */
+
+/* Fixed text at (x, y), owning the row to the right edge */
+#define UI_LABEL(px, py, str) \
+    { .type = OLED_WIDGET_LABEL, .x = (px), .y = (py), \
+      .w = OLED_WIDTH - (px), .h = UI_TEXT_HEIGHT, .text = (str) }
+
+/* Text from fn at (x, y), width pw */
+#define UI_VALUE(px, py, pw, fn) \
+    { .type = OLED_WIDGET_VALUE, .x = (px), .y = (py), \
+      .w = (pw), .h = UI_TEXT_HEIGHT, .text_fn = (fn) }
+
+/**
+ * @brief The device the screens describe (the first connected one)
+ */
+static const device_snapshot_t *ui_device(const void *model) {
+    return &((const system_snapshot_t *)model)->devices[0];
+}
+
+static void bind_product_ids(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    snprintf(out, size, "%.19s", dev->product[0] ? dev->product : "Unknown Device");
+}
+
+static void bind_vid_pid(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    snprintf(out, size, "VID:0x%04X PID:0x%04X", dev->vid, dev->pid);
+}
+
+static void bind_class(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    const char *type_str = "STD";
+    if (dev->is_hid) {
+        if (dev->hid_protocol == 1) type_str = "KBD";
+        else if (dev->hid_protocol == 2) type_str = "MOUSE";
+        else type_str = "HID";
+    }
+    snprintf(out, size, "Class: 0x%02X %s", dev->usb_class, type_str);
+}
+
+static void bind_threat(const void *model, char *out, size_t size) {
+    const device_snapshot_t *entry = ui_device(model);
+    const char *threat_str = "SAFE";
+    switch (entry->threat_level) {
+        case THREAT_MALICIOUS:
+            threat_str = "MALICIOUS!!!";
+            break;
+        case THREAT_POTENTIALLY_UNSAFE:
+            threat_str = "CAUTION";
+            break;
+        default:
+            threat_str = "SAFE";
+    }
+    /* Report-flood suspects are called out unless already malicious. Mice
+     * are left to their level: a 1 kHz gaming mouse saturates the budget
+     * too, and the analyzer keeps them SAFE for that reason. */
+    if (entry->flood_suspect && entry->threat_level != THREAT_MALICIOUS &&
+        entry->device.hid_protocol != 2) {
+        threat_str = "FLOODING";
+    }
+    snprintf(out, size, "Threat: %s", threat_str);
+}
+
+/**
+ * @brief Live keystroke rate for HID devices, the mode name otherwise
+ */
+static void bind_rate(const void *model, char *out, size_t size, const char *mode) {
+    const device_snapshot_t *entry = ui_device(model);
+    if (entry->device.is_hid) {
+        snprintf(out, size, "Rate:%u k/s", entry->hid_reports_per_sec);
+    } else {
+        snprintf(out, size, "Mode: %s", mode);
+    }
+}
+
+static void bind_rate_ids(const void *model, char *out, size_t size) {
+    bind_rate(model, out, size, "IDs");
+}
+
+static void bind_rate_strings(const void *model, char *out, size_t size) {
+    bind_rate(model, out, size, "Strings");
+}
+
+static void bind_manufacturer(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    snprintf(out, size, "%.17s", dev->manufacturer[0] ? dev->manufacturer : "Unknown");
+}
+
+static void bind_product_strings(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    snprintf(out, size, "%.17s", dev->product[0] ? dev->product : "Unknown Device");
+}
+
+static void bind_serial(const void *model, char *out, size_t size) {
+    const usb_device_info_t *dev = &ui_device(model)->device;
+    snprintf(out, size, "%.17s", dev->serial[0] ? dev->serial : "No Serial");
+}
+
+/* Welcome screen (waiting for device) */
+static oled_widget_t welcome_widgets[] = {
+    UI_LABEL(10, 5,  "=== PlugSafe ==="),
+    UI_LABEL(8, 20,  "Insert USB Device"),
+    UI_LABEL(5, 32,  "to start monitoring"),
+    UI_LABEL(5, 42,  "---"),
+    UI_LABEL(8, 52,  "Waiting..."),
+};
+
+/* Device information, mode 1: VID/PID and USB Class (default) */
+static oled_widget_t device_ids_widgets[] = {
+    UI_LABEL(10, 2,  "Device Detected!"),
+    UI_VALUE(5, 12,  OLED_WIDTH - 5, bind_product_ids),
+    UI_VALUE(5, 22,  OLED_WIDTH - 5, bind_vid_pid),
+    UI_VALUE(5, 32,  OLED_WIDTH - 5, bind_class),
+    UI_VALUE(5, 42,  OLED_WIDTH - 5, bind_threat),
+    UI_VALUE(0, 56,  80, bind_rate_ids),
+    UI_LABEL(80, 56, "BOOTSEL"),
+};
+
+/* Device information, mode 2: Manufacturer/Product/Serial (press BOOTSEL
+ * to toggle) */
+static oled_widget_t device_strings_widgets[] = {
+    UI_LABEL(10, 2,  "Device Detected!"),
+    UI_VALUE(5, 12,  OLED_WIDTH - 5, bind_manufacturer),
+    UI_VALUE(5, 22,  OLED_WIDTH - 5, bind_product_strings),
+    UI_VALUE(5, 32,  OLED_WIDTH - 5, bind_serial),
+    UI_VALUE(5, 42,  OLED_WIDTH - 5, bind_threat),
+    UI_VALUE(0, 56,  80, bind_rate_strings),
+    UI_LABEL(80, 56, "BOOTSEL"),
+};
+
+/* USB Hub warning page */
+static oled_widget_t hub_warning_widgets[] = {
+    UI_LABEL(5, 2,   "!!! WARNING !!!"),
+    UI_LABEL(5, 12,  "USB HUB DETECTED"),
+    UI_LABEL(5, 32,  "Please disconnect"),
+    UI_LABEL(5, 42,  "hub and connect"),
+    UI_LABEL(5, 52,  "device directly."),
+};
+
+#define UI_SCREEN(widgets) { widgets, sizeof(widgets) / sizeof(widgets[0]), NULL }
+
+static oled_screen_t welcome_screen = UI_SCREEN(welcome_widgets);
+static oled_screen_t device_ids_screen = UI_SCREEN(device_ids_widgets);
+static oled_screen_t device_strings_screen = UI_SCREEN(device_strings_widgets);
+static oled_screen_t hub_warning_screen = UI_SCREEN(hub_warning_widgets);
+
+/**
+ * @brief Pick the screen for the current state and display mode
+ */
+static oled_screen_t *select_screen(const system_snapshot_t *snap) {
+    /* Check if hub is connected - if so, always show warning page */
+    if (snap->hub_connected) {
+        current_page = DISPLAY_PAGE_WELCOME;  /* Reset page when hub detected */
+        return &hub_warning_screen;
+    }
+    if (snap->device_count > 0) {
+        current_page = DISPLAY_PAGE_DEVICE_INFO;
+        return current_mode == DISPLAY_MODE_VID_PID ? &device_ids_screen
+                                                     : &device_strings_screen;
+    }
+    current_page = DISPLAY_PAGE_WELCOME;
+    return &welcome_screen;
+}
+
+/* ============================================================================
+ * CORE 1: USB HOST + ANALYSIS
  * ============================================================================ */
 
 /**
- * @brief Draw the welcome screen (waiting for device)
+ * @brief Core 1 poll hook: make the USB task due when the IRQ queued events
+ */
+static void core1_poll(void *ctx) {
+    (void) ctx;
+    if (usb_host_event_pending()) {
+        scheduler_trigger(&core1_sched, usb_task_id);
+    }
+}
+
+/**
+ * @brief USB service task: drain TinyUSB events, then hand off to analysis
  */
-static void draw_welcome_screen(oled_display_t *display, const oled_font_t *font) {
-    oled_display_clear(display);
+static void usb_service_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
+    usb_host_task();
+    scheduler_trigger(&core1_sched, analysis_task_id);
+}
+
+/**
+ * @brief Analysis drain task: re-arm throttled HID interfaces, publish snapshots
+ */
+static void analysis_drain_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
+    usb_host_analysis_task();
+}
+
+/**
+ * @brief Core 1 entry: owns the TinyUSB host, HID analysis and threat scoring.
+ *
+ * tusb_init() runs here so the USB IRQ is enabled on this core. Blocking
+ * display flushes on core 0 therefore never delay USB event processing.
+ * State changes are reported to core 0 through the event queue.
+ */
+static void core1_main(void) {
+    /* Let core 0 park this core while it erases/programs flash */
+    flash_store_core1_init();
+
+    /* Initialize USB Host (TinyUSB active enumeration) */
+    printf("Initializing USB host on core 1...\n");
+    bool usb_ok = usb_host_init();
+    if (!usb_ok) {
+        printf("ERROR: USB host initialization failed\n");
+        /* Continue anyway - USB might not be essential */
+    }
+    printf("USB host initialized\n");
     
-    /* Title */
-    oled_draw_string(display, 10, 5,   "=== PlugSafe ===", font, true);
+    /* Initialize keystroke rate monitoring (analysis runs on this core) */
+    hid_monitor_init();
     
-    /* Main message */
-    oled_draw_string(display, 8, 20,  "Insert USB Device", font, true);
+    /* Initialize threat analyzer */
+    printf("Initializing threat analyzer...\n");
+    threat_analyzer_init();
+    printf("Threat analyzer initialized\n\n");
     
-    /* Instructions */
-    oled_draw_string(display, 5, 32,  "to start monitoring", font, true);
+    /* USB service runs only when the IRQ signalled work; the analysis task
+     * follows every USB batch and also runs on the idle backstop period */
+    scheduler_init(&core1_sched);
+    usb_task_id = scheduler_add_task(&core1_sched, &(scheduler_task_config_t){
+        .name = "usb", .fn = usb_service_task, .period_ms = 0,
+        .deadline_ms = 1, .priority = 0
+    });
+    analysis_task_id = scheduler_add_task(&core1_sched, &(scheduler_task_config_t){
+        .name = "analysis", .fn = analysis_drain_task,
+        .period_ms = USB_HOST_IDLE_SERVICE_MS, .priority = 1
+    });
+    scheduler_set_poll(&core1_sched, core1_poll, NULL);
     
-    /* Separator */
-    oled_draw_string(display, 5, 42,  "---", font, true);
+    multicore_fifo_push_blocking(usb_ok ? CORE1_READY_OK : CORE1_READY_FAIL);
     
-    /* Status indicator */
-    oled_draw_string(display, 8, 52,  "Waiting...", font, true);
+    /* The USB IRQ ends the WFE sleep and tuh_event_hook_cb() issues SEV, so
+     * an event raised after the poll is not slept through */
+    scheduler_run(&core1_sched);
 }
 
+/* ============================================================================
+ * CORE 0 TASKS: DISPLAY, BUTTONS, LED
+ * ============================================================================ */
+
 /**
- * @brief Draw the device information screen with dual mode support
- * Mode 1: VID/PID and USB Class (default)
- * Mode 2: Manufacturer/Product/Serial (press BOOTSEL to toggle)
+ * @brief Core 0 poll hook: drain state-change events from core 1. Any mount,
+ * unmount or threat change forces an immediate display update.
  */
-static void draw_device_screen(oled_display_t *display, const oled_font_t *font) {
-    oled_display_clear(display);
+static void core0_poll(void *ctx) {
+    (void) ctx;
+    core_event_t event;
+    bool changed = false;
+    while (event_queue_pop(&event)) {
+        changed = true;
+    }
+    if (changed) {
+        scheduler_trigger(&core0_sched, display_task_id);
+    }
+}
+
+/**
+ * @brief BOOTSEL button handling for display mode toggle (200ms debounce)
+ */
+static void input_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
     
-    uint8_t device_count = usb_get_device_count();
+    /* Read BOOTSEL button state (GPIO 24, active low) */
+    bool bootsel_pressed = !gpio_get(BOOTSEL_PIN);
     
-    /* If no devices, show waiting message */
-    if (device_count == 0) {
-        draw_welcome_screen(display, font);
-        return;
+    /* Detect rising edge (button pressed) */
+    if (bootsel_pressed && !bootsel_pressed_prev) {
+        /* Toggle display mode */
+        current_mode = (current_mode == DISPLAY_MODE_VID_PID) ? 
+                       DISPLAY_MODE_MANUFACTURER : DISPLAY_MODE_VID_PID;
+        printf("[BUTTON] Display mode toggled to: %s\n",
+               current_mode == DISPLAY_MODE_VID_PID ? "VID/PID" : "Manufacturer");
+        /* Force immediate display update */
+        scheduler_trigger(&core0_sched, display_task_id);
     }
+    bootsel_pressed_prev = bootsel_pressed;
+}
+
+/**
+ * @brief Display refresh (every 200ms or on state change)
+ */
+static void display_task(void *ctx, uint64_t now_us) {
+    ui_context_t *ui = (ui_context_t *)ctx;
+    (void) now_us;
     
-    /* Get device information */
-    usb_device_info_t *dev = usb_get_device_at_index(0);
-    if (!dev) {
-        oled_draw_string(display, 5, 20, "Error reading device", font, true);
-        return;
+    /* Refresh the UI's copy of device/threat state when core 1 has
+     * published a new version. On a torn read try again next run. */
+    bool fresh = false;
+    if (state_snapshot_get_version() != ui_snapshot.version) {
+        fresh = state_snapshot_read(&ui_snapshot);
     }
     
-    /* Title */
-    oled_draw_string(display, 10, 2,   "Device Detected!", font, true);
-    
-    char buf[28];
-    
-    if (current_mode == DISPLAY_MODE_VID_PID) {
-        /* Mode 1: VID/PID display */
-        
-        /* Device name/product (truncated) */
-        char product_short[20];
-        strncpy(product_short, dev->product[0] ? dev->product : "Unknown Device", 19);
-        product_short[19] = '\0';
-        oled_draw_string(display, 5, 12, product_short, font, true);
-        
-        /* VID/PID */
-        snprintf(buf, sizeof(buf), "VID:0x%04X PID:0x%04X", dev->vid, dev->pid);
-        oled_draw_string(display, 5, 22, buf, font, true);
+    {
+        PROFILE_SCOPE(PROBE_DISPLAY_DRAW);
         
-        /* USB Class and HID indicator */
-        const char *type_str = "STD";
-        if (dev->is_hid) {
-            if (dev->hid_protocol == 1) type_str = "KBD";
-            else if (dev->hid_protocol == 2) type_str = "MOUSE";
-            else type_str = "HID";
+        /* A new screen starts from a blank frame; otherwise only widgets
+         * whose value changed are redrawn, and only after a new snapshot */
+        oled_screen_t *screen = select_screen(&ui_snapshot);
+        if (screen != ui->screen) {
+            oled_display_clear(ui->display);
+            oled_screen_invalidate(screen);
+            ui->screen = screen;
+            fresh = true;
         }
-        snprintf(buf, sizeof(buf), "Class: 0x%02X %s", dev->usb_class, type_str);
-        oled_draw_string(display, 5, 32, buf, font, true);
-        
-        /* Threat level */
-        device_threat_t *threat = threat_get_device_at_index(0);
-        const char *threat_str = "SAFE";
-        if (threat) {
-            switch (threat->threat_level) {
-                case THREAT_MALICIOUS:
-                    threat_str = "MALICIOUS!!!";
-                    break;
-                case THREAT_POTENTIALLY_UNSAFE:
-                    threat_str = "CAUTION";
-                    break;
-                default:
-                    threat_str = "SAFE";
-            }
+        if (fresh) {
+            oled_screen_update(screen, ui->display, &ui_snapshot);
         }
-        
-        snprintf(buf, sizeof(buf), "Threat: %s", threat_str);
-        oled_draw_string(display, 5, 42, buf, font, true);
-        
-        /* Show live keystroke rate for HID devices, mode indicator otherwise */
-        if (dev->is_hid) {
-            uint32_t rate = threat ? threat->hid_reports_per_sec : 0;
-            snprintf(buf, sizeof(buf), "Rate:%u k/s", rate);
-            oled_draw_string(display, 0, 56, buf, font, true);
-        } else {
-            oled_draw_string(display, 0, 56, "Mode: IDs", font, true);
-        }
-        oled_draw_string(display, 80, 56, "BOOTSEL", font, true);
-        
+    }
+    
+    /* Flush to display: only the windows that changed go out. Nothing
+     * drawn since the last flush sends nothing. */
+    {
+        PROFILE_SCOPE(PROBE_DISPLAY_FLUSH);
+        oled_display_flush_async(ui->display, NULL, NULL);
+    }
+}
+
+/**
+ * @brief Adaptive LED blinking based on device state:
+ * - Device connected: Fast blink (200ms ON, 200ms OFF)
+ * - No device: Slow blink (500ms ON, 500ms OFF)
+ */
+static void led_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    uint64_t now_ms = now_us / 1000;
+    
+    if (ui_snapshot.device_count > 0) {
+        /* Device connected - fast blink (200ms half period) */
+        gpio_put(LED_PIN, (now_ms / 200) % 2);
     } else {
-        /* Mode 2: Manufacturer/Product/Serial display */
-        
-        /* Manufacturer (truncated) */
-        char mfg_short[18];
-        strncpy(mfg_short, dev->manufacturer[0] ? dev->manufacturer : "Unknown", 17);
-        mfg_short[17] = '\0';
-        oled_draw_string(display, 5, 12, mfg_short, font, true);
-        
-        /* Product (truncated) */
-        char prod_short[18];
-        strncpy(prod_short, dev->product[0] ? dev->product : "Unknown Device", 17);
-        prod_short[17] = '\0';
-        oled_draw_string(display, 5, 22, prod_short, font, true);
-        
-        /* Serial (truncated) */
-        char serial_short[18];
-        strncpy(serial_short, dev->serial[0] ? dev->serial : "No Serial", 17);
-        serial_short[17] = '\0';
-        oled_draw_string(display, 5, 32, serial_short, font, true);
-        
-        /* Threat level */
-        device_threat_t *threat = threat_get_device_at_index(0);
-        const char *threat_str = "SAFE";
-        if (threat) {
-            switch (threat->threat_level) {
-                case THREAT_MALICIOUS:
-                    threat_str = "MALICIOUS!!!";
-                    break;
-                case THREAT_POTENTIALLY_UNSAFE:
-                    threat_str = "CAUTION";
-                    break;
-                default:
-                    threat_str = "SAFE";
-            }
-        }
-        
-        snprintf(buf, sizeof(buf), "Threat: %s", threat_str);
-        oled_draw_string(display, 5, 42, buf, font, true);
-        
-        /* Show live keystroke rate for HID devices, mode indicator otherwise */
-        if (dev->is_hid) {
-            uint32_t rate = threat ? threat->hid_reports_per_sec : 0;
-            snprintf(buf, sizeof(buf), "Rate:%u k/s", rate);
-            oled_draw_string(display, 0, 56, buf, font, true);
-        } else {
-            oled_draw_string(display, 0, 56, "Mode: Strings", font, true);
-        }
-        oled_draw_string(display, 80, 56, "BOOTSEL", font, true);
+        /* No device - slow blink (500ms half period) */
+        gpio_put(LED_PIN, (now_ms / 500) % 2);
     }
 }
 
 /**
- * @brief Draw the USB Hub warning page
+ * @brief Print queued core 1 log records in idle time, a batch per run so a
+ * burst cannot hold off the display for long
  */
-static void draw_hub_warning_page(oled_display_t *display, const oled_font_t *font) {
-    oled_display_clear(display);
+static void log_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
+    dlog_drain(DLOG_DRAIN_BATCH);
+}
+
+/**
+ * @brief Frame and send queued telemetry messages (and periodic counters)
+ */
+static void telemetry_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
+    telemetry_drain(TLM_DRAIN_BATCH);
+}
+
+/**
+ * @brief Write flash in small steps, each of which parks core 1 briefly.
+ * A pending forensic capture goes first; the journal gets the runs in
+ * between.
+ */
+static void storage_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    uint32_t now_ms = (uint32_t)(now_us / 1000);
+    if (flight_recorder_persist_step(now_ms)) {
+        return;
+    }
+    journal_step(now_ms);
+}
+
+/**
+ * @brief Apply a UART output mode to the log and telemetry streams
+ */
+static void set_uart_output_mode(uart_output_mode_t mode) {
+    uart_output_mode = mode;
+    dlog_set_enabled(mode != UART_OUTPUT_TELEMETRY);
+    telemetry_set_enabled(mode != UART_OUTPUT_TEXT);
+    if (mode == UART_OUTPUT_TEXT) {
+        /* Trace events only leave the device as telemetry frames */
+        trace_set_enabled(false);
+    }
+}
+
+/**
+ * @brief UART console: dump profiler histograms and scheduler statistics on
+ * demand. Core 1's counters are read without locking; a sample recorded
+ * during the dump may be missing from one column.
+ */
+static void console_task(void *ctx, uint64_t now_us) {
+    (void) ctx;
+    (void) now_us;
     
-    oled_draw_string(display, 5, 2,   "!!! WARNING !!!", font, true);
-    oled_draw_string(display, 5, 12,  "USB HUB DETECTED", font, true);
-    oled_draw_string(display, 5, 22,  "", font, true);
-    oled_draw_string(display, 5, 32,  "Please disconnect", font, true);
-    oled_draw_string(display, 5, 42,  "hub and connect", font, true);
-    oled_draw_string(display, 5, 52,  "device directly.", font, true);
+    int c = getchar_timeout_us(0);
+    switch (c) {
+        case 'p':
+            profiler_dump();
+            break;
+        case 's':
+            scheduler_print_stats(&core0_sched, "core0");
+            scheduler_print_stats(&core1_sched, "core1");
+            break;
+        case 'r':
+            profiler_reset();
+            printf("[PROF] Histograms cleared\n");
+            break;
+        case 'm': {
+            static const char *const mode_names[UART_OUTPUT_MODE_COUNT] = {
+                "text", "telemetry", "text+telemetry"
+            };
+            uart_output_mode_t mode = (uart_output_mode_t)((uart_output_mode + 1) % UART_OUTPUT_MODE_COUNT);
+            printf("[CONSOLE] UART output: %s\n", mode_names[mode]);
+            set_uart_output_mode(mode);
+            break;
+        }
+        case 't':
+            if (!PLUGSAFE_PROFILING) {
+                printf("[TRACE] Not built in (PLUGSAFE_PROFILING=OFF)\n");
+            } else if (uart_output_mode == UART_OUTPUT_TEXT) {
+                printf("[TRACE] Switch to telemetry output first ('m')\n");
+            } else {
+                trace_set_enabled(!trace_is_enabled());
+                printf("[TRACE] Recording %s\n", trace_is_enabled() ? "on" : "off");
+            }
+            break;
+        case 'f':
+            flight_recorder_print_slots();
+            break;
+        case 'j':
+            journal_print_status();
+            break;
+        default:
+            break;
+    }
 }
 
 /* ============================================================================
- * MAIN APPLICATION
+ * MAIN APPLICATION (CORE 0: DISPLAY, BUTTONS, LED, LOGGING)
  * ============================================================================ */
 
 int main() {
     stdio_init_all();
     
+    /* Paint both stacks for high-water tracking before core 1 exists */
+    profiler_init();
+    profiler_register_stack(0, &__StackBottom,
+                            (size_t)((uintptr_t)&__StackTop - (uintptr_t)&__StackBottom));
+    profiler_register_stack(1, core1_stack, sizeof(core1_stack));
+    
     /* Initialize LED for debugging */
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
@@ -280,9 +628,9 @@ int main() {
         printf("ERROR: I2C initialization failed\n");
         while (1) {
             gpio_put(LED_PIN, 1);
-            sleep_ms(100);
+            timebase_sleep_ms(100);
             gpio_put(LED_PIN, 0);
-            sleep_ms(100);
+            timebase_sleep_ms(100);
         }
     }
     printf("I2C initialized successfully\n");
@@ -293,9 +641,9 @@ int main() {
         printf("ERROR: OLED driver initialization failed\n");
         while (1) {
             gpio_put(LED_PIN, 1);
-            sleep_ms(200);
+            timebase_sleep_ms(200);
             gpio_put(LED_PIN, 0);
-            sleep_ms(200);
+            timebase_sleep_ms(200);
         }
     }
     printf("OLED driver initialized\n");
@@ -306,25 +654,30 @@ int main() {
         printf("ERROR: Display initialization failed\n");
         while (1) {
             gpio_put(LED_PIN, 1);
-            sleep_ms(300);
+            timebase_sleep_ms(300);
             gpio_put(LED_PIN, 0);
-            sleep_ms(300);
+            timebase_sleep_ms(300);
         }
     }
     printf("Display initialized\n");
     
-    /* Initialize USB Host (TinyUSB active enumeration) */
-    printf("Initializing USB host...\n");
-    if (!usb_host_init()) {
-        printf("ERROR: USB host initialization failed\n");
-        /* Continue anyway - USB might not be essential */
+    /* Hand USB host + analysis to core 1 and wait until it is up */
+    event_queue_init();
+    dlog_init();
+    telemetry_init();
+    trace_init();
+    flight_recorder_init();
+    if (flash_store_init()) {
+        journal_init();
+    } else {
+        printf("WARNING: Forensic captures and the event journal will not be saved\n");
     }
-    printf("USB host initialized\n");
-    
-    /* Initialize threat analyzer */
-    printf("Initializing threat analyzer...\n");
-    threat_analyzer_init();
-    printf("Threat analyzer initialized\n\n");
+    multicore_launch_core1_with_stack(core1_main, core1_stack, sizeof(core1_stack));
+    if (multicore_fifo_pop_blocking() != CORE1_READY_OK) {
+        printf("WARNING: Core 1 reported USB host init failure\n");
+    }
+    dlog_drain(DLOG_RING_SIZE);
+    set_uart_output_mode(UART_OUTPUT_DEFAULT);
     
     /* Get font for text rendering */
     const oled_font_t *font = oled_get_font_5x7();
@@ -336,108 +689,66 @@ int main() {
     oled_draw_string(&display, 5, 20, "PlugSafe Booting...", font, true);
     oled_draw_string(&display, 5, 40, "The Protection your PC deserves", font, true);
     oled_display_flush(&display);
-    sleep_ms(2000);
+    timebase_sleep_ms(2000);
     
     /* Blink LED to indicate startup complete */
     for (int i = 0; i < 3; i++) {
         gpio_put(LED_PIN, 1);
-        sleep_ms(100);
+        timebase_sleep_ms(100);
         gpio_put(LED_PIN, 0);
-        sleep_ms(100);
+        timebase_sleep_ms(100);
     }
     
      printf("\nEntering main event loop...\n");
     printf("Display will refresh every %d ms\n", DISPLAY_UPDATE_INTERVAL_MS);
-    printf("USB polling every %d ms\n", USB_HOST_POLL_INTERVAL_MS);
-    printf("Press BOOTSEL button to toggle display mode (VID/PID <-> Manufacturer)\n\n");
+    printf("USB serviced on core 1 on IRQ events (idle backstop every %d ms)\n",
+           USB_HOST_IDLE_SERVICE_MS);
+    printf("Press BOOTSEL button to toggle display mode (VID/PID <-> Manufacturer)\n");
+    printf("Console: 'p' latency profile, 's' scheduler stats, 'r' reset profile, "
+           "'m' text/telemetry output, 't' trace, 'f' forensic slots, 'j' journal\n\n");
     
-    /* Main event loop */
-    while (1) {
-        uint64_t now_ms = time_us_64() / 1000;
-        
-        /* BOOTSEL button handling for display mode toggle (every 200ms debounce) */
-        if (now_ms - last_bootsel_check_ms >= BOOTSEL_DEBOUNCE_MS) {
-            last_bootsel_check_ms = now_ms;
-            
-            /* Read BOOTSEL button state (GPIO 24, active low) */
-            bool bootsel_pressed = !gpio_get(BOOTSEL_PIN);
-            
-            /* Detect rising edge (button pressed) */
-            if (bootsel_pressed && !bootsel_pressed_prev) {
-                /* Toggle display mode */
-                current_mode = (current_mode == DISPLAY_MODE_VID_PID) ? 
-                               DISPLAY_MODE_MANUFACTURER : DISPLAY_MODE_VID_PID;
-                printf("[BUTTON] Display mode toggled to: %s\n",
-                       current_mode == DISPLAY_MODE_VID_PID ? "VID/PID" : "Manufacturer");
-                /* Force immediate display update */
-                last_display_update_ms = 0;
-            }
-            bootsel_pressed_prev = bootsel_pressed;
-        }
-        
-        /* USB Host polling (every 10ms) */
-        if (now_ms - last_usb_poll_ms >= USB_HOST_POLL_INTERVAL_MS) {
-            last_usb_poll_ms = now_ms;
-            usb_host_task();
-        }
-        
-        /* Edge detection: check if device count changed */
-        uint8_t current_device_count = usb_get_device_count();
-        bool device_state_changed = (current_device_count != last_device_count);
-        
-        if (device_state_changed) {
-            last_device_count = current_device_count;
-            /* Force immediate display update on device connection/disconnection */
-            last_display_update_ms = 0;
-        }
-        
-        /* Display refresh (every 200ms or on state change) */
-        if (now_ms - last_display_update_ms >= DISPLAY_UPDATE_INTERVAL_MS) {
-            last_display_update_ms = now_ms;
-            
-            /* Automatic page switching based on device connection status */
-            uint8_t device_count = usb_get_device_count();
-            
-            /* Check if hub is connected - if so, always show warning page */
-            if (usb_is_hub_connected()) {
-                draw_hub_warning_page(&display, font);
-                current_page = DISPLAY_PAGE_WELCOME;  /* Reset page when hub detected */
-            } else {
-                /* Switch pages based on device presence */
-                if (device_count > 0) {
-                    /* Device connected - show device info */
-                    current_page = DISPLAY_PAGE_DEVICE_INFO;
-                    draw_device_screen(&display, font);
-                } else {
-                    /* No device - show welcome screen */
-                    current_page = DISPLAY_PAGE_WELCOME;
-                    draw_welcome_screen(&display, font);
-                }
-            }
-            
-            /* Flush to display */
-            oled_display_flush(&display);
-            
-            /* Adaptive LED blinking based on device state:
-             * - Device connected: Fast blink (200ms ON, 200ms OFF)
-             * - No device: Slow blink (500ms ON, 500ms OFF)
-             */
-            if (now_ms - last_led_update_ms >= 100) {
-                last_led_update_ms = now_ms;
-                
-                if (current_device_count > 0) {
-                    /* Device connected - fast blink (200ms half period) */
-                    gpio_put(LED_PIN, (now_ms / 200) % 2);
-                } else {
-                    /* No device - slow blink (500ms half period) */
-                    gpio_put(LED_PIN, (now_ms / 500) % 2);
-                }
-            }
-        }
-        
-        /* Small sleep to prevent busy-waiting */
-        sleep_ms(1);
-    }
+    /* Register core 0 tasks. The display also runs immediately whenever
+     * core 1 reports a state change or the display mode is toggled. */
+    ui_context_t ui = { .display = &display, .screen = NULL };
+    welcome_screen.font = font;
+    device_ids_screen.font = font;
+    device_strings_screen.font = font;
+    hub_warning_screen.font = font;
+    scheduler_init(&core0_sched);
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "input", .fn = input_task,
+        .period_ms = BOOTSEL_DEBOUNCE_MS, .priority = 1
+    });
+    display_task_id = scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "display", .fn = display_task, .ctx = &ui,
+        .period_ms = DISPLAY_UPDATE_INTERVAL_MS, .priority = 2
+    });
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "led", .fn = led_task,
+        .period_ms = LED_UPDATE_INTERVAL_MS, .priority = 3
+    });
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "log", .fn = log_task,
+        .period_ms = LOG_DRAIN_INTERVAL_MS, .priority = 4
+    });
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "telemetry", .fn = telemetry_task,
+        .period_ms = TELEMETRY_DRAIN_INTERVAL_MS, .priority = 4
+    });
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "storage", .fn = storage_task,
+        .period_ms = STORAGE_STEP_INTERVAL_MS, .priority = 4
+    });
+    scheduler_add_task(&core0_sched, &(scheduler_task_config_t){
+        .name = "console", .fn = console_task,
+        .period_ms = CONSOLE_POLL_INTERVAL_MS, .priority = 5
+    });
+    scheduler_set_poll(&core0_sched, core0_poll, NULL);
+    scheduler_trigger(&core0_sched, display_task_id);
+    
+    /* event_queue_push() on core 1 issues SEV, so a queued state change
+     * ends the scheduler's WFE sleep early */
+    scheduler_run(&core0_sched);
     
     return 0;
 }
@@ -0,0 +1,197 @@
+/*
+ * PlugSafe Deferred Logging Implementation
+ * Callers on the USB core queue compact records; core 0 formats them later
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "deferred_log.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/* Ring storage. head is written only by the producer core, tail only by the
+ * consumer; both are free-running and masked on access. */
+static dlog_record_t g_records[DLOG_RING_SIZE];
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static volatile uint32_t g_dropped = 0;
+static uint32_t g_high_water = 0;
+static volatile bool g_enabled = true;
+
+/* Longest conversion spec _print() passes on, e.g. "%-08lX" */
+#define DLOG_SPEC_LEN                 16
+
+/* Drop count already announced by dlog_drain() */
+static uint32_t g_dropped_reported = 0;
+
+/**
+ * @brief Print one conversion spec with its argument, passed as the type
+ * the conversion expects.
+ */
+static void _print_arg(const char *spec, char conv, bool is_long, dlog_arg_t arg) {
+    if (conv == 's') {
+        printf(spec, arg.s);
+    } else if (conv == 'd' || conv == 'i' || conv == 'c') {
+        if (is_long) {
+            printf(spec, (long)(int32_t)arg.u);
+        } else {
+            printf(spec, (int)arg.u);
+        }
+    } else if (is_long) {
+        printf(spec, (unsigned long)arg.u);
+    } else {
+        printf(spec, (unsigned)arg.u);
+    }
+}
+
+/**
+ * @brief Print a record (or an immediate message) with its arguments.
+ *
+ * A single printf(fmt, ...) would pass every argument with one type, which
+ * is undefined where int and pointers differ in size (the 64-bit host
+ * simulator). fmt is walked instead: literal text is written as is and each
+ * conversion is printed on its own. str, if set, is the first argument.
+ * Conversions beyond the arguments given are written literally.
+ */
+static void _print(const char *fmt, const char *str, uint8_t nargs, const dlog_arg_t *args) {
+    const char *p = fmt;
+    uint8_t next = 0;
+
+    while (*p) {
+        if (*p != '%') {
+            size_t len = strcspn(p, "%");
+            printf("%.*s", (int)len, p);
+            p += len;
+            continue;
+        }
+        if (p[1] == '%') {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+
+        /* Flags, width and precision, then length modifiers */
+        size_t len = 1 + strspn(p + 1, "-+ #0123456789.");
+        bool is_long = false;
+        while (p[len] == 'h' || p[len] == 'l') {
+            is_long = is_long || (p[len] == 'l');
+            len++;
+        }
+        char conv = p[len];
+        if (conv == '\0') {
+            break;
+        }
+        len++;
+
+        if (len >= DLOG_SPEC_LEN || (str == NULL && next >= nargs)) {
+            printf("%.*s", (int)len, p);
+        } else {
+            char spec[DLOG_SPEC_LEN];
+            memcpy(spec, p, len);
+            spec[len] = '\0';
+            if (str) {
+                _print_arg(spec, conv, is_long, (dlog_arg_t){ .s = str });
+                str = NULL;
+            } else {
+                _print_arg(spec, conv, is_long, args[next++]);
+            }
+        }
+        p += len;
+    }
+}
+
+void dlog_init(void) {
+    g_head = 0;
+    g_tail = 0;
+    g_dropped = 0;
+    g_high_water = 0;
+    g_dropped_reported = 0;
+    g_enabled = true;
+}
+
+void dlog_set_enabled(bool enabled) {
+    g_enabled = enabled;
+}
+
+void dlog_write(const char *fmt, const char *str, uint8_t nargs, const dlog_arg_t *args) {
+    if (!g_enabled) {
+        return;
+    }
+    if (nargs > DLOG_MAX_ARGS) {
+        nargs = DLOG_MAX_ARGS;
+    }
+
+    /* Only one core may produce; anything else keeps the old behaviour */
+    if (get_core_num() != DLOG_PRODUCER_CORE) {
+        _print(fmt, str, nargs, args);
+        return;
+    }
+
+    uint32_t head = g_head;
+    uint32_t used = head - g_tail;
+    if (used >= DLOG_RING_SIZE) {
+        g_dropped++;
+        return;
+    }
+    if (used + 1 > g_high_water) {
+        g_high_water = used + 1;
+    }
+
+    dlog_record_t *rec = &g_records[head & (DLOG_RING_SIZE - 1)];
+    rec->fmt = fmt;
+    rec->nargs = nargs;
+    memset(rec->args, 0, sizeof(rec->args));
+    if (nargs) {
+        memcpy(rec->args, args, nargs * sizeof(dlog_arg_t));
+    }
+    rec->has_str = (str != NULL);
+    if (str) {
+        strncpy(rec->str, str, DLOG_STR_LEN - 1);
+        rec->str[DLOG_STR_LEN - 1] = '\0';
+    }
+
+    /* Publish the record before the new head becomes visible */
+    __dmb();
+    g_head = head + 1;
+}
+
+uint32_t dlog_drain(uint32_t max_records) {
+    uint32_t printed = 0;
+
+    uint32_t dropped = g_dropped;
+    if (dropped != g_dropped_reported) {
+        printf("[LOG] %lu log records dropped (ring full)\n",
+               (unsigned long)(dropped - g_dropped_reported));
+        g_dropped_reported = dropped;
+    }
+
+    while (printed < max_records) {
+        uint32_t tail = g_tail;
+        if (tail == g_head) {
+            break;
+        }
+        __dmb();
+
+        const dlog_record_t *rec = &g_records[tail & (DLOG_RING_SIZE - 1)];
+        _print(rec->fmt, rec->has_str ? rec->str : NULL, rec->nargs, rec->args);
+
+        /* Release the slot only after formatting is done with it */
+        __dmb();
+        g_tail = tail + 1;
+        printed++;
+    }
+    return printed;
+}
+
+uint32_t dlog_get_dropped(void) {
+    return g_dropped;
+}
+
+uint32_t dlog_get_high_water(void) {
+    return g_high_water;
+}
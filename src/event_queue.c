@@ -0,0 +1,84 @@
+/*
+ * PlugSafe Inter-Core Event Queue Implementation
+ * Lock-free single-producer/single-consumer ring (core 1 -> core 0)
+ * Copyright (c) 2026
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "event_queue.h"
+#include <string.h>
+#include "timebase.h"
+#include "hardware/sync.h"
+
+/* Ring storage. head is written only by the producer (core 1), tail only by
+ * the consumer (core 0); both are free-running and masked on access.
+ * Pushed events sit between head and g_staged, private to core 1, until
+ * event_queue_commit() moves head up to them. */
+static core_event_t g_events[EVENT_QUEUE_SIZE];
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static uint32_t g_staged = 0;
+static volatile uint32_t g_dropped = 0;
+
+void event_queue_init(void) {
+    memset(g_events, 0, sizeof(g_events));
+    g_head = 0;
+    g_tail = 0;
+    g_staged = 0;
+    g_dropped = 0;
+}
+
+bool event_queue_push(core_event_type_e type, uint8_t dev_addr, uint16_t arg) {
+    uint32_t head = g_staged;
+
+    if ((head - g_tail) >= EVENT_QUEUE_SIZE) {
+        g_dropped++;
+        return false;
+    }
+
+    core_event_t *event = &g_events[head & (EVENT_QUEUE_SIZE - 1)];
+    event->type = (uint8_t)type;
+    event->dev_addr = dev_addr;
+    event->arg = arg;
+    event->time_ms = timebase_now_ms();
+    g_staged = head + 1;
+    return true;
+}
+
+void event_queue_commit(void) {
+    if (g_staged == g_head) {
+        return;
+    }
+
+    /* Publish the entries before the new head becomes visible to core 0 */
+    __dmb();
+    g_head = g_staged;
+
+    /* Wake core 0 if it is parked in __wfe() */
+    __sev();
+}
+
+bool event_queue_pop(core_event_t *event) {
+    uint32_t tail = g_tail;
+
+    if (tail == g_head) {
+        return false;
+    }
+
+    /* Read the entry only after observing the head that published it */
+    __dmb();
+    *event = g_events[tail & (EVENT_QUEUE_SIZE - 1)];
+
+    /* Finish reading before handing the slot back to core 1 */
+    __dmb();
+    g_tail = tail + 1;
+    return true;
+}
+
+uint32_t event_queue_get_dropped(void) {
+    return g_dropped;
+}
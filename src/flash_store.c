@@ -0,0 +1,92 @@
+/*
+ * PlugSafe Flash Store Implementation
+ * Reserved flash regions and multicore-safe erase/program
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "flash_store.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+_Static_assert(FLASH_STORE_SECTOR_SIZE == FLASH_SECTOR_SIZE, "flash sector size");
+_Static_assert(FLASH_STORE_PAGE_SIZE == FLASH_PAGE_SIZE, "flash page size");
+_Static_assert(FLASH_STORE_FORENSIC_OFFSET % FLASH_SECTOR_SIZE == 0, "region alignment");
+_Static_assert(FLASH_STORE_JOURNAL_OFFSET % FLASH_SECTOR_SIZE == 0, "region alignment");
+
+/* End of the firmware image in XIP space (linker script) */
+extern char __flash_binary_end;
+
+/* Writes are refused until flash_store_init() has checked the layout */
+static bool g_layout_ok = false;
+
+typedef struct {
+    uint32_t offset;
+    const void *data;
+    size_t len;
+} flash_op_t;
+
+/**
+ * @brief Erase callback, run with the other core parked and IRQs disabled
+ */
+static void _erase_cb(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_erase(op->offset, op->len);
+}
+
+/**
+ * @brief Program callback, run with the other core parked and IRQs disabled
+ */
+static void _program_cb(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_program(op->offset, (const uint8_t *)op->data, op->len);
+}
+
+/**
+ * @brief True if [offset, offset+len) lies inside the reserved regions
+ */
+static bool _in_region(uint32_t offset, size_t len) {
+    return g_layout_ok && offset >= FLASH_STORE_REGION_START &&
+           len <= PICO_FLASH_SIZE_BYTES - offset;
+}
+
+bool flash_store_init(void) {
+    uintptr_t image_end = (uintptr_t)&__flash_binary_end - XIP_BASE;
+    if (image_end > FLASH_STORE_REGION_START) {
+        printf("[FLASH] ERROR: Firmware (%lu bytes) overlaps the reserved region at 0x%06lx\n",
+               (unsigned long)image_end, (unsigned long)FLASH_STORE_REGION_START);
+        return false;
+    }
+    g_layout_ok = true;
+    return true;
+}
+
+void flash_store_core1_init(void) {
+    flash_safe_execute_core_init();
+}
+
+bool flash_store_erase(uint32_t offset, size_t len) {
+    if (offset % FLASH_SECTOR_SIZE || len % FLASH_SECTOR_SIZE || !_in_region(offset, len)) {
+        return false;
+    }
+    flash_op_t op = { .offset = offset, .len = len };
+    return flash_safe_execute(_erase_cb, &op, FLASH_STORE_LOCKOUT_TIMEOUT_MS) == PICO_OK;
+}
+
+bool flash_store_program(uint32_t offset, const void *data, size_t len) {
+    if (offset % FLASH_PAGE_SIZE || len % FLASH_PAGE_SIZE || !_in_region(offset, len)) {
+        return false;
+    }
+    flash_op_t op = { .offset = offset, .data = data, .len = len };
+    return flash_safe_execute(_program_cb, &op, FLASH_STORE_LOCKOUT_TIMEOUT_MS) == PICO_OK;
+}
+
+const uint8_t *flash_store_read_ptr(uint32_t offset) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + offset);
+}
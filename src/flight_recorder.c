@@ -0,0 +1,551 @@
+/*
+ * PlugSafe Flight Recorder Implementation
+ * Pre-trigger capture of raw HID reports and descriptors for flagged devices
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "flight_recorder.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "timebase.h"
+#include "hardware/sync.h"
+#include "flash_store.h"
+#include "hid_trace.h"
+#include "usb_host.h"
+
+_Static_assert(FR_FLASH_SLOTS * FR_SLOT_SIZE <= FLASH_STORE_FORENSIC_SIZE, "forensic region too small");
+_Static_assert(FR_SLOT_SECTORS * FLASH_STORE_SECTOR_SIZE == FR_SLOT_SIZE, "slot must be whole sectors");
+_Static_assert(FR_SLOT_DATA_OFFSET == FLASH_STORE_PAGE_SIZE, "header occupies one page");
+_Static_assert(sizeof(fr_slot_header_t) <= FR_SLOT_DATA_OFFSET, "slot header too large");
+_Static_assert((FR_REPORTS_PER_ITF & (FR_REPORTS_PER_ITF - 1)) == 0, "ring size must be a power of two");
+_Static_assert(FR_MAX_INTERFACES <= HT_MAX_INTERFACES, "too many interfaces for hid_trace");
+
+/* One recorded report */
+typedef struct {
+    uint32_t time_us;                 /* Arrival (IRQ stamp), low 32 bits */
+    uint8_t len;                      /* Bytes kept in data[] */
+    uint8_t data[FR_REPORT_BYTES];
+} fr_report_t;
+
+/* Per-interface ring, written only by core 1. A frozen ring belongs to
+ * core 0 until it has built the capture: core 1 neither records into it
+ * nor reuses it. */
+typedef struct {
+    bool in_use;
+    volatile bool frozen;
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t protocol;
+    uint16_t desc_len;
+    uint32_t count;                   /* Reports ever recorded (free-running) */
+    uint8_t desc[FR_REPORT_DESC_MAX];
+    fr_report_t reports[FR_REPORTS_PER_ITF];
+} fr_interface_t;
+
+typedef struct {
+    bool in_use;
+    uint8_t dev_addr;
+    uint8_t desc_device[HT_DEVICE_DESC_SIZE];
+} fr_device_t;
+
+/* Persist progress (core 0) */
+typedef enum {
+    PERSIST_IDLE = 0,
+    PERSIST_ERASE,
+    PERSIST_PROGRAM,
+    PERSIST_HEADER
+} persist_phase_t;
+
+static fr_device_t g_devices[FR_MAX_DEVICES];
+static fr_interface_t g_interfaces[FR_MAX_INTERFACES];
+static fr_stats_t g_stats;
+
+/* Trigger state handed to core 0: core 1 fills g_pending, g_frozen_device
+ * and the time reference and freezes the device's rings while
+ * g_capture_ready is false; core 0 owns them until it clears the flag
+ * again. Core 0 builds the slot image (header page, then the capture). */
+static uint8_t g_slot_image[FR_SLOT_SIZE] __attribute__((aligned(4)));
+static fr_slot_header_t g_pending;
+static hid_trace_device_t g_frozen_device;
+static uint32_t g_trigger_us = 0;     /* timebase_now_us32() at the trigger */
+static volatile bool g_capture_ready = false;
+
+static persist_phase_t g_phase = PERSIST_IDLE;
+static uint32_t g_slot_offset = 0;    /* Flash offset of the slot being written */
+static uint32_t g_step = 0;           /* Sector or page index within the slot */
+static uint32_t g_pages_total = 0;
+static uint32_t g_next_seq = 1;
+static uint8_t g_next_slot = 0;
+static uint32_t g_erased_sectors = 0; /* Leading sectors of g_next_slot known blank */
+static bool g_pre_erase = true;       /* Cleared after a failed erase */
+
+/* ============================================================================
+ * LOOKUP HELPERS
+ * ============================================================================ */
+
+static fr_interface_t *_find_interface(uint8_t dev_addr, uint8_t instance) {
+    for (int i = 0; i < FR_MAX_INTERFACES; i++) {
+        fr_interface_t *itf = &g_interfaces[i];
+        if (itf->in_use && itf->dev_addr == dev_addr && itf->instance == instance) {
+            return itf;
+        }
+    }
+    return NULL;
+}
+
+static fr_device_t *_find_device(uint8_t dev_addr) {
+    for (int i = 0; i < FR_MAX_DEVICES; i++) {
+        if (g_devices[i].in_use && g_devices[i].dev_addr == dev_addr) {
+            return &g_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Validate the slot header at a flash offset
+ */
+static const fr_slot_header_t *_read_slot_header(uint32_t offset) {
+    const fr_slot_header_t *hdr = (const fr_slot_header_t *)flash_store_read_ptr(offset);
+    if (hdr->magic != FR_SLOT_MAGIC || hdr->version != FR_SLOT_VERSION ||
+        hdr->header_size != sizeof(fr_slot_header_t) || hdr->capture_len > FR_CAPTURE_MAX ||
+        hdr->header_crc != hid_trace_crc32(hdr, offsetof(fr_slot_header_t, header_crc))) {
+        return NULL;
+    }
+    return hdr;
+}
+
+static uint32_t _slot_offset(uint8_t slot) {
+    return FLASH_STORE_FORENSIC_OFFSET + (uint32_t)slot * FR_SLOT_SIZE;
+}
+
+/**
+ * @brief Number of leading sectors of a slot that are already erased
+ */
+static uint32_t _blank_sectors(uint8_t slot) {
+    uint32_t sectors = 0;
+    for (; sectors < FR_SLOT_SECTORS; sectors++) {
+        const uint8_t *p = flash_store_read_ptr(_slot_offset(slot) +
+                                                sectors * FLASH_STORE_SECTOR_SIZE);
+        for (uint32_t i = 0; i < FLASH_STORE_SECTOR_SIZE; i++) {
+            if (p[i] != 0xFF) {
+                return sectors;
+            }
+        }
+    }
+    return sectors;
+}
+
+/* ============================================================================
+ * CAPTURE BUILD (CORE 0)
+ * ============================================================================ */
+
+/* Merge cursor over the interfaces of one device */
+typedef struct {
+    fr_interface_t *itf[FR_MAX_INTERFACES];
+    uint32_t pos[FR_MAX_INTERFACES];
+    uint8_t count;
+} fr_merge_t;
+
+/**
+ * @brief Index of the interface holding the oldest unread report, or -1
+ */
+static int _merge_oldest(const fr_merge_t *m) {
+    int best = -1;
+    uint32_t best_us = 0;
+    for (int i = 0; i < m->count; i++) {
+        if (m->pos[i] == m->itf[i]->count) {
+            continue;
+        }
+        uint32_t t = m->itf[i]->reports[m->pos[i] & (FR_REPORTS_PER_ITF - 1)].time_us;
+        if (best < 0 || (int32_t)(t - best_us) < 0) {
+            best = i;
+            best_us = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Serialize the frozen device and rings as a hid_trace into the slot
+ * image. The newest reports are kept when not all fit.
+ */
+static size_t _build_capture(void) {
+    fr_merge_t m = {0};
+    uint32_t total = 0;
+    size_t desc_bytes = HT_HEADER_SIZE + 1 + 1 + HT_DEVICE_DESC_SIZE + 3 * HT_STRING_MAX + 1;
+    for (int i = 0; i < FR_MAX_INTERFACES; i++) {
+        fr_interface_t *itf = &g_interfaces[i];
+        if (!itf->frozen) {
+            continue;
+        }
+        uint32_t avail = itf->count < FR_REPORTS_PER_ITF ? itf->count : FR_REPORTS_PER_ITF;
+        m.itf[m.count] = itf;
+        m.pos[m.count] = itf->count - avail;
+        m.count++;
+        total += avail;
+        desc_bytes += 7 + itf->desc_len;
+    }
+
+    /* Drop the oldest reports that would not fit */
+    uint32_t max_fit = (uint32_t)((FR_CAPTURE_MAX - desc_bytes) /
+                                  HT_REPORT_RECORD_MAX(FR_REPORT_BYTES));
+    for (uint32_t skip = total > max_fit ? total - max_fit : 0; skip > 0; skip--) {
+        m.pos[_merge_oldest(&m)]++;
+    }
+
+    /* Trace time 0 is the oldest kept report */
+    int first = _merge_oldest(&m);
+    uint32_t t0_us = g_trigger_us;
+    if (first >= 0) {
+        t0_us = m.itf[first]->reports[m.pos[first] & (FR_REPORTS_PER_ITF - 1)].time_us;
+    }
+    uint32_t start_time_ms = g_pending.trigger_time_ms - (g_trigger_us - t0_us) / 1000;
+
+    hid_trace_writer_t w;
+    hid_trace_writer_init(&w, g_slot_image + FR_SLOT_DATA_OFFSET, FR_CAPTURE_MAX, start_time_ms);
+    hid_trace_write_device(&w, &g_frozen_device);
+
+    for (uint8_t i = 0; i < m.count; i++) {
+        hid_trace_interface_t itf = {
+            .itf_id = i,
+            .dev_addr = g_frozen_device.dev_addr,
+            .instance = m.itf[i]->instance,
+            .protocol = m.itf[i]->protocol,
+            .desc_len = m.itf[i]->desc_len,
+            .desc = m.itf[i]->desc
+        };
+        hid_trace_write_interface(&w, &itf);
+    }
+
+    int i;
+    while ((i = _merge_oldest(&m)) >= 0) {
+        const fr_report_t *rep = &m.itf[i]->reports[m.pos[i] & (FR_REPORTS_PER_ITF - 1)];
+        hid_trace_write_report(&w, (uint8_t)i, rep->time_us - t0_us, rep->data, rep->len);
+        m.pos[i]++;
+    }
+
+    /* Hand the rings back to core 1 */
+    __dmb();
+    for (uint8_t i = 0; i < m.count; i++) {
+        m.itf[i]->frozen = false;
+    }
+    return hid_trace_finish(&w);
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void flight_recorder_init(void) {
+    memset(g_devices, 0, sizeof(g_devices));
+    memset(g_interfaces, 0, sizeof(g_interfaces));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_capture_ready = false;
+    g_phase = PERSIST_IDLE;
+
+    /* Continue numbering after the newest capture and overwrite the oldest */
+    g_next_seq = 1;
+    g_next_slot = 0;
+    for (uint8_t slot = 0; slot < FR_FLASH_SLOTS; slot++) {
+        const fr_slot_header_t *hdr = _read_slot_header(_slot_offset(slot));
+        if (hdr && hdr->seq >= g_next_seq) {
+            g_next_seq = hdr->seq + 1;
+            g_next_slot = (uint8_t)((slot + 1) % FR_FLASH_SLOTS);
+        }
+    }
+    g_erased_sectors = _blank_sectors(g_next_slot);
+    g_pre_erase = true;
+}
+
+void flight_recorder_add_device(uint8_t dev_addr, const uint8_t *desc_device) {
+    fr_device_t *dev = _find_device(dev_addr);
+    for (int i = 0; !dev && i < FR_MAX_DEVICES; i++) {
+        if (!g_devices[i].in_use) {
+            dev = &g_devices[i];
+        }
+    }
+    if (!dev) {
+        return;
+    }
+    memset(dev, 0, sizeof(*dev));
+    dev->in_use = true;
+    dev->dev_addr = dev_addr;
+    if (desc_device) {
+        memcpy(dev->desc_device, desc_device, HT_DEVICE_DESC_SIZE);
+    }
+}
+
+void flight_recorder_add_interface(uint8_t dev_addr, uint8_t instance, uint8_t protocol,
+                                   const uint8_t *desc_report, uint16_t desc_len) {
+    fr_interface_t *itf = _find_interface(dev_addr, instance);
+    if (itf && itf->frozen) {
+        itf->in_use = false;          /* Left to core 0; take a fresh ring */
+        itf = NULL;
+    }
+    for (int i = 0; !itf && i < FR_MAX_INTERFACES; i++) {
+        if (!g_interfaces[i].in_use && !g_interfaces[i].frozen) {
+            itf = &g_interfaces[i];
+        }
+    }
+    if (!itf) {
+        return;
+    }
+    itf->in_use = true;
+    itf->dev_addr = dev_addr;
+    itf->instance = instance;
+    itf->protocol = protocol;
+    itf->count = 0;
+    itf->desc_len = desc_len > FR_REPORT_DESC_MAX ? FR_REPORT_DESC_MAX : desc_len;
+    if (desc_report) {
+        memcpy(itf->desc, desc_report, itf->desc_len);
+    } else {
+        itf->desc_len = 0;
+    }
+}
+
+void flight_recorder_remove_device(uint8_t dev_addr) {
+    for (int i = 0; i < FR_MAX_INTERFACES; i++) {
+        if (g_interfaces[i].in_use && g_interfaces[i].dev_addr == dev_addr) {
+            g_interfaces[i].in_use = false;
+        }
+    }
+    fr_device_t *dev = _find_device(dev_addr);
+    if (dev) {
+        dev->in_use = false;
+    }
+}
+
+void flight_recorder_record(uint8_t dev_addr, uint8_t instance,
+                            const uint8_t *report, uint16_t len, uint64_t time_us) {
+    fr_interface_t *itf = _find_interface(dev_addr, instance);
+    if (!itf || itf->frozen) {
+        return;
+    }
+
+    fr_report_t *slot = &itf->reports[itf->count & (FR_REPORTS_PER_ITF - 1)];
+    uint8_t kept = len > FR_REPORT_BYTES ? FR_REPORT_BYTES : (uint8_t)len;
+    if (kept < len) {
+        g_stats.reports_truncated++;
+    }
+    slot->time_us = (uint32_t)time_us;
+    slot->len = kept;
+    memcpy(slot->data, report, kept);
+    itf->count++;
+    g_stats.reports_recorded++;
+}
+
+bool flight_recorder_trigger(uint8_t dev_addr, uint8_t level, uint8_t reason) {
+    if (g_capture_ready) {
+        g_stats.captures_missed++;
+        return false;
+    }
+
+    /* Freeze the device's rings; core 0 merges and serializes them */
+    bool found = false;
+    for (int i = 0; i < FR_MAX_INTERFACES; i++) {
+        if (g_interfaces[i].in_use && g_interfaces[i].dev_addr == dev_addr) {
+            g_interfaces[i].frozen = true;
+            found = true;
+        }
+    }
+    const fr_device_t *saved = _find_device(dev_addr);
+    if (!found && !saved) {
+        return false;
+    }
+
+    memset(&g_frozen_device, 0, sizeof(g_frozen_device));
+    g_frozen_device.dev_addr = dev_addr;
+    if (saved) {
+        memcpy(g_frozen_device.desc_device, saved->desc_device, HT_DEVICE_DESC_SIZE);
+    }
+    const usb_device_info_t *info = usb_get_device_info(dev_addr);
+    if (info) {
+        strncpy(g_frozen_device.manufacturer, info->manufacturer, HT_STRING_MAX - 1);
+        strncpy(g_frozen_device.product, info->product, HT_STRING_MAX - 1);
+        strncpy(g_frozen_device.serial, info->serial, HT_STRING_MAX - 1);
+    }
+
+    memset(&g_pending, 0, sizeof(g_pending));
+    g_trigger_us = timebase_now_us32();
+    g_pending.trigger_time_ms = timebase_now_ms();
+    g_pending.dev_addr = dev_addr;
+    g_pending.level = level;
+    g_pending.reason = reason;
+    g_stats.captures++;
+
+    /* Hand the staged image to core 0 */
+    __dmb();
+    g_capture_ready = true;
+    return true;
+}
+
+/* ============================================================================
+ * PERSIST (CORE 0)
+ * ============================================================================ */
+
+/**
+ * @brief Erase the next unerased sector of the next slot (~45 ms with core 1
+ * parked)
+ */
+static bool _erase_sector(void) {
+    uint32_t offset = _slot_offset(g_next_slot) + g_erased_sectors * FLASH_STORE_SECTOR_SIZE;
+    if (!flash_store_erase(offset, FLASH_STORE_SECTOR_SIZE)) {
+        return false;
+    }
+    g_erased_sectors++;
+    return true;
+}
+
+/**
+ * @brief Abandon the current capture after a flash failure
+ */
+static void _persist_fail(const char *what) {
+    g_stats.flash_errors++;
+    printf("[FR] ERROR: Flash %s failed in slot at 0x%06lx, capture dropped\n",
+           what, (unsigned long)g_slot_offset);
+    g_phase = PERSIST_IDLE;
+    __dmb();
+    g_capture_ready = false;
+}
+
+bool flight_recorder_persist_step(uint32_t now_ms) {
+    switch (g_phase) {
+        case PERSIST_IDLE: {
+            if (!g_capture_ready) {
+                /* Erase the next slot ahead of the verdict that will need
+                 * it, one sector per run and only while USB is quiet */
+                if (g_pre_erase && g_erased_sectors < FR_SLOT_SECTORS &&
+                    usb_host_reports_quiet(now_ms, FR_ERASE_QUIET_MS)) {
+                    if (!_erase_sector()) {
+                        g_stats.flash_errors++;
+                        g_pre_erase = false;
+                        printf("[FR] ERROR: Flash erase failed in slot %d\n", g_next_slot);
+                    }
+                    return true;
+                }
+                return false;
+            }
+            __dmb();
+
+            size_t len = _build_capture();
+            if (len == 0) {
+                /* Only on a writer overflow, which the fit check rules out */
+                __dmb();
+                g_capture_ready = false;
+                return true;
+            }
+            g_pending.capture_len = (uint32_t)len;
+
+            /* Complete the header; it is programmed last */
+            g_pending.magic = FR_SLOT_MAGIC;
+            g_pending.version = FR_SLOT_VERSION;
+            g_pending.header_size = sizeof(fr_slot_header_t);
+            g_pending.seq = g_next_seq;
+            g_pending.capture_crc = hid_trace_crc32(g_slot_image + FR_SLOT_DATA_OFFSET,
+                                                    g_pending.capture_len);
+            g_pending.header_crc = hid_trace_crc32(&g_pending,
+                                                   offsetof(fr_slot_header_t, header_crc));
+            memset(g_slot_image, 0xFF, FR_SLOT_DATA_OFFSET);
+            memcpy(g_slot_image, &g_pending, sizeof(g_pending));
+
+            g_slot_offset = _slot_offset(g_next_slot);
+            g_pages_total = (FR_SLOT_DATA_OFFSET + g_pending.capture_len +
+                             FLASH_STORE_PAGE_SIZE - 1) / FLASH_STORE_PAGE_SIZE;
+            g_step = 0;
+            g_phase = PERSIST_ERASE;
+            return true;
+        }
+
+        case PERSIST_ERASE:
+            /* Normally the slot was erased before the verdict and this
+             * falls straight through. Otherwise each erase parks core 1
+             * for ~45 ms, so it waits for USB to go quiet: not while the
+             * device that was just flagged is still typing. */
+            if (g_erased_sectors < FR_SLOT_SECTORS) {
+                if (!usb_host_reports_quiet(now_ms, FR_ERASE_QUIET_MS)) {
+                    return false;
+                }
+                if (!_erase_sector()) {
+                    _persist_fail("erase");
+                    return false;
+                }
+                return true;
+            }
+            g_step = 1;               /* Page 0 is the header */
+            g_phase = PERSIST_PROGRAM;
+            /* fall through */
+
+        case PERSIST_PROGRAM: {
+            uint32_t pages = g_pages_total - g_step;
+            if (pages > FR_PERSIST_PAGES_PER_STEP) {
+                pages = FR_PERSIST_PAGES_PER_STEP;
+            }
+            if (pages && !flash_store_program(g_slot_offset + g_step * FLASH_STORE_PAGE_SIZE,
+                                              g_slot_image + g_step * FLASH_STORE_PAGE_SIZE,
+                                              pages * FLASH_STORE_PAGE_SIZE)) {
+                _persist_fail("program");
+                return false;
+            }
+            g_step += pages;
+            if (g_step == g_pages_total) {
+                g_phase = PERSIST_HEADER;
+            }
+            return true;
+        }
+
+        case PERSIST_HEADER:
+            /* The slot becomes valid only now; a power loss before this
+             * point leaves an erased (ignored) slot */
+            if (!flash_store_program(g_slot_offset, g_slot_image, FLASH_STORE_PAGE_SIZE)) {
+                _persist_fail("program");
+                return false;
+            }
+            printf("[FR] Capture #%lu saved: dev_addr=%d, %lu bytes, slot %d\n",
+                   (unsigned long)g_pending.seq, g_pending.dev_addr,
+                   (unsigned long)g_pending.capture_len, g_next_slot);
+            g_stats.captures_saved++;
+            g_next_seq++;
+            g_next_slot = (uint8_t)((g_next_slot + 1) % FR_FLASH_SLOTS);
+            g_erased_sectors = _blank_sectors(g_next_slot);
+            g_phase = PERSIST_IDLE;
+            __dmb();
+            g_capture_ready = false;
+            return false;
+    }
+    return false;
+}
+
+void flight_recorder_print_slots(void) {
+    printf("[FR] Forensic slots at flash offset 0x%06lx (%d x %lu bytes):\n",
+           (unsigned long)FLASH_STORE_FORENSIC_OFFSET, FR_FLASH_SLOTS,
+           (unsigned long)FR_SLOT_SIZE);
+    for (uint8_t slot = 0; slot < FR_FLASH_SLOTS; slot++) {
+        uint32_t offset = _slot_offset(slot);
+        const fr_slot_header_t *hdr = _read_slot_header(offset);
+        if (!hdr) {
+            printf("[FR]   slot %d: empty\n", slot);
+            continue;
+        }
+        bool crc_ok = hid_trace_crc32(flash_store_read_ptr(offset + FR_SLOT_DATA_OFFSET),
+                                      hdr->capture_len) == hdr->capture_crc;
+        printf("[FR]   slot %d: #%lu dev_addr=%d level=%d reason=%d at %lu ms, %lu bytes%s\n",
+               slot, (unsigned long)hdr->seq, hdr->dev_addr, hdr->level, hdr->reason,
+               (unsigned long)hdr->trigger_time_ms, (unsigned long)hdr->capture_len,
+               crc_ok ? "" : " (CRC MISMATCH)");
+    }
+    printf("[FR] recorded=%lu truncated=%lu captures=%lu missed=%lu saved=%lu flash_errors=%lu\n",
+           (unsigned long)g_stats.reports_recorded, (unsigned long)g_stats.reports_truncated,
+           (unsigned long)g_stats.captures, (unsigned long)g_stats.captures_missed,
+           (unsigned long)g_stats.captures_saved, (unsigned long)g_stats.flash_errors);
+}
+
+const fr_stats_t *flight_recorder_get_stats(void) {
+    return &g_stats;
+}
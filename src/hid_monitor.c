@@ -10,25 +10,35 @@
  */
 
 #include "hid_monitor.h"
+#include "deferred_log.h"
+#include "telemetry.h"
 #include <stdio.h>
 #include <string.h>
-#include "pico/time.h"
+#include "timebase.h"
 
 /* HID Monitor tracking */
 static hid_monitor_t g_hid_monitors[MAX_HID_DEVICES];
 
+/* Detection tuning (core 1 only) */
+static hid_monitor_tuning_t g_tuning = {
+    .threshold_hz = HID_KEYSTROKE_THRESHOLD_HZ,
+    .window_ms = KEYSTROKE_RATE_WINDOW_MS
+};
+
 /* Helper: Get current time in ms */
 static uint64_t get_time_ms(void) {
-    return to_ms_since_boot(get_absolute_time());
+    return timebase_now_ms();
 }
 
 /* ===== Public API ===== */
 
 void hid_monitor_init(void) {
-    printf("[HID] Initializing HID keystroke rate monitor...\n");
+    DLOG("[HID] Initializing HID keystroke rate monitor...\n");
     memset(g_hid_monitors, 0, sizeof(g_hid_monitors));
-    printf("[HID] Keystroke threshold: %d keys/sec (malicious if exceeded)\n", HID_KEYSTROKE_THRESHOLD_HZ);
-    printf("[HID] Measurement window: %d ms\n", KEYSTROKE_RATE_WINDOW_MS);
+    g_tuning.threshold_hz = HID_KEYSTROKE_THRESHOLD_HZ;
+    g_tuning.window_ms = KEYSTROKE_RATE_WINDOW_MS;
+    DLOG("[HID] Keystroke threshold: %d keys/sec (malicious if exceeded)\n", HID_KEYSTROKE_THRESHOLD_HZ);
+    DLOG("[HID] Measurement window: %d ms\n", KEYSTROKE_RATE_WINDOW_MS);
 }
 
 void hid_monitor_add_device(uint8_t dev_addr) {
@@ -40,26 +50,58 @@ void hid_monitor_add_device(uint8_t dev_addr) {
             mon->dev_addr = dev_addr;
             mon->is_monitoring = true;
             mon->last_window_start_ms = get_time_ms();
-            printf("[HID] Started monitoring HID device at address: %d\n", dev_addr);
+            DLOG("[HID] Started monitoring HID device at address: %d\n", dev_addr);
             return;
         }
     }
-    printf("[HID] WARNING: No free HID monitor slots for device %d\n", dev_addr);
+    DLOG("[HID] WARNING: No free HID monitor slots for device %d\n", dev_addr);
 }
 
-void hid_monitor_report(uint8_t dev_addr, const uint8_t *report, uint16_t len) {
+void hid_monitor_report(uint8_t dev_addr, const uint8_t *report, uint16_t len,
+                        uint64_t arrival_us, uint16_t frame) {
     hid_monitor_t *mon = hid_get_monitor_stats(dev_addr);
     
     if (!mon) {
         return;
     }
     
-    uint64_t now = get_time_ms();
+    /* Windowing and jitter run on the transfer-completion time, not on the
+     * (later) time the callback was dispatched */
+    uint64_t now = arrival_us / 1000;
     mon->total_reports++;
     mon->reports_this_second++;
     
-    /* Check if we need to update the window */
-    if ((now - mon->last_window_start_ms) >= KEYSTROKE_RATE_WINDOW_MS) {
+    /* All-zero reports are key/button releases or idle polls */
+    for (uint16_t i = 0; i < len; i++) {
+        if (report[i]) {
+            mon->key_reports_this_window++;
+            break;
+        }
+    }
+    
+    /* Inter-arrival interval and smoothed jitter: J += (|D| - J) / 16 */
+    if (mon->last_report_us != 0 && arrival_us > mon->last_report_us) {
+        uint32_t interval_us = (uint32_t)(arrival_us - mon->last_report_us);
+        if (mon->min_interval_us == 0 || interval_us < mon->min_interval_us) {
+            mon->min_interval_us = interval_us;
+        }
+        if (mon->last_interval_us != 0) {
+            int32_t delta = (int32_t)interval_us - (int32_t)mon->last_interval_us;
+            if (delta < 0) {
+                delta = -delta;
+            }
+            mon->jitter_us = (uint32_t)((int32_t)mon->jitter_us +
+                                        (delta - (int32_t)mon->jitter_us) / 16);
+        }
+        mon->last_interval_us = interval_us;
+    }
+    mon->last_report_us = arrival_us;
+    mon->last_frame = frame;
+    
+    /* Check if we need to update the window (a report stamped just before the
+     * window opened counts towards it) */
+    if (now > mon->last_window_start_ms &&
+        (now - mon->last_window_start_ms) >= g_tuning.window_ms) {
         /* Calculate rate for completed window */
         uint64_t elapsed_ms = now - mon->last_window_start_ms;
         mon->current_rate_hz = (mon->reports_this_second * 1000) / elapsed_ms;
@@ -69,14 +111,32 @@ void hid_monitor_report(uint8_t dev_addr, const uint8_t *report, uint16_t len) {
             mon->peak_rate_hz = mon->current_rate_hz;
         }
         
+        /* Summarise the closed window on the telemetry stream */
+        tlm_key_summary_t summary = {
+            .dev_addr = dev_addr,
+            .window_ms = (uint16_t)(elapsed_ms > UINT16_MAX ? UINT16_MAX : elapsed_ms),
+            .reports = mon->reports_this_second,
+            .key_reports = mon->key_reports_this_window
+        };
+        telemetry_emit(TLM_MSG_KEY_SUMMARY, &summary, sizeof(summary));
+        tlm_rate_sample_t sample = {
+            .dev_addr = dev_addr,
+            .rate_hz = mon->current_rate_hz,
+            .peak_rate_hz = mon->peak_rate_hz,
+            .min_interval_us = mon->min_interval_us,
+            .jitter_us = mon->jitter_us
+        };
+        telemetry_emit(TLM_MSG_RATE_SAMPLE, &sample, sizeof(sample));
+        
         /* Reset window */
         mon->last_window_start_ms = now;
         mon->reports_this_second = 0;
+        mon->key_reports_this_window = 0;
         
         /* Log if spammy */
-        if (mon->current_rate_hz > HID_KEYSTROKE_THRESHOLD_HZ) {
-            printf("[HID] 🚨 ALERT: Keystroke rate %u keys/sec (threshold: %d) from device %d\n",
-                   mon->current_rate_hz, HID_KEYSTROKE_THRESHOLD_HZ, dev_addr);
+        if (mon->current_rate_hz > g_tuning.threshold_hz) {
+            DLOG("[HID] 🚨 ALERT: Keystroke rate %u keys/sec (threshold: %u) from device %d\n",
+                 mon->current_rate_hz, g_tuning.threshold_hz, dev_addr);
         }
     }
 }
@@ -88,14 +148,25 @@ uint32_t hid_get_keystroke_rate(uint8_t dev_addr) {
 
 bool hid_is_spammy(uint8_t dev_addr) {
     hid_monitor_t *mon = hid_get_monitor_stats(dev_addr);
-    return (mon && mon->current_rate_hz > HID_KEYSTROKE_THRESHOLD_HZ);
+    return (mon && mon->current_rate_hz > g_tuning.threshold_hz);
+}
+
+void hid_monitor_set_tuning(const hid_monitor_tuning_t *tuning) {
+    g_tuning = *tuning;
+    if (g_tuning.window_ms == 0) {
+        g_tuning.window_ms = 1;
+    }
+}
+
+const hid_monitor_tuning_t *hid_monitor_get_tuning(void) {
+    return &g_tuning;
 }
 
 void hid_monitor_remove_device(uint8_t dev_addr) {
     for (int i = 0; i < MAX_HID_DEVICES; i++) {
         if (g_hid_monitors[i].dev_addr == dev_addr && g_hid_monitors[i].is_monitoring) {
-            printf("[HID] Stopped monitoring HID device at address: %d (peak rate: %u keys/sec)\n",
-                   dev_addr, g_hid_monitors[i].peak_rate_hz);
+            DLOG("[HID] Stopped monitoring HID device at address: %d (peak rate: %u keys/sec)\n",
+                 dev_addr, g_hid_monitors[i].peak_rate_hz);
             memset(&g_hid_monitors[i], 0, sizeof(g_hid_monitors[i]));
             return;
         }
@@ -0,0 +1,252 @@
+/*
+ * PlugSafe HID Trace Format Implementation
+ * Compact capture of USB descriptors and timestamped HID reports
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "hid_trace.h"
+#include <string.h>
+
+/* Builds on the host as well: no SDK headers here */
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+/**
+ * @brief Reserve n bytes at the end of the trace, or flag an overflow
+ */
+static uint8_t *_reserve(hid_trace_writer_t *w, size_t n) {
+    if (w->overflow || w->cap - w->len < n) {
+        w->overflow = true;
+        return NULL;
+    }
+    uint8_t *p = w->buf + w->len;
+    w->len += n;
+    return p;
+}
+
+static bool _put(hid_trace_writer_t *w, const void *data, size_t n) {
+    uint8_t *p = _reserve(w, n);
+    if (!p) {
+        return false;
+    }
+    if (n) {
+        memcpy(p, data, n);         /* data may be NULL when n is 0 */
+    }
+    return true;
+}
+
+static bool _put_u8(hid_trace_writer_t *w, uint8_t v) {
+    return _put(w, &v, 1);
+}
+
+static bool _put_varint(hid_trace_writer_t *w, uint64_t v) {
+    uint8_t tmp[10];
+    size_t n = 0;
+    do {
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        tmp[n++] = byte | (v ? 0x80 : 0);
+    } while (v);
+    return _put(w, tmp, n);
+}
+
+static bool _put_string(hid_trace_writer_t *w, const char *s) {
+    const char *end = memchr(s, '\0', HT_STRING_MAX - 1);
+    size_t n = end ? (size_t)(end - s) : HT_STRING_MAX - 1;
+    return _put_u8(w, (uint8_t)n) && _put(w, s, n);
+}
+
+void hid_trace_writer_init(hid_trace_writer_t *w, uint8_t *buf, size_t cap,
+                           uint32_t start_time_ms) {
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+
+    uint8_t header[HT_HEADER_SIZE] = {0};
+    memcpy(header, HT_MAGIC, 4);
+    header[4] = HT_VERSION;
+    header[8] = (uint8_t)start_time_ms;
+    header[9] = (uint8_t)(start_time_ms >> 8);
+    header[10] = (uint8_t)(start_time_ms >> 16);
+    header[11] = (uint8_t)(start_time_ms >> 24);
+    _put(w, header, sizeof(header));
+}
+
+bool hid_trace_write_device(hid_trace_writer_t *w, const hid_trace_device_t *dev) {
+    return _put_u8(w, HT_REC_DEVICE) &&
+           _put_u8(w, dev->dev_addr) &&
+           _put(w, dev->desc_device, HT_DEVICE_DESC_SIZE) &&
+           _put_string(w, dev->manufacturer) &&
+           _put_string(w, dev->product) &&
+           _put_string(w, dev->serial);
+}
+
+bool hid_trace_write_interface(hid_trace_writer_t *w, const hid_trace_interface_t *itf) {
+    if (itf->itf_id >= HT_MAX_INTERFACES || itf->desc_len > HT_MAX_REPORT_DESC) {
+        return false;
+    }
+    uint8_t head[7] = {
+        HT_REC_INTERFACE, itf->itf_id, itf->dev_addr, itf->instance, itf->protocol,
+        (uint8_t)itf->desc_len, (uint8_t)(itf->desc_len >> 8)
+    };
+    return _put(w, head, sizeof(head)) && _put(w, itf->desc, itf->desc_len);
+}
+
+bool hid_trace_write_report(hid_trace_writer_t *w, uint8_t itf_id, uint64_t time_us,
+                            const uint8_t *data, uint8_t len) {
+    if (itf_id >= HT_MAX_INTERFACES || len > HT_MAX_REPORT) {
+        return false;
+    }
+
+    /* Out-of-order stamps (should not happen) are clamped to a zero delta */
+    uint64_t delta = time_us > w->last_us[itf_id] ? time_us - w->last_us[itf_id] : 0;
+    if (!(_put_u8(w, HT_REC_REPORT) && _put_u8(w, itf_id) && _put_varint(w, delta) &&
+          _put_u8(w, len) && _put(w, data, len))) {
+        return false;
+    }
+    w->last_us[itf_id] += delta;
+    return true;
+}
+
+size_t hid_trace_finish(hid_trace_writer_t *w) {
+    _put_u8(w, HT_REC_END);
+    return w->overflow ? 0 : w->len;
+}
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+static bool _get(hid_trace_reader_t *r, void *out, size_t n) {
+    if (r->len - r->pos < n) {
+        return false;
+    }
+    memcpy(out, r->data + r->pos, n);
+    r->pos += n;
+    return true;
+}
+
+static bool _get_varint(hid_trace_reader_t *r, uint64_t *out) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (!_get(r, &byte, 1)) {
+            return false;
+        }
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _get_string(hid_trace_reader_t *r, char *out) {
+    uint8_t n;
+    if (!_get(r, &n, 1) || n >= HT_STRING_MAX || !_get(r, out, n)) {
+        return false;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+bool hid_trace_reader_init(hid_trace_reader_t *r, const uint8_t *data, size_t len) {
+    memset(r, 0, sizeof(*r));
+    if (len < HT_HEADER_SIZE || memcmp(data, HT_MAGIC, 4) != 0 || data[4] != HT_VERSION) {
+        return false;
+    }
+    r->data = data;
+    r->len = len;
+    r->pos = HT_HEADER_SIZE;
+    r->version = data[4];
+    r->start_time_ms = (uint32_t)data[8] | ((uint32_t)data[9] << 8) |
+                       ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
+    return true;
+}
+
+bool hid_trace_next(hid_trace_reader_t *r, hid_trace_record_t *rec) {
+    uint8_t type;
+    if (!r->data || !_get(r, &type, 1)) {
+        return false;
+    }
+
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (hid_trace_rec_type_e)type;
+    switch (type) {
+        case HT_REC_END:
+            /* Nothing may be read after the end marker */
+            r->data = NULL;
+            return true;
+
+        case HT_REC_DEVICE: {
+            hid_trace_device_t *dev = &rec->device;
+            return _get(r, &dev->dev_addr, 1) &&
+                   _get(r, dev->desc_device, HT_DEVICE_DESC_SIZE) &&
+                   _get_string(r, dev->manufacturer) &&
+                   _get_string(r, dev->product) &&
+                   _get_string(r, dev->serial);
+        }
+
+        case HT_REC_INTERFACE: {
+            hid_trace_interface_t *itf = &rec->itf;
+            uint8_t head[6];
+            if (!_get(r, head, sizeof(head))) {
+                return false;
+            }
+            itf->itf_id = head[0];
+            itf->dev_addr = head[1];
+            itf->instance = head[2];
+            itf->protocol = head[3];
+            itf->desc_len = (uint16_t)(head[4] | (head[5] << 8));
+            if (itf->itf_id >= HT_MAX_INTERFACES || itf->desc_len > HT_MAX_REPORT_DESC ||
+                r->len - r->pos < itf->desc_len) {
+                return false;
+            }
+            itf->desc = r->data + r->pos;
+            r->pos += itf->desc_len;
+            return true;
+        }
+
+        case HT_REC_REPORT: {
+            hid_trace_report_t *rep = &rec->report;
+            uint64_t delta;
+            if (!_get(r, &rep->itf_id, 1) || rep->itf_id >= HT_MAX_INTERFACES ||
+                !_get_varint(r, &delta) || !_get(r, &rep->len, 1) ||
+                rep->len > HT_MAX_REPORT || r->len - r->pos < rep->len) {
+                return false;
+            }
+            rep->data = r->data + r->pos;
+            r->pos += rep->len;
+            r->last_us[rep->itf_id] += delta;
+            rep->time_us = r->last_us[rep->itf_id];
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+/* ============================================================================
+ * CRC-32
+ * ============================================================================ */
+
+uint32_t hid_trace_crc32(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
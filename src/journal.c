@@ -0,0 +1,406 @@
+/*
+ * PlugSafe Event Journal Implementation
+ * Log-structured, wear-leveled record of device events that survives reboots
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "journal.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "timebase.h"
+#include "hardware/sync.h"
+#include "flash_store.h"
+#include "telemetry.h"
+#include "usb_host.h"
+
+#define JOURNAL_SECTORS               (FLASH_STORE_JOURNAL_SIZE / JOURNAL_SECTOR_SIZE)
+
+_Static_assert(JOURNAL_SECTOR_SIZE == FLASH_STORE_SECTOR_SIZE, "journal sector size");
+_Static_assert(JOURNAL_PAGE_SIZE == FLASH_STORE_PAGE_SIZE, "journal page size");
+_Static_assert(JOURNAL_SECTORS >= 2, "journal needs a spare sector");
+_Static_assert((JOURNAL_RING_SIZE & (JOURNAL_RING_SIZE - 1)) == 0, "ring size must be a power of two");
+
+/* Queued record from the producer core */
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint32_t time_ms;
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+} journal_slot_t;
+
+/* SPSC ring: head written only by the producer, tail only by core 0 */
+static journal_slot_t g_slots[JOURNAL_RING_SIZE];
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static volatile bool g_enabled = false;
+
+/* Writer state (core 0). g_page mirrors the flash page being filled:
+ * bytes below g_page_flushed are already programmed, the rest up to
+ * g_page_len are waiting, and everything after is 0xFF. A page is
+ * programmed again as it grows; already-programmed bytes are rewritten
+ * with the same value, so a power loss can only tear the new records. */
+static uint8_t g_page[JOURNAL_PAGE_SIZE];
+static uint32_t g_sector = 0;         /* Sector being filled */
+static uint32_t g_seq = 0;            /* Its sequence number */
+static uint32_t g_page_offset = 0;    /* Page within the sector */
+static uint32_t g_page_len = 0;
+static uint32_t g_page_flushed = 0;
+static uint32_t g_unflushed_since_ms = 0;
+static bool g_page_full = false;      /* A staged record did not fit */
+static bool g_need_sector = false;    /* Sector exhausted, open the next one */
+static bool g_next_erased = false;    /* The sector after g_sector is blank */
+static bool g_boot_pending = false;
+static uint32_t g_boot_ms = 0;        /* Uptime at journal_init(), the BOOT record's time */
+
+static uint32_t g_last_counters_ms = 0;
+static journal_stats_t g_stats;
+
+/* Records lost, counted per core (indexed by get_core_num()) so neither
+ * core increments a counter the other one writes. journal_get_stats()
+ * adds them up. */
+static volatile uint32_t g_dropped[2];
+
+/* ============================================================================
+ * HELPERS (CORE 0)
+ * ============================================================================ */
+
+static uint32_t _sector_offset(uint32_t sector) {
+    return FLASH_STORE_JOURNAL_OFFSET + sector * JOURNAL_SECTOR_SIZE;
+}
+
+static uint32_t _next_sector(uint32_t sector) {
+    return (sector + 1) % JOURNAL_SECTORS;
+}
+
+static bool _is_blank(const uint8_t *p, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != JOURNAL_ERASED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Stop journaling after a flash failure (records are discarded)
+ */
+static void _fail(const char *what, uint32_t offset) {
+    g_stats.flash_errors++;
+    g_enabled = false;
+    printf("[JNL] ERROR: Flash %s failed at 0x%06lx, journal stopped\n",
+           what, (unsigned long)offset);
+}
+
+/**
+ * @brief Move to the next page of the sector in RAM
+ */
+static void _advance_page(void) {
+    g_page_offset += JOURNAL_PAGE_SIZE;
+    memset(g_page, JOURNAL_ERASED, sizeof(g_page));
+    g_page_len = 0;
+    g_page_flushed = 0;
+    g_page_full = false;
+    if (g_page_offset >= JOURNAL_SECTOR_SIZE) {
+        g_need_sector = true;
+    }
+}
+
+/**
+ * @brief Start the (already erased) next sector: its header becomes the
+ * first bytes of the page buffer and is programmed with the first records
+ */
+static void _open_sector(uint32_t now_ms) {
+    journal_sector_header_t hdr;
+    g_sector = _next_sector(g_sector);
+    g_seq++;
+    journal_sector_header_init(&hdr, g_seq, g_stats.boot);
+
+    memset(g_page, JOURNAL_ERASED, sizeof(g_page));
+    memcpy(g_page, &hdr, sizeof(hdr));
+    g_page_offset = 0;
+    g_page_len = JOURNAL_SECTOR_DATA_OFFSET;
+    g_page_flushed = 0;
+    g_page_full = false;
+    g_unflushed_since_ms = now_ms;
+    g_need_sector = false;
+
+    /* The following sector holds the oldest records (or is blank on a
+     * fresh device); it is erased ahead of need */
+    g_next_erased = _is_blank(flash_store_read_ptr(_sector_offset(_next_sector(g_sector))),
+                              JOURNAL_SECTOR_SIZE);
+}
+
+/**
+ * @brief Append an encoded record to the page buffer.
+ *
+ * Returns false if it has to wait for a flash operation first: the buffered
+ * page is full but not yet programmed, or the sector is exhausted.
+ */
+static bool _stage(uint8_t type, uint32_t time_ms, const void *payload, size_t len) {
+    uint8_t rec[JOURNAL_RECORD_MAX];
+    size_t rec_len = journal_encode_record(rec, type, time_ms, payload, len);
+    if (rec_len == 0) {
+        return true;                  /* Oversized, never fits: discard */
+    }
+
+    while (!g_need_sector) {
+        if (g_page_len + rec_len <= JOURNAL_PAGE_SIZE) {
+            if (g_page_len == g_page_flushed) {
+                g_unflushed_since_ms = time_ms;
+            }
+            memcpy(g_page + g_page_len, rec, rec_len);
+            g_page_len += rec_len;
+            g_stats.records++;
+            return true;
+        }
+        /* Records never cross a page; the rest of this one stays erased */
+        if (g_page_len > g_page_flushed) {
+            g_page_full = true;
+            return false;
+        }
+        _advance_page();
+    }
+    return false;
+}
+
+/**
+ * @brief Program the page buffer. One page takes well under a millisecond
+ * with core 1 parked.
+ */
+static bool _program_page(void) {
+    uint32_t offset = _sector_offset(g_sector) + g_page_offset;
+    if (!flash_store_program(offset, g_page, JOURNAL_PAGE_SIZE)) {
+        _fail("program", offset);
+        return false;
+    }
+    g_stats.pages_programmed++;
+    g_page_flushed = g_page_len;
+    if (g_page_full) {
+        _advance_page();
+    }
+    return true;
+}
+
+/**
+ * @brief Erase the sector after the current one (~45 ms with core 1 parked)
+ */
+static bool _erase_next(void) {
+    uint32_t offset = _sector_offset(_next_sector(g_sector));
+    if (!flash_store_erase(offset, JOURNAL_SECTOR_SIZE)) {
+        _fail("erase", offset);
+        return false;
+    }
+    g_stats.sectors_erased++;
+    g_next_erased = true;
+    return true;
+}
+
+/**
+ * @brief True once no HID report has arrived for JOURNAL_ERASE_QUIET_MS
+ */
+static bool _usb_quiet(uint32_t now_ms) {
+    return usb_host_reports_quiet(now_ms, JOURNAL_ERASE_QUIET_MS);
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void journal_init(void) {
+    g_head = 0;
+    g_tail = 0;
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_dropped[0] = 0;
+    g_dropped[1] = 0;
+    memset(g_page, JOURNAL_ERASED, sizeof(g_page));
+    g_page_len = 0;
+    g_page_flushed = 0;
+    g_page_full = false;
+
+    /* Newest sector = highest sequence number */
+    journal_sector_header_t hdr;
+    bool found = false;
+    for (uint32_t s = 0; s < JOURNAL_SECTORS; s++) {
+        journal_sector_header_t h;
+        if (journal_sector_valid(flash_store_read_ptr(_sector_offset(s)), &h) &&
+            (!found || h.seq > hdr.seq)) {
+            hdr = h;
+            g_sector = s;
+            found = true;
+        }
+    }
+
+    uint32_t last_boot = 0;
+    if (found) {
+        /* Tail scan of that sector only: find the append position and the
+         * last boot number */
+        const uint8_t *sector = flash_store_read_ptr(_sector_offset(g_sector));
+        journal_reader_t r;
+        journal_record_t rec;
+        g_seq = hdr.seq;
+        last_boot = hdr.boot;
+        journal_reader_init(&r, sector);
+        while (journal_reader_next(&r, &rec)) {
+            if (rec.type == JOURNAL_REC_BOOT && rec.len == sizeof(journal_boot_t)) {
+                journal_boot_t boot;
+                memcpy(&boot, rec.payload, sizeof(boot));
+                if (boot.boot > last_boot) {
+                    last_boot = boot.boot;
+                }
+            }
+        }
+        g_stats.torn = r.torn;
+
+        /* Appending is only safe into bytes that are still erased */
+        uint32_t pos = r.pos;
+        while (pos < JOURNAL_SECTOR_SIZE) {
+            uint32_t page_end = (pos & ~(JOURNAL_PAGE_SIZE - 1)) + JOURNAL_PAGE_SIZE;
+            if (_is_blank(sector + pos, page_end - pos)) {
+                break;
+            }
+            pos = page_end;
+        }
+        g_page_offset = pos & ~(JOURNAL_PAGE_SIZE - 1);
+        if (pos >= JOURNAL_SECTOR_SIZE) {
+            g_need_sector = true;
+        } else {
+            memcpy(g_page, sector + g_page_offset, JOURNAL_PAGE_SIZE);
+            g_page_len = pos - g_page_offset;
+            g_page_flushed = g_page_len;
+            g_need_sector = false;
+        }
+    } else {
+        /* Fresh journal: the first sector opened is sector 0 */
+        g_sector = JOURNAL_SECTORS - 1;
+        g_seq = 0;
+        g_need_sector = true;
+    }
+    g_next_erased = _is_blank(flash_store_read_ptr(_sector_offset(_next_sector(g_sector))),
+                              JOURNAL_SECTOR_SIZE);
+
+    g_stats.boot = last_boot + 1;
+    g_boot_pending = true;
+    g_boot_ms = timebase_now_ms();
+    g_last_counters_ms = g_boot_ms;
+    g_enabled = true;
+
+    printf("[JNL] Boot #%lu, journal sector %lu (seq %lu) at offset %lu",
+           (unsigned long)g_stats.boot, (unsigned long)g_sector, (unsigned long)g_seq,
+           (unsigned long)(g_need_sector ? JOURNAL_SECTOR_SIZE : g_page_offset + g_page_len));
+    if (g_stats.torn) {
+        printf(", %lu torn records skipped", (unsigned long)g_stats.torn);
+    }
+    printf("\n");
+}
+
+void journal_append(journal_rec_type_e type, const void *payload, size_t len) {
+    if (!g_enabled || len > JOURNAL_MAX_PAYLOAD) {
+        return;
+    }
+
+    uint32_t now_ms = timebase_now_ms();
+    uint core = get_core_num();
+    if (core != JOURNAL_PRODUCER_CORE) {
+        if (!_stage((uint8_t)type, now_ms, payload, len)) {
+            g_dropped[core]++;
+        }
+        return;
+    }
+
+    uint32_t head = g_head;
+    if ((head - g_tail) >= JOURNAL_RING_SIZE) {
+        g_dropped[core]++;
+        return;
+    }
+
+    journal_slot_t *slot = &g_slots[head & (JOURNAL_RING_SIZE - 1)];
+    slot->type = (uint8_t)type;
+    slot->len = (uint8_t)len;
+    slot->time_ms = now_ms;
+    memcpy(slot->payload, payload, len);
+
+    /* Publish the slot before the new head becomes visible */
+    __dmb();
+    g_head = head + 1;
+}
+
+bool journal_step(uint32_t now_ms) {
+    if (!g_enabled) {
+        return false;
+    }
+
+    if (g_boot_pending) {
+        journal_boot_t boot = { .boot = g_stats.boot };
+        g_boot_pending = !_stage(JOURNAL_REC_BOOT, g_boot_ms, &boot, sizeof(boot));
+    }
+    if (now_ms - g_last_counters_ms >= JOURNAL_COUNTERS_INTERVAL_MS) {
+        tlm_counters_t counters;
+        telemetry_get_counters(&counters);
+        if (_stage(JOURNAL_REC_COUNTERS, now_ms, &counters, sizeof(counters))) {
+            g_last_counters_ms = now_ms;
+        }
+    }
+
+    /* Queued records stay in the ring until the page buffer takes them */
+    while (g_tail != g_head) {
+        uint32_t tail = g_tail;
+        __dmb();
+        const journal_slot_t *slot = &g_slots[tail & (JOURNAL_RING_SIZE - 1)];
+        if (!_stage(slot->type, slot->time_ms, slot->payload, slot->len)) {
+            break;
+        }
+        __dmb();
+        g_tail = tail + 1;
+    }
+
+    /* At most one flash operation per call */
+    if (g_need_sector) {
+        if (!g_next_erased) {
+            /* Out of pre-erased space. An erase stalls core 1 for ~45 ms,
+             * so it still waits for USB to go quiet: records queue in the
+             * ring until then, and are dropped once it is full. */
+            return _usb_quiet(now_ms) && _erase_next();
+        }
+        _open_sector(now_ms);
+        return false;
+    }
+    if (g_page_len > g_page_flushed &&
+        (g_page_full || (int32_t)(now_ms - g_unflushed_since_ms) >= JOURNAL_FLUSH_INTERVAL_MS)) {
+        return _program_page();
+    }
+    if (!g_next_erased && _usb_quiet(now_ms)) {
+        return _erase_next();
+    }
+    return false;
+}
+
+void journal_print_status(void) {
+    if (!g_enabled) {
+        printf("[JNL] Journal disabled\n");
+        return;
+    }
+    printf("[JNL] Boot #%lu, %u sectors at flash offset 0x%06lx\n",
+           (unsigned long)g_stats.boot, (unsigned)JOURNAL_SECTORS,
+           (unsigned long)FLASH_STORE_JOURNAL_OFFSET);
+    printf("[JNL]   sector %lu (seq %lu): page %lu, %lu bytes buffered (%lu unflushed), "
+           "next sector %s\n",
+           (unsigned long)g_sector, (unsigned long)g_seq,
+           (unsigned long)(g_page_offset / JOURNAL_PAGE_SIZE), (unsigned long)g_page_len,
+           (unsigned long)(g_page_len - g_page_flushed),
+           g_next_erased ? "erased" : "not erased");
+    printf("[JNL] records=%lu dropped=%lu torn=%lu pages=%lu erases=%lu flash_errors=%lu\n",
+           (unsigned long)g_stats.records, (unsigned long)(g_dropped[0] + g_dropped[1]),
+           (unsigned long)g_stats.torn, (unsigned long)g_stats.pages_programmed,
+           (unsigned long)g_stats.sectors_erased, (unsigned long)g_stats.flash_errors);
+}
+
+const journal_stats_t *journal_get_stats(void) {
+    g_stats.dropped = g_dropped[0] + g_dropped[1];
+    return &g_stats;
+}
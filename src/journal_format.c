@@ -0,0 +1,109 @@
+/*
+ * PlugSafe Event Journal Format Implementation
+ * On-flash sector and record layout shared by the firmware and host tools
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "journal_format.h"
+#include <string.h>
+
+/* Builds on the host as well: no SDK headers here */
+
+_Static_assert(sizeof(journal_sector_header_t) <= JOURNAL_SECTOR_DATA_OFFSET,
+               "journal_sector_header_t too large");
+_Static_assert(sizeof(tlm_counters_t) <= JOURNAL_MAX_PAYLOAD, "tlm_counters_t too large");
+_Static_assert(sizeof(tlm_mount_t) <= JOURNAL_MAX_PAYLOAD, "tlm_mount_t too large");
+_Static_assert(sizeof(journal_fingerprint_t) <= JOURNAL_MAX_PAYLOAD,
+               "journal_fingerprint_t too large");
+_Static_assert(JOURNAL_MAX_PAYLOAD < JOURNAL_ERASED, "len byte must not look erased");
+
+bool journal_sector_valid(const uint8_t *sector, journal_sector_header_t *hdr) {
+    journal_sector_header_t h;
+    memcpy(&h, sector, sizeof(h));
+    if (h.magic != JOURNAL_SECTOR_MAGIC || h.version != JOURNAL_FORMAT_VERSION ||
+        h.crc != tlm_crc16((const uint8_t *)&h, offsetof(journal_sector_header_t, crc))) {
+        return false;
+    }
+    if (hdr) {
+        *hdr = h;
+    }
+    return true;
+}
+
+void journal_sector_header_init(journal_sector_header_t *hdr, uint32_t seq, uint32_t boot) {
+    hdr->magic = JOURNAL_SECTOR_MAGIC;
+    hdr->seq = seq;
+    hdr->boot = boot;
+    hdr->version = JOURNAL_FORMAT_VERSION;
+    hdr->crc = tlm_crc16((const uint8_t *)hdr, offsetof(journal_sector_header_t, crc));
+}
+
+size_t journal_encode_record(uint8_t *out, uint8_t type, uint32_t time_ms,
+                             const void *payload, size_t len) {
+    if (len > JOURNAL_MAX_PAYLOAD) {
+        return 0;
+    }
+    out[0] = (uint8_t)len;
+    out[1] = type;
+    memcpy(out + 2, &time_ms, sizeof(time_ms));
+    if (len) {
+        memcpy(out + 6, payload, len);
+    }
+    uint16_t crc = tlm_crc16(out, 6 + len);
+    memcpy(out + 6 + len, &crc, sizeof(crc));
+    return JOURNAL_RECORD_OVERHEAD + len;
+}
+
+void journal_reader_init(journal_reader_t *r, const uint8_t *sector) {
+    r->sector = sector;
+    r->pos = JOURNAL_SECTOR_DATA_OFFSET;
+    r->torn = 0;
+}
+
+bool journal_reader_next(journal_reader_t *r, journal_record_t *rec) {
+    while (r->pos < JOURNAL_SECTOR_SIZE) {
+        uint32_t page_start = r->pos & ~(JOURNAL_PAGE_SIZE - 1);
+        uint32_t page_end = page_start + JOURNAL_PAGE_SIZE;
+        uint32_t first = page_start ? page_start : JOURNAL_SECTOR_DATA_OFFSET;
+        const uint8_t *p = r->sector + r->pos;
+
+        if (p[0] == JOURNAL_ERASED) {
+            /* Unused tail of a page, or the end of the data if nothing
+             * follows on the next page */
+            if (r->pos == first || page_end >= JOURNAL_SECTOR_SIZE ||
+                r->sector[page_end] == JOURNAL_ERASED) {
+                return false;
+            }
+            r->pos = page_end;
+            continue;
+        }
+
+        uint32_t rec_len = JOURNAL_RECORD_OVERHEAD + p[0];
+        bool ok = p[0] <= JOURNAL_MAX_PAYLOAD && r->pos + rec_len <= page_end;
+        if (ok) {
+            uint16_t crc;
+            memcpy(&crc, p + rec_len - sizeof(crc), sizeof(crc));
+            ok = (crc == tlm_crc16(p, rec_len - sizeof(crc)));
+        }
+        if (!ok) {
+            /* Torn by a power loss: nothing after it in this page is trusted */
+            r->torn++;
+            r->pos = page_end;
+            continue;
+        }
+
+        rec->len = p[0];
+        rec->type = p[1];
+        memcpy(&rec->time_ms, p + 2, sizeof(rec->time_ms));
+        rec->payload = p + 6;
+        r->pos += rec_len;
+        return true;
+    }
+    r->pos = JOURNAL_SECTOR_SIZE;
+    return false;
+}
@@ -13,6 +13,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define OLED_DISPLAY_ALL_PAGES        ((uint8_t)((1u << OLED_PAGES) - 1))
+
 bool oled_display_init(oled_display_t *display, oled_driver_t *driver)
 {
     if (!display || !driver) {
@@ -23,12 +25,26 @@ bool oled_display_init(oled_display_t *display, oled_driver_t *driver)
     display->width = driver->width;
     display->height = driver->height;
     display->dirty = true;
+    display->dirty_pages = OLED_DISPLAY_ALL_PAGES;
+    display->tx_words = NULL;
+    display->flush_done = NULL;
+    display->flush_ctx = NULL;
+    display->shadow_valid = false;
+    display->flush_bytes = 0;
+
+    /* Without a shadow every flush sends the whole frame */
+    display->shadow = (uint8_t *)malloc(OLED_BUFFER_SIZE);
 
-    /* Allocate framebuffer */
-    display->buffer = (uint8_t *)malloc(OLED_BUFFER_SIZE);
-    if (!display->buffer) {
+    /* Allocate framebuffer, with room in front for the flush to put the
+     * addressing commands and control bytes (no copy of the frame) */
+    uint8_t *block = (uint8_t *)malloc(OLED_DRIVER_FRAME_HEADROOM + OLED_BUFFER_SIZE);
+    if (!block) {
+        free(display->shadow);
+        display->shadow = NULL;
+        display->buffer = NULL;
         return false;
     }
+    display->buffer = block + OLED_DRIVER_FRAME_HEADROOM;
 
     /* Clear framebuffer */
     memset(display->buffer, 0, OLED_BUFFER_SIZE);
@@ -42,10 +58,22 @@ void oled_display_deinit(oled_display_t *display)
         return;
     }
 
+    oled_display_flush_wait(display);
+
     if (display->buffer) {
-        free(display->buffer);
+        free(display->buffer - OLED_DRIVER_FRAME_HEADROOM);
         display->buffer = NULL;
     }
+
+    if (display->tx_words) {
+        free(display->tx_words);
+        display->tx_words = NULL;
+    }
+
+    if (display->shadow) {
+        free(display->shadow);
+        display->shadow = NULL;
+    }
 }
 
 void oled_display_clear(oled_display_t *display)
@@ -56,6 +84,7 @@ void oled_display_clear(oled_display_t *display)
 
     memset(display->buffer, 0, OLED_BUFFER_SIZE);
     display->dirty = true;
+    display->dirty_pages = OLED_DISPLAY_ALL_PAGES;
 }
 
 void oled_display_invert(oled_display_t *display, bool invert)
@@ -71,35 +100,229 @@ void oled_display_invert(oled_display_t *display, bool invert)
     }
     
     display->dirty = true;
+    display->dirty_pages = OLED_DISPLAY_ALL_PAGES;
 }
 
-bool oled_display_flush(oled_display_t *display)
+void oled_display_mark_dirty(oled_display_t *display, int y, int h)
 {
-    if (!display || !display->buffer || !display->driver) {
+    if (!display || h <= 0 || y >= display->height || h <= -y) {
+        return;
+    }
+
+    int first = y < 0 ? 0 : y / 8;
+    int last = h > display->height - y ? OLED_PAGES - 1 : (y + h - 1) / 8;
+    for (int page = first; page <= last && page < OLED_PAGES; page++) {
+        display->dirty_pages |= (uint8_t)(1u << page);
+    }
+    display->dirty = true;
+}
+
+/**
+ * @brief First and last column of a page that differ from the shadow
+ */
+static bool _page_changes(oled_display_t *display, uint8_t page, uint8_t *first, uint8_t *last)
+{
+    const uint8_t *now = display->buffer + page * OLED_WIDTH;
+
+    if (!display->shadow || !display->shadow_valid) {
+        *first = 0;
+        *last = OLED_WIDTH - 1;
+        return true;
+    }
+
+    /* Not drawn to since the panel got it */
+    if (!(display->dirty_pages & (1u << page))) {
         return false;
     }
 
-    /* Send each page to display */
+    const uint8_t *held = display->shadow + page * OLED_WIDTH;
+    int lo = 0;
+    int hi = OLED_WIDTH - 1;
+
+    while (lo < OLED_WIDTH && now[lo] == held[lo]) {
+        lo++;
+    }
+    if (lo == OLED_WIDTH) {
+        return false;
+    }
+    while (now[hi] == held[hi]) {
+        hi--;
+    }
+
+    *first = (uint8_t)lo;
+    *last = (uint8_t)hi;
+    return true;
+}
+
+size_t oled_display_dirty_windows(oled_display_t *display, oled_window_t *windows)
+{
+    if (!display || !display->buffer || !windows) {
+        return 0;
+    }
+
+    size_t count = 0;
+
     for (uint8_t page = 0; page < OLED_PAGES; page++) {
-        if (!oled_driver_set_page(display->driver, page)) {
-            return false;
+        uint8_t first, last;
+        if (!_page_changes(display, page, &first, &last)) {
+            continue;
         }
 
-        if (!oled_driver_set_column(display->driver, 0)) {
-            return false;
+        /* Whole pages in a row stay contiguous in the framebuffer: one window */
+        oled_window_t *prev = count ? &windows[count - 1] : NULL;
+        bool whole = first == 0 && last == OLED_WIDTH - 1;
+        if (whole && prev && prev->page_end + 1 == page &&
+            prev->col_start == 0 && prev->col_end == OLED_WIDTH - 1) {
+            prev->page_end = page;
+            continue;
         }
 
-        /* Send 128 bytes for this page */
-        uint8_t *page_data = display->buffer + (page * OLED_WIDTH);
-        if (!oled_driver_write_pixel_data(display->driver, page_data, OLED_WIDTH)) {
+        windows[count++] = (oled_window_t){ page, page, first, last };
+    }
+
+    return count;
+}
+
+void oled_display_invalidate(oled_display_t *display)
+{
+    if (display) {
+        display->shadow_valid = false;
+    }
+}
+
+/**
+ * @brief The panel now holds these windows of the framebuffer
+ */
+static void _shadow_update(oled_display_t *display, const oled_window_t *windows, size_t count)
+{
+    if (!display->shadow) {
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const oled_window_t *w = &windows[i];
+        size_t width = (size_t)(w->col_end - w->col_start + 1);
+        for (uint8_t page = w->page_start; page <= w->page_end; page++) {
+            size_t offset = page * OLED_WIDTH + w->col_start;
+            memcpy(display->shadow + offset, display->buffer + offset, width);
+        }
+    }
+}
+
+bool oled_display_flush(oled_display_t *display)
+{
+    if (!display || !display->buffer || !display->driver) {
+        return false;
+    }
+
+    oled_window_t windows[OLED_PAGES];
+    size_t count = oled_display_dirty_windows(display, windows);
+
+    display->flush_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!oled_driver_write_window(display->driver, &windows[i], display->buffer)) {
+            display->shadow_valid = false;
             return false;
         }
+        display->flush_bytes += oled_driver_window_bytes(display->driver, &windows[i]);
+    }
+
+    _shadow_update(display, windows, count);
+    display->shadow_valid = true;
+    display->dirty = false;
+    display->dirty_pages = 0;
+    return true;
+}
+
+static void _flush_async_done(bool ok, void *ctx)
+{
+    oled_display_t *display = (oled_display_t *)ctx;
+
+    if (!ok) {
+        display->shadow_valid = false;
+    }
+
+    if (display->flush_done) {
+        display->flush_done(display, ok, display->flush_ctx);
+    }
+}
+
+bool oled_display_flush_async(oled_display_t *display,
+                              oled_display_flush_cb_t done, void *ctx)
+{
+    if (!display || !display->buffer || !display->driver) {
+        return false;
+    }
+
+    /* The previous frame's words may still be in flight */
+    oled_display_flush_wait(display);
+
+    if (!display->tx_words) {
+        display->tx_words = (uint16_t *)malloc(OLED_DRIVER_WORDS_MAX * sizeof(uint16_t));
+    }
+    if (!display->tx_words) {
+        /* No second buffer: send it now */
+        bool ok = oled_display_flush(display);
+        if (done) {
+            done(display, ok, ctx);
+        }
+        return ok;
     }
 
+    oled_window_t windows[OLED_PAGES];
+    size_t windows_count = oled_display_dirty_windows(display, windows);
+    size_t count = 0;
+    for (size_t i = 0; i < windows_count; i++) {
+        count += oled_driver_window_words(display->driver, &windows[i], display->buffer,
+                                          display->tx_words + count);
+    }
+
+    display->flush_done = done;
+    display->flush_ctx = ctx;
+    display->flush_bytes = (uint32_t)count;
     display->dirty = false;
+    display->dirty_pages = 0;
+
+    if (count == 0) {
+        /* Nothing changed */
+        if (done) {
+            done(display, true, ctx);
+        }
+        return true;
+    }
+
+    /* Assume the frame gets there; a failure invalidates the shadow */
+    _shadow_update(display, windows, windows_count);
+    display->shadow_valid = true;
+
+    if (!oled_driver_write_words_async(display->driver, display->tx_words, count,
+                                       _flush_async_done, display)) {
+        /* The transport refused the write: send it now */
+        display->shadow_valid = false;
+        bool ok = oled_display_flush(display);
+        if (done) {
+            done(display, ok, ctx);
+        }
+        return ok;
+    }
+
     return true;
 }
 
+bool oled_display_flush_busy(oled_display_t *display)
+{
+    return display && display->driver && oled_i2c_busy(display->driver->i2c);
+}
+
+bool oled_display_flush_wait(oled_display_t *display)
+{
+    if (!display || !display->driver) {
+        return false;
+    }
+
+    return oled_i2c_wait(display->driver->i2c);
+}
+
 uint8_t *oled_display_get_buffer(oled_display_t *display)
 {
     if (!display) {
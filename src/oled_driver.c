@@ -10,7 +10,8 @@
  */
 
 #include "oled_driver.h"
-#include "pico/time.h"
+#include "timebase.h"
+#include <string.h>
 
 /* Forward declarations */
 static bool oled_driver_init_ssd1306(oled_driver_t *driver);
@@ -67,7 +68,7 @@ static bool oled_driver_init_ssd1306(oled_driver_t *driver)
     }
 
     driver->is_on = true;
-    sleep_ms(100);
+    timebase_sleep_ms(100);
     
     return true;
 }
@@ -97,7 +98,7 @@ static bool oled_driver_init_sh1106(oled_driver_t *driver)
     }
 
     driver->is_on = true;
-    sleep_ms(100);
+    timebase_sleep_ms(100);
     
     return true;
 }
@@ -140,6 +141,199 @@ bool oled_driver_write_pixel_data(oled_driver_t *driver,
     return oled_i2c_write_data(driver->i2c, data, len);
 }
 
+bool oled_driver_set_window(oled_driver_t *driver, uint8_t col_start, uint8_t col_end,
+                            uint8_t page_start, uint8_t page_end)
+{
+    if (!driver || driver->type != OLED_DISPLAY_SSD1306 ||
+        col_start > col_end || col_end >= OLED_WIDTH ||
+        page_start > page_end || page_end >= OLED_PAGES) {
+        return false;
+    }
+
+    uint8_t cmds[] = {
+        0x21, col_start, col_end,       /* Column address range */
+        0x22, page_start, page_end      /* Page address range */
+    };
+
+    return oled_i2c_write_cmd(driver->i2c, cmds, sizeof(cmds));
+}
+
+static bool _window_valid(const oled_window_t *w)
+{
+    return w->page_start <= w->page_end && w->page_end < OLED_PAGES &&
+           w->col_start <= w->col_end && w->col_end < OLED_WIDTH;
+}
+
+/**
+ * @brief Commands and control bytes in front of a window's data. Every
+ * command goes behind its own Co=1 control byte, so the final 0x40 can
+ * switch the same transaction over to pixel data.
+ * SSD1306: the column and page window, for the whole window.
+ * SH1106: no address window (132-column RAM, page addressing only), so
+ * page and column pointers, for one page of it.
+ */
+static size_t _window_header(oled_driver_t *driver, const oled_window_t *w, uint8_t page,
+                             uint8_t *hdr)
+{
+    uint8_t cmds[6];
+    size_t n = 0;
+
+    if (driver->type == OLED_DISPLAY_SSD1306) {
+        cmds[n++] = 0x21;               /* Column address range */
+        cmds[n++] = w->col_start;
+        cmds[n++] = w->col_end;
+        cmds[n++] = 0x22;               /* Page address range */
+        cmds[n++] = w->page_start;
+        cmds[n++] = w->page_end;
+    } else {
+        uint8_t col = w->col_start + 2; /* 128 visible columns centred in 132 */
+        cmds[n++] = (uint8_t)(0xB0 | page);
+        cmds[n++] = (uint8_t)(0x00 | (col & 0x0F));
+        cmds[n++] = (uint8_t)(0x10 | (col >> 4));
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        hdr[2 * i] = OLED_I2C_CTRL_CMD_DATA;
+        hdr[2 * i + 1] = cmds[i];
+    }
+    hdr[2 * n] = OLED_I2C_CTRL_DATA;
+
+    return 2 * n + 1;
+}
+
+/**
+ * @brief Send header + data as one transaction, the header written over the
+ * bytes in front of data for the duration
+ */
+static bool _write_in_place(oled_driver_t *driver, const uint8_t *hdr, size_t hdr_len,
+                            uint8_t *data, size_t len)
+{
+    uint8_t saved[OLED_DRIVER_WINDOW_HEADER];
+    uint8_t *msg = data - hdr_len;
+
+    memcpy(saved, msg, hdr_len);
+    memcpy(msg, hdr, hdr_len);
+    bool ok = oled_i2c_write_message(driver->i2c, msg, hdr_len + len);
+    memcpy(msg, saved, hdr_len);
+
+    return ok;
+}
+
+bool oled_driver_write_window(oled_driver_t *driver, const oled_window_t *window,
+                              uint8_t *frame)
+{
+    if (!driver || !window || !frame || !_window_valid(window)) {
+        return false;
+    }
+
+    uint8_t hdr[OLED_DRIVER_WINDOW_HEADER];
+    size_t width = (size_t)(window->col_end - window->col_start + 1);
+    uint8_t *data = frame + window->page_start * OLED_WIDTH + window->col_start;
+
+    if (driver->type == OLED_DISPLAY_SSD1306) {
+        /* Contiguous in the frame: one page, or whole pages */
+        if (window->page_start != window->page_end && width != OLED_WIDTH) {
+            return false;
+        }
+        size_t hdr_len = _window_header(driver, window, window->page_start, hdr);
+        size_t pages = (size_t)(window->page_end - window->page_start + 1);
+        return _write_in_place(driver, hdr, hdr_len, data, pages * width);
+    } else if (driver->type == OLED_DISPLAY_SH1106) {
+        for (uint8_t page = window->page_start; page <= window->page_end; page++) {
+            size_t hdr_len = _window_header(driver, window, page, hdr);
+            if (!_write_in_place(driver, hdr, hdr_len, data, width)) {
+                return false;
+            }
+            data += OLED_WIDTH;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+size_t oled_driver_window_bytes(oled_driver_t *driver, const oled_window_t *window)
+{
+    if (!driver || !window || !_window_valid(window)) {
+        return 0;
+    }
+
+    uint8_t hdr[OLED_DRIVER_WINDOW_HEADER];
+    size_t width = (size_t)(window->col_end - window->col_start + 1);
+    size_t pages = (size_t)(window->page_end - window->page_start + 1);
+    size_t hdr_len = _window_header(driver, window, window->page_start, hdr);
+
+    /* The SSD1306 has one header per window, the SH1106 one per page */
+    return (driver->type == OLED_DISPLAY_SSD1306 ? hdr_len : pages * hdr_len) + pages * width;
+}
+
+bool oled_driver_write_frame(oled_driver_t *driver, uint8_t *frame)
+{
+    const oled_window_t full = { 0, OLED_PAGES - 1, 0, OLED_WIDTH - 1 };
+
+    return oled_driver_write_window(driver, &full, frame);
+}
+
+/* Header bytes as words, then the data with STOP after the last byte */
+static uint16_t *_words_transaction(uint16_t *w, const uint8_t *hdr, size_t hdr_len,
+                                    const uint8_t *data, size_t width, size_t rows)
+{
+    for (size_t i = 0; i < hdr_len; i++) {
+        *w++ = hdr[i];
+    }
+    for (size_t row = 0; row < rows; row++) {
+        for (size_t i = 0; i < width; i++) {
+            *w++ = data[row * OLED_WIDTH + i];
+        }
+    }
+    w[-1] |= OLED_I2C_WORD_STOP;
+    return w;
+}
+
+size_t oled_driver_window_words(oled_driver_t *driver, const oled_window_t *window,
+                                const uint8_t *frame, uint16_t *words)
+{
+    if (!driver || !window || !frame || !words || !_window_valid(window)) {
+        return 0;
+    }
+
+    uint8_t hdr[OLED_DRIVER_WINDOW_HEADER];
+    size_t width = (size_t)(window->col_end - window->col_start + 1);
+    const uint8_t *data = frame + window->page_start * OLED_WIDTH + window->col_start;
+    uint16_t *w = words;
+
+    if (driver->type == OLED_DISPLAY_SSD1306) {
+        size_t hdr_len = _window_header(driver, window, window->page_start, hdr);
+        w = _words_transaction(w, hdr, hdr_len, data, width,
+                               (size_t)(window->page_end - window->page_start + 1));
+    } else if (driver->type == OLED_DISPLAY_SH1106) {
+        for (uint8_t page = window->page_start; page <= window->page_end; page++) {
+            size_t hdr_len = _window_header(driver, window, page, hdr);
+            w = _words_transaction(w, hdr, hdr_len, data, width, 1);
+            data += OLED_WIDTH;
+        }
+    }
+
+    return (size_t)(w - words);
+}
+
+size_t oled_driver_frame_words(oled_driver_t *driver, const uint8_t *frame, uint16_t *words)
+{
+    const oled_window_t full = { 0, OLED_PAGES - 1, 0, OLED_WIDTH - 1 };
+
+    return oled_driver_window_words(driver, &full, frame, words);
+}
+
+bool oled_driver_write_words_async(oled_driver_t *driver, const uint16_t *words, size_t count,
+                                   oled_i2c_done_cb_t done, void *ctx)
+{
+    if (!driver) {
+        return false;
+    }
+
+    return oled_i2c_write_async(driver->i2c, words, count, done, ctx);
+}
+
 bool oled_driver_power_on(oled_driver_t *driver)
 {
     if (!driver) {
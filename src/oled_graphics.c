@@ -11,6 +11,7 @@
 
 #include "oled_graphics.h"
 #include <stdlib.h>
+#include <string.h>
 
 /* Helper: check if pixel is in bounds */
 static bool is_in_bounds(oled_display_t *display, int x, int y)
@@ -40,6 +41,7 @@ void oled_draw_pixel(oled_display_t *display, int x, int y, bool on)
     }
 
     display->dirty = true;
+    display->dirty_pages |= (uint8_t)(1u << page);
 }
 
 bool oled_get_pixel(oled_display_t *display, int x, int y)
@@ -59,15 +61,53 @@ bool oled_get_pixel(oled_display_t *display, int x, int y)
     return (display->buffer[index] & (1 << bit)) != 0;
 }
 
+/* Set or clear the clipped rectangle [x, x + w) x [y, y + h): per page,
+ * one mask for the rows it covers, applied to a run of column bytes */
+static void fill_span(oled_display_t *display, int x, int y, int w, int h, bool on)
+{
+    if (!display->buffer || w <= 0 || h <= 0) {
+        return;
+    }
+
+    /* Clip to the screen */
+    int x0 = x < 0 ? 0 : x;
+    int x1 = w > display->width - x ? display->width : x + w;
+    int y0 = y < 0 ? 0 : y;
+    int y1 = h > display->height - y ? display->height : y + h;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    for (int page = y0 / 8; page <= (y1 - 1) / 8; page++) {
+        int top = page * 8 > y0 ? 0 : y0 - page * 8;
+        int bottom = page * 8 + 8 < y1 ? 8 : y1 - page * 8;
+        uint8_t mask = (uint8_t)((0xFFu << top) & (0xFFu >> (8 - bottom)));
+        uint8_t *row = display->buffer + page * OLED_WIDTH;
+        display->dirty_pages |= (uint8_t)(1u << page);
+
+        if (mask == 0xFF) {
+            memset(row + x0, on ? 0xFF : 0x00, x1 - x0);
+        } else if (on) {
+            for (int col = x0; col < x1; col++) {
+                row[col] |= mask;
+            }
+        } else {
+            for (int col = x0; col < x1; col++) {
+                row[col] &= (uint8_t)~mask;
+            }
+        }
+    }
+
+    display->dirty = true;
+}
+
 void oled_draw_hline(oled_display_t *display, int x, int y, int len, bool on)
 {
     if (!display) {
         return;
     }
 
-    for (int i = 0; i < len; i++) {
-        oled_draw_pixel(display, x + i, y, on);
-    }
+    fill_span(display, x, y, len, 1, on);
 }
 
 void oled_draw_vline(oled_display_t *display, int x, int y, int len, bool on)
@@ -76,9 +116,7 @@ void oled_draw_vline(oled_display_t *display, int x, int y, int len, bool on)
         return;
     }
 
-    for (int i = 0; i < len; i++) {
-        oled_draw_pixel(display, x, y + i, on);
-    }
+    fill_span(display, x, y, 1, len, on);
 }
 
 /* Bresenham line algorithm */
@@ -122,11 +160,7 @@ void oled_draw_rect(oled_display_t *display, int x, int y, int w, int h,
 
     if (fill) {
         /* Filled rectangle */
-        for (int yy = 0; yy < h; yy++) {
-            for (int xx = 0; xx < w; xx++) {
-                oled_draw_pixel(display, x + xx, y + yy, on);
-            }
-        }
+        fill_span(display, x, y, w, h, on);
     } else {
         /* Rectangle outline */
         oled_draw_hline(display, x, y, w, on);
@@ -10,7 +10,18 @@
  */
 
 #include "oled_i2c.h"
+#include "oled_config.h"
+#include "pico/stdlib.h"
 #include "hardware/gpio.h"
+#include <string.h>
+
+/* Longest transaction an asynchronous write may hold; it is sent with
+ * i2c_write_blocking() from this buffer */
+#define OLED_I2C_ASYNC_MESSAGE_MAX    (OLED_BUFFER_SIZE + 32)
+
+static uint8_t g_async_msg[OLED_I2C_ASYNC_MESSAGE_MAX];
+
+static void _async_setup(oled_i2c_t *i2c);
 
 bool oled_i2c_init(oled_i2c_t *i2c)
 {
@@ -29,6 +40,8 @@ bool oled_i2c_init(oled_i2c_t *i2c)
     gpio_pull_up(i2c->sda_pin);
     gpio_pull_up(i2c->scl_pin);
 
+    _async_setup(i2c);
+
     return true;
 }
 
@@ -57,15 +70,127 @@ bool oled_i2c_write_raw(oled_i2c_t *i2c, uint8_t ctrl_byte,
         return false;
     }
 
-    /* Build message: control byte + data */
-    uint8_t msg[len + 1];
+    if (len > OLED_I2C_STAGING_SIZE && ctrl_byte != OLED_I2C_CTRL_DATA) {
+        return false;
+    }
+
+    /* Build message: control byte + up to OLED_I2C_STAGING_SIZE bytes */
+    uint8_t msg[OLED_I2C_STAGING_SIZE + 1];
     msg[0] = ctrl_byte;
-    for (size_t i = 0; i < len; i++) {
-        msg[i + 1] = data[i];
+
+    while (len > 0) {
+        size_t chunk = (len > OLED_I2C_STAGING_SIZE) ? OLED_I2C_STAGING_SIZE : len;
+        memcpy(msg + 1, data, chunk);
+
+        if (!oled_i2c_write_message(i2c, msg, chunk + 1)) {
+            return false;
+        }
+
+        data += chunk;
+        len -= chunk;
+    }
+
+    return true;
+}
+
+bool oled_i2c_write_data_in_place(oled_i2c_t *i2c, uint8_t *data, size_t len)
+{
+    if (!i2c || !data || len == 0) {
+        return false;
+    }
+
+    /* Borrow the byte in front of the payload for the control byte */
+    uint8_t *msg = data - 1;
+    uint8_t saved = *msg;
+    *msg = OLED_I2C_CTRL_DATA;
+
+    bool ok = oled_i2c_write_message(i2c, msg, len + 1);
+
+    *msg = saved;
+    return ok;
+}
+
+bool oled_i2c_write_message(oled_i2c_t *i2c, const uint8_t *msg, size_t len)
+{
+    if (!i2c || !msg || len == 0) {
+        return false;
+    }
+
+    oled_i2c_wait(i2c);
+
+    int result = i2c_write_blocking(i2c->i2c, i2c->address, msg, len, false);
+
+    return (result == (int)len);
+}
+
+/* ============================================================================
+ * ASYNCHRONOUS WRITES
+ * ============================================================================ */
+
+static void _async_setup(oled_i2c_t *i2c)
+{
+    i2c->busy = false;
+    i2c->ok = true;
+}
+
+/**
+ * @brief Narrow each transaction to bytes and send it blocking
+ */
+static bool _async_send_blocking(oled_i2c_t *i2c, const uint16_t *words, size_t count)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (len == OLED_I2C_ASYNC_MESSAGE_MAX) {
+            return false;
+        }
+        g_async_msg[len++] = (uint8_t)words[i];
+
+        if ((words[i] & OLED_I2C_WORD_STOP) || i + 1 == count) {
+            int result = i2c_write_blocking(i2c->i2c, i2c->address, g_async_msg, len, false);
+            if (result != (int)len) {
+                return false;
+            }
+            len = 0;
+        }
+    }
+
+    return true;
+}
+
+bool oled_i2c_write_async(oled_i2c_t *i2c, const uint16_t *words, size_t count,
+                          oled_i2c_done_cb_t done, void *ctx)
+{
+    if (!i2c || !words || count == 0 || i2c->busy) {
+        return false;
+    }
+
+    i2c->done = done;
+    i2c->done_ctx = ctx;
+
+    bool ok = _async_send_blocking(i2c, words, count);
+    i2c->ok = ok;
+    if (done) {
+        done(ok, ctx);
+    }
+
+    return true;
+}
+
+bool oled_i2c_busy(const oled_i2c_t *i2c)
+{
+    return i2c && i2c->busy;
+}
+
+bool oled_i2c_wait(oled_i2c_t *i2c)
+{
+    if (!i2c) {
+        return false;
+    }
+
+    while (i2c->busy) {
+        tight_loop_contents();
     }
 
-    /* Send via I2C */
-    int result = i2c_write_blocking(i2c->i2c, i2c->address, msg, len + 1, false);
-    
-    return (result == (len + 1));
+    return i2c->ok;
 }
@@ -27,22 +27,63 @@ int oled_draw_char(oled_display_t *display, int x, int y,
     /* Calculate character offset in font data */
     int char_index = c - font->start_char;
     int char_offset = char_index * font->char_width;
+    if (!display->buffer || char_offset >= font->width) {
+        return font->char_width;
+    }
 
-    /* Draw character bitmap */
-    for (int row = 0; row < font->height; row++) {
-        for (int col = 0; col < font->char_width; col++) {
-            int byte_idx = char_offset + col;
-            if (byte_idx >= font->width) {
-                break;
-            }
-
-            uint8_t byte_val = font->data[byte_idx];
-            bool pixel = (byte_val & (1 << row)) != 0;
+    /* Clip once per glyph: the columns on screen, and the glyph rows
+     * (one byte per column, bit 0 at the top) that land inside it */
+    int cols = font->char_width;
+    if (cols > font->width - char_offset) {
+        cols = font->width - char_offset;
+    }
+    int col_start = x < 0 ? -x : 0;
+    int col_end = x + cols > display->width ? display->width - x : cols;
+    int rows = font->height < 8 ? font->height : 8;
+    uint32_t cell = (1u << rows) - 1;
+    if (y < 0) {
+        cell = y > -8 ? cell & ~((1u << -y) - 1) : 0;
+    }
+    if (y + rows > display->height) {
+        cell = y < display->height ? cell & ((1u << (display->height - y)) - 1) : 0;
+    }
+    if (col_start >= col_end || cell == 0) {
+        return font->char_width;
+    }
 
-            oled_draw_pixel(display, x + col, y + row, pixel ? on : !on);
+    /* The cell covers the low bits of one page and, unless y is
+     * page-aligned, the high bits of the next */
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+    uint8_t mask_lo = (uint8_t)(cell << shift);
+    uint8_t mask_hi = (uint8_t)(cell << shift >> 8);
+    const uint8_t *glyph = font->data + char_offset;
+    uint8_t invert = on ? 0x00 : 0xFF;
+
+    if (mask_lo) {
+        uint8_t *dst = display->buffer + page * OLED_WIDTH;
+        display->dirty_pages |= (uint8_t)(1u << page);
+        if (mask_lo == 0xFF && !mask_hi) {
+            for (int col = col_start; col < col_end; col++) {
+                dst[x + col] = glyph[col] ^ invert;
+            }
+        } else {
+            for (int col = col_start; col < col_end; col++) {
+                uint8_t bits = (uint8_t)((glyph[col] ^ invert) << shift);
+                dst[x + col] = (uint8_t)((dst[x + col] & ~mask_lo) | (bits & mask_lo));
+            }
+        }
+    }
+    if (mask_hi) {
+        uint8_t *dst = display->buffer + (page + 1) * OLED_WIDTH;
+        display->dirty_pages |= (uint8_t)(1u << (page + 1));
+        for (int col = col_start; col < col_end; col++) {
+            uint8_t bits = (uint8_t)((glyph[col] ^ invert) >> (8 - shift));
+            dst[x + col] = (uint8_t)((dst[x + col] & ~mask_hi) | (bits & mask_hi));
         }
     }
 
+    display->dirty = true;
     return font->char_width;
 }
 
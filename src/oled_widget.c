@@ -0,0 +1,132 @@
+/*
+ * OLED Widgets
+ * Retained-mode labels, values, bars and icons bound to application state
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "oled_widget.h"
+#include "oled_graphics.h"
+#include <string.h>
+
+/* Text from the left of the widget, whole glyphs only, so it never spills
+ * into a neighbour */
+static void _draw_text(oled_display_t *display, const oled_widget_t *widget,
+                       const char *text, const oled_font_t *font)
+{
+    int x = widget->x;
+    int right = widget->x + widget->w;
+
+    for (const char *p = text; *p != '\0' && x + font->char_width <= right; p++) {
+        x += oled_draw_char(display, x, widget->y, *p, font, true);
+    }
+}
+
+/* Outline with the inside filled left to right in proportion to level */
+static void _draw_bar(oled_display_t *display, const oled_widget_t *widget, uint32_t level)
+{
+    int inner = widget->w - 2;
+    int fill = 0;
+
+    if (widget->max > 0 && inner > 0) {
+        if (level > widget->max) {
+            level = widget->max;
+        }
+        fill = (int)((uint64_t)inner * level / widget->max);
+    }
+
+    oled_draw_rect(display, widget->x, widget->y, widget->w, widget->h, false, true);
+    oled_draw_rect(display, widget->x + 1, widget->y + 1, fill, widget->h - 2, true, true);
+}
+
+/**
+ * @brief Read the widget's binding; returns whether it differs from what
+ * the widget shows
+ */
+static bool _widget_changed(oled_widget_t *widget, const void *model, char *text)
+{
+    switch (widget->type) {
+    case OLED_WIDGET_VALUE:
+        text[0] = '\0';
+        if (widget->text_fn) {
+            widget->text_fn(model, text, OLED_WIDGET_TEXT_MAX);
+            text[OLED_WIDGET_TEXT_MAX - 1] = '\0';
+        }
+        return !widget->drawn || strcmp(text, widget->shown) != 0;
+
+    case OLED_WIDGET_BAR:
+    case OLED_WIDGET_ICON: {
+        uint32_t level = widget->level_fn ? widget->level_fn(model) : 0;
+        bool changed = !widget->drawn || level != widget->level;
+        widget->level = level;
+        return changed;
+    }
+
+    default:
+        return !widget->drawn;
+    }
+}
+
+void oled_screen_invalidate(oled_screen_t *screen)
+{
+    if (!screen) {
+        return;
+    }
+
+    for (size_t i = 0; i < screen->count; i++) {
+        screen->widgets[i].drawn = false;
+    }
+}
+
+size_t oled_screen_update(oled_screen_t *screen, oled_display_t *display, const void *model)
+{
+    if (!screen || !display || !screen->font) {
+        return 0;
+    }
+
+    size_t redrawn = 0;
+    char text[OLED_WIDGET_TEXT_MAX];
+
+    for (size_t i = 0; i < screen->count; i++) {
+        oled_widget_t *widget = &screen->widgets[i];
+        if (!_widget_changed(widget, model, text)) {
+            continue;
+        }
+
+        /* The widget's rectangle is its own: clear it and draw afresh */
+        oled_draw_rect(display, widget->x, widget->y, widget->w, widget->h, true, false);
+
+        switch (widget->type) {
+        case OLED_WIDGET_LABEL:
+            if (widget->text) {
+                _draw_text(display, widget, widget->text, screen->font);
+            }
+            break;
+
+        case OLED_WIDGET_VALUE:
+            memcpy(widget->shown, text, sizeof(widget->shown));
+            _draw_text(display, widget, text, screen->font);
+            break;
+
+        case OLED_WIDGET_BAR:
+            _draw_bar(display, widget, widget->level);
+            break;
+
+        case OLED_WIDGET_ICON:
+            if (widget->icons && widget->level < widget->max) {
+                oled_draw_bitmap(display, widget->x, widget->y,
+                                 widget->icons[widget->level], widget->w, widget->h);
+            }
+            break;
+        }
+
+        widget->drawn = true;
+        redrawn++;
+    }
+
+    return redrawn;
+}
@@ -0,0 +1,223 @@
+/*
+ * PlugSafe Latency Profiler Implementation
+ * Named probes feeding log2 latency histograms, plus stack high-water marks
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Probe names for the dump, indexed by profiler_probe_e */
+static const char *const g_probe_names[PROBE_COUNT] = {
+    "usb_task",
+    "analysis",
+    "mount_cb",
+    "umount_cb",
+    "hid_mount",
+    "hid_report",
+    "stats_print",
+    "draw",
+    "flush",
+};
+
+/* Histograms. Each probe is written by one core only; readers on the other
+ * core may see a sample half-recorded, which the dump tolerates. */
+static profiler_histogram_t g_histograms[PROBE_COUNT];
+
+/* Registered stacks, one per core */
+typedef struct {
+    uint32_t *bottom;
+    profiler_stack_info_t info;
+} stack_region_t;
+
+static stack_region_t g_stacks[2];
+
+/* ============================================================================
+ * HISTOGRAM HELPERS
+ * ============================================================================ */
+
+/**
+ * @brief Bucket index for a sample: 0 for 0us, else floor(log2(us)) + 1
+ */
+static inline uint8_t _bucket_for(uint32_t elapsed_us) {
+    if (elapsed_us == 0) {
+        return 0;
+    }
+    uint8_t bucket = (uint8_t)(32 - __builtin_clz(elapsed_us));
+    return (bucket < PROFILER_BUCKETS) ? bucket : (PROFILER_BUCKETS - 1);
+}
+
+/**
+ * @brief Lowest value that lands in a bucket
+ */
+static inline uint32_t _bucket_low(uint8_t bucket) {
+    return bucket ? (1u << (bucket - 1)) : 0;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void profiler_init(void) {
+    profiler_reset();
+}
+
+void profiler_reset(void) {
+    memset(g_histograms, 0, sizeof(g_histograms));
+}
+
+void profiler_record(profiler_probe_e probe, uint32_t elapsed_us) {
+    if ((unsigned)probe >= PROBE_COUNT) {
+        return;
+    }
+
+    profiler_histogram_t *hist = &g_histograms[probe];
+    if (hist->count == 0 || elapsed_us < hist->min_us) {
+        hist->min_us = elapsed_us;
+    }
+    if (elapsed_us > hist->max_us) {
+        hist->max_us = elapsed_us;
+    }
+    hist->count++;
+    hist->total_us += elapsed_us;
+    hist->buckets[_bucket_for(elapsed_us)]++;
+}
+
+const profiler_histogram_t* profiler_get_histogram(profiler_probe_e probe) {
+    if ((unsigned)probe >= PROBE_COUNT) {
+        return NULL;
+    }
+    return &g_histograms[probe];
+}
+
+uint32_t profiler_percentile_us(const profiler_histogram_t *hist, uint8_t percentile) {
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+    if (percentile > 100) {
+        percentile = 100;
+    }
+
+    /* Rank of the wanted sample (1-based, rounded up) */
+    uint32_t target = (uint32_t)(((uint64_t)hist->count * percentile + 99) / 100);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+        uint32_t in_bucket = hist->buckets[b];
+        if (in_bucket == 0 || seen + in_bucket < target) {
+            seen += in_bucket;
+            continue;
+        }
+
+        /* Interpolate linearly across the bucket's range */
+        uint32_t low = _bucket_low(b);
+        uint32_t high = (b + 1 < PROFILER_BUCKETS) ? _bucket_low(b + 1) : hist->max_us;
+        uint32_t estimate = low + (uint32_t)(((uint64_t)(high - low) * (target - seen)) / in_bucket);
+
+        if (estimate > hist->max_us) {
+            estimate = hist->max_us;
+        }
+        if (estimate < hist->min_us) {
+            estimate = hist->min_us;
+        }
+        return estimate;
+    }
+    return hist->max_us;
+}
+
+void profiler_register_stack(uint8_t core, uint32_t *bottom, size_t size_bytes) {
+    if (core > 1 || !bottom || size_bytes < sizeof(uint32_t)) {
+        return;
+    }
+
+    stack_region_t *region = &g_stacks[core];
+    region->bottom = bottom;
+    region->info.size_bytes = (uint32_t)size_bytes;
+    region->info.high_water_bytes = 0;
+    region->info.registered = true;
+
+    /* When registering the stack we are running on, stop painting a guard
+     * distance below this frame so live data is not overwritten */
+    uint32_t *top = bottom + size_bytes / sizeof(uint32_t);
+    uint32_t marker = 0;
+    uint32_t *sp = &marker;
+    if (sp > bottom && sp <= top) {
+        top = (sp - PROFILER_STACK_GUARD_WORDS > bottom) ?
+              sp - PROFILER_STACK_GUARD_WORDS : bottom;
+    }
+
+    for (uint32_t *word = bottom; word < top; word++) {
+        *word = PROFILER_STACK_PAINT;
+    }
+}
+
+const profiler_stack_info_t* profiler_get_stack_info(uint8_t core) {
+    if (core > 1) {
+        return NULL;
+    }
+
+    stack_region_t *region = &g_stacks[core];
+    if (region->info.registered) {
+        /* Stacks grow down: the first overwritten word from the bottom marks
+         * the deepest point reached */
+        uint32_t words = region->info.size_bytes / sizeof(uint32_t);
+        uint32_t untouched = 0;
+        while (untouched < words && region->bottom[untouched] == PROFILER_STACK_PAINT) {
+            untouched++;
+        }
+        region->info.high_water_bytes = (words - untouched) * sizeof(uint32_t);
+    }
+    return &region->info;
+}
+
+void profiler_dump(void) {
+#if PLUGSAFE_PROFILING
+    printf("[PROF] %-11s %8s %7s %7s %7s %7s %7s %8s\n",
+           "probe", "count", "min", "avg", "p50", "p90", "p99", "max(us)");
+    for (int p = 0; p < PROBE_COUNT; p++) {
+        const profiler_histogram_t *hist = &g_histograms[p];
+        if (hist->count == 0) {
+            continue;
+        }
+        printf("[PROF] %-11s %8lu %7lu %7lu %7lu %7lu %7lu %8lu\n",
+               g_probe_names[p],
+               (unsigned long)hist->count,
+               (unsigned long)hist->min_us,
+               (unsigned long)(hist->total_us / hist->count),
+               (unsigned long)profiler_percentile_us(hist, 50),
+               (unsigned long)profiler_percentile_us(hist, 90),
+               (unsigned long)profiler_percentile_us(hist, 99),
+               (unsigned long)hist->max_us);
+
+        /* Non-empty buckets as "<lower bound>:<count>" */
+        printf("[PROF]   buckets:");
+        for (uint8_t b = 0; b < PROFILER_BUCKETS; b++) {
+            if (hist->buckets[b]) {
+                printf(" %lu:%lu", (unsigned long)_bucket_low(b),
+                       (unsigned long)hist->buckets[b]);
+            }
+        }
+        printf("\n");
+    }
+#else
+    printf("[PROF] Probes compiled out (PLUGSAFE_PROFILING=0)\n");
+#endif
+
+    for (uint8_t core = 0; core < 2; core++) {
+        const profiler_stack_info_t *info = profiler_get_stack_info(core);
+        if (info->registered) {
+            printf("[PROF] core%u stack: %lu / %lu bytes used (high-water)\n", core,
+                   (unsigned long)info->high_water_bytes,
+                   (unsigned long)info->size_bytes);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+/*
+ * PlugSafe Cooperative Task Scheduler Implementation
+ * Deadline-ordered run-to-completion tasks, one scheduler per core
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "scheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include "timebase.h"
+#include "hardware/sync.h"
+
+/* ============================================================================
+ * RELEASE-TIME HEAP
+ * ============================================================================ */
+
+/* Triggered tasks get this key so they sort ahead of every timed release */
+#define SCHEDULER_TRIGGERED   0
+
+/**
+ * @brief Heap order: earlier release first, then higher priority (lower value)
+ */
+static bool _before(const scheduler_t *sched, uint8_t a, uint8_t b) {
+    const scheduler_task_t *ta = &sched->tasks[a];
+    const scheduler_task_t *tb = &sched->tasks[b];
+    if (ta->next_run_us != tb->next_run_us) {
+        return ta->next_run_us < tb->next_run_us;
+    }
+    return ta->config.priority < tb->config.priority;
+}
+
+/**
+ * @brief Swap two heap slots and keep the tasks' back-references in sync
+ */
+static void _swap(scheduler_t *sched, uint8_t i, uint8_t j) {
+    uint8_t tmp = sched->heap[i];
+    sched->heap[i] = sched->heap[j];
+    sched->heap[j] = tmp;
+    sched->tasks[sched->heap[i]].heap_index = i;
+    sched->tasks[sched->heap[j]].heap_index = j;
+}
+
+static void _sift_up(scheduler_t *sched, uint8_t i) {
+    while (i > 0) {
+        uint8_t parent = (uint8_t)((i - 1) / 2);
+        if (!_before(sched, sched->heap[i], sched->heap[parent])) {
+            break;
+        }
+        _swap(sched, i, parent);
+        i = parent;
+    }
+}
+
+static void _sift_down(scheduler_t *sched, uint8_t i) {
+    while (1) {
+        uint8_t left = (uint8_t)(2 * i + 1);
+        uint8_t right = (uint8_t)(2 * i + 2);
+        uint8_t best = i;
+        if (left < sched->task_count && _before(sched, sched->heap[left], sched->heap[best])) {
+            best = left;
+        }
+        if (right < sched->task_count && _before(sched, sched->heap[right], sched->heap[best])) {
+            best = right;
+        }
+        if (best == i) {
+            break;
+        }
+        _swap(sched, i, best);
+        i = best;
+    }
+}
+
+/**
+ * @brief Change a task's release time and restore heap order
+ */
+static void _reschedule(scheduler_t *sched, uint8_t task_id, uint64_t next_run_us) {
+    scheduler_task_t *task = &sched->tasks[task_id];
+    uint64_t old = task->next_run_us;
+    task->next_run_us = next_run_us;
+    if (next_run_us < old) {
+        _sift_up(sched, task->heap_index);
+    } else {
+        _sift_down(sched, task->heap_index);
+    }
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void scheduler_init(scheduler_t *sched) {
+    memset(sched, 0, sizeof(*sched));
+}
+
+int scheduler_add_task(scheduler_t *sched, const scheduler_task_config_t *config) {
+    if (sched->task_count >= SCHEDULER_MAX_TASKS || config->fn == NULL) {
+        printf("[SCHED] Cannot register task '%s'\n", config->name ? config->name : "?");
+        return -1;
+    }
+
+    uint8_t id = sched->task_count;
+    scheduler_task_t *task = &sched->tasks[id];
+    memset(task, 0, sizeof(*task));
+    task->config = *config;
+    if (task->config.deadline_ms == 0) {
+        task->config.deadline_ms = task->config.period_ms;
+    }
+
+    uint64_t now_us = timebase_now_us();
+    task->next_run_us = config->period_ms ?
+                        now_us + (uint64_t)config->period_ms * 1000 : SCHEDULER_NEVER;
+    task->release_us = task->next_run_us;
+
+    sched->heap[id] = id;
+    task->heap_index = id;
+    sched->task_count++;
+    _sift_up(sched, id);
+    return id;
+}
+
+void scheduler_set_poll(scheduler_t *sched, scheduler_poll_fn poll, void *ctx) {
+    sched->poll = poll;
+    sched->poll_ctx = ctx;
+}
+
+void scheduler_trigger(scheduler_t *sched, int task_id) {
+    if (task_id < 0 || task_id >= sched->task_count) {
+        return;
+    }
+    scheduler_task_t *task = &sched->tasks[task_id];
+    if (task->next_run_us == SCHEDULER_TRIGGERED) {
+        return;  /* Already pending; keep the original release time */
+    }
+
+    /* A timed release that is already overdue keeps its earlier release time
+     * so lateness is measured from when the task really became due */
+    uint64_t now_us = timebase_now_us();
+    task->release_us = (task->next_run_us < now_us) ? task->next_run_us : now_us;
+    _reschedule(sched, (uint8_t)task_id, SCHEDULER_TRIGGERED);
+}
+
+bool scheduler_run_once(scheduler_t *sched) {
+    if (sched->task_count == 0) {
+        return false;
+    }
+
+    uint64_t now_us = timebase_now_us();
+    uint8_t id = sched->heap[0];
+    scheduler_task_t *task = &sched->tasks[id];
+    if (task->next_run_us > now_us) {
+        return false;
+    }
+
+    /* Timed releases become due at next_run_us; triggered ones recorded it */
+    if (task->next_run_us != SCHEDULER_TRIGGERED) {
+        task->release_us = task->next_run_us;
+    }
+    uint64_t lateness_us = now_us - task->release_us;
+
+    /* Schedule the next periodic run relative to this release. If the task
+     * has fallen a whole period behind, restart the cadence from now rather
+     * than running it back-to-back to catch up. */
+    uint64_t next_run_us = SCHEDULER_NEVER;
+    if (task->config.period_ms) {
+        uint64_t period_us = (uint64_t)task->config.period_ms * 1000;
+        next_run_us = task->release_us + period_us;
+        if (next_run_us <= now_us) {
+            next_run_us = now_us + period_us;
+        }
+    }
+    _reschedule(sched, id, next_run_us);
+
+    task->config.fn(task->config.ctx, now_us);
+    uint32_t run_us = (uint32_t)(timebase_now_us() - now_us);
+
+    scheduler_task_stats_t *stats = &task->stats;
+    stats->runs++;
+    stats->last_run_us = run_us;
+    stats->total_run_us += run_us;
+    if (run_us > stats->max_run_us) {
+        stats->max_run_us = run_us;
+    }
+    if (lateness_us > stats->max_lateness_us) {
+        stats->max_lateness_us = (uint32_t)lateness_us;
+    }
+    if (task->config.deadline_ms &&
+        lateness_us > (uint64_t)task->config.deadline_ms * 1000) {
+        stats->deadline_misses++;
+    }
+    return true;
+}
+
+uint64_t scheduler_next_deadline_us(const scheduler_t *sched) {
+    if (sched->task_count == 0) {
+        return SCHEDULER_NEVER;
+    }
+    return sched->tasks[sched->heap[0]].next_run_us;
+}
+
+void scheduler_run(scheduler_t *sched) {
+    while (1) {
+        /* Poll immediately before deciding to sleep: work signalled after
+         * this point also raises SEV, so the WFE below returns at once */
+        if (sched->poll) {
+            sched->poll(sched->poll_ctx);
+        }
+        if (scheduler_run_once(sched)) {
+            continue;
+        }
+
+        uint64_t next_us = scheduler_next_deadline_us(sched);
+        if (next_us == SCHEDULER_NEVER) {
+            __wfe();
+        } else {
+            timebase_wait_until_us(next_us);
+        }
+    }
+}
+
+const scheduler_task_stats_t* scheduler_get_task_stats(const scheduler_t *sched, int task_id) {
+    if (task_id < 0 || task_id >= sched->task_count) {
+        return NULL;
+    }
+    return &sched->tasks[task_id].stats;
+}
+
+void scheduler_print_stats(const scheduler_t *sched, const char *label) {
+    printf("[SCHED] %s: %u tasks\n", label ? label : "scheduler", sched->task_count);
+    for (uint8_t i = 0; i < sched->task_count; i++) {
+        const scheduler_task_t *task = &sched->tasks[i];
+        const scheduler_task_stats_t *stats = &task->stats;
+        uint32_t avg_us = stats->runs ? (uint32_t)(stats->total_run_us / stats->runs) : 0;
+        printf("[SCHED]   %-10s prio=%u period=%lums runs=%lu avg=%luus max=%luus "
+               "late_max=%luus misses=%lu\n",
+               task->config.name ? task->config.name : "?",
+               task->config.priority,
+               (unsigned long)task->config.period_ms,
+               (unsigned long)stats->runs,
+               (unsigned long)avg_us,
+               (unsigned long)stats->max_run_us,
+               (unsigned long)stats->max_lateness_us,
+               (unsigned long)stats->deadline_misses);
+    }
+}
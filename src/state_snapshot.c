@@ -0,0 +1,89 @@
+/*
+ * PlugSafe State Snapshots Implementation
+ * Seqlock-protected, versioned copies of device/threat state for readers
+ * Copyright (c) 2026
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "state_snapshot.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/* Seqlock: the single writer makes g_seq odd while g_snapshot is being
+ * rewritten and even again once it is consistent. Readers copy the data and
+ * retry if the sequence was odd or changed underneath them. */
+static volatile uint32_t g_seq = 0;
+static system_snapshot_t g_snapshot;
+
+/* Staging copy, built outside the write window to keep it short */
+static system_snapshot_t g_staging;
+
+void state_snapshot_init(void) {
+    memset(&g_snapshot, 0, sizeof(g_snapshot));
+    memset(&g_staging, 0, sizeof(g_staging));
+    g_seq = 0;
+}
+
+void state_snapshot_publish(void) {
+    /* Gather live state into the staging copy (writer-private) */
+    memset(&g_staging, 0, sizeof(g_staging));
+    g_staging.hub_connected = usb_is_hub_connected();
+
+    uint8_t count = usb_get_device_count();
+    for (uint8_t i = 0; i < count && i < SNAPSHOT_MAX_DEVICES; i++) {
+        usb_device_info_t *dev = usb_get_device_at_index(i);
+        if (!dev) {
+            break;
+        }
+
+        device_snapshot_t *snap = &g_staging.devices[g_staging.device_count++];
+        memcpy(&snap->device, dev, sizeof(*dev));
+
+        device_threat_t *threat = threat_get_device_status(dev->dev_addr);
+        if (threat) {
+            snap->threat_level = threat->threat_level;
+            snap->hid_reports_per_sec = threat->hid_reports_per_sec;
+            snap->flood_suspect = threat->flood_suspect;
+        } else {
+            snap->threat_level = THREAT_SAFE;
+            snap->flood_suspect = dev->flood_suspect;
+        }
+    }
+
+    /* Write window: odd sequence, copy, even sequence */
+    uint32_t seq = g_seq + 1;
+    g_staging.version = seq + 1;
+    g_seq = seq;
+    __dmb();
+    memcpy(&g_snapshot, &g_staging, sizeof(g_snapshot));
+    __dmb();
+    g_seq = seq + 1;
+}
+
+bool state_snapshot_read(system_snapshot_t *out) {
+    for (int attempt = 0; attempt < SNAPSHOT_READ_RETRIES; attempt++) {
+        /* Wait out a write in progress; the window is a single memcpy */
+        uint32_t start;
+        while ((start = g_seq) & 1u) {
+            tight_loop_contents();
+        }
+
+        __dmb();
+        memcpy(out, &g_snapshot, sizeof(*out));
+        __dmb();
+
+        if (g_seq == start) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t state_snapshot_get_version(void) {
+    return g_seq;
+}
@@ -0,0 +1,252 @@
+/*
+ * PlugSafe Binary Telemetry Implementation
+ * Structured events from the USB core, framed and sent from core 0
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "timebase.h"
+#include "hardware/sync.h"
+#include "usb_host.h"
+#include "hid_monitor.h"
+#include "event_queue.h"
+#include "deferred_log.h"
+#include "state_snapshot.h"
+#include "trace.h"
+#include "journal.h"
+
+/* Queued message from the producer core */
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint32_t time_ms;
+    uint8_t payload[TLM_MAX_PAYLOAD];
+} tlm_slot_t;
+
+/* SPSC ring: head written only by the producer, tail only by core 0 */
+static tlm_slot_t g_slots[TLM_RING_SIZE];
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static volatile uint32_t g_dropped = 0;
+static volatile bool g_enabled = false;
+
+/* Consumer-side state (core 0) */
+static uint16_t g_seq = 0;
+static uint32_t g_last_counters_ms = 0;
+static uint8_t g_trace_core = 0;      /* Core whose trace ring is drained first next time */
+
+/* ============================================================================
+ * FRAME OUTPUT (CORE 0)
+ * ============================================================================ */
+
+/**
+ * @brief Frame one message and write it to the UART without CR/LF translation
+ */
+static void _send(uint8_t type, uint32_t time_ms, const void *payload, size_t len) {
+    uint8_t frame[TLM_MAX_ENCODED_FRAME + 2];
+    size_t frame_len = tlm_build_frame(type, g_seq++, time_ms, payload, len, frame);
+    for (size_t i = 0; i < frame_len; i++) {
+        putchar_raw(frame[i]);
+    }
+}
+
+/**
+ * @brief Send TLM_MSG_COUNTERS with the current drop and latency counters
+ */
+static void _send_counters(uint32_t now_ms) {
+    tlm_counters_t counters;
+    telemetry_get_counters(&counters);
+    _send(TLM_MSG_COUNTERS, now_ms, &counters, sizeof(counters));
+}
+
+/**
+ * @brief Send one TLM_MSG_TRACE batch from a core's trace ring.
+ *
+ * Returns false if that core had nothing to report.
+ */
+static bool _send_trace_batch(uint8_t core, uint32_t now_ms) {
+    trace_event_t events[TLM_TRACE_BATCH_MAX];
+    uint32_t count = trace_read(core, events, TLM_TRACE_BATCH_MAX);
+    uint32_t dropped = trace_take_dropped(core);
+    if (count == 0 && dropped == 0) {
+        return false;
+    }
+
+    tlm_trace_batch_t batch = {
+        .core = core,
+        .count = (uint8_t)count,
+        .dropped = (uint16_t)(dropped > UINT16_MAX ? UINT16_MAX : dropped)
+    };
+    for (uint32_t i = 0; i < count; i++) {
+        batch.events[i] = (tlm_trace_event_t){
+            .ts_us = events[i].ts_us,
+            .dur_us = events[i].dur_us,
+            .point = events[i].point,
+            .flags = events[i].flags,
+            .arg = events[i].arg
+        };
+    }
+    _send(TLM_MSG_TRACE, now_ms, &batch,
+          offsetof(tlm_trace_batch_t, events) + count * sizeof(tlm_trace_event_t));
+    return true;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+void telemetry_init(void) {
+    g_head = 0;
+    g_tail = 0;
+    g_dropped = 0;
+    g_enabled = false;
+    g_seq = 0;
+    g_last_counters_ms = 0;
+    g_trace_core = 0;
+}
+
+void telemetry_set_enabled(bool enabled) {
+    bool was_enabled = g_enabled;
+    g_enabled = enabled;
+    if (enabled && !was_enabled && get_core_num() != TLM_PRODUCER_CORE) {
+        tlm_hello_t hello = {
+            .proto_version = TLM_PROTO_VERSION,
+            .max_devices = SNAPSHOT_MAX_DEVICES,
+            .keystroke_threshold_hz = (uint16_t)hid_monitor_get_tuning()->threshold_hz
+        };
+        _send(TLM_MSG_HELLO, timebase_now_ms(), &hello, sizeof(hello));
+    }
+}
+
+bool telemetry_is_enabled(void) {
+    return g_enabled;
+}
+
+void telemetry_emit(tlm_msg_type_e type, const void *payload, size_t len) {
+    if (!g_enabled || len > TLM_MAX_PAYLOAD) {
+        return;
+    }
+
+    uint32_t now_ms = timebase_now_ms();
+    if (get_core_num() != TLM_PRODUCER_CORE) {
+        _send((uint8_t)type, now_ms, payload, len);
+        return;
+    }
+
+    uint32_t head = g_head;
+    if ((head - g_tail) >= TLM_RING_SIZE) {
+        g_dropped++;
+        return;
+    }
+
+    tlm_slot_t *slot = &g_slots[head & (TLM_RING_SIZE - 1)];
+    slot->type = (uint8_t)type;
+    slot->len = (uint8_t)len;
+    slot->time_ms = now_ms;
+    memcpy(slot->payload, payload, len);
+
+    /* Publish the slot before the new head becomes visible */
+    __dmb();
+    g_head = head + 1;
+}
+
+uint32_t telemetry_drain(uint32_t max_msgs) {
+    uint32_t sent = 0;
+
+    while (sent < max_msgs) {
+        uint32_t tail = g_tail;
+        if (tail == g_head) {
+            break;
+        }
+        __dmb();
+
+        const tlm_slot_t *slot = &g_slots[tail & (TLM_RING_SIZE - 1)];
+        /* Messages queued before a disable are discarded, not sent */
+        if (g_enabled) {
+            _send(slot->type, slot->time_ms, slot->payload, slot->len);
+            sent++;
+        }
+
+        __dmb();
+        g_tail = tail + 1;
+    }
+
+    uint32_t now_ms = timebase_now_ms();
+    if (g_enabled && now_ms - g_last_counters_ms >= TLM_COUNTERS_INTERVAL_MS) {
+        g_last_counters_ms = now_ms;
+        _send_counters(now_ms);
+        sent++;
+    }
+
+    /* Trace batches are capped per run so tracing cannot saturate the UART.
+     * The cores take turns; an overflowing ring reports its drops. */
+    if (g_enabled) {
+        for (uint32_t i = 0; i < TLM_TRACE_FRAMES_PER_DRAIN; i++) {
+            uint8_t first = g_trace_core;
+            g_trace_core ^= 1;
+            if (!_send_trace_batch(first, now_ms) && !_send_trace_batch(first ^ 1, now_ms)) {
+                break;
+            }
+            sent++;
+        }
+    }
+    return sent;
+}
+
+uint32_t telemetry_get_dropped(void) {
+    return g_dropped;
+}
+
+void telemetry_get_counters(tlm_counters_t *out) {
+    const usb_stamp_stats_t *stamps = usb_host_get_stamp_stats();
+    *out = (tlm_counters_t){
+        .tlm_dropped = g_dropped,
+        .log_dropped = dlog_get_dropped(),
+        .events_dropped = event_queue_get_dropped(),
+        .irq_stamped = stamps->irq_stamped,
+        .fallback_stamped = stamps->fallback_stamped,
+        .max_dispatch_us = stamps->max_dispatch_us,
+        .max_usb_task_us = usb_host_get_max_task_us()
+    };
+}
+
+void telemetry_emit_verdict(uint8_t dev_addr, uint8_t level, tlm_verdict_reason_e reason,
+                            bool flood_suspect, uint32_t rate_hz) {
+    /* Every verdict passes through here, so this also marks it on the trace
+     * and records it in the flash journal */
+    TRACE_INSTANT(TRACE_PT_VERDICT, (uint16_t)((level << 8) | dev_addr));
+
+    tlm_verdict_t verdict = {
+        .dev_addr = dev_addr,
+        .level = level,
+        .reason = (uint8_t)reason,
+        .flood_suspect = flood_suspect ? 1 : 0,
+        .rate_hz = rate_hz
+    };
+    journal_append(JOURNAL_REC_VERDICT, &verdict, sizeof(verdict));
+    telemetry_emit(TLM_MSG_VERDICT, &verdict, sizeof(verdict));
+}
+
+void telemetry_emit_string(uint8_t dev_addr, tlm_string_kind_e kind, const char *text) {
+    if (!g_enabled) {
+        return;
+    }
+
+    tlm_descriptor_t desc;
+    size_t len = strnlen(text, sizeof(desc.text));
+    desc.dev_addr = dev_addr;
+    desc.kind = (uint8_t)kind;
+    desc.len = (uint8_t)len;
+    memcpy(desc.text, text, len);
+
+    /* Only the used part of text[] goes on the wire */
+    telemetry_emit(TLM_MSG_DESCRIPTOR, &desc, offsetof(tlm_descriptor_t, text) + len);
+}
@@ -0,0 +1,131 @@
+/*
+ * PlugSafe Telemetry Wire Protocol Implementation
+ * Framing, CRC and message layouts shared by the firmware and host tools
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "telemetry_proto.h"
+#include <string.h>
+
+/* Builds on the host as well: no SDK headers here */
+
+_Static_assert(sizeof(tlm_header_t) == TLM_HEADER_SIZE, "tlm_header_t layout");
+_Static_assert(sizeof(tlm_counters_t) <= TLM_MAX_PAYLOAD, "tlm_counters_t too large");
+_Static_assert(sizeof(tlm_descriptor_t) <= TLM_MAX_PAYLOAD, "tlm_descriptor_t too large");
+
+uint16_t tlm_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t tlm_cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t out_pos = 1;
+    size_t code_pos = 0;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+            continue;
+        }
+        out[out_pos++] = in[i];
+        code++;
+        if (code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return out_pos;
+}
+
+size_t tlm_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t out_max) {
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+
+    while (in_pos < len) {
+        uint8_t code = in[in_pos++];
+        if (code == 0) {
+            return 0;  /* Delimiter inside a frame */
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in_pos >= len || out_pos >= out_max || in[in_pos] == 0) {
+                return 0;
+            }
+            out[out_pos++] = in[in_pos++];
+        }
+        /* A group shorter than 0xFE stands for a zero, except at the end */
+        if (code != 0xFF && in_pos < len) {
+            if (out_pos >= out_max) {
+                return 0;
+            }
+            out[out_pos++] = 0;
+        }
+    }
+    return out_pos;
+}
+
+size_t tlm_build_frame(uint8_t type, uint16_t seq, uint32_t time_ms,
+                       const void *payload, size_t payload_len, uint8_t *out) {
+    if (payload_len > TLM_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    uint8_t raw[TLM_MAX_RAW_FRAME];
+    tlm_header_t header = {
+        .version = TLM_PROTO_VERSION,
+        .type = type,
+        .seq = seq,
+        .time_ms = time_ms
+    };
+    memcpy(raw, &header, sizeof(header));
+    if (payload_len) {
+        memcpy(raw + TLM_HEADER_SIZE, payload, payload_len);
+    }
+
+    size_t raw_len = TLM_HEADER_SIZE + payload_len;
+    uint16_t crc = tlm_crc16(raw, raw_len);
+    raw[raw_len++] = (uint8_t)(crc & 0xFF);
+    raw[raw_len++] = (uint8_t)(crc >> 8);
+
+    out[0] = TLM_FRAME_DELIMITER;
+    size_t encoded = tlm_cobs_encode(raw, raw_len, out + 1);
+    out[1 + encoded] = TLM_FRAME_DELIMITER;
+    return encoded + 2;
+}
+
+bool tlm_parse_frame(const uint8_t *raw, size_t raw_len, tlm_header_t *header,
+                     const uint8_t **payload, size_t *payload_len) {
+    if (raw_len < TLM_HEADER_SIZE + TLM_CRC_SIZE || raw_len > TLM_MAX_RAW_FRAME) {
+        return false;
+    }
+
+    size_t body_len = raw_len - TLM_CRC_SIZE;
+    uint16_t crc = (uint16_t)(raw[body_len] | (raw[body_len + 1] << 8));
+    if (crc != tlm_crc16(raw, body_len)) {
+        return false;
+    }
+
+    memcpy(header, raw, sizeof(*header));
+    if (header->version != TLM_PROTO_VERSION) {
+        return false;
+    }
+
+    *payload = raw + TLM_HEADER_SIZE;
+    *payload_len = body_len - TLM_HEADER_SIZE;
+    return true;
+}
@@ -11,6 +11,10 @@
 
 #include "threat_analyzer.h"
 #include "hid_monitor.h"
+#include "event_queue.h"
+#include "deferred_log.h"
+#include "telemetry.h"
+#include "flight_recorder.h"
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
@@ -24,13 +28,13 @@ static device_threat_t g_threat_devices[MAX_TRACKED_DEVICES];
 /* ===== Public API ===== */
 
 void threat_analyzer_init(void) {
-    printf("[THREAT] Initializing threat analyzer...\n");
+    DLOG("[THREAT] Initializing threat analyzer...\n");
     memset(g_threat_devices, 0, sizeof(g_threat_devices));
-    printf("[THREAT] Threat analyzer ready\n");
-    printf("[THREAT] Classification:\n");
-    printf("  - SAFE: Non-HID devices (USB drives, audio devices, etc.)\n");
-    printf("  - POTENTIALLY_UNSAFE: HID devices (keyboard/mouse - monitor keystroke rate)\n");
-    printf("  - MALICIOUS: HID with keystroke rate > %d keys/sec\n", HID_KEYSTROKE_THRESHOLD_HZ);
+    DLOG("[THREAT] Threat analyzer ready\n");
+    DLOG("[THREAT] Classification:\n");
+    DLOG("  - SAFE: Non-HID devices (USB drives, audio devices, etc.)\n");
+    DLOG("  - POTENTIALLY_UNSAFE: HID devices (keyboard/mouse - monitor keystroke rate)\n");
+    DLOG("  - MALICIOUS: HID with keystroke rate > %d keys/sec\n", HID_KEYSTROKE_THRESHOLD_HZ);
 }
 
 threat_level_e threat_analyze_device(const usb_device_info_t *info) {
@@ -42,24 +46,24 @@ threat_level_e threat_analyze_device(const usb_device_info_t *info) {
     if (info->is_hid) {
         /* Mice (protocol 2) are safe — high report rates are normal mouse movement */
         if (info->hid_protocol == 2) {
-            printf("[THREAT] Device '%s' is HID Mouse - Classification: SAFE ✅\n",
+            DLOG_S("[THREAT] Device '%s' is HID Mouse - Classification: SAFE ✅\n",
                    info->product[0] ? info->product : "Unknown");
-            printf("[THREAT] Reason: Mouse input, no keystroke injection risk\n");
+            DLOG("[THREAT] Reason: Mouse input, no keystroke injection risk\n");
             return THREAT_SAFE;
         }
         
         /* Keyboards (protocol 1) and unknown HID (protocol 0) need monitoring */
         const char *type_str = (info->hid_protocol == 1) ? "Keyboard" : "HID";
-        printf("[THREAT] Device '%s' is %s - Classification: POTENTIALLY_UNSAFE ⚠️\n",
+        DLOG_S("[THREAT] Device '%s' is %s - Classification: POTENTIALLY_UNSAFE ⚠️\n",
                info->product[0] ? info->product : "Unknown", type_str);
-        printf("[THREAT] Reason: %s devices require keystroke rate monitoring\n", type_str);
+        DLOG("[THREAT] Reason: %s devices require keystroke rate monitoring\n", type_str);
         return THREAT_POTENTIALLY_UNSAFE;
     }
     
     /* Non-HID device */
-    printf("[THREAT] Device '%s' is non-HID (class 0x%02X) - Classification: SAFE ✅\n",
+    DLOG_S("[THREAT] Device '%s' is non-HID (class 0x%02X) - Classification: SAFE ✅\n",
            info->product[0] ? info->product : "Unknown", info->usb_class);
-    printf("[THREAT] Reason: Not a keyboard/mouse input device\n");
+    DLOG("[THREAT] Reason: Not a keyboard/mouse input device\n");
     return THREAT_SAFE;
 }
 
@@ -82,22 +86,40 @@ void threat_update_hid_activity(uint8_t dev_addr, uint16_t report_len) {
                 threat->device.is_hid = true;
                 if (threat->threat_level < THREAT_POTENTIALLY_UNSAFE) {
                     threat->threat_level = THREAT_POTENTIALLY_UNSAFE;
+                    event_queue_push(CORE_EVENT_THREAT_CHANGED, dev_addr,
+                                     THREAT_POTENTIALLY_UNSAFE);
+                    telemetry_emit_verdict(dev_addr, THREAT_POTENTIALLY_UNSAFE,
+                                           TLM_REASON_RECLASSIFIED,
+                                           threat->flood_suspect, windowed_rate);
                 }
             }
         }
         
         /* Check if spammy (malicious) — MALICIOUS is sticky, never de-escalates */
-        if (windowed_rate > HID_KEYSTROKE_THRESHOLD_HZ) {
+        uint32_t threshold_hz = hid_monitor_get_tuning()->threshold_hz;
+        if (windowed_rate > threshold_hz) {
             if (threat->threat_level != THREAT_MALICIOUS) {
-                printf("\n[THREAT] 🚨 THREAT ESCALATION 🚨\n");
-                printf("[THREAT] Device '%s' detected with rapid keystroke rate!\n",
-                       threat->device.product[0] ? threat->device.product : "Unknown");
-                printf("[THREAT] Rate: %u keys/sec (threshold: %d keys/sec)\n",
-                       windowed_rate, HID_KEYSTROKE_THRESHOLD_HZ);
-                printf("[THREAT] Classification: MALICIOUS 🚨\n");
-                printf("[THREAT] RECOMMENDATION: DISCONNECT DEVICE IMMEDIATELY\n");
-                printf("[THREAT] This appears to be an automated keystroke injection attack\n");
-                printf("[THREAT] (e.g., Rubber Ducky, BadUSB, or similar malware)\n\n");
+                /* One record for the whole banner: queued in microseconds
+                 * instead of ~40 ms of UART time inside the report callback */
+                DLOG_S("\n[THREAT] 🚨 THREAT ESCALATION 🚨\n"
+                       "[THREAT] Device '%s' detected with rapid keystroke rate!\n"
+                       "[THREAT] Rate: %u keys/sec (threshold: %u keys/sec)\n"
+                       "[THREAT] Classification: MALICIOUS 🚨\n"
+                       "[THREAT] RECOMMENDATION: DISCONNECT DEVICE IMMEDIATELY\n"
+                       "[THREAT] This appears to be an automated keystroke injection attack\n"
+                       "[THREAT] (e.g., Rubber Ducky, BadUSB, or similar malware)\n\n",
+                       threat->device.product[0] ? threat->device.product : "Unknown",
+                       windowed_rate, threshold_hz);
+                event_queue_push(CORE_EVENT_THREAT_CHANGED, dev_addr, THREAT_MALICIOUS);
+                telemetry_emit_verdict(dev_addr, THREAT_MALICIOUS, TLM_REASON_RATE,
+                                       threat->flood_suspect, windowed_rate);
+
+                /* Freeze the reports that led up to the verdict; core 0
+                 * writes them to a forensic flash slot */
+                if (flight_recorder_trigger(dev_addr, THREAT_MALICIOUS, TLM_REASON_RATE)) {
+                    DLOG("[THREAT] Pre-trigger report history of device %d captured\n",
+                         dev_addr);
+                }
             }
             threat->threat_level = THREAT_MALICIOUS;
         }
@@ -142,7 +164,7 @@ bool threat_is_hid_spammy(uint8_t dev_addr) {
 void threat_remove_device(uint8_t dev_addr) {
     for (int i = 0; i < MAX_TRACKED_DEVICES; i++) {
         if (g_threat_devices[i].device.dev_addr == dev_addr) {
-            printf("[THREAT] Device '%s' removed from threat tracking\n",
+            DLOG_S("[THREAT] Device '%s' removed from threat tracking\n",
                    g_threat_devices[i].device.product[0] ? g_threat_devices[i].device.product : "Unknown");
             memset(&g_threat_devices[i], 0, sizeof(g_threat_devices[i]));
             return;
@@ -167,15 +189,39 @@ void threat_add_device(const usb_device_info_t *dev_info) {
             /* Analyze threat level */
             threat->threat_level = threat_analyze_device(dev_info);
             threat->is_active = true;
+            telemetry_emit_verdict(dev_info->dev_addr, threat->threat_level,
+                                   TLM_REASON_CLASSIFIED, false, 0);
             
-            printf("[THREAT] Device '%s' added to threat tracking\n",
+            DLOG_S("[THREAT] Device '%s' added to threat tracking\n",
                    dev_info->product[0] ? dev_info->product : "Unknown");
             
             return;
         }
     }
     
-    printf("[THREAT] [ERROR] Threat tracking array full, cannot add device\n");
+    DLOG("[THREAT] [ERROR] Threat tracking array full, cannot add device\n");
+}
+
+void threat_report_flood(uint8_t dev_addr) {
+    device_threat_t *threat = threat_get_device_status(dev_addr);
+    if (!threat || threat->flood_suspect) {
+        return;
+    }
+
+    threat->flood_suspect = true;
+    threat->device.flood_suspect = true;
+    DLOG_S("[THREAT] Device '%s' is flooding HID reports - flagged as DoS suspect\n",
+           threat->device.product[0] ? threat->device.product : "Unknown");
+
+    /* A flooding keyboard/unknown HID is at least suspicious. Mice keep their
+     * level: a 1 kHz gaming mouse legitimately saturates the budget. */
+    if (threat->device.hid_protocol != 2 &&
+        threat->threat_level < THREAT_POTENTIALLY_UNSAFE) {
+        threat->threat_level = THREAT_POTENTIALLY_UNSAFE;
+    }
+    event_queue_push(CORE_EVENT_FLOOD_SUSPECT, dev_addr, threat->threat_level);
+    telemetry_emit_verdict(dev_addr, threat->threat_level, TLM_REASON_FLOOD, true,
+                           threat->hid_reports_per_sec);
 }
 
 void threat_update_device_info(const usb_device_info_t *dev_info) {
@@ -196,9 +242,12 @@ void threat_update_device_info(const usb_device_info_t *dev_info) {
             threat_level_e new_level = threat_analyze_device(dev_info);
             if (new_level > threat->threat_level) {
                 threat->threat_level = new_level;
-                printf("[THREAT] Device '%s' re-classified to level %d\n",
+                DLOG_S("[THREAT] Device '%s' re-classified to level %d\n",
                        dev_info->product[0] ? dev_info->product : "Unknown",
                        new_level);
+                event_queue_push(CORE_EVENT_THREAT_CHANGED, dev_info->dev_addr, new_level);
+                telemetry_emit_verdict(dev_info->dev_addr, new_level, TLM_REASON_RECLASSIFIED,
+                                       threat->flood_suspect, threat->hid_reports_per_sec);
             }
             
             return;
@@ -206,7 +255,7 @@ void threat_update_device_info(const usb_device_info_t *dev_info) {
     }
     
     /* Device not found in threat tracker — add it */
-    printf("[THREAT] Device %d not tracked yet, adding via update\n", dev_info->dev_addr);
+    DLOG("[THREAT] Device %d not tracked yet, adding via update\n", dev_info->dev_addr);
     threat_add_device(dev_info);
 }
 
@@ -0,0 +1,119 @@
+/*
+ * PlugSafe Event Trace Implementation
+ * Per-core lock-free rings of timestamped spans and instants
+ * Copyright (c) 2026
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ */
+
+#include "trace.h"
+#include "profiler.h"
+#include "pico/stdlib.h"
+#include "timebase.h"
+#include "hardware/sync.h"
+
+/* Profiler probes double as the first trace points */
+_Static_assert(TRACE_PT_USB_TASK == (int)PROBE_USB_TASK, "trace/probe ID mismatch");
+_Static_assert(TRACE_PT_DISPLAY_FLUSH == (int)PROBE_DISPLAY_FLUSH, "trace/probe ID mismatch");
+_Static_assert(TRACE_PT_DISPLAY_FLUSH + 1 == (int)PROBE_COUNT, "trace/probe ID mismatch");
+
+/* One SPSC ring per core: head is written only by the owning core, tail only
+ * by the reader on core 0. Both are free-running and masked on access. */
+typedef struct {
+    trace_event_t events[TRACE_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    uint32_t dropped_reported;        /* Reader side */
+} trace_ring_t;
+
+static trace_ring_t g_rings[2];
+static volatile bool g_enabled = false;
+
+/**
+ * @brief Append one event to the calling core's ring
+ */
+static void _record(uint8_t point, uint8_t flags, uint16_t arg,
+                    uint32_t start_us, uint32_t dur_us) {
+    trace_ring_t *ring = &g_rings[get_core_num()];
+    uint32_t head = ring->head;
+    if ((head - ring->tail) >= TRACE_RING_SIZE) {
+        ring->dropped++;
+        return;
+    }
+
+    trace_event_t *ev = &ring->events[head & (TRACE_RING_SIZE - 1)];
+    ev->ts_us = start_us;
+    ev->dur_us = dur_us;
+    ev->point = point;
+    ev->flags = flags;
+    ev->arg = arg;
+
+    /* Publish the event before the new head becomes visible */
+    __dmb();
+    ring->head = head + 1;
+}
+
+void trace_init(void) {
+    for (uint8_t core = 0; core < 2; core++) {
+        g_rings[core].head = 0;
+        g_rings[core].tail = 0;
+        g_rings[core].dropped = 0;
+        g_rings[core].dropped_reported = 0;
+    }
+    g_enabled = false;
+}
+
+void trace_set_enabled(bool enabled) {
+    g_enabled = enabled;
+}
+
+bool trace_is_enabled(void) {
+    return g_enabled;
+}
+
+void trace_span(uint8_t point, uint16_t arg, uint32_t start_us, uint32_t dur_us) {
+    if (g_enabled) {
+        _record(point, 0, arg, start_us, dur_us);
+    }
+}
+
+void trace_instant(uint8_t point, uint16_t arg) {
+    if (g_enabled) {
+        _record(point, TRACE_FLAG_INSTANT, arg, timebase_now_us32(), 0);
+    }
+}
+
+uint32_t trace_read(uint8_t core, trace_event_t *out, uint32_t max) {
+    if (core > 1) {
+        return 0;
+    }
+
+    trace_ring_t *ring = &g_rings[core];
+    uint32_t count = 0;
+    uint32_t tail = ring->tail;
+    while (count < max && tail != ring->head) {
+        __dmb();
+        out[count++] = ring->events[tail & (TRACE_RING_SIZE - 1)];
+        tail++;
+    }
+
+    /* Release the slots only after they have been copied */
+    __dmb();
+    ring->tail = tail;
+    return count;
+}
+
+uint32_t trace_take_dropped(uint8_t core) {
+    if (core > 1) {
+        return 0;
+    }
+    trace_ring_t *ring = &g_rings[core];
+    uint32_t dropped = ring->dropped;
+    uint32_t delta = dropped - ring->dropped_reported;
+    ring->dropped_reported = dropped;
+    return delta;
+}
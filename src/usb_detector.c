@@ -8,7 +8,7 @@
 
 #include "usb_detector.h"
 #include "pico/stdlib.h"
-#include "pico/time.h"
+#include "timebase.h"
 #include "hardware/gpio.h"
 #include <stdio.h>
 
@@ -89,7 +89,7 @@ static void usb_detector_update_led(void)
         return;  // Skip automatic control if manual control is active
     }
 
-    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t now_ms = timebase_now_ms();
     uint32_t blink_period;
 
     // Select blink period based on state
@@ -143,7 +143,7 @@ static void usb_detector_update_state(void)
             }
 
             // Record when state changed
-            state_change_time_ms = to_ms_since_boot(get_absolute_time());
+            state_change_time_ms = timebase_now_ms();
             debounce_counter = 0;
         }
     }
@@ -178,7 +178,7 @@ void usb_detector_init(void)
     manual_led_control = false;
 
     // Record initialization time
-    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t now_ms = timebase_now_ms();
     led_last_toggle_ms = now_ms;
     state_change_time_ms = now_ms;
 
@@ -198,14 +198,14 @@ void usb_detector_update(void)
     // Handle device registration/unregistration on state change
     if (current_state != previous_state) {
         if (current_state == USB_DETECTOR_STATE_DETECTED) {
-            printf("[USB Detector] Device DETECTED at %u ms\n", to_ms_since_boot(get_absolute_time()));
+            printf("[USB Detector] Device DETECTED at %u ms\n", timebase_now_ms());
             
             /* Register device with USB host system */
             extern bool usb_register_gpio_device(uint16_t vid, uint16_t pid);
             usb_register_gpio_device(0x0000, 0x0000);  /* Unknown VID/PID */
             
         } else {
-            printf("[USB Detector] Device DISCONNECTED at %u ms\n", to_ms_since_boot(get_absolute_time()));
+            printf("[USB Detector] Device DISCONNECTED at %u ms\n", timebase_now_ms());
             
             /* Unregister device from USB host system */
             extern void usb_unregister_gpio_device(void);
@@ -227,7 +227,7 @@ bool usb_detector_is_device_connected(void)
 
 uint32_t usb_detector_get_state_duration_ms(void)
 {
-    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    uint32_t now_ms = timebase_now_ms();
     return (now_ms - state_change_time_ms);
 }
 
@@ -12,10 +12,21 @@
 #include "usb_host.h"
 #include "threat_analyzer.h"
 #include "hid_monitor.h"
+#include "event_queue.h"
+#include "state_snapshot.h"
+#include "profiler.h"
+#include "trace.h"
+#include "deferred_log.h"
+#include "telemetry.h"
+#include "flight_recorder.h"
+#include "hid_trace.h"
+#include "journal.h"
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
-#include "pico/time.h"
+#include "timebase.h"
+#include "hardware/irq.h"
+#include "hardware/structs/usb.h"
 #include "tusb.h"
 
 /* ============================================================================
@@ -28,6 +39,9 @@
 /* Maximum number of tracked devices */
 #define MAX_DEVICES 4
 
+/* Maximum number of budgeted HID interfaces (one per TinyUSB HID instance) */
+#define MAX_HID_INTERFACES CFG_TUH_HID
+
 /* ============================================================================
  * USB TRANSFER BUFFERS (DMA-aligned for USB controller)
  * ============================================================================ */
@@ -49,6 +63,42 @@ static usb_device_info_t g_usb_devices[MAX_DEVICES];
 /* Track if a USB hub is connected (warning flag) */
 static bool g_hub_connected = false;
 
+/* Per-interface HID report budgets */
+static hid_itf_budget_t g_hid_budgets[MAX_HID_INTERFACES];
+
+/* Worst-case usb_host_task() duration */
+static uint32_t g_max_task_us = 0;
+
+/* Set from IRQ context when TinyUSB queues an event for tuh_task() */
+static volatile bool g_usb_event_pending = false;
+
+/* Device/threat state changed since the last snapshot publish */
+static bool g_snapshot_dirty = false;
+
+/* ============================================================================
+ * IRQ-TIME REPORT TIMESTAMPS
+ * ============================================================================ */
+
+/* Completion stamp for one host interrupt endpoint (IEP1..IEP15). Written by
+ * the USB IRQ while !valid, consumed (valid cleared) by the report callback.
+ * At most one transfer per endpoint is in flight, so a slot cannot be
+ * overwritten before its report has been dispatched. */
+typedef struct {
+    uint64_t time_us;
+    uint32_t seq;
+    uint16_t frame;
+    volatile bool valid;
+} irq_stamp_t;
+
+static irq_stamp_t g_irq_stamps[USB_HOST_INTERRUPT_ENDPOINTS];
+static uint32_t g_irq_stamp_seq = 0;
+static usb_stamp_stats_t g_stamp_stats;
+
+/* Quiet test for flash erases (core 0 only): report count last seen and
+ * when it last changed */
+static uint32_t g_quiet_report_count = 0;
+static uint32_t g_quiet_since_ms = 0;
+
 /* ============================================================================
  * UTF-16 TO UTF-8 CONVERSION HELPERS
  * (Adapted from TinyUSB device_info example)
@@ -159,16 +209,261 @@ static usb_device_info_t *_find_device(uint8_t dev_addr) {
     return NULL;
 }
 
+/**
+ * @brief Journal the device's string identity: a CRC over manufacturer,
+ * product and serial (NUL-separated) plus the start of the product name
+ */
+static void _journal_fingerprint(const usb_device_info_t *dev) {
+    char strings[sizeof(dev->manufacturer) + sizeof(dev->product) + sizeof(dev->serial)];
+    size_t len = 0;
+    const char *parts[] = { dev->manufacturer, dev->product, dev->serial };
+    for (int i = 0; i < 3; i++) {
+        size_t n = strnlen(parts[i], sizeof(dev->product) - 1);
+        memcpy(strings + len, parts[i], n);
+        len += n;
+        strings[len++] = '\0';
+    }
+
+    journal_fingerprint_t fp = {
+        .dev_addr = dev->dev_addr,
+        .strings_crc = hid_trace_crc32(strings, len)
+    };
+    strncpy(fp.product, dev->product, sizeof(fp.product));
+    journal_append(JOURNAL_REC_FINGERPRINT, &fp, sizeof(fp));
+}
+
+/* ============================================================================
+ * REPORT TIMESTAMPING
+ * ============================================================================ */
+
+/**
+ * @brief Shared USBCTRL_IRQ handler that stamps interrupt-endpoint completions.
+ *
+ * Runs ahead of TinyUSB's handler, while BUFF_STATUS still shows which
+ * host interrupt endpoints completed. In host mode IEPn IN is bit 2n
+ * (EPX owns bits 0/1). The stamp pairs timebase_now_us() with the 11-bit frame
+ * number of the last SOF the controller sent.
+ */
+static void _usb_irq_stamp_handler(void) {
+    uint32_t status = usb_hw->buf_status;
+    if (status == 0) {
+        return;
+    }
+
+    uint64_t now_us = timebase_now_us();
+    uint16_t frame = (uint16_t)(usb_hw->sof_rd & USB_SOF_RD_BITS);
+
+    for (uint i = 0; i < USB_HOST_INTERRUPT_ENDPOINTS; i++) {
+        irq_stamp_t *stamp = &g_irq_stamps[i];
+        if ((status & (1u << ((i + 1) * 2))) && !stamp->valid) {
+            stamp->time_us = now_us;
+            stamp->frame = frame;
+            stamp->seq = ++g_irq_stamp_seq;
+            __dmb();
+            stamp->valid = true;
+        }
+    }
+}
+
+/**
+ * @brief Drop pending completion stamps of a device's interrupt endpoints
+ */
+static void _clear_irq_stamps(uint8_t dev_addr) {
+    for (uint i = 0; i < USB_HOST_INTERRUPT_ENDPOINTS; i++) {
+        uint32_t ctrl = usb_hw->int_ep_addr_ctrl[i];
+        if ((ctrl & USB_ADDR_ENDP1_ADDRESS_BITS) == dev_addr) {
+            g_irq_stamps[i].valid = false;
+        }
+    }
+}
+
+/**
+ * @brief Claim the completion stamp of the report being dispatched.
+ *
+ * TinyUSB dispatches completions in FIFO order, so the report now being
+ * delivered for dev_addr is the oldest unclaimed stamp among the device's
+ * interrupt IN endpoints. Falls back to the callback time (and current
+ * frame) when no fresh stamp exists.
+ */
+static void _take_report_stamp(uint8_t dev_addr, uint64_t now_us,
+                               uint64_t *time_us, uint16_t *frame) {
+    irq_stamp_t *oldest = NULL;
+
+    for (uint i = 0; i < USB_HOST_INTERRUPT_ENDPOINTS; i++) {
+        irq_stamp_t *stamp = &g_irq_stamps[i];
+        if (!stamp->valid) {
+            continue;
+        }
+        uint32_t ctrl = usb_hw->int_ep_addr_ctrl[i];
+        if ((ctrl & USB_ADDR_ENDP1_ADDRESS_BITS) != dev_addr ||
+            (ctrl & USB_ADDR_ENDP1_INTEP_DIR_BITS)) {
+            continue;   /* Other device, or an OUT endpoint */
+        }
+        if (!oldest || (int32_t)(stamp->seq - oldest->seq) < 0) {
+            oldest = stamp;
+        }
+    }
+
+    if (oldest && (now_us - oldest->time_us) <= USB_STAMP_MAX_AGE_US) {
+        uint32_t delay_us = (uint32_t)(now_us - oldest->time_us);
+        *time_us = oldest->time_us;
+        *frame = oldest->frame;
+        g_stamp_stats.irq_stamped++;
+        g_stamp_stats.total_dispatch_us += delay_us;
+        if (delay_us > g_stamp_stats.max_dispatch_us) {
+            g_stamp_stats.max_dispatch_us = delay_us;
+        }
+    } else {
+        *time_us = now_us;
+        *frame = (uint16_t)(usb_hw->sof_rd & USB_SOF_RD_BITS);
+        g_stamp_stats.fallback_stamped++;
+    }
+
+    if (oldest) {
+        oldest->valid = false;
+    }
+}
+
+/* ============================================================================
+ * HID REPORT BUDGETING
+ * ============================================================================ */
+
+/**
+ * @brief Find the budget slot of a HID interface
+ * @return Pointer to the budget, or NULL
+ */
+static hid_itf_budget_t *_find_budget(uint8_t dev_addr, uint8_t instance) {
+    for (int i = 0; i < MAX_HID_INTERFACES; i++) {
+        if (g_hid_budgets[i].in_use &&
+            g_hid_budgets[i].dev_addr == dev_addr &&
+            g_hid_budgets[i].instance == instance) {
+            return &g_hid_budgets[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Allocate a budget slot for a newly mounted HID interface
+ * @return Pointer to the budget, or NULL if all slots are in use
+ */
+static hid_itf_budget_t *_alloc_budget(uint8_t dev_addr, uint8_t instance) {
+    hid_itf_budget_t *budget = _find_budget(dev_addr, instance);
+    for (int i = 0; !budget && i < MAX_HID_INTERFACES; i++) {
+        if (!g_hid_budgets[i].in_use) {
+            budget = &g_hid_budgets[i];
+        }
+    }
+    if (budget) {
+        memset(budget, 0, sizeof(*budget));
+        budget->dev_addr = dev_addr;
+        budget->instance = instance;
+        budget->in_use = true;
+        budget->window_start_ms = timebase_now_ms();
+    }
+    return budget;
+}
+
+/**
+ * @brief Release every budget slot belonging to a device
+ */
+static void _free_budgets(uint8_t dev_addr) {
+    for (int i = 0; i < MAX_HID_INTERFACES; i++) {
+        if (g_hid_budgets[i].in_use && g_hid_budgets[i].dev_addr == dev_addr) {
+            memset(&g_hid_budgets[i], 0, sizeof(g_hid_budgets[i]));
+        }
+    }
+}
+
+/**
+ * @brief Flag an interface (and its device) as a flooding / DoS suspect
+ */
+static void _budget_flag_flood(hid_itf_budget_t *budget) {
+    budget->flood_suspect = true;
+    DLOG("[HID] WARNING: Report flood from dev_addr=%d instance=%d "
+         "(%u deferrals) - flagged as DoS suspect\n",
+         budget->dev_addr, budget->instance, budget->deferred_count);
+
+    usb_device_info_t *dev = _find_device(budget->dev_addr);
+    if (dev) {
+        dev->flood_suspect = true;
+    }
+    threat_report_flood(budget->dev_addr);
+    g_snapshot_dirty = true;
+}
+
+/**
+ * @brief Close the budget window if it has elapsed and open a new one.
+ *
+ * An interface that exhausts its budget for HID_BUDGET_FLOOD_WINDOWS
+ * consecutive windows is flagged as a flooding suspect (sticky).
+ */
+static void _budget_roll_window(hid_itf_budget_t *budget, uint64_t now_ms) {
+    if ((now_ms - budget->window_start_ms) < HID_BUDGET_WINDOW_MS) {
+        return;
+    }
+
+    if (budget->window_exhausted) {
+        if (budget->exhausted_windows < UINT8_MAX) {
+            budget->exhausted_windows++;
+        }
+        if (!budget->flood_suspect &&
+            budget->exhausted_windows >= HID_BUDGET_FLOOD_WINDOWS) {
+            _budget_flag_flood(budget);
+        }
+    } else {
+        budget->exhausted_windows = 0;
+    }
+
+    budget->window_start_ms = now_ms;
+    budget->window_reports = 0;
+    budget->window_cpu_us = 0;
+    budget->window_exhausted = false;
+}
+
+/**
+ * @brief Re-arm interfaces whose report request was deferred, once their
+ * budget window has ended.
+ */
+static void _budget_service_deferred(uint64_t now_ms) {
+    for (int i = 0; i < MAX_HID_INTERFACES; i++) {
+        hid_itf_budget_t *budget = &g_hid_budgets[i];
+        if (!budget->in_use || !budget->rearm_pending) {
+            continue;
+        }
+        if ((now_ms - budget->window_start_ms) < HID_BUDGET_WINDOW_MS) {
+            continue;
+        }
+
+        _budget_roll_window(budget, now_ms);
+        budget->rearm_pending = false;
+        if (!tuh_hid_receive_report(budget->dev_addr, budget->instance)) {
+            DLOG("[HID] ERROR: Cannot re-request report from dev_addr=%d instance=%d\n",
+                 budget->dev_addr, budget->instance);
+        }
+    }
+}
+
 /* ============================================================================
  * PUBLIC API FUNCTIONS
  * ============================================================================ */
 
 bool usb_host_init(void) {
-    printf("[USB] Initializing USB Host Stack...\n");
+    DLOG("[USB] Initializing USB Host Stack...\n");
 
     /* Clear device array */
     memset(g_usb_devices, 0, sizeof(g_usb_devices));
+    memset(g_hid_budgets, 0, sizeof(g_hid_budgets));
     g_hub_connected = false;
+    g_max_task_us = 0;
+    memset(g_irq_stamps, 0, sizeof(g_irq_stamps));
+    memset(&g_stamp_stats, 0, sizeof(g_stamp_stats));
+    g_quiet_report_count = 0;
+    g_quiet_since_ms = timebase_now_ms();
+
+    /* Readers on other cores only ever see published snapshots */
+    state_snapshot_init();
+    state_snapshot_publish();
 
     /* Initialize TinyUSB host stack on native USB port 0 */
     tusb_rhport_init_t host_init = {
@@ -176,19 +471,58 @@ bool usb_host_init(void) {
         .speed = TUSB_SPEED_AUTO
     };
     if (!tusb_init(BOARD_TUH_RHPORT, &host_init)) {
-        printf("[USB] ERROR: tusb_init() failed!\n");
+        DLOG("[USB] ERROR: tusb_init() failed!\n");
         return false;
     }
 
-    printf("[USB] TinyUSB host initialized on port %d\n", BOARD_TUH_RHPORT);
-    printf("[USB] Ready for device enumeration\n");
+    /* Stamp HID transfer completions in the USB IRQ. Added after tusb_init()
+     * at the same (highest) order priority as TinyUSB's handler: the SDK
+     * places a newly added handler ahead of existing equal-priority ones, so
+     * this runs while BUFF_STATUS is still uncleared. */
+    irq_add_shared_handler(USBCTRL_IRQ, _usb_irq_stamp_handler,
+                           PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+
+    DLOG("[USB] TinyUSB host initialized on port %d\n", BOARD_TUH_RHPORT);
+    DLOG("[USB] Ready for device enumeration\n");
 
     return true;
 }
 
 void usb_host_task(void) {
+    PROFILE_SCOPE(PROBE_USB_TASK);
+    uint64_t start_us = timebase_now_us();
+
+    /* Clear before draining: events queued while tuh_task() runs set it again */
+    g_usb_event_pending = false;
+
     /* Process TinyUSB host events (enumeration, callbacks, etc.) */
     tuh_task();
+
+    uint32_t elapsed_us = (uint32_t)(timebase_now_us() - start_us);
+    if (elapsed_us > g_max_task_us) {
+        g_max_task_us = elapsed_us;
+    }
+}
+
+void usb_host_analysis_task(void) {
+    PROFILE_SCOPE(PROBE_ANALYSIS_TASK);
+
+    /* Re-arm HID interfaces that were throttled by their report budget */
+    _budget_service_deferred(timebase_now_us() / 1000);
+
+    /* Publish one consistent snapshot per batch of callbacks */
+    if (g_snapshot_dirty) {
+        g_snapshot_dirty = false;
+        state_snapshot_publish();
+    }
+
+    /* Only now hand over the batch's events: core 0 reads the snapshot as
+     * soon as it sees one */
+    event_queue_commit();
+}
+
+bool usb_host_event_pending(void) {
+    return g_usb_event_pending;
 }
 
 usb_device_info_t *usb_get_device_info(uint8_t dev_addr) {
@@ -226,10 +560,59 @@ bool usb_is_hub_connected(void) {
     return g_hub_connected;
 }
 
+hid_itf_budget_t *usb_get_hid_budget(uint8_t dev_addr, uint8_t instance) {
+    return _find_budget(dev_addr, instance);
+}
+
+uint32_t usb_host_get_max_task_us(void) {
+    return g_max_task_us;
+}
+
+usb_stamp_stats_t *usb_host_get_stamp_stats(void) {
+    return &g_stamp_stats;
+}
+
+bool usb_host_reports_quiet(uint32_t now_ms, uint32_t quiet_ms) {
+    uint32_t count = g_stamp_stats.irq_stamped + g_stamp_stats.fallback_stamped;
+    if (count != g_quiet_report_count) {
+        g_quiet_report_count = count;
+        g_quiet_since_ms = now_ms;
+        return false;
+    }
+    return now_ms - g_quiet_since_ms >= quiet_ms;
+}
+
+void usb_host_print_stats(void) {
+    PROFILE_SCOPE(PROBE_STATS_PRINT);
+
+    uint32_t avg_us = g_stamp_stats.irq_stamped ?
+        (uint32_t)(g_stamp_stats.total_dispatch_us / g_stamp_stats.irq_stamped) : 0;
+    DLOG("[USB] Event-to-callback: avg %u us, max %u us (%u stamped, %u fallback)\n",
+         avg_us, g_stamp_stats.max_dispatch_us,
+         g_stamp_stats.irq_stamped, g_stamp_stats.fallback_stamped);
+    DLOG("[USB] Worst usb_host_task(): %u us\n", g_max_task_us);
+}
+
 /* ============================================================================
  * TinyUSB HOST CALLBACKS
  * ============================================================================ */
 
+/**
+ * @brief Called by TinyUSB whenever an event is queued for tuh_task(),
+ * usually from the USB IRQ.
+ *
+ * Flags pending work for the main loop and issues SEV so a core that is
+ * about to park in __wfe() wakes up instead of missing the event.
+ */
+void tuh_event_hook_cb(uint8_t rhport, uint32_t eventid, bool in_isr) {
+    (void)rhport;
+    (void)eventid;
+    (void)in_isr;
+
+    g_usb_event_pending = true;
+    __sev();
+}
+
 /**
  * @brief Called by TinyUSB when a device is mounted (enumerated).
  *
@@ -237,20 +620,23 @@ bool usb_is_hub_connected(void) {
  * and then fetch string descriptors for manufacturer/product/serial.
  */
 void tuh_mount_cb(uint8_t daddr) {
-    printf("[USB] Device mounted at address %d\n", daddr);
+    PROFILE_SCOPE(PROBE_TUH_MOUNT_CB);
+    DLOG("[USB] Device mounted at address %d\n", daddr);
 
     usb_device_info_t *dev = _find_free_slot();
     if (!dev) {
-        printf("[USB] ERROR: No free slot for device %d\n", daddr);
+        DLOG("[USB] ERROR: No free slot for device %d\n", daddr);
         return;
     }
 
     memset(dev, 0, sizeof(*dev));
     dev->dev_addr = daddr;
     dev->is_mounted = true;
-    dev->connected_time_ms = to_ms_since_boot(get_absolute_time());
+    g_snapshot_dirty = true;
+    dev->connected_time_ms = timebase_now_ms();
 
     /* ---- Device descriptor (synchronous) ---- */
+    uint32_t stage_start_us = timebase_now_us32();
     uint8_t xfer_result = tuh_descriptor_get_device_sync(daddr, &_desc.device, 18);
     if (XFER_RESULT_SUCCESS == xfer_result) {
         dev->vid = _desc.device.idVendor;
@@ -260,25 +646,29 @@ void tuh_mount_cb(uint8_t daddr) {
         dev->protocol = _desc.device.bDeviceProtocol;
         dev->descriptor_ready = true;
 
-        printf("[USB] VID: 0x%04X  PID: 0x%04X  Class: 0x%02X\n",
-               dev->vid, dev->pid, dev->usb_class);
+        DLOG("[USB] VID: 0x%04X  PID: 0x%04X  Class: 0x%02X\n",
+             dev->vid, dev->pid, dev->usb_class);
+        flight_recorder_add_device(daddr, (const uint8_t *)&_desc.device);
 
         /* Check for hub (class 0x09) */
         if (dev->usb_class == 0x09) {
             g_hub_connected = true;
-            printf("[USB] WARNING: USB Hub detected!\n");
+            DLOG("[USB] WARNING: USB Hub detected!\n");
         }
     } else {
-        printf("[USB] WARNING: Failed to get device descriptor (result=%d)\n", xfer_result);
+        DLOG("[USB] WARNING: Failed to get device descriptor (result=%d)\n", xfer_result);
         /* Set defaults */
         snprintf(dev->manufacturer, sizeof(dev->manufacturer), "Unknown");
         snprintf(dev->product, sizeof(dev->product), "USB Device");
         snprintf(dev->serial, sizeof(dev->serial), "N/A");
         dev->descriptor_ready = false;
     }
+    TRACE_SPAN(TRACE_PT_ENUM_DEVICE_DESC, daddr, stage_start_us);
 
     /* ---- String descriptors (synchronous) ---- */
     if (dev->descriptor_ready) {
+        stage_start_us = timebase_now_us32();
+
         /* Manufacturer string */
         if (_desc.device.iManufacturer != 0) {
             xfer_result = tuh_descriptor_get_manufacturer_string_sync(
@@ -319,30 +709,56 @@ void tuh_mount_cb(uint8_t daddr) {
         }
 
         dev->strings_ready = true;
+        TRACE_SPAN(TRACE_PT_ENUM_STRINGS, daddr, stage_start_us);
 
-        printf("[USB] Manufacturer: %s\n", dev->manufacturer);
-        printf("[USB] Product:      %s\n", dev->product);
-        printf("[USB] Serial:       %s\n", dev->serial);
+        DLOG_S("[USB] Manufacturer: %s\n", dev->manufacturer);
+        DLOG_S("[USB] Product:      %s\n", dev->product);
+        DLOG_S("[USB] Serial:       %s\n", dev->serial);
     }
 
-    /* Notify threat analyzer */
+    /* Structured copy of the above for the telemetry stream */
+    tlm_mount_t mount = {
+        .dev_addr = daddr,
+        .vid = dev->vid,
+        .pid = dev->pid,
+        .usb_class = dev->usb_class,
+        .subclass = dev->subclass,
+        .protocol = dev->protocol,
+        .descriptor_ready = dev->descriptor_ready
+    };
+    telemetry_emit(TLM_MSG_MOUNT, &mount, sizeof(mount));
+    journal_append(JOURNAL_REC_MOUNT, &mount, sizeof(mount));
+    if (dev->strings_ready) {
+        telemetry_emit_string(daddr, TLM_STR_MANUFACTURER, dev->manufacturer);
+        telemetry_emit_string(daddr, TLM_STR_PRODUCT, dev->product);
+        telemetry_emit_string(daddr, TLM_STR_SERIAL, dev->serial);
+        _journal_fingerprint(dev);
+    }
+
+    /* Notify threat analyzer and the UI core */
+    stage_start_us = timebase_now_us32();
     threat_add_device(dev);
+    TRACE_SPAN(TRACE_PT_ENUM_CLASSIFY, daddr, stage_start_us);
+    event_queue_push(CORE_EVENT_DEVICE_MOUNTED, daddr, 0);
 
-    printf("[USB] Device %d fully enumerated\n", daddr);
+    DLOG("[USB] Device %d fully enumerated\n", daddr);
 }
 
 /**
  * @brief Called by TinyUSB when a device is unmounted (disconnected).
  */
 void tuh_umount_cb(uint8_t daddr) {
-    printf("[USB] Device unmounted at address %d\n", daddr);
+    PROFILE_SCOPE(PROBE_TUH_UMOUNT_CB);
+    DLOG("[USB] Device unmounted at address %d\n", daddr);
 
     usb_device_info_t *dev = _find_device(daddr);
     if (dev) {
+        g_snapshot_dirty = true;
+
         /* Check if this was a hub */
         if (dev->usb_class == 0x09) {
             g_hub_connected = false;
-            printf("[USB] Hub disconnected\n");
+            DLOG("[USB] Hub disconnected\n");
         }
 
         /* Notify threat analyzer and HID monitor */
@@ -350,12 +766,19 @@ void tuh_umount_cb(uint8_t daddr) {
         if (dev->is_hid) {
             hid_monitor_remove_device(daddr);
         }
+        _free_budgets(daddr);
+        flight_recorder_remove_device(daddr);
 
         /* Clear the slot */
         memset(dev, 0, sizeof(*dev));
-        printf("[USB] Device %d removed\n", daddr);
+        DLOG("[USB] Device %d removed\n", daddr);
+        event_queue_push(CORE_EVENT_DEVICE_UNMOUNTED, daddr, 0);
+        tlm_unmount_t unmount = { .dev_addr = daddr };
+        telemetry_emit(TLM_MSG_UNMOUNT, &unmount, sizeof(unmount));
+        journal_append(JOURNAL_REC_UNMOUNT, &unmount, sizeof(unmount));
+        usb_host_print_stats();
     } else {
-        printf("[USB] WARNING: Unmount for unknown device %d\n", daddr);
+        DLOG("[USB] WARNING: Unmount for unknown device %d\n", daddr);
     }
 }
 
@@ -366,24 +789,26 @@ void tuh_umount_cb(uint8_t daddr) {
 /**
  * @brief Called when a HID interface is mounted on a device.
  *
- * We mark the device as HID, register it with hid_monitor, and start
- * receiving reports via tuh_hid_receive_report().
+ * We mark the device as HID, register it with hid_monitor, open a report
+ * budget for the interface, and start receiving reports via
+ * tuh_hid_receive_report().
  */
 void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
                        uint8_t const *desc_report, uint16_t desc_len) {
-    (void)desc_report;
-    (void)desc_len;
+    PROFILE_SCOPE(PROBE_HID_MOUNT_CB);
 
-    printf("[HID] HID mounted: dev_addr=%d instance=%d\n", dev_addr, instance);
+    DLOG("[HID] HID mounted: dev_addr=%d instance=%d\n", dev_addr, instance);
 
     uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
+    flight_recorder_add_interface(dev_addr, instance, itf_protocol, desc_report, desc_len);
     const char *protocol_str[] = {"None", "Keyboard", "Mouse"};
-    printf("[HID] Interface Protocol = %s\n",
-           (itf_protocol < 3) ? protocol_str[itf_protocol] : "Unknown");
+    DLOG("[HID] Interface Protocol = %s\n",
+         (itf_protocol < 3) ? protocol_str[itf_protocol] : "Unknown");
 
     /* Mark the device as HID */
     usb_device_info_t *dev = _find_device(dev_addr);
     if (dev) {
+        g_snapshot_dirty = true;
         dev->is_hid = true;
         dev->instance = instance;
         dev->hid_protocol = itf_protocol;
@@ -396,20 +821,35 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
         /* Re-notify threat analyzer with updated device info (is_hid is now true)
          * so it re-classifies based on protocol (keyboard vs mouse) */
         threat_update_device_info(dev);
+        event_queue_push(CORE_EVENT_HID_MOUNTED, dev_addr, itf_protocol);
     }
+    tlm_hid_mount_t hid_mount = {
+        .dev_addr = dev_addr,
+        .instance = instance,
+        .protocol = itf_protocol
+    };
+    telemetry_emit(TLM_MSG_HID_MOUNT, &hid_mount, sizeof(hid_mount));
 
     /* Only monitor keyboards and unknown HID for keystroke rate.
      * Mice (protocol 2) generate high report rates from normal movement. */
     if (itf_protocol != 2) {
         hid_monitor_add_device(dev_addr);
     } else {
-        printf("[HID] Mouse detected — skipping keystroke rate monitoring\n");
+        DLOG("[HID] Mouse detected — skipping keystroke rate monitoring\n");
+    }
+
+    /* Every interface is budgeted, mice included — they are the ones most
+     * likely to report at the full 1 kHz frame rate. */
+    _clear_irq_stamps(dev_addr);
+    if (!_alloc_budget(dev_addr, instance)) {
+        DLOG("[HID] WARNING: No free budget slot for dev_addr=%d instance=%d\n",
+             dev_addr, instance);
     }
 
     /* Start receiving HID reports */
     if (!tuh_hid_receive_report(dev_addr, instance)) {
-        printf("[HID] ERROR: Cannot request report from dev_addr=%d instance=%d\n",
-               dev_addr, instance);
+        DLOG("[HID] ERROR: Cannot request report from dev_addr=%d instance=%d\n",
+             dev_addr, instance);
     }
 }
 
@@ -417,31 +857,83 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance,
  * @brief Called when a HID interface is unmounted.
  */
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
-    printf("[HID] HID unmounted: dev_addr=%d instance=%d\n", dev_addr, instance);
+    DLOG("[HID] HID unmounted: dev_addr=%d instance=%d\n", dev_addr, instance);
+
+    hid_itf_budget_t *budget = _find_budget(dev_addr, instance);
+    if (budget) {
+        memset(budget, 0, sizeof(*budget));
+    }
 }
 
 /**
  * @brief Called when a HID report is received from a device.
  *
  * Feeds the report to hid_monitor (keystroke rate tracking) and
- * threat_analyzer (attack detection), then re-requests the next report.
+ * threat_analyzer (attack detection), then re-requests the next report —
+ * unless the interface has exhausted its report budget, in which case the
+ * request is deferred to usb_host_task() at the end of the budget window.
  */
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance,
                                  uint8_t const *report, uint16_t len) {
+    PROFILE_SCOPE(PROBE_HID_REPORT_CB);
+    uint64_t start_us = timebase_now_us();
+    hid_itf_budget_t *budget = _find_budget(dev_addr, instance);
+    if (budget) {
+        _budget_roll_window(budget, start_us / 1000);
+    }
+
+    /* Arrival time as recorded by the USB IRQ at transfer completion */
+    uint64_t arrival_us;
+    uint16_t arrival_frame;
+    _take_report_stamp(dev_addr, start_us, &arrival_us, &arrival_frame);
+
+    /* Keep the raw report before analysis, so a report that triggers a
+     * verdict is part of the captured history */
+    flight_recorder_record(dev_addr, instance, report, len, arrival_us);
+
     /* Only feed keyboard/unknown HID to rate monitoring and threat analysis.
      * Mice generate high report rates from normal movement — skip them. */
     usb_device_info_t *dev = _find_device(dev_addr);
     if (dev && dev->hid_protocol != 2) {
+        /* Only rate or level changes warrant a new snapshot, not every report */
+        device_threat_t *threat = threat_get_device_status(dev_addr);
+        uint32_t prev_rate = threat ? threat->hid_reports_per_sec : 0;
+        threat_level_e prev_level = threat ? threat->threat_level : THREAT_SAFE;
+
         /* Feed to HID monitor for keystroke rate analysis */
-        hid_monitor_report(dev_addr, report, len);
+        hid_monitor_report(dev_addr, report, len, arrival_us, arrival_frame);
 
         /* Feed to threat analyzer for attack detection */
         threat_update_hid_activity(dev_addr, len);
+        if (threat && (threat->hid_reports_per_sec != prev_rate ||
+                       threat->threat_level != prev_level)) {
+            g_snapshot_dirty = true;
+        }
+    }
+
+    /* Charge this report against the interface budget */
+    if (budget) {
+        uint32_t cost_us = (uint32_t)(timebase_now_us() - start_us);
+        budget->total_reports++;
+        budget->window_reports++;
+        budget->window_cpu_us += cost_us;
+        if (cost_us > budget->max_report_us) {
+            budget->max_report_us = cost_us;
+        }
+
+        if (budget->window_reports >= HID_BUDGET_MAX_REPORTS ||
+            budget->window_cpu_us >= HID_BUDGET_MAX_CPU_US) {
+            /* Over budget: leave the endpoint idle until the window ends */
+            budget->window_exhausted = true;
+            budget->rearm_pending = true;
+            budget->deferred_count++;
+            return;
+        }
     }
 
     /* Continue requesting reports (always, even for mice — TinyUSB needs this) */
     if (!tuh_hid_receive_report(dev_addr, instance)) {
-        printf("[HID] ERROR: Cannot re-request report from dev_addr=%d instance=%d\n",
-               dev_addr, instance);
+        DLOG("[HID] ERROR: Cannot re-request report from dev_addr=%d instance=%d\n",
+             dev_addr, instance);
     }
 }